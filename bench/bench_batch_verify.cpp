@@ -0,0 +1,102 @@
+// 签名批量验证基准：批大小 16..4096，签名内容与证明包相同（60 字节），单线程。
+// 对比同一批签名：
+//   ECDSA P-256 逐个验证（VerifyKeyCache，公钥已预热）
+//   Ed25519 逐个验证（VerifyKeyCache，公钥已预热）
+//   Ed25519 tee_verify_batch（随机线性组合 + 多标量乘法）
+// 分别测每个签名来自不同飞地、以及全批来自 16 个飞地两种情况（后者同一公钥的项合并）。
+// 用法：bench_batch_verify [最大批大小]
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../src/tee_simulator/enclave_sign.h"
+#include "../src/tee_simulator/verify_key_cache.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Batch {
+    std::vector<EnclaveKeyPair> keys;
+    std::vector<std::vector<uint8_t>> messages;
+    std::vector<std::array<uint8_t, 64>> sigs;
+    std::vector<SignatureBatchItem> items;
+};
+
+static bool make_batch(Batch& b, size_t n, size_t enclaves, SignatureScheme scheme) {
+    b.keys.resize(enclaves);
+    for (auto& key : b.keys) {
+        if (tee_init_key_pair(key, scheme) != 0) return false;
+    }
+    b.messages.assign(n, std::vector<uint8_t>(60));
+    b.sigs.resize(n);
+    b.items.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < 60; ++j) b.messages[i][j] = static_cast<uint8_t>(i * 13 + j);
+        const EnclaveKeyPair& key = b.keys[i % enclaves];
+        if (tee_enclave_sign(key, b.messages[i].data(), 60, b.sigs[i]) != 0) return false;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        b.items[i] = {&b.keys[i % enclaves].pk, b.messages[i].data(), 60, &b.sigs[i]};
+    }
+    return true;
+}
+
+// 每个签名的平均验证时间（us），重复到至少 0.2 秒
+static double time_individual(const Batch& b, VerifyKeyCache& cache) {
+    for (const auto& item : b.items) {
+        if (!cache.verify(*item.pub_key, item.data, item.len, *item.sig)) return -1;
+    }
+    size_t done = 0;
+    Clock::time_point start = Clock::now();
+    do {
+        for (const auto& item : b.items) {
+            if (!cache.verify(*item.pub_key, item.data, item.len, *item.sig)) return -1;
+        }
+        done += b.items.size();
+    } while (seconds_since(start) < 0.2);
+    return seconds_since(start) / done * 1e6;
+}
+
+static double time_batch(const Batch& b) {
+    std::vector<uint8_t> results;
+    size_t done = 0;
+    Clock::time_point start = Clock::now();
+    do {
+        if (!tee_verify_batch(b.items, results)) return -1;
+        done += b.items.size();
+    } while (seconds_since(start) < 0.2);
+    return seconds_since(start) / done * 1e6;
+}
+
+int main(int argc, char** argv) {
+    const size_t max_n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 4096;
+    
+    printf("每个签名的平均验证时间（us），单线程\n");
+    printf("%6s | %10s %10s %10s %7s | %10s %10s %7s\n", "", "distinct", "keys", "", "",
+           "16 keys", "", "");
+    printf("%6s | %10s %10s %10s %7s | %10s %10s %7s\n", "batch", "ecdsa", "ed25519", "ed-batch", "speedup",
+           "ed25519", "ed-batch", "speedup");
+    for (size_t n = 16; n <= max_n; n *= 4) {
+        Batch ecdsa, ed, ed_shared;
+        if (!make_batch(ecdsa, n, n, SignatureScheme::ECDSA_P256) ||
+            !make_batch(ed, n, n, SignatureScheme::ED25519) ||
+            !make_batch(ed_shared, n, 16, SignatureScheme::ED25519)) {
+            return 1;
+        }
+        VerifyKeyCache cache(2 * n);
+        double t_ecdsa = time_individual(ecdsa, cache);
+        double t_ed = time_individual(ed, cache);
+        double t_batch = time_batch(ed);
+        double t_ed_shared = time_individual(ed_shared, cache);
+        double t_batch_shared = time_batch(ed_shared);
+        if (t_ecdsa < 0 || t_ed < 0 || t_batch < 0 || t_ed_shared < 0 || t_batch_shared < 0) return 1;
+        printf("%6zu | %10.1f %10.1f %10.1f %6.2fx | %10.1f %10.1f %6.2fx\n", n, t_ecdsa, t_ed, t_batch,
+               t_ed / t_batch, t_ed_shared, t_batch_shared, t_ed_shared / t_batch_shared);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// 热块缓存基准：磁盘块存储中有 256K 个 1KB 密文块，模拟 50 个时间槽，每个时间槽公布 2000 个挑战，
+// 其中 90% 落在 2% 的热块上（多个文件反复挑战同一批块）。
+// 挑战公布后先预取（StorageNode::prefetch_blocks），证明生成阶段对每个挑战取叶子哈希、与树比对并获取Merkle路径。
+// 比较不同缓存容量下证明生成阶段的单挑战延迟（p50/p99）、整批耗时和命中率。
+// 用法：bench_block_cache [存储目录]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/core/init/storage_node.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double us_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const std::filesystem::path dir = argc > 1 ? std::filesystem::path(argv[1])
+        : std::filesystem::temp_directory_path() / "bench_block_cache";
+    std::filesystem::remove_all(dir);
+    const size_t block_count = static_cast<size_t>(1) << 18;
+    const size_t hot_blocks = block_count / 50;
+    const size_t slots = 50;
+    const size_t per_slot = 2000;
+
+    // 准备磁盘存储和Merkle树
+    MerkleTree tree;
+    {
+        StorageNode writer;
+        if (writer.open_block_store(dir.string()) != 0) return 1;
+        EncryptedBlockSet blocks;
+        blocks.resize(block_count);
+        for (size_t i = 0; i < block_count; ++i) {
+            blocks.set_ciphertext_size(i, 1024);
+            memset(blocks.ciphertext_data(i), static_cast<int>(i * 31), 1024);
+            memcpy(blocks.ciphertext_data(i), &i, sizeof(i));
+        }
+        if (writer.store_blocks(std::move(blocks)) != 0 || writer.build_merkle_tree(tree) != 0) return 1;
+    }
+
+    // 所有配置使用同一串挑战
+    std::mt19937_64 rng(11);
+    std::vector<std::vector<size_t>> batches(slots, std::vector<size_t>(per_slot));
+    for (auto& batch : batches) {
+        for (auto& idx : batch) {
+            idx = (rng() % 10 < 9) ? rng() % hot_blocks : rng() % block_count;
+        }
+    }
+
+    printf("块数 %zu，热块 %zu，%zu 个时间槽 x %zu 个挑战\n", block_count, hot_blocks, slots, per_slot);
+    for (size_t cache_mb : {0, 1, 4, 16}) {
+        StorageNode storage_node;
+        if (storage_node.open_block_store(dir.string()) != 0) return 1;
+        storage_node.set_block_cache(cache_mb << 20);
+
+        std::vector<double> latency;
+        latency.reserve(slots * per_slot);
+        double prefetch_us = 0, proof_us = 0;
+        bool ok = true;
+        std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+        for (const auto& batch : batches) {
+            auto start = Clock::now();
+            if (storage_node.prefetch_blocks(batch) != 0) return 1;
+            prefetch_us += us_since(start);
+
+            // 证明生成阶段
+            start = Clock::now();
+            for (size_t idx : batch) {
+                std::array<uint8_t, 32> stored_leaf, tree_leaf;
+                ok &= storage_node.get_block_leaf(idx, stored_leaf) && tree.get_leaf(idx, tree_leaf) &&
+                      stored_leaf == tree_leaf && tree.get_proof(idx, path);
+                latency.push_back(us_since(start));
+            }
+            proof_us += us_since(start);
+        }
+        std::sort(latency.begin(), latency.end());
+        double hit_rate = 0;
+        if (const BlockCache* cache = storage_node.get_block_cache()) {
+            BlockCache::Stats stats = cache->stats();
+            hit_rate = 100.0 * stats.hits / std::max<uint64_t>(stats.hits + stats.misses, 1);
+        }
+        printf("缓存 %2zu MB：证明阶段 p50 %6.0f us  p99 %6.0f us  每批 %6.2f ms  预取每批 %6.2f ms  命中率 %5.1f%%  %s\n",
+               cache_mb, latency[latency.size() / 2], latency[latency.size() * 99 / 100],
+               proof_us / 1000.0 / slots, prefetch_us / 1000.0 / slots, hit_rate, ok ? "" : "（叶子比对失败）");
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,81 @@
+// 叶子哈希基准：262144 个 1 KiB 密文块（每块哈希 12 + 1024 + 16 字节）
+//   拼接：原实现（拼接到临时 vector 后一次性哈希，每块一次分配和一次整块复制）
+//   流式：三个字段依次送入线程局部摘要引擎
+//   批量：hash_encrypted_blocks 整批复用同一引擎（建树路径）
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "../src/utils/crypto_utils.h"
+#include "../src/utils/encrypted_block_set.h"
+#include "../src/utils/sha256_multi.h"
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::array<uint8_t, 32> hash_concat(const EncryptedBlockView& block) {
+    std::vector<uint8_t> data;
+    data.insert(data.end(), block.iv->begin(), block.iv->end());
+    data.insert(data.end(), block.ciphertext, block.ciphertext + block.ciphertext_size);
+    data.insert(data.end(), block.auth_tag->begin(), block.auth_tag->end());
+    std::array<uint8_t, 32> hash;
+    sha256_hash(data.data(), data.size(), hash);
+    return hash;
+}
+
+int main() {
+    const size_t num_blocks = 262144;
+    EncryptedBlockSet blocks(1024);
+    blocks.resize(num_blocks);
+    for (size_t i = 0; i < num_blocks; ++i) {
+        uint8_t* ct = blocks.ciphertext_data(i);
+        for (size_t j = 0; j < 1024; ++j) {
+            ct[j] = static_cast<uint8_t>(i * 7 + j);
+        }
+        blocks.set_ciphertext_size(i, 1024);
+        blocks.iv(i).fill(static_cast<uint8_t>(i));
+        blocks.auth_tag(i).fill(static_cast<uint8_t>(i >> 8));
+    }
+    const double mb = num_blocks * (12 + 1024 + 16) / 1048576.0;
+    std::vector<std::array<uint8_t, 32>> expected(num_blocks), out(num_blocks);
+
+    for (int round = 0; round < 2; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_blocks; ++i) {
+            expected[i] = hash_concat(blocks[i]);
+        }
+        double concat_ms = elapsed_ms(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_blocks; ++i) {
+            out[i] = hash_encrypted_block(blocks[i]);
+        }
+        double stream_ms = elapsed_ms(start);
+        if (out != expected) return 1;
+
+        if (round == 1) {
+            printf("%zu 块，%.0f MB\n", num_blocks, mb);
+            printf("拼接           %6.1f ms  %6.0f MB/s\n", concat_ms, mb * 1000 / concat_ms);
+            printf("流式           %6.1f ms  %6.0f MB/s\n", stream_ms, mb * 1000 / stream_ms);
+        }
+
+        // 批量：依次使用各个内核
+        Sha256Kernel best = sha256_active_kernel();
+        for (Sha256Kernel kernel : {Sha256Kernel::SCALAR, Sha256Kernel::SSE4, Sha256Kernel::AVX2,
+                                    Sha256Kernel::AVX512, Sha256Kernel::SHANI}) {
+            if (sha256_set_active_kernel(kernel) != 0) continue;
+            start = std::chrono::steady_clock::now();
+            if (hash_encrypted_blocks(blocks, 0, num_blocks, out.data()) != 0) return 1;
+            double batch_ms = elapsed_ms(start);
+            if (out != expected) return 1;
+            if (round == 1) {
+                printf("批量 %-8s  %6.1f ms  %6.0f MB/s%s\n", sha256_kernel_name(kernel), batch_ms,
+                       mb * 1000 / batch_ms, kernel == best ? "（默认）" : "");
+            }
+        }
+        sha256_set_active_kernel(best);
+    }
+    return 0;
+}
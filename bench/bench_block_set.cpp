@@ -0,0 +1,88 @@
+// 加密块存储基准：256 MB 文件（1 KiB 分块），分块加密 → 存储节点入库 → 存储节点重建树
+//   std::vector<EncryptedBlock>：每块单独分配密文
+//   EncryptedBlockSet：所有密文在一块连续缓冲区中，移交给存储节点
+// 统计耗时和期间的堆分配次数（替换全局 operator new 计数）
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "../src/core/init/data_owner.h"
+#include "../src/core/init/storage_node.h"
+
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const size_t file_size = static_cast<size_t>(256) << 20;
+    std::vector<uint8_t> raw_file(file_size);
+    for (size_t i = 0; i < file_size; ++i) {
+        raw_file[i] = static_cast<uint8_t>(i * 131 + (i >> 12));
+    }
+    std::array<uint8_t, 32> key;
+    key.fill(0x24);
+    printf("文件 %zu MB，%zu 块\n", file_size >> 20, file_size / 1024);
+
+    // 每块独立分配
+    {
+        DataOwner data_owner;
+        StorageNode storage_node;
+        size_t allocs = g_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<EncryptedBlock> blocks;
+        std::array<uint8_t, 32> fingerprint;
+        if (data_owner.split_and_encrypt(raw_file, key, blocks, fingerprint) != 0) return 1;
+        double encrypt_ms = elapsed_ms(start);
+        if (storage_node.store_blocks(blocks) != 0) return 1;
+        double store_ms = elapsed_ms(start) - encrypt_ms;
+        MerkleTree tree;
+        if (storage_node.build_merkle_tree(storage_node.get_blocks(), tree) != 0) return 1;
+        double total_ms = elapsed_ms(start);
+        if (tree.get_root() != fingerprint) return 1;
+        printf("vector<EncryptedBlock>  加密 %6.0f ms  入库 %5.0f ms  合计 %6.0f ms  堆分配 %zu 次\n",
+               encrypt_ms, store_ms, total_ms, g_allocations.load() - allocs);
+    }
+
+    // 连续存储的块集合
+    {
+        DataOwner data_owner;
+        StorageNode storage_node;
+        size_t allocs = g_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        EncryptedBlockSet blocks;
+        std::array<uint8_t, 32> fingerprint;
+        if (data_owner.split_and_encrypt(raw_file, key, blocks, fingerprint) != 0) return 1;
+        double encrypt_ms = elapsed_ms(start);
+        if (storage_node.store_blocks(std::move(blocks)) != 0) return 1;
+        double store_ms = elapsed_ms(start) - encrypt_ms;
+        MerkleTree tree;
+        if (storage_node.build_merkle_tree(storage_node.get_blocks(), tree) != 0) return 1;
+        double total_ms = elapsed_ms(start);
+        if (tree.get_root() != fingerprint) return 1;
+        printf("EncryptedBlockSet       加密 %6.0f ms  入库 %5.0f ms  合计 %6.0f ms  堆分配 %zu 次\n",
+               encrypt_ms, store_ms, total_ms, g_allocations.load() - allocs);
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+// 磁盘块存储基准：分批写入 512K 个 1KB 密文块（约 540 MB），记录写入吞吐和峰值内存，
+// 然后测量重新打开耗时、随机零复制读取耗时以及从磁盘存储重建Merkle树的耗时
+// 用法：bench_block_store [存储目录]
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "../src/utils/block_store.h"
+#include "../src/core/init/storage_node.h"
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static long peak_rss_mb() {
+#ifndef _WIN32
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+#else
+    return 0;
+#endif
+}
+
+int main(int argc, char** argv) {
+    const std::filesystem::path dir = argc > 1 ? std::filesystem::path(argv[1])
+        : std::filesystem::temp_directory_path() / "bench_block_store";
+    std::filesystem::remove_all(dir);
+    const size_t block_count = static_cast<size_t>(1) << 19;
+    const size_t batch_size = 65536;
+
+    // 每批内容只改前8字节，避免生成数据占用测量时间
+    EncryptedBlockSet batch;
+    batch.resize(batch_size);
+    for (size_t i = 0; i < batch_size; ++i) {
+        batch.set_ciphertext_size(i, 1024);
+        memset(batch.ciphertext_data(i), static_cast<int>(i), 1024);
+    }
+
+    // 1. 分批写入
+    auto start = std::chrono::steady_clock::now();
+    {
+        BlockStore store;
+        if (store.open(dir.string(), static_cast<uint64_t>(1) << 28) != 0) return 1;
+        for (size_t first = 0; first < block_count; first += batch_size) {
+            for (size_t i = 0; i < batch_size; ++i) {
+                uint64_t id = first + i;
+                memcpy(batch.ciphertext_data(i), &id, sizeof(id));
+            }
+            if (store.append_blocks(batch) != 0) return 1;
+        }
+    }
+    double write_ms = elapsed_ms(start);
+    printf("块数 %zu，写入 %.0f ms（%.0f MB/s），峰值内存 %ld MB\n", block_count, write_ms,
+           block_count * 1052.0 / 1048576.0 / (write_ms / 1000.0), peak_rss_mb());
+
+    // 2. 逐块追加（每4096块自动落盘）
+    {
+        BlockStore store;
+        if (store.open((dir / "single").string()) != 0) return 1;
+        store.set_sync_interval(4096);
+        const size_t appends = 65536;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < appends; ++i) {
+            if (store.append(batch[i]) != 0) return 1;
+        }
+        if (store.sync() != 0) return 1;
+        printf("逐块追加：%.2f us/块\n", elapsed_ms(start) * 1000.0 / appends);
+    }
+
+    // 3. 重新打开（模拟节点重启）并随机读取
+    BlockStore store;
+    start = std::chrono::steady_clock::now();
+    if (store.open(dir.string()) != 0) return 1;
+    printf("重新打开：%.2f ms，块数 %zu\n", elapsed_ms(start), store.size());
+
+    std::mt19937_64 rng(1);
+    const size_t reads = 1000000;
+    uint64_t checksum = 0;
+    bool ok = true;
+    start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < reads; ++n) {
+        size_t idx = rng() % block_count;
+        EncryptedBlockView view;
+        ok &= store.get_block_view(idx, view);
+        uint64_t id;
+        memcpy(&id, view.ciphertext, sizeof(id));
+        ok &= id == idx;
+        checksum += view.ciphertext[view.ciphertext_size - 1];
+    }
+    printf("随机零复制读取：%.3f us/块，内容正确：%s（%llu）\n", elapsed_ms(start) * 1000.0 / reads,
+           ok ? "是" : "否", static_cast<unsigned long long>(checksum));
+    store.close();
+
+    // 4. 存储节点从磁盘存储重建Merkle树
+    StorageNode storage_node;
+    if (storage_node.open_block_store(dir.string()) != 0) return 1;
+    MerkleTree tree;
+    start = std::chrono::steady_clock::now();
+    if (storage_node.build_merkle_tree(tree) != 0) return 1;
+    printf("从磁盘存储重建Merkle树：%.0f ms\n", elapsed_ms(start));
+    printf("进程峰值内存 %ld MB\n", peak_rss_mb());
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,122 @@
+// 挑战响应读取基准：磁盘块存储中有 256K 个 1KB 密文块（约 270 MB），一次到达 10000 个挑战，
+// 每个挑战读出被挑战块、哈希并与树中叶子比对。比较三种方式的挑战响应延迟（从挑战到达起计）：
+//   同步 mmap：单线程依次 get_block_view（缺页阻塞）
+//   线程池：AsyncBlockReader 的 pread 回退路径
+//   io_uring：AsyncBlockReader 批量提交
+// 用法：bench_challenge_read [存储目录]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../src/utils/async_block_reader.h"
+#include "../src/utils/crypto_utils.h"
+#include "../src/utils/merkle_tree.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double us_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// 关闭块存储（解除映射）后把段文件从页缓存中逐出再重新打开，模拟冷数据
+static int drop_cache(BlockStore& store, const std::string& dir, size_t segments) {
+    store.close();
+    for (size_t s = 0; s < segments; ++s) {
+        char name[32];
+        snprintf(name, sizeof(name), "segment_%06zu.dat", s);
+        int fd = ::open((std::filesystem::path(dir) / name).c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+    }
+    return store.open(dir);
+}
+
+static void report(const char* name, std::vector<double>& latency, double total_us, bool ok) {
+    std::sort(latency.begin(), latency.end());
+    printf("  %-10s p50 %8.0f us  p99 %8.0f us  全部完成 %7.1f ms  叶子比对：%s\n", name,
+           latency[latency.size() / 2], latency[latency.size() * 99 / 100], total_us / 1000.0, ok ? "通过" : "失败");
+}
+
+int main(int argc, char** argv) {
+    const std::filesystem::path dir = argc > 1 ? std::filesystem::path(argv[1])
+        : std::filesystem::temp_directory_path() / "bench_challenge_read";
+    std::filesystem::remove_all(dir);
+    const size_t block_count = static_cast<size_t>(1) << 18;
+    const size_t challenges = 10000;
+    const uint64_t segment_bytes = static_cast<uint64_t>(1) << 26;
+
+    BlockStore store;
+    if (store.open(dir.string(), segment_bytes) != 0) return 1;
+    EncryptedBlockSet batch;
+    batch.resize(65536);
+    for (size_t first = 0; first < block_count; first += batch.size()) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch.set_ciphertext_size(i, 1024);
+            uint64_t id = first + i;
+            memset(batch.ciphertext_data(i), static_cast<int>(id), 1024);
+            memcpy(batch.ciphertext_data(i), &id, sizeof(id));
+        }
+        if (store.append_blocks(batch) != 0) return 1;
+    }
+    MerkleTree::NodeBuffer leaves(block_count);
+    if (hash_encrypted_blocks(store, 0, block_count, leaves.data()) != 0) return 1;
+    MerkleTree tree(std::move(leaves));
+    const size_t segments = static_cast<size_t>(block_count * 1052 / segment_bytes) + 1;
+
+    std::mt19937_64 rng(7);
+    std::vector<size_t> indices(challenges);
+    for (auto& idx : indices) idx = rng() % block_count;
+
+    printf("块数 %zu，并发挑战 %zu\n", block_count, challenges);
+    for (bool cold : {true, false}) {
+        printf("%s：\n", cold ? "冷数据（逐出页缓存）" : "热数据（页缓存命中）");
+        std::vector<double> latency(challenges);
+
+        // 同步 mmap
+        if (cold && drop_cache(store, dir.string(), segments) != 0) return 1;
+        bool ok = true;
+        auto start = Clock::now();
+        for (size_t i = 0; i < challenges; ++i) {
+            EncryptedBlockView view;
+            std::array<uint8_t, 32> leaf;
+            ok &= store.get_block_view(indices[i], view) && tree.get_leaf(indices[i], leaf) &&
+                  leaf == hash_encrypted_block(view);
+            latency[i] = us_since(start);
+        }
+        report("同步mmap", latency, us_since(start), ok);
+
+        for (bool allow_io_uring : {false, true}) {
+            if (cold && drop_cache(store, dir.string(), segments) != 0) return 1;
+            AsyncBlockReader reader;
+            if (reader.open(store, AsyncBlockReader::DEFAULT_QUEUE_DEPTH, allow_io_uring) != 0) return 1;
+            if (allow_io_uring && !reader.uses_io_uring()) {
+                printf("  io_uring 不可用\n");
+                continue;
+            }
+            ok = true;
+            start = Clock::now();
+            int ret = reader.read_blocks(indices.data(), challenges,
+                [&](size_t request, int status, const EncryptedBlockView& block) {
+                    std::array<uint8_t, 32> leaf;
+                    ok &= status == 0 && tree.get_leaf(indices[request], leaf) && leaf == hash_encrypted_block(block);
+                    latency[request] = us_since(start);
+                });
+            report(allow_io_uring ? "io_uring" : "线程池", latency, us_since(start), ok && ret == 0);
+        }
+    }
+
+    store.close();
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,91 @@
+// 飞地签名基准：签名内容与证明包相同（60 字节），单核每秒可签名的证明数。
+// 对比每次签名都从原始私钥字节重建 EVP_PKEY 并新建摘要上下文（改动前 tee_enclave_sign 的做法）
+// 与 EnclaveSigner（密钥只解析一次、按线程复用签名上下文）的吞吐。
+// 用法：bench_enclave_sign [签名次数]
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <openssl/evp.h>
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/param_build.h>
+#include "../src/tee_simulator/enclave_sign.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// 改动前的做法：每次签名重建密钥对象和签名上下文（DER 签名，不计格式转换）
+static int sign_rebuilding_key(const EnclaveKeyPair& key_pair, const uint8_t* data, size_t len) {
+    OSSL_PARAM_BLD* bld = OSSL_PARAM_BLD_new();
+    BIGNUM* priv = BN_bin2bn(key_pair.sk.data(), 32, nullptr);
+    OSSL_PARAM_BLD_push_utf8_string(bld, OSSL_PKEY_PARAM_GROUP_NAME, "prime256v1", 0);
+    OSSL_PARAM_BLD_push_octet_string(bld, OSSL_PKEY_PARAM_PUB_KEY, key_pair.pk.data(), 65);
+    OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_PRIV_KEY, priv);
+    OSSL_PARAM* params = OSSL_PARAM_BLD_to_param(bld);
+    EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr);
+    EVP_PKEY* pkey = nullptr;
+    EVP_PKEY_fromdata_init(pctx);
+    EVP_PKEY_fromdata(pctx, &pkey, EVP_PKEY_KEYPAIR, params);
+    
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    uint8_t der[80];
+    size_t der_len = sizeof(der);
+    int ok = pkey && ctx && EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, pkey) == 1 &&
+             EVP_DigestSign(ctx, der, &der_len, data, len) == 1;
+    
+    EVP_MD_CTX_free(ctx);
+    EVP_PKEY_free(pkey);
+    EVP_PKEY_CTX_free(pctx);
+    OSSL_PARAM_free(params);
+    BN_clear_free(priv);
+    OSSL_PARAM_BLD_free(bld);
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 4000;
+    EnclaveKeyPair key_pair;
+    if (tee_init_key_pair(key_pair) != 0) return 1;
+    std::vector<std::vector<uint8_t>> messages(count, std::vector<uint8_t>(60));
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < 60; ++j) messages[i][j] = static_cast<uint8_t>(i * 7 + j);
+    }
+    
+    printf("%zu 次签名（单线程）\n", count);
+    Clock::time_point start = Clock::now();
+    for (const auto& msg : messages) {
+        if (sign_rebuilding_key(key_pair, msg.data(), msg.size()) != 0) return 1;
+    }
+    double rebuild = seconds_since(start);
+    printf("  每次重建密钥与上下文   %8.0f 证明/秒  %6.1f us/次\n", count / rebuild, rebuild / count * 1e6);
+    
+    EnclaveSigner signer;
+    if (signer.init(key_pair) != 0) return 1;
+    std::array<uint8_t, 64> sig;
+    start = Clock::now();
+    for (const auto& msg : messages) {
+        if (signer.sign(msg.data(), msg.size(), sig) != 0) return 1;
+    }
+    double reuse = seconds_since(start);
+    printf("  EnclaveSigner::sign    %8.0f 证明/秒  %6.1f us/次\n", count / reuse, reuse / count * 1e6);
+    
+    start = Clock::now();
+    for (const auto& msg : messages) {
+        if (tee_enclave_sign(key_pair, msg.data(), msg.size(), sig) != 0) return 1;
+    }
+    double cached = seconds_since(start);
+    printf("  tee_enclave_sign       %8.0f 证明/秒  %6.1f us/次\n", count / cached, cached / count * 1e6);
+    
+    std::vector<std::array<uint8_t, 64>> sigs;
+    start = Clock::now();
+    if (signer.sign_batch(messages, sigs) != 0) return 1;
+    double batch = seconds_since(start);
+    printf("  sign_batch             %8.0f 证明/秒  %6.1f us/次\n", count / batch, batch / count * 1e6);
+    return 0;
+}
@@ -0,0 +1,121 @@
+// 多文件注册表基准：注册 10000 个文件（每个 128 个 32 字节的块），测量
+//   1. 多线程按指纹查找文件并取证明的吞吐（64 分片 vs 单分片，即相当于一把全局锁）
+//   2. 按内存预算逐出冷树的耗时和逐出前后的内存占用
+//   3. 树常驻内存与已逐出到磁盘时的单条证明耗时
+// 用法：bench_file_registry [逐出目录]
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/core/init/file_registry.h"
+#include "../src/utils/crypto_utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double ms_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static int fill_registry(FileRegistry& registry, size_t files, size_t blocks_per_file,
+                         std::vector<std::array<uint8_t, 32>>& fingerprints) {
+    fingerprints.clear();
+    for (size_t f = 0; f < files; ++f) {
+        EncryptedBlockSet blocks(32);
+        blocks.resize(blocks_per_file);
+        for (size_t i = 0; i < blocks_per_file; ++i) {
+            blocks.set_ciphertext_size(i, 32);
+            uint64_t id = f * blocks_per_file + i;
+            memset(blocks.ciphertext_data(i), 0, 32);
+            memcpy(blocks.ciphertext_data(i), &id, sizeof(id));
+        }
+        auto storage = std::make_unique<StorageNode>();
+        MerkleTree tree;
+        if (storage->store_blocks(std::move(blocks)) != 0 || storage->build_merkle_tree(tree) != 0) return -1;
+        fingerprints.push_back(tree.get_root());
+        if (registry.add_file("owner-" + std::to_string(f % 100), std::move(storage), std::move(tree)) != 0) return -1;
+    }
+    return 0;
+}
+
+// threads 个线程各自随机查找文件并取证明，返回每秒证明数
+static double lookup_throughput(const FileRegistry& registry, const std::vector<std::array<uint8_t, 32>>& fingerprints,
+                                size_t threads, size_t per_thread) {
+    std::atomic<size_t> failures{0};
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937_64 rng(t + 1);
+            std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+            for (size_t n = 0; n < per_thread; ++n) {
+                auto file = registry.find(fingerprints[rng() % fingerprints.size()]);
+                if (!file || !file->get_proof(rng() % 128, path)) ++failures;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double ms = ms_since(start);
+    if (failures.load() != 0) printf("  查找失败 %zu 次\n", failures.load());
+    return threads * per_thread / (ms / 1000.0);
+}
+
+int main(int argc, char** argv) {
+    const std::filesystem::path dir = argc > 1 ? std::filesystem::path(argv[1])
+        : std::filesystem::temp_directory_path() / "bench_file_registry";
+    std::filesystem::remove_all(dir);
+    const size_t files = 10000;
+    const size_t blocks_per_file = 128;
+
+    std::vector<std::array<uint8_t, 32>> fingerprints;
+    printf("文件数 %zu，每个文件 %zu 块（硬件线程 %u）\n", files, blocks_per_file, std::thread::hardware_concurrency());
+
+    // 1. 查找吞吐
+    for (size_t shards : {static_cast<size_t>(1), FileRegistry::DEFAULT_SHARDS}) {
+        FileRegistry registry(dir.string(), 0, shards);
+        auto start = Clock::now();
+        if (fill_registry(registry, files, blocks_per_file, fingerprints) != 0) return 1;
+        printf("%2zu 分片：注册 %.0f ms，内存 %.1f MB\n", shards, ms_since(start), registry.memory_bytes() / 1048576.0);
+        for (size_t threads : {1, 4, 16}) {
+            printf("  %2zu 线程：%.2f M 证明/秒\n", threads,
+                   lookup_throughput(registry, fingerprints, threads, 400000 / threads) / 1e6);
+        }
+    }
+
+    // 2. 逐出冷树：预算降为全部常驻时的 3/4（内存中的块不能逐出，只能逐出树）
+    FileRegistry registry(dir.string());
+    if (fill_registry(registry, files, blocks_per_file, fingerprints) != 0) return 1;
+    size_t before = registry.memory_bytes();
+    auto start = Clock::now();
+    registry.set_memory_budget(before - before / 4);
+    size_t evicted = 0;
+    for (const auto& fp : fingerprints) evicted += registry.find(fp)->tree_resident() ? 0 : 1;
+    printf("逐出：%.0f ms，内存 %.1f MB -> %.1f MB，逐出 %zu 棵树\n", ms_since(start),
+           before / 1048576.0, registry.memory_bytes() / 1048576.0, evicted);
+
+    // 3. 常驻树与磁盘树的单条证明耗时
+    std::vector<std::array<uint8_t, 32>> resident, spilled;
+    for (const auto& fp : fingerprints) (registry.find(fp)->tree_resident() ? resident : spilled).push_back(fp);
+    for (auto* group : {&resident, &spilled}) {
+        if (group->empty()) continue;
+        std::mt19937_64 rng(3);
+        std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+        const size_t proofs = 200000;
+        start = Clock::now();
+        for (size_t n = 0; n < proofs; ++n) {
+            auto file = registry.find((*group)[rng() % group->size()]);
+            file->get_proof(rng() % blocks_per_file, path);
+        }
+        printf("%s：%.3f us/证明\n", group == &resident ? "常驻内存的树" : "逐出到磁盘的树",
+               ms_since(start) * 1000.0 / proofs);
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,66 @@
+// 入库基准：64 MB 文件（1 KiB 分块）
+//   原流程：split_and_encrypt → store_blocks（复制）→ build_merkle_tree ×2（与原 main.cpp 相同）
+//   单遍流程：ingest_file（加密时计算叶子哈希并建树一次，块移交、树直接交给存储节点）
+// 两种流程各自的存储节点树根都必须与文件指纹一致（IV随机，两次的密文和根互不相同）
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "../src/core/init/data_owner.h"
+#include "../src/core/init/ingest.h"
+#include "../src/core/init/storage_node.h"
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const size_t file_size = static_cast<size_t>(64) << 20;
+    std::vector<uint8_t> raw_file(file_size);
+    for (size_t i = 0; i < file_size; ++i) {
+        raw_file[i] = static_cast<uint8_t>(i * 131 + (i >> 12));
+    }
+    std::array<uint8_t, 32> key;
+    key.fill(0x24);
+
+    // 原流程
+    std::array<uint8_t, 32> legacy_root;
+    double legacy_ms;
+    {
+        DataOwner data_owner;
+        StorageNode storage_node;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<EncryptedBlock> blocks;
+        std::array<uint8_t, 32> fingerprint;
+        if (data_owner.split_and_encrypt(raw_file, key, blocks, fingerprint) != 0) return 1;
+        MerkleTree tree;
+        storage_node.build_merkle_tree(blocks, tree);
+        storage_node.store_blocks(blocks);
+        storage_node.build_merkle_tree(blocks, tree);
+        legacy_ms = elapsed_ms(start);
+        legacy_root = tree.get_root();
+        if (legacy_root != fingerprint) return 1;
+    }
+
+    // 单遍流程
+    std::array<uint8_t, 32> fused_root;
+    double fused_ms;
+    {
+        DataOwner data_owner;
+        StorageNode storage_node;
+        auto start = std::chrono::steady_clock::now();
+        std::array<uint8_t, 32> fingerprint;
+        MerkleTree tree;
+        if (ingest_file(data_owner, storage_node, raw_file, key, fingerprint, tree) != 0) return 1;
+        fused_ms = elapsed_ms(start);
+        fused_root = tree.get_root();
+        if (fused_root != fingerprint || storage_node.get_block_count() != file_size / 1024) return 1;
+    }
+
+    printf("文件 %zu MB，%zu 块\n", file_size >> 20, file_size / 1024);
+    printf("原流程     %8.0f ms\n", legacy_ms);
+    printf("单遍流程   %8.0f ms（%.0f%%）\n", fused_ms, fused_ms * 100.0 / legacy_ms);
+    printf("两种流程的树根均与文件指纹一致\n");
+    return 0;
+}
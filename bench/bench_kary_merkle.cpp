@@ -0,0 +1,51 @@
+// k叉Merkle树基准：1M 叶子，分叉数 2/4/8/16 下的构建耗时、证明深度、证明字节数和单次验证耗时
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../src/utils/kary_merkle_tree.h"
+
+template <size_t Arity>
+static void run(const std::vector<std::array<uint8_t, 32>>& leaves) {
+    auto start = std::chrono::steady_clock::now();
+    BasicMerkleTree<Arity> tree(leaves);
+    double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const size_t proofs = 20000;
+    std::mt19937_64 rng(5);
+    std::vector<size_t> indices(proofs);
+    std::vector<std::vector<KaryProofStep<Arity>>> all(proofs);
+    for (size_t n = 0; n < proofs; ++n) {
+        indices[n] = rng() % leaves.size();
+        tree.get_proof(indices[n], all[n]);
+    }
+
+    const std::array<uint8_t, 32> root = tree.get_root();
+    bool ok = true;
+    start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < proofs; ++n) {
+        ok &= BasicMerkleTree<Arity>::verify_proof(leaves[indices[n]], all[n], root);
+    }
+    double verify_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / proofs;
+
+    printf("%6zu %10.1f %6zu %10zu %12.0f %6s\n", Arity, build_ms, tree.depth(),
+           BasicMerkleTree<Arity>::proof_size_bytes(tree.depth()), verify_ns, ok ? "是" : "否");
+}
+
+int main() {
+    const size_t leaf_count = static_cast<size_t>(1) << 20;
+    std::vector<std::array<uint8_t, 32>> leaves(leaf_count);
+    for (size_t i = 0; i < leaf_count; ++i) {
+        memcpy(leaves[i].data(), &i, sizeof(i));
+    }
+
+    printf("叶子数 %zu\n%6s %10s %6s %10s %12s %6s\n", leaf_count, "分叉", "构建ms", "深度", "证明字节", "验证ns", "通过");
+    run<2>(leaves);
+    run<4>(leaves);
+    run<8>(leaves);
+    run<16>(leaves);
+    return 0;
+}
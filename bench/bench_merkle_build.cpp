@@ -0,0 +1,45 @@
+// Merkle树构建基准：对比各 SHA-256 批量内核构建 1M/4M 叶子树的耗时
+// 所有内核构建出的根必须一致
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "../src/utils/merkle_tree.h"
+#include "../src/utils/sha256_multi.h"
+
+int main() {
+    const Sha256Kernel kernels[] = {Sha256Kernel::SCALAR, Sha256Kernel::SSE4, Sha256Kernel::AVX2,
+                                    Sha256Kernel::AVX512, Sha256Kernel::SHANI};
+    const Sha256Kernel default_kernel = sha256_active_kernel();
+    printf("默认内核：%s\n", sha256_kernel_name(default_kernel));
+
+    for (size_t leaf_count : {static_cast<size_t>(1) << 20, static_cast<size_t>(1) << 22}) {
+        std::vector<std::array<uint8_t, 32>> leaves(leaf_count);
+        for (size_t i = 0; i < leaf_count; ++i) {
+            memcpy(leaves[i].data(), &i, sizeof(i));
+        }
+
+        double scalar_ms = 0;
+        std::array<uint8_t, 32> scalar_root{};
+        printf("\n叶子数 %zu\n%-8s %10s %8s %6s\n", leaf_count, "内核", "构建ms", "加速比", "根一致");
+        for (Sha256Kernel kernel : kernels) {
+            if (sha256_set_active_kernel(kernel) != 0) continue;
+
+            auto start = std::chrono::steady_clock::now();
+            MerkleTree tree(leaves);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            if (kernel == Sha256Kernel::SCALAR) {
+                scalar_ms = ms;
+                scalar_root = tree.get_root();
+            }
+            printf("%-8s %10.1f %7.2fx %6s\n", sha256_kernel_name(kernel), ms, scalar_ms / ms,
+                   tree.get_root() == scalar_root ? "是" : "否");
+        }
+    }
+
+    sha256_set_active_kernel(default_kernel);
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Merkle树内存布局基准：16M叶子下对比旧的分层 vector<vector> 布局与单块连续布局的
+// 构建耗时和进程峰值内存（每种布局在独立子进程中运行，峰值内存互不影响）
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../src/utils/merkle_tree.h"
+#include "../src/utils/sha256_multi.h"
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+static const size_t LEAF_COUNT = static_cast<size_t>(1) << 24;
+
+// 进程峰值常驻内存（MB）
+static double peak_rss_mb() {
+#ifndef _WIN32
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+#else
+    return 0.0;
+#endif
+}
+
+static void fill_leaf(std::array<uint8_t, 32>& leaf, size_t i) {
+    leaf.fill(0);
+    memcpy(leaf.data(), &i, sizeof(i));
+}
+
+// 旧布局：复制叶子层，每层单独分配一个 vector（层内同样批量哈希）
+static std::array<uint8_t, 32> build_legacy(const std::vector<std::array<uint8_t, 32>>& leaf_hashes) {
+    std::vector<std::vector<std::array<uint8_t, 32>>> layers;
+    layers.push_back(leaf_hashes);
+    while (layers.back().size() > 1) {
+        const auto& prev_layer = layers.back();
+        std::vector<std::array<uint8_t, 32>> curr_layer((prev_layer.size() + 1) / 2);
+        sha256_64x_n(prev_layer[0].data(), prev_layer.size() / 2, curr_layer[0].data());
+        if (prev_layer.size() % 2 == 1) {
+            std::array<uint8_t, 64> combined;
+            memcpy(combined.data(), prev_layer.back().data(), 32);
+            memcpy(combined.data() + 32, prev_layer.back().data(), 32);
+            sha256_64x_n(combined.data(), 1, curr_layer.back().data());
+        }
+        layers.push_back(std::move(curr_layer));
+    }
+    return layers.back()[0];
+}
+
+static int run_mode(const std::string& mode) {
+    std::array<uint8_t, 32> root;
+    double build_ms = 0;
+
+    if (mode == "legacy") {
+        std::vector<std::array<uint8_t, 32>> leaves(LEAF_COUNT);
+        for (size_t i = 0; i < LEAF_COUNT; ++i) fill_leaf(leaves[i], i);
+
+        auto start = std::chrono::steady_clock::now();
+        root = build_legacy(leaves);
+        build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    } else {
+        MerkleTree::NodeBuffer leaves;
+        leaves.reserve(MerkleTree::node_count(LEAF_COUNT));
+        leaves.resize(LEAF_COUNT);
+        for (size_t i = 0; i < LEAF_COUNT; ++i) fill_leaf(leaves[i], i);
+
+        auto start = std::chrono::steady_clock::now();
+        MerkleTree tree(std::move(leaves));
+        build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        root = tree.get_root();
+    }
+
+    printf("%-8s 构建 %8.1f ms  峰值内存 %8.1f MB  根前缀 %02x%02x%02x%02x\n", mode.c_str(), build_ms,
+           peak_rss_mb(), root[0], root[1], root[2], root[3]);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return run_mode(argv[1]);
+    }
+
+    printf("叶子数 %zu（叶子数据 %.0f MB）\n", LEAF_COUNT, LEAF_COUNT * 32 / 1048576.0);
+    fflush(stdout);
+    std::string self = argv[0];
+    for (const char* mode : {"legacy", "flat"}) {
+        std::string cmd = "\"" + self + "\" " + mode;
+        if (std::system(cmd.c_str()) != 0) {
+            fprintf(stderr, "子进程 %s 运行失败\n", mode);
+            return 1;
+        }
+    }
+    return 0;
+}
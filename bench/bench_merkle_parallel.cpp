@@ -0,0 +1,39 @@
+// 并行建树基准：1/2/4/8 线程构建 4M 叶子树的耗时，根必须与单线程构建逐位一致
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "../src/utils/merkle_tree.h"
+#include "../src/utils/thread_pool.h"
+
+int main() {
+    const size_t leaf_count = static_cast<size_t>(1) << 22;
+    MerkleTree::NodeBuffer leaves(leaf_count);
+    for (size_t i = 0; i < leaf_count; ++i) {
+        memset(leaves[i].data(), 0, 32);
+        memcpy(leaves[i].data(), &i, sizeof(i));
+    }
+    printf("CPU核数：%u，叶子数 %zu\n", std::thread::hardware_concurrency(), leaf_count);
+
+    MerkleTree::NodeBuffer serial_leaves = leaves;
+    auto start = std::chrono::steady_clock::now();
+    MerkleTree serial(std::move(serial_leaves));
+    double serial_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const std::array<uint8_t, 32> serial_root = serial.get_root();
+
+    printf("%-8s %10s %8s %6s\n", "线程", "构建ms", "加速比", "根一致");
+    printf("%-8s %10.1f %7.2fx %6s\n", "serial", serial_ms, 1.0, "是");
+    for (size_t threads : {1, 2, 4, 8}) {
+        ThreadPool pool(threads);
+        MerkleTree::NodeBuffer copy = leaves;
+        start = std::chrono::steady_clock::now();
+        MerkleTree tree(std::move(copy), pool);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printf("%-8zu %10.1f %7.2fx %6s\n", threads, ms, serial_ms / ms,
+               tree.get_root() == serial_root ? "是" : "否");
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Merkle路径格式基准：1M 叶子树（20层路径），对比
+//   旧格式：每步 32 字节哈希 + 1 字节方向，验证前解析成 vector<pair<...>>
+//   新格式：深度 + 方向位图 + 连续哈希，MerklePathView 直接在缓冲区上验证
+// 的证明字节数和单次验证耗时
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../src/utils/merkle_path.h"
+#include "../src/utils/merkle_tree.h"
+
+int main() {
+    const size_t leaf_count = static_cast<size_t>(1) << 20;
+    std::vector<std::array<uint8_t, 32>> leaves(leaf_count);
+    for (size_t i = 0; i < leaf_count; ++i) {
+        memcpy(leaves[i].data(), &i, sizeof(i));
+    }
+    MerkleTree tree(leaves);
+    const std::array<uint8_t, 32> root = tree.get_root();
+
+    // 预先生成两种格式的证明
+    const size_t proofs = 4096;
+    std::mt19937_64 rng(11);
+    std::vector<size_t> indices(proofs);
+    std::vector<std::vector<uint8_t>> legacy(proofs), compact(proofs);
+    std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+    for (size_t n = 0; n < proofs; ++n) {
+        indices[n] = rng() % leaf_count;
+        tree.get_proof(indices[n], path);
+        for (const auto& [hash, dir] : path) {
+            legacy[n].insert(legacy[n].end(), hash.begin(), hash.end());
+            legacy[n].push_back(dir ? 0x01 : 0x00);
+        }
+        encode_merkle_path(path, compact[n]);
+    }
+
+    const int rounds = 25;
+    bool ok = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t n = 0; n < proofs; ++n) {
+            std::vector<std::pair<std::array<uint8_t, 32>, bool>> parsed;
+            for (size_t pos = 0; pos + 33 <= legacy[n].size(); pos += 33) {
+                std::array<uint8_t, 32> hash;
+                memcpy(hash.data(), legacy[n].data() + pos, 32);
+                parsed.emplace_back(hash, legacy[n][pos + 32] == 0x01);
+            }
+            ok &= MerkleTree::verify_proof(leaves[indices[n]], parsed, root);
+        }
+    }
+    double legacy_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (rounds * proofs);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t n = 0; n < proofs; ++n) {
+            MerklePathView view;
+            ok &= view.parse(compact[n]) && MerkleTree::verify_proof(leaves[indices[n]], view, root);
+        }
+    }
+    double compact_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (rounds * proofs);
+
+    printf("叶子数 %zu，路径深度 %zu\n", leaf_count, path.size());
+    printf("%-8s %8s %12s\n", "格式", "字节", "验证ns");
+    printf("%-8s %8zu %12.0f\n", "legacy", legacy[0].size(), legacy_ns);
+    printf("%-8s %8zu %12.0f\n", "compact", compact[0].size(), compact_ns);
+    printf("全部验证通过：%s\n", ok ? "是" : "否");
+    return 0;
+}
@@ -0,0 +1,79 @@
+// 增量更新基准：1M 叶子树上单叶子修改/批量修改/追加 与 整树重建 的耗时对比
+// 增量维护后的根必须与重建结果一致
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../src/utils/merkle_tree.h"
+
+static double elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const size_t leaf_count = static_cast<size_t>(1) << 20;
+    std::vector<std::array<uint8_t, 32>> leaves(leaf_count);
+    for (size_t i = 0; i < leaf_count; ++i) {
+        memcpy(leaves[i].data(), &i, sizeof(i));
+    }
+    MerkleTree tree(leaves);
+    std::mt19937_64 rng(42);
+
+    // 1. 单叶子修改
+    const size_t single_ops = 10000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < single_ops; ++n) {
+        size_t idx = rng() % leaf_count;
+        leaves[idx][8] ^= 1;
+        tree.update_leaf(idx, leaves[idx]);
+    }
+    double single_us = elapsed_us(start) / single_ops;
+
+    // 2. 批量修改 1000 个随机叶子：逐个 vs 批量
+    std::vector<std::pair<size_t, std::array<uint8_t, 32>>> batch;
+    for (size_t n = 0; n < 1000; ++n) {
+        size_t idx = rng() % leaf_count;
+        leaves[idx][9] ^= 1;
+        batch.emplace_back(idx, leaves[idx]);
+    }
+    MerkleTree one_by_one = tree;
+    start = std::chrono::steady_clock::now();
+    for (const auto& [idx, leaf] : batch) {
+        one_by_one.update_leaf(idx, leaf);
+    }
+    double loop_us = elapsed_us(start);
+    start = std::chrono::steady_clock::now();
+    tree.update_leaves(batch);
+    double batch_us = elapsed_us(start);
+    bool batch_same = tree.get_root() == one_by_one.get_root();
+
+    // 3. 追加 10000 个叶子（含一次扩容）
+    const size_t append_ops = 10000;
+    start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < append_ops; ++n) {
+        size_t seed = leaf_count + n;
+        std::array<uint8_t, 32> leaf{};
+        memcpy(leaf.data(), &seed, sizeof(seed));
+        leaves.push_back(leaf);
+        tree.append_leaf(leaf);
+    }
+    double append_us = elapsed_us(start) / append_ops;
+
+    // 4. 整树重建
+    start = std::chrono::steady_clock::now();
+    MerkleTree rebuilt(leaves);
+    double rebuild_us = elapsed_us(start);
+
+    printf("叶子数 %zu\n", leaf_count);
+    printf("单叶子修改        %10.2f us/次\n", single_us);
+    printf("1000叶子逐个修改  %10.1f us\n", loop_us);
+    printf("1000叶子批量修改  %10.1f us\n", batch_us);
+    printf("追加叶子（均摊）  %10.2f us/次\n", append_us);
+    printf("整树重建          %10.1f us\n", rebuild_us);
+    printf("根一致：%s\n", batch_same && rebuilt.get_root() == tree.get_root() ? "是" : "否");
+    return 0;
+}
@@ -0,0 +1,63 @@
+// 多重证明基准：1M 叶子树上同时挑战 k 个随机叶子，
+// 对比 k 条独立路径与一份多重证明的证明大小和验证耗时
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../src/utils/merkle_tree.h"
+
+int main() {
+    const size_t leaf_count = static_cast<size_t>(1) << 20;
+    std::vector<std::array<uint8_t, 32>> leaves(leaf_count);
+    for (size_t i = 0; i < leaf_count; ++i) {
+        memcpy(leaves[i].data(), &i, sizeof(i));
+    }
+    MerkleTree tree(leaves);
+    const std::array<uint8_t, 32> root = tree.get_root();
+    std::mt19937_64 rng(7);
+
+    printf("叶子数 %zu\n%6s %12s %12s %12s %12s %6s\n", leaf_count,
+           "k", "独立字节", "多重字节", "独立验证us", "多重验证us", "通过");
+    for (size_t k = 1; k <= 1024; k *= 4) {
+        std::vector<size_t> indices(k);
+        std::vector<std::array<uint8_t, 32>> hashes(k);
+        for (size_t i = 0; i < k; ++i) {
+            indices[i] = rng() % leaf_count;
+            hashes[i] = leaves[indices[i]];
+        }
+
+        // k 条独立路径（每个元素 32 字节哈希 + 1 字节方向）
+        std::vector<std::vector<std::pair<std::array<uint8_t, 32>, bool>>> paths(k);
+        size_t single_bytes = 0;
+        for (size_t i = 0; i < k; ++i) {
+            tree.get_proof(indices[i], paths[i]);
+            single_bytes += paths[i].size() * 33;
+        }
+        MerkleMultiproof multiproof;
+        tree.get_multiproof(indices, multiproof);
+        size_t multi_bytes = sizeof(multiproof.leaf_count) + multiproof.hashes.size() * 32;
+
+        const int rounds = k >= 256 ? 20 : 200;
+        bool ok = true;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < k; ++i) {
+                ok &= MerkleTree::verify_proof(hashes[i], paths[i], root);
+            }
+        }
+        double single_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            ok &= MerkleTree::verify_multiproof(indices, hashes, multiproof, root);
+        }
+        double multi_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+        printf("%6zu %12zu %12zu %12.1f %12.1f %6s\n", k, single_bytes, multi_bytes, single_us, multi_us, ok ? "是" : "否");
+    }
+    return 0;
+}
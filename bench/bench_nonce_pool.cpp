@@ -0,0 +1,64 @@
+// ECDSA 随机数预计算池基准：模拟时间槽结束时集中签名。
+// 每个时间槽结束时连续签名 burst 个证明（60 字节签名内容），槽间隔 gap 毫秒（后台线程在间隔内补充随机数池），
+// 统计每次 tee_enclave_sign 调用的延迟分位数，对比不使用池、池深度足够、以及突发超过池深度三种情况。
+// 槽间休眠后的第一次签名受缓存变冷影响，与是否使用池无关，另给出除去每槽第一次签名后的 p99。
+// 用法：bench_nonce_pool [时间槽数] [槽间隔毫秒]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "../src/tee_simulator/enclave_sign.h"
+
+using Clock = std::chrono::steady_clock;
+
+static bool run(const EnclaveKeyPair& key_pair, size_t depth, size_t burst, size_t slots, int gap_ms,
+                const char* label) {
+    tee_set_nonce_pool_depth(depth);
+    std::vector<uint8_t> msg(60);
+    std::array<uint8_t, 64> sig;
+    // 预热：创建内部签名器（开启池时等待首次补满）
+    if (tee_enclave_sign(key_pair, msg.data(), msg.size(), sig) != 0) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(gap_ms));
+    
+    std::vector<double> latency, warm;
+    latency.reserve(slots * burst);
+    warm.reserve(slots * burst);
+    for (size_t slot = 0; slot < slots; ++slot) {
+        for (size_t i = 0; i < burst; ++i) {
+            msg[0] = static_cast<uint8_t>(slot);
+            msg[1] = static_cast<uint8_t>(i);
+            Clock::time_point start = Clock::now();
+            if (tee_enclave_sign(key_pair, msg.data(), msg.size(), sig) != 0) return false;
+            double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            latency.push_back(us);
+            if (i > 0) warm.push_back(us);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(gap_ms));
+    }
+    std::sort(latency.begin(), latency.end());
+    std::sort(warm.begin(), warm.end());
+    auto pct = [](const std::vector<double>& v, double p) { return v[static_cast<size_t>(p * (v.size() - 1))]; };
+    printf("  %-26s burst %4zu  p50 %6.1f  p90 %6.1f  p99 %6.1f  max %7.1f  warm p99 %6.1f us\n", label, burst,
+           pct(latency, 0.50), pct(latency, 0.90), pct(latency, 0.99), latency.back(), pct(warm, 0.99));
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const size_t slots = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 100;
+    const int gap_ms = argc > 2 ? std::atoi(argv[2]) : 20;
+    EnclaveKeyPair key_pair;
+    if (tee_init_key_pair(key_pair) != 0) return 1;
+    
+    printf("%zu 个时间槽，槽间隔 %d ms，单次 tee_enclave_sign 延迟\n", slots, gap_ms);
+    if (!run(key_pair, 0, 16, slots, gap_ms, "no pool")) return 1;
+    if (!run(key_pair, 64, 16, slots, gap_ms, "pool depth 64")) return 1;
+    if (!run(key_pair, 0, 128, slots, gap_ms, "no pool")) return 1;
+    if (!run(key_pair, 64, 128, slots, gap_ms, "pool depth 64 (exhausted)")) return 1;
+    if (!run(key_pair, 256, 128, slots, gap_ms, "pool depth 256")) return 1;
+    tee_set_nonce_pool_depth(0);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// 部分Merkle树基准：1M 叶子（每个叶子哈希模拟一个 1 KiB 数据块的 SHA-256），
+// 对比保留不同顶部层数 L 时的内存占用和单条证明的获取耗时
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../src/utils/crypto_utils.h"
+#include "../src/utils/partial_merkle_tree.h"
+#include "../include/config.h"
+
+int main() {
+    const size_t leaf_count = static_cast<size_t>(1) << 20;
+
+    // 叶子来源：对按下标生成的 1 KiB 数据块求哈希（与 StorageNode 从存储块重算叶子的开销相当）
+    auto source = [](size_t first, size_t count, std::array<uint8_t, 32>* out) {
+        std::vector<uint8_t> block(Config::BLOCK_SIZE, 0x5C);
+        for (size_t i = 0; i < count; ++i) {
+            size_t idx = first + i;
+            memcpy(block.data(), &idx, sizeof(idx));
+            sha256_hash(block.data(), block.size(), out[i]);
+        }
+        return 0;
+    };
+
+    MerkleTree::NodeBuffer leaves(leaf_count);
+    source(0, leaf_count, leaves.data());
+    MerkleTree full(std::move(leaves));
+
+    printf("叶子数 %zu，完整树 %.1f MB\n", leaf_count, MerkleTree::node_count(leaf_count) * 32 / 1048576.0);
+    printf("%4s %12s %14s %14s %6s\n", "L", "内存KB", "每次重算叶子", "单条证明us", "一致");
+    for (size_t kept : {21, 17, 14, 11, 8}) {
+        PartialMerkleTree partial;
+        if (partial.build(leaf_count, kept, source) != 0) return 1;
+
+        std::mt19937_64 rng(3);
+        const size_t proofs = kept >= 17 ? 20000 : 200;
+        std::vector<std::pair<std::array<uint8_t, 32>, bool>> path, full_path;
+        bool same = partial.get_root() == full.get_root();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t n = 0; n < proofs; ++n) {
+            size_t idx = rng() % leaf_count;
+            partial.get_proof(idx, path);
+            if (n % 50 == 0) {
+                full.get_proof(idx, full_path);
+                same &= path == full_path;
+            }
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / proofs;
+        printf("%4zu %12.1f %14zu %14.1f %6s\n", kept, partial.memory_bytes() / 1024.0,
+               partial.subtree_leaves(), us, same ? "是" : "否");
+    }
+
+    printf("\n预算 1 MB 时可保留的层数：%zu\n", PartialMerkleTree::levels_for_budget(leaf_count, 1 << 20));
+    return 0;
+}
@@ -0,0 +1,58 @@
+// 随机数源基准：多线程小请求（12 字节 IV、32 字节挑战）的总吞吐。
+// 对比直接调用 RAND_bytes（改动前 tee_get_random 的做法，所有线程共用 OpenSSL 的 DRBG）
+// 与每线程缓冲的 AES-256-CTR DRBG（tee_get_random）。每种配置总请求数固定，由各线程平分。
+// 用法：bench_random [总请求数]
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <openssl/rand.h>
+#include "../src/tee_simulator/random_source.h"
+
+using Clock = std::chrono::steady_clock;
+
+// 返回每秒请求数
+template <typename Fn>
+static double run(size_t threads, size_t total, size_t request_size, Fn fn) {
+    const size_t per_thread = total / threads;
+    std::vector<std::thread> workers;
+    std::atomic<bool> failed{false};
+    Clock::time_point start = Clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, per_thread, request_size] {
+            uint8_t buf[64];
+            for (size_t i = 0; i < per_thread; ++i) {
+                if (fn(buf, request_size) != 0) {
+                    failed.store(true);
+                    return;
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return failed ? -1 : per_thread * threads / seconds;
+}
+
+int main(int argc, char** argv) {
+    const size_t total = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 2000000;
+    auto rand_bytes = [](uint8_t* buf, size_t len) { return RAND_bytes(buf, static_cast<int>(len)) == 1 ? 0 : -1; };
+    auto buffered = [](uint8_t* buf, size_t len) { return tee_get_random(buf, len); };
+    
+    printf("%zu 次请求（各线程平分），百万次/秒\n", total);
+    printf("%8s | %10s %10s %8s | %10s %10s %8s\n", "threads", "12B RAND", "12B DRBG", "speedup",
+           "32B RAND", "32B DRBG", "speedup");
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        double r12 = run(threads, total, 12, rand_bytes);
+        double d12 = run(threads, total, 12, buffered);
+        double r32 = run(threads, total, 32, rand_bytes);
+        double d32 = run(threads, total, 32, buffered);
+        if (r12 < 0 || d12 < 0 || r32 < 0 || d32 < 0) return 1;
+        printf("%8zu | %10.2f %10.2f %7.1fx | %10.2f %10.2f %7.1fx\n", threads, r12 / 1e6, d12 / 1e6, d12 / r12,
+               r32 / 1e6, d32 / 1e6, d32 / r32);
+    }
+    return 0;
+}
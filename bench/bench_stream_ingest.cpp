@@ -0,0 +1,100 @@
+// 流式入库基准：512 MB 文件
+//   stream：split_and_encrypt_file（4 MB 读缓冲区，叶子哈希流式写入磁盘Merkle树，块交给计数接收端）
+//   vector：读入整个文件 → split_and_encrypt（所有加密块留在内存）
+// 两种模式各在独立子进程中运行，分别统计耗时和峰值内存；指纹都与磁盘树/内存树的根核对
+// 用法：bench_stream_ingest [stream|vector]
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "../src/core/init/data_owner.h"
+#include "../src/utils/disk_merkle_tree.h"
+
+// 只统计块数、不保存块的接收端（模拟块直接写到远端存储节点）
+class CountingSink : public BlockSink {
+public:
+    explicit CountingSink(DiskMerkleTreeWriter& writer) : writer_(writer) {}
+    int consume(size_t index, const EncryptedBlockView& block, const std::array<uint8_t, 32>& leaf_hash) override {
+        count_ = index + 1;
+        bytes_ += block.ciphertext_size;
+        return writer_.append_leaf(leaf_hash);
+    }
+    size_t count_ = 0;
+    size_t bytes_ = 0;
+
+private:
+    DiskMerkleTreeWriter& writer_;
+};
+
+static long peak_rss_mb() {
+#ifndef _WIN32
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+#else
+    return 0;
+#endif
+}
+
+int main(int argc, char** argv) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string file_path = (dir / "bench_stream_ingest.bin").string();
+    const std::string tree_path = (dir / "bench_stream_ingest.tree").string();
+    const size_t file_size = static_cast<size_t>(512) << 20;
+    std::array<uint8_t, 32> key;
+    key.fill(0x6B);
+
+    if (argc < 2) {
+        // 父进程：生成测试文件后依次启动两种模式
+        std::vector<uint8_t> chunk(1 << 20);
+        FILE* f = fopen(file_path.c_str(), "wb");
+        if (f == nullptr) return 1;
+        for (size_t written = 0; written < file_size; written += chunk.size()) {
+            for (size_t i = 0; i < chunk.size(); ++i) {
+                chunk[i] = static_cast<uint8_t>((written + i) * 2654435761u >> 13);
+            }
+            fwrite(chunk.data(), 1, chunk.size(), f);
+        }
+        fclose(f);
+        printf("文件 %zu MB\n%-8s %10s %12s %6s\n", file_size >> 20, "模式", "耗时ms", "峰值内存MB", "一致");
+        fflush(stdout);
+        int rc = std::system((std::string(argv[0]) + " stream").c_str());
+        rc |= std::system((std::string(argv[0]) + " vector").c_str());
+        std::remove(file_path.c_str());
+        std::remove(tree_path.c_str());
+        return rc == 0 ? 0 : 1;
+    }
+
+    DataOwner data_owner;
+    std::array<uint8_t, 32> fingerprint;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = false;
+    if (strcmp(argv[1], "stream") == 0) {
+        DiskMerkleTreeWriter writer;
+        if (writer.open(tree_path) != 0) return 1;
+        CountingSink sink(writer);
+        if (data_owner.split_and_encrypt_file(file_path, key, sink, fingerprint) != 0) return 1;
+        std::array<uint8_t, 32> root;
+        if (writer.finish(&root) != 0) return 1;
+        ok = root == fingerprint && sink.bytes_ == file_size;
+    } else {
+        std::vector<uint8_t> raw_file(file_size);
+        FILE* f = fopen(file_path.c_str(), "rb");
+        if (f == nullptr || fread(raw_file.data(), 1, file_size, f) != file_size) return 1;
+        fclose(f);
+        std::vector<EncryptedBlock> blocks;
+        if (data_owner.split_and_encrypt(raw_file, key, blocks, fingerprint) != 0) return 1;
+        ok = data_owner.get_file_tree().get_root() == fingerprint && blocks.size() == file_size / 1024;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%-8s %10.0f %12ld %6s\n", argv[1], ms, peak_rss_mb(), ok ? "是" : "否");
+    return 0;
+}
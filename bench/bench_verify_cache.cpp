@@ -0,0 +1,79 @@
+// 验证公钥缓存基准：大量飞地各自提交若干证明（60 字节签名内容），验证者轮流验证。
+// 对比每次验证都重新解析公钥的 tee_verify_signature 与 VerifyKeyCache，
+// 并给出容量小于飞地数时（轮流访问下 LRU 全部失效）的退化情况。
+// 用法：bench_verify_cache [飞地数] [每个飞地的证明数]
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../src/tee_simulator/enclave_sign.h"
+#include "../src/tee_simulator/verify_key_cache.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Proof {
+    size_t enclave;
+    std::vector<uint8_t> data;
+    std::array<uint8_t, 64> sig;
+};
+
+static bool run_cached(VerifyKeyCache& cache, const std::vector<EnclaveKeyPair>& keys,
+                       const std::vector<Proof>& proofs, const char* label) {
+    cache.reset_stats();
+    Clock::time_point start = Clock::now();
+    for (const Proof& p : proofs) {
+        if (!cache.verify(keys[p.enclave].pk, p.data.data(), p.data.size(), p.sig)) return false;
+    }
+    double t = seconds_since(start);
+    VerifyKeyCache::Stats stats = cache.stats();
+    printf("  %-28s %8.0f 证明/秒  %6.1f us/次  命中率 %5.1f%%  淘汰 %llu\n", label,
+           proofs.size() / t, t / proofs.size() * 1e6, stats.hit_rate() * 100,
+           static_cast<unsigned long long>(stats.evictions));
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const size_t enclaves = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 2000;
+    const size_t per_enclave = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 5;
+    
+    std::vector<EnclaveKeyPair> keys(enclaves);
+    for (auto& key : keys) {
+        if (tee_init_key_pair(key) != 0) return 1;
+    }
+    // 按轮次交错：每一轮每个飞地提交一个证明
+    std::vector<Proof> proofs;
+    proofs.reserve(enclaves * per_enclave);
+    for (size_t round = 0; round < per_enclave; ++round) {
+        for (size_t e = 0; e < enclaves; ++e) {
+            Proof p;
+            p.enclave = e;
+            p.data.resize(60);
+            for (size_t j = 0; j < 60; ++j) p.data[j] = static_cast<uint8_t>(e * 31 + round * 7 + j);
+            if (tee_enclave_sign(keys[e], p.data.data(), p.data.size(), p.sig) != 0) return 1;
+            proofs.push_back(std::move(p));
+        }
+    }
+    
+    printf("%zu 个飞地 x %zu 个证明 = %zu 次验证（单线程）\n", enclaves, per_enclave, proofs.size());
+    Clock::time_point start = Clock::now();
+    for (const Proof& p : proofs) {
+        if (!tee_verify_signature(keys[p.enclave].pk, p.data.data(), p.data.size(), p.sig)) return 1;
+    }
+    double uncached = seconds_since(start);
+    printf("  %-28s %8.0f 证明/秒  %6.1f us/次\n", "tee_verify_signature",
+           proofs.size() / uncached, uncached / proofs.size() * 1e6);
+    
+    VerifyKeyCache cache;
+    if (!run_cached(cache, keys, proofs, "VerifyKeyCache (cold)")) return 1;
+    if (!run_cached(cache, keys, proofs, "VerifyKeyCache (warm)")) return 1;
+    
+    VerifyKeyCache small(enclaves / 2);
+    if (!run_cached(small, keys, proofs, "VerifyKeyCache (cap = N/2)")) return 1;
+    return 0;
+}
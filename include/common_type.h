@@ -13,6 +13,12 @@ struct EncryptedBlock {
     std::array<uint8_t, 16> auth_tag; // 认证标签（128位）
 };
 
+// 飞地签名方案（公钥首字节区分：0x04 为 P-256 非压缩点，0xED 为 Ed25519）
+enum class SignatureScheme : uint8_t {
+    ECDSA_P256 = 0, // ECDSA P-256 + SHA-256（逐个验证）
+    ED25519 = 1     // Ed25519（支持批量验证）
+};
+
 // 2. 证明包结构体（链式）
 struct ProofPackage {
     uint64_t time_slot_id;            // 时间槽ID
@@ -21,9 +27,10 @@ struct ProofPackage {
     uint32_t t_slot;                  // 时间槽长度（秒）
     std::array<uint8_t, 32> random_r; // 挑战随机数（256位）
     uint32_t challenge_idx;           // 挑战块索引
-    std::vector<uint8_t> merkle_path; // Merkle路径（验证证据）
-    std::array<uint8_t, 64> enclave_sig; // 飞地签名（ECC-Secp256k1）
+    std::vector<uint8_t> merkle_path; // Merkle路径（验证证据，紧凑格式见 merkle_path.h）
+    std::array<uint8_t, 64> enclave_sig; // 飞地签名（64字节，格式由 sig_scheme 决定）
     uint64_t t_start;                 // 时间槽起点（时间戳）
+    SignatureScheme sig_scheme = SignatureScheme::ECDSA_P256; // 签名方案（须与飞地公钥的方案一致）
 };
 
 // 3. 分段凭证结构体
@@ -48,7 +48,7 @@ int main() {
 
     // 1.1 数据拥有者：文件分块+加密+合约部署
     std::vector<uint8_t> raw_file(10240, 0x01); // 模拟10KB文件
-    std::vector<EncryptedBlock> encrypted_blocks;
+    EncryptedBlockSet encrypted_blocks;
     std::array<uint8_t, 32> file_fingerprint;
     std::array<uint8_t, 32> aes_key;
     tee_get_random(aes_key.data(), 32); // 生成AES密钥
@@ -69,13 +69,7 @@ int main() {
     EnclaveKeyPair enclave_key;
     std::vector<uint8_t> attestation_report;
 
-    // 直接通过build_merkle_tree函数内部构造并返回，而不是传引用
-    MerkleTree data_merkle;  // 移到这里，并通过函数返回值初始化
-    if (storage_node.build_merkle_tree(encrypted_blocks, data_merkle) != 0) {
-        std::cerr << "Merkle树构建失败！" << std::endl;
-        return -1;
-    }
-
+    MerkleTree data_merkle;
 
     if (storage_node.init_tee(enclave_key, attestation_report) != 0) {
         std::cerr << "TEE初始化失败！" << std::endl;
@@ -84,13 +78,14 @@ int main() {
     std::cout << "3. TEE初始化完成，飞地公钥：";
     print_bytes(enclave_key.pk.data(), 65);
 
-    if (storage_node.store_blocks(encrypted_blocks) != 0) {
+    if (storage_node.store_blocks(std::move(encrypted_blocks)) != 0) {
         std::cerr << "存储数据块失败！" << std::endl;
         return -1;
     }
-    std::cout << "4. 数据块存储完成（" << encrypted_blocks.size() << "块）" << std::endl;
+    std::cout << "4. 数据块存储完成（" << storage_node.get_block_count() << "块）" << std::endl;
 
-    if (storage_node.build_merkle_tree(encrypted_blocks, data_merkle) != 0) {
+    // 直接接收数据所有者分块时构建的树（叶子哈希不再重新计算）
+    if (storage_node.adopt_merkle_tree(data_owner.get_file_tree(), data_merkle) != 0) {
         std::cerr << "Merkle树构建失败！" << std::endl;
         return -1;
     }
@@ -57,3 +57,12 @@ std::vector<SegmentCredential> VerificationContract::get_node_credentials(const
     }
     return it->second;
 }
+
+void VerificationContract::set_key_cache(VerifyKeyCache* cache) {
+    single_verifier_.set_key_cache(cache);
+    aggregate_verifier_.set_key_cache(cache);
+}
+
+VerifyKeyCache::Stats VerificationContract::key_cache_stats() const {
+    return single_verifier_.get_key_cache()->stats();
+}
@@ -37,6 +37,12 @@ public:
     
     // 获取节点的所有分段凭证
     std::vector<SegmentCredential> get_node_credentials(const std::string& node_id) const;
+    
+    // 指定合约内所有签名验证共用的公钥缓存（为空时恢复进程共享缓存）
+    void set_key_cache(VerifyKeyCache* cache);
+    
+    // 公钥缓存的命中统计
+    VerifyKeyCache::Stats key_cache_stats() const;
 
 private:
     // 节点ID到分段凭证的映射
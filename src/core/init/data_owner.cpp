@@ -1,8 +1,12 @@
 #include "data_owner.h"
 #include "../../utils/merkle_tree.h"
 #include "../../tee_simulator/enclave_sign.h"
+#include "../../tee_simulator/verify_key_cache.h"
 #include "../../utils/time_utils.h"
 #include "../../../include/config.h"
+#include "../../utils/merkle_accumulator.h"
+#include "../../utils/aes_gcm_engine.h"
+#include <algorithm>
 
 int DataOwner::split_and_encrypt(const std::vector<uint8_t>& raw_file,
                                 const std::array<uint8_t, 32>& key,
@@ -13,49 +17,250 @@ int DataOwner::split_and_encrypt(const std::vector<uint8_t>& raw_file,
     // 计算文件分块数量
     size_t num_blocks = (raw_file.size() + Config::BLOCK_SIZE - 1) / Config::BLOCK_SIZE;
     
-    // 存储所有块的哈希，用于计算文件指纹
-    std::vector<std::array<uint8_t, 32>> block_hashes;
+    // 存储所有块的哈希，用于计算文件指纹（预留整棵树的空间）
+    MerkleTree::NodeBuffer block_hashes;
+    block_hashes.reserve(MerkleTree::node_count(num_blocks));
+    block_hashes.resize(num_blocks);
     
-    // 分块并加密
-    for (size_t i = 0; i < num_blocks; ++i) {
-        // 计算当前块的起始和结束索引
-        size_t start = i * Config::BLOCK_SIZE;
-        size_t end = std::min(start + Config::BLOCK_SIZE, raw_file.size());
-        std::vector<uint8_t> block_data(raw_file.begin() + start, raw_file.begin() + end);
-        
-        // 生成随机IV
-        EncryptedBlock encrypted_block;
-        if (tee_get_random(encrypted_block.iv.data(), 12) != 0) {
+    // 分块加密（单遍：每块加密后立即计算叶子哈希，密文直接写入预分配的输出块，
+    // 每个线程复用自己已设置密钥的加密上下文）
+    ParallelBlockEncryptor encryptor(key, encrypt_pool_.get());
+    if (encryptor.encrypt_blocks(raw_file.data(), raw_file.size(), Config::BLOCK_SIZE,
+                                 encrypted_blocks, block_hashes.data()) != 0) {
+        encrypted_blocks.clear();
+        return -1;
+    }
+    
+    build_file_tree(std::move(block_hashes), file_fingerprint);
+    return 0;
+}
+
+int DataOwner::split_and_encrypt(const std::vector<uint8_t>& raw_file,
+                                const std::array<uint8_t, 32>& key,
+                                EncryptedBlockSet& encrypted_blocks,
+                                std::array<uint8_t, 32>& file_fingerprint) {
+    size_t num_blocks = (raw_file.size() + Config::BLOCK_SIZE - 1) / Config::BLOCK_SIZE;
+    MerkleTree::NodeBuffer block_hashes;
+    block_hashes.reserve(MerkleTree::node_count(num_blocks));
+    block_hashes.resize(num_blocks);
+    
+    // 密文直接写入块集合的连续缓冲区
+    encrypted_blocks = EncryptedBlockSet(Config::BLOCK_SIZE);
+    ParallelBlockEncryptor encryptor(key, encrypt_pool_.get());
+    if (encryptor.encrypt_blocks(raw_file.data(), raw_file.size(),
+                                 encrypted_blocks, block_hashes.data()) != 0) {
+        encrypted_blocks.clear();
+        return -1;
+    }
+    
+    build_file_tree(std::move(block_hashes), file_fingerprint);
+    return 0;
+}
+
+int DataOwner::split_and_encrypt_cdc(const std::vector<uint8_t>& raw_file,
+                                     const std::array<uint8_t, 32>& key,
+                                     const ChunkingParams& params,
+                                     EncryptedBlockSet& encrypted_blocks,
+                                     std::array<uint8_t, 32>& file_fingerprint) {
+    std::vector<size_t> chunk_ends;
+    CdcChunker chunker(params);
+    if (chunker.split(raw_file.data(), raw_file.size(), chunk_ends) != 0) {
+        return -1;
+    }
+    
+    // IV派生密钥与加密密钥分开：iv_key = HMAC-SHA256(key, 固定标签)
+    static const char IV_KEY_LABEL[] = "TEE-CDC-CONVERGENT-IV";
+    std::array<uint8_t, 32> iv_key;
+    if (hmac_sha256(key, reinterpret_cast<const uint8_t*>(IV_KEY_LABEL), sizeof(IV_KEY_LABEL) - 1, iv_key) != 0) {
+        return -1;
+    }
+    
+    MerkleTree::NodeBuffer block_hashes;
+    block_hashes.reserve(MerkleTree::node_count(chunk_ends.size()));
+    block_hashes.resize(chunk_ends.size());
+    
+    encrypted_blocks = EncryptedBlockSet(params.max_size);
+    ParallelBlockEncryptor encryptor(key, encrypt_pool_.get());
+    if (encryptor.encrypt_chunks(raw_file.data(), chunk_ends, iv_key,
+                                 encrypted_blocks, block_hashes.data()) != 0) {
+        encrypted_blocks.clear();
+        return -1;
+    }
+    
+    build_file_tree(std::move(block_hashes), file_fingerprint);
+    return 0;
+}
+
+void DataOwner::build_file_tree(MerkleTree::NodeBuffer&& block_hashes, std::array<uint8_t, 32>& file_fingerprint) {
+    // 计算文件指纹（所有块哈希的哈希），保留文件树用于后续增量更新
+    if (block_hashes.empty()) {
+        file_tree_ = MerkleTree();
+        file_fingerprint.fill(0);
+    } else {
+        file_tree_ = encrypt_pool_ ? MerkleTree(std::move(block_hashes), *encrypt_pool_)
+                                   : MerkleTree(std::move(block_hashes));
+        file_fingerprint = file_tree_.get_root();
+    }
+}
+
+int DataOwner::split_and_encrypt_file(const RandomAccessFile& file,
+                                     const std::array<uint8_t, 32>& key,
+                                     BlockSink& sink,
+                                     std::array<uint8_t, 32>& file_fingerprint,
+                                     size_t read_buffer_bytes) {
+    file_tree_ = MerkleTree();
+    if (!file.is_open()) {
+        return -1;
+    }
+    
+    // 读缓冲区取块大小的整数倍，每次读取一整批块
+    size_t blocks_per_read = std::max<size_t>(read_buffer_bytes / Config::BLOCK_SIZE, 1);
+    std::vector<uint8_t> buffer(blocks_per_read * Config::BLOCK_SIZE);
+    EncryptedBlockSet batch(Config::BLOCK_SIZE);
+    std::vector<std::array<uint8_t, 32>> leaf_hashes(blocks_per_read);
+    ParallelBlockEncryptor encryptor(key, encrypt_pool_.get());
+    MerkleRootAccumulator accumulator;
+    
+    uint64_t file_size = file.size();
+    size_t index = 0;
+    for (uint64_t offset = 0; offset < file_size; offset += buffer.size()) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(buffer.size(), file_size - offset));
+        if (file.read_at(offset, buffer.data(), len) != 0) {
             return -1;
         }
         
-        // 加密块数据
-        if (aes_gcm_encrypt(key, block_data, encrypted_block.iv, 
-                           encrypted_block.ciphertext, encrypted_block.auth_tag) != 0) {
+        // 整批加密并计算叶子哈希，再按下标顺序交给 sink
+        if (encryptor.encrypt_blocks(buffer.data(), len, batch, leaf_hashes.data()) != 0) {
             return -1;
         }
-        
-        encrypted_blocks.push_back(encrypted_block);
-        
-        // 计算块哈希并存储
-        block_hashes.push_back(hash_encrypted_block(encrypted_block));
+        for (size_t i = 0; i < batch.size(); ++i, ++index) {
+            accumulator.append(leaf_hashes[i]);
+            if (sink.consume(index, batch[i], leaf_hashes[i]) != 0) {
+                return -1;
+            }
+        }
     }
     
-    // 计算文件指纹（所有块哈希的哈希）
-    if (block_hashes.empty()) {
-        file_fingerprint.fill(0);
+    // 空文件的指纹为全0（与 split_and_encrypt 一致）
+    file_fingerprint = accumulator.root();
+    return 0;
+}
+
+int DataOwner::split_and_encrypt_file(const std::string& path,
+                                     const std::array<uint8_t, 32>& key,
+                                     BlockSink& sink,
+                                     std::array<uint8_t, 32>& file_fingerprint,
+                                     size_t read_buffer_bytes) {
+    RandomAccessFile file;
+    if (file.open(path, false) != 0) {
+        return -1;
+    }
+    return split_and_encrypt_file(file, key, sink, file_fingerprint, read_buffer_bytes);
+}
+
+void DataOwner::set_encrypt_threads(size_t num_threads) {
+    if (num_threads == 1) {
+        encrypt_pool_.reset();
     } else {
-        MerkleTree merkle(block_hashes);
-        file_fingerprint = merkle.get_root();
+        encrypt_pool_ = std::make_unique<ThreadPool>(num_threads);
+    }
+}
+
+int DataOwner::encrypt_block(const std::vector<uint8_t>& block_data,
+                            const std::array<uint8_t, 32>& key,
+                            EncryptedBlock& encrypted_block) {
+    if (block_data.size() > Config::BLOCK_SIZE) {
+        return -1;
+    }
+    
+    // 生成随机IV（重写块时也必须使用新IV，GCM下同一密钥不能复用IV）
+    if (tee_get_random(encrypted_block.iv.data(), 12) != 0) {
+        return -1;
+    }
+    
+    // 加密块数据
+    return aes_gcm_encrypt(key, block_data, encrypted_block.iv,
+                           encrypted_block.ciphertext, encrypted_block.auth_tag);
+}
+
+int DataOwner::update_block(size_t index,
+                           const std::vector<uint8_t>& block_data,
+                           const std::array<uint8_t, 32>& key,
+                           EncryptedBlock& encrypted_block,
+                           std::array<uint8_t, 32>& file_fingerprint) {
+    if (index >= file_tree_.leaf_count()) {
+        return -1;
+    }
+    if (encrypt_block(block_data, key, encrypted_block) != 0) {
+        return -1;
+    }
+    
+    file_tree_.update_leaf(index, hash_encrypted_block(encrypted_block));
+    file_fingerprint = file_tree_.get_root();
+    return 0;
+}
+
+int DataOwner::update_blocks(const std::vector<std::pair<size_t, std::vector<uint8_t>>>& updates,
+                            const std::array<uint8_t, 32>& key,
+                            std::vector<EncryptedBlock>& encrypted_blocks,
+                            std::array<uint8_t, 32>& file_fingerprint) {
+    encrypted_blocks.clear();
+    encrypted_blocks.reserve(updates.size());
+    
+    std::vector<std::pair<size_t, std::array<uint8_t, 32>>> leaf_updates;
+    leaf_updates.reserve(updates.size());
+    for (const auto& [index, block_data] : updates) {
+        if (index >= file_tree_.leaf_count()) {
+            return -1;
+        }
+        EncryptedBlock encrypted_block;
+        if (encrypt_block(block_data, key, encrypted_block) != 0) {
+            return -1;
+        }
+        leaf_updates.emplace_back(index, hash_encrypted_block(encrypted_block));
+        encrypted_blocks.push_back(std::move(encrypted_block));
+    }
+    
+    file_tree_.update_leaves(leaf_updates);
+    file_fingerprint = file_tree_.get_root();
+    return 0;
+}
+
+int DataOwner::append_block(const std::vector<uint8_t>& block_data,
+                           const std::array<uint8_t, 32>& key,
+                           EncryptedBlock& encrypted_block,
+                           std::array<uint8_t, 32>& file_fingerprint) {
+    if (encrypt_block(block_data, key, encrypted_block) != 0) {
+        return -1;
+    }
+    
+    file_tree_.append_leaf(hash_encrypted_block(encrypted_block));
+    file_fingerprint = file_tree_.get_root();
+    return 0;
+}
+
+int DataOwner::truncate_blocks(size_t num_blocks, std::array<uint8_t, 32>& file_fingerprint) {
+    if (!file_tree_.truncate(num_blocks)) {
+        return -1;
     }
     
+    // 截断为空时与空文件的指纹一致（全0）
+    file_fingerprint = file_tree_.get_root();
     return 0;
 }
 
+const MerkleTree& DataOwner::get_file_tree() const {
+    return file_tree_;
+}
+
 bool DataOwner::verify_proof(const ProofPackage& proof,
                             const std::array<uint8_t, 65>& enclave_pub_key,
                             const MerkleTree& merkle_tree) {
-    // 1. 验证签名
+    // 1. 验证签名（证明包声明的签名方案须与飞地公钥一致，两种方案都接受）
+    SignatureScheme key_scheme;
+    if (tee_key_scheme(enclave_pub_key, key_scheme) != 0 || key_scheme != proof.sig_scheme) {
+        return false;
+    }
     std::vector<uint8_t> sign_data;
     sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&proof.time_slot_id), 
                      reinterpret_cast<const uint8_t*>(&proof.time_slot_id) + 8);
@@ -67,28 +272,22 @@ bool DataOwner::verify_proof(const ProofPackage& proof,
                      reinterpret_cast<const uint8_t*>(&proof.rep_snapshot) + 8);
     sign_data.insert(sign_data.end(), proof.random_r.begin(), proof.random_r.end());
     
-    if (!tee_verify_signature(enclave_pub_key, sign_data.data(), sign_data.size(), proof.enclave_sig)) {
+    if (!VerifyKeyCache::shared().verify(enclave_pub_key, sign_data.data(), sign_data.size(), proof.enclave_sig)) {
         return false;
     }
     
-    // 2. 验证Merkle路径（需要解析merkle_path）
-    std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
-    size_t pos = 0;
-    
-    while (pos + 32 + 1 <= proof.merkle_path.size()) {
-        std::array<uint8_t, 32> hash;
-        memcpy(hash.data(), proof.merkle_path.data() + pos, 32);
-        pos += 32;
-        
-        bool is_left = (proof.merkle_path[pos] == 0x01);
-        pos += 1;
-        
-        path.emplace_back(hash, is_left);
+    // 2. 验证Merkle路径（直接在证明包的缓冲区上解析和验证，不复制路径）
+    MerklePathView path;
+    if (!path.parse(proof.merkle_path)) {
+        return false;
     }
     
-    // 这里需要获取挑战块的哈希来验证，实际应用中应该从存储节点获取
-    // 简化处理：假设我们可以获取到挑战块的哈希
-    // 注意：在实际系统中，这需要通过其他方式验证
+    // 挑战块的哈希取自数据所有者持有的树，路径必须能还原出该树的根
+    std::array<uint8_t, 32> leaf_hash;
+    if (!merkle_tree.get_leaf(proof.challenge_idx, leaf_hash) ||
+        !MerkleTree::verify_proof(leaf_hash, path, merkle_tree.get_root())) {
+        return false;
+    }
     
     // 3. 验证时间有效性
     uint64_t current_time = get_current_timestamp();
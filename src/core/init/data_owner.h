@@ -4,10 +4,26 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <utility>
+#include <string>
 #include "../../../include/common_type.h"
 #include "../../tee_simulator/random_source.h"
 #include "../../utils/crypto_utils.h"
 #include "../../utils/merkle_tree.h"  // 引入MerkleTree类定义
+#include "../../utils/file_io.h"
+#include "../../utils/thread_pool.h"
+#include "../../utils/encrypted_block_set.h"
+#include "../../utils/cdc_chunker.h"
+
+// 加密块的接收方（流式入库时每加密一块就交给它，块按下标顺序到达）
+class BlockSink {
+public:
+    virtual ~BlockSink() = default;
+    
+    // index: 块下标，block: 加密块视图（只在本次调用期间有效，需要保留时复制），
+    // leaf_hash: 该块的Merkle叶子哈希
+    virtual int consume(size_t index, const EncryptedBlockView& block, const std::array<uint8_t, 32>& leaf_hash) = 0;
+};
 
 class DataOwner {
 public:
@@ -27,10 +43,89 @@ public:
                          std::vector<EncryptedBlock>& encrypted_blocks,
                          std::array<uint8_t, 32>& file_fingerprint);
     
+    // 同上，加密块写入连续存储的块集合（无逐块内存分配）
+    int split_and_encrypt(const std::vector<uint8_t>& raw_file,
+                         const std::array<uint8_t, 32>& key,
+                         EncryptedBlockSet& encrypted_blocks,
+                         std::array<uint8_t, 32>& file_fingerprint);
+    
+    // 内容定义分块加密：按 params 用 CdcChunker 切成变长块（块长由内容决定，插入/删除数据后
+    // 未改动的内容仍切出相同的块），encrypted_blocks 的槽位大小调整为 params.max_size。
+    // 使用收敛加密（IV由明文派生，见 ParallelBlockEncryptor::encrypt_chunks），
+    // 相同密钥下各版本中相同的块密文相同，存储节点可用 ChunkStore 去重。
+    // 文件树与 split_and_encrypt 相同（每块一个叶子），之后的挑战/证明流程不变
+    int split_and_encrypt_cdc(const std::vector<uint8_t>& raw_file,
+                              const std::array<uint8_t, 32>& key,
+                              const ChunkingParams& params,
+                              EncryptedBlockSet& encrypted_blocks,
+                              std::array<uint8_t, 32>& file_fingerprint);
+    
+    // 流式分块加密：从文件按块读取明文，每块加密、计算叶子哈希后立即交给 sink，
+    // 文件指纹由流式累加器计算。内存占用只有 read_buffer_bytes 大小的读缓冲区，与文件大小无关。
+    // 流式模式不保存整棵文件树（之后不能使用下面的动态更新接口），需要证明时由 sink 一侧建树
+    // （例如存储节点把叶子哈希流式写入 DiskMerkleTreeWriter）
+    int split_and_encrypt_file(const RandomAccessFile& file,
+                               const std::array<uint8_t, 32>& key,
+                               BlockSink& sink,
+                               std::array<uint8_t, 32>& file_fingerprint,
+                               size_t read_buffer_bytes = DEFAULT_READ_BUFFER_BYTES);
+    int split_and_encrypt_file(const std::string& path,
+                               const std::array<uint8_t, 32>& key,
+                               BlockSink& sink,
+                               std::array<uint8_t, 32>& file_fingerprint,
+                               size_t read_buffer_bytes = DEFAULT_READ_BUFFER_BYTES);
+    
+    // 设置分块加密（加密 + 叶子哈希 + 建文件树）使用的线程数
+    // num_threads: 1 表示单线程加密（默认），0 表示使用CPU核数
+    void set_encrypt_threads(size_t num_threads);
+    
+    // 流式入库默认的读缓冲区大小（4 MB）
+    static constexpr size_t DEFAULT_READ_BUFFER_BYTES = static_cast<size_t>(4) << 20;
+    
+    // 动态更新：以下接口在 split_and_encrypt 建立的文件Merkle树上增量修改，
+    // 每次只重算受影响的 O(log n) 条路径，并输出更新后的文件指纹
+    
+    // 重写第 index 块（使用新的随机IV重新加密）
+    int update_block(size_t index,
+                     const std::vector<uint8_t>& block_data,
+                     const std::array<uint8_t, 32>& key,
+                     EncryptedBlock& encrypted_block,
+                     std::array<uint8_t, 32>& file_fingerprint);
+    
+    // 批量重写多个块（共同祖先只重算一次），encrypted_blocks 与 updates 一一对应
+    int update_blocks(const std::vector<std::pair<size_t, std::vector<uint8_t>>>& updates,
+                      const std::array<uint8_t, 32>& key,
+                      std::vector<EncryptedBlock>& encrypted_blocks,
+                      std::array<uint8_t, 32>& file_fingerprint);
+    
+    // 在文件末尾追加一块
+    int append_block(const std::vector<uint8_t>& block_data,
+                     const std::array<uint8_t, 32>& key,
+                     EncryptedBlock& encrypted_block,
+                     std::array<uint8_t, 32>& file_fingerprint);
+    
+    // 截断为前 num_blocks 块
+    int truncate_blocks(size_t num_blocks, std::array<uint8_t, 32>& file_fingerprint);
+    
+    // 当前文件的Merkle树（根即文件指纹）
+    const MerkleTree& get_file_tree() const;
+    
     // 验证存储节点返回的证明
     bool verify_proof(const ProofPackage& proof,
                      const std::array<uint8_t, 65>& enclave_pub_key,
                      const MerkleTree& merkle_tree);
+
+private:
+    MerkleTree file_tree_; // 当前文件的Merkle树（叶子为各加密块的哈希）
+    std::unique_ptr<ThreadPool> encrypt_pool_; // 并行加密线程池（单线程时为空）
+    
+    // 用叶子哈希建立文件树并输出文件指纹（空文件指纹为全0）
+    void build_file_tree(MerkleTree::NodeBuffer&& block_hashes, std::array<uint8_t, 32>& file_fingerprint);
+    
+    // 加密单个块（块数据不超过 Config::BLOCK_SIZE）
+    int encrypt_block(const std::vector<uint8_t>& block_data,
+                      const std::array<uint8_t, 32>& key,
+                      EncryptedBlock& encrypted_block);
 };
 
 #endif // DATA_OWNER_H
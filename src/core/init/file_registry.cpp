@@ -0,0 +1,353 @@
+#include "file_registry.h"
+#include "../../utils/siphash.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+HostedFile::HostedFile(const std::string& owner, std::unique_ptr<StorageNode> storage, MerkleTree&& tree)
+    : fingerprint_(tree.get_root()),
+      owner_(owner),
+      storage_(std::move(storage)),
+      tree_(std::make_unique<MerkleTree>(std::move(tree))) {}
+
+HostedFile::~HostedFile() {
+    // 先解除磁盘树的映射再删除文件（Windows 上不能删除仍被映射的文件）
+    disk_tree_.reset();
+    if (removed_ && !tree_path_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(tree_path_, ec);
+    }
+}
+
+std::array<uint8_t, 32> HostedFile::fingerprint() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return fingerprint_;
+}
+
+const std::string& HostedFile::owner() const {
+    return owner_;
+}
+
+const StorageNode& HostedFile::storage() const {
+    return *storage_;
+}
+
+size_t HostedFile::leaf_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return tree_ ? tree_->leaf_count() : disk_tree_->leaf_count();
+}
+
+bool HostedFile::get_leaf(size_t leaf_idx, std::array<uint8_t, 32>& leaf_hash) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return tree_ ? tree_->get_leaf(leaf_idx, leaf_hash) : disk_tree_->get_leaf(leaf_idx, leaf_hash);
+}
+
+bool HostedFile::get_proof(size_t leaf_idx, std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return tree_ ? tree_->get_proof(leaf_idx, path) : disk_tree_->get_proof(leaf_idx, path);
+}
+
+bool HostedFile::tree_resident() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return tree_ != nullptr;
+}
+
+size_t HostedFile::memory_bytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return memory_bytes_locked();
+}
+
+size_t HostedFile::memory_bytes_locked() const {
+    size_t bytes = storage_->get_blocks().memory_bytes() + (tree_ ? tree_->memory_bytes() : 0);
+    if (const ChunkStore* chunk_store = storage_->get_chunk_store()) {
+        // 去重块存储由多个文件共享，按本文件的引用数分摊实际保存的密文
+        size_t refs = storage_->get_block_count();
+        ChunkStore::Stats stats = chunk_store->stats();
+        bytes += refs * sizeof(uint32_t);
+        if (stats.references > 0) {
+            bytes += static_cast<size_t>(static_cast<double>(stats.stored_bytes) * refs / stats.references);
+        }
+    }
+    return bytes;
+}
+
+std::array<uint8_t, 32> HostedFile::root_locked() const {
+    return tree_ ? tree_->get_root() : disk_tree_->get_root();
+}
+
+int HostedFile::evict_tree_locked(const std::string& path) {
+    if (!tree_) {
+        return 0;
+    }
+    auto disk_tree = std::make_unique<DiskMerkleTree>();
+    // 逐出的树只是可从块重建的缓存，写出时不 fsync
+    if (DiskMerkleTreeWriter::write(path, *tree_, false) != 0 ||
+        disk_tree->open(path, FileRegistry::EVICTED_PINNED_LEVELS) != 0 ||
+        disk_tree->get_root() != tree_->get_root()) {
+        return -1;
+    }
+    disk_tree_ = std::move(disk_tree);
+    tree_path_ = path;
+    tree_.reset();
+    return 0;
+}
+
+int HostedFile::load_tree_locked() {
+    if (tree_) {
+        return 0;
+    }
+    // 只读回叶子层，上层节点在内存中重算（比逐层读回更快，且与内存树的布局无关）
+    MerkleTree::NodeBuffer leaves;
+    leaves.reserve(MerkleTree::node_count(disk_tree_->leaf_count()));
+    leaves.resize(disk_tree_->leaf_count());
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        if (!disk_tree_->get_leaf(i, leaves[i])) {
+            return -1;
+        }
+    }
+    auto tree = std::make_unique<MerkleTree>(std::move(leaves));
+    if (tree->get_root() != disk_tree_->get_root()) {
+        return -1;
+    }
+    tree_ = std::move(tree);
+    disk_tree_.reset();
+    return 0;
+}
+
+FileRegistry::FileRegistry(const std::string& spill_dir, size_t memory_budget, size_t num_shards)
+    : spill_dir_(spill_dir), memory_budget_(memory_budget) {
+    shards_.resize(std::max<size_t>(num_shards, 1));
+    for (auto& shard : shards_) {
+        shard = std::make_unique<Shard>();
+    }
+}
+
+size_t FileRegistry::FingerprintHash::operator()(const std::array<uint8_t, 32>& fingerprint) const {
+    // 指纹（树根）由租户上传的数据决定，用带进程随机密钥的 SipHash，避免被构造成落入同一个桶
+    return static_cast<size_t>(keyed_hash(fingerprint.data(), fingerprint.size()));
+}
+
+FileRegistry::Shard& FileRegistry::shard_for(const std::array<uint8_t, 32>& fingerprint) const {
+    // 分片用哈希值的高32位选取，与分片内哈希表取桶使用的低位无关
+    uint64_t h = keyed_hash(fingerprint.data(), fingerprint.size());
+    return *shards_[(h >> 32) % shards_.size()];
+}
+
+std::string FileRegistry::tree_path(const std::array<uint8_t, 32>& fingerprint) {
+    char name[2 * 32 + 32];
+    for (size_t i = 0; i < fingerprint.size(); ++i) {
+        std::snprintf(name + 2 * i, 3, "%02x", fingerprint[i]);
+    }
+    std::snprintf(name + 64, sizeof(name) - 64, "-%llu.tree", static_cast<unsigned long long>(++spill_seq_));
+    return (std::filesystem::path(spill_dir_) / name).string();
+}
+
+void FileRegistry::account(HostedFile& file) {
+    size_t bytes = file.memory_bytes_locked();
+    memory_bytes_ += bytes;
+    memory_bytes_ -= file.accounted_bytes_;
+    file.accounted_bytes_ = bytes;
+}
+
+int FileRegistry::add_file(const std::string& owner, std::unique_ptr<StorageNode> storage, MerkleTree&& tree) {
+    if (!storage || tree.leaf_count() == 0 || tree.leaf_count() != storage->get_block_count()) {
+        return -1;
+    }
+    
+    auto file = std::make_shared<HostedFile>(owner, std::move(storage), std::move(tree));
+    file->last_access_ = ++access_clock_;
+    {
+        Shard& shard = shard_for(file->fingerprint_);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (!shard.files.emplace(file->fingerprint_, file).second) {
+            return -1;
+        }
+        std::unique_lock<std::shared_mutex> file_lock(file->mutex_);
+        account(*file);
+    }
+    enforce_budget();
+    return 0;
+}
+
+int FileRegistry::remove_file(const std::array<uint8_t, 32>& fingerprint) {
+    std::shared_ptr<HostedFile> file;
+    {
+        Shard& shard = shard_for(fingerprint);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.files.find(fingerprint);
+        if (it == shard.files.end()) {
+            return -1;
+        }
+        file = std::move(it->second);
+        shard.files.erase(it);
+    }
+    
+    std::unique_lock<std::shared_mutex> file_lock(file->mutex_);
+    memory_bytes_ -= file->accounted_bytes_;
+    file->accounted_bytes_ = 0;
+    // 已取出的引用仍通过映射读取磁盘树，树文件留到最后一个引用释放时删除
+    file->removed_ = true;
+    return 0;
+}
+
+std::shared_ptr<HostedFile> FileRegistry::find(const std::array<uint8_t, 32>& fingerprint) const {
+    std::shared_ptr<HostedFile> file;
+    {
+        Shard& shard = shard_for(fingerprint);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.files.find(fingerprint);
+        if (it == shard.files.end()) {
+            return nullptr;
+        }
+        file = it->second;
+    }
+    file->last_access_.store(++access_clock_, std::memory_order_relaxed);
+    return file;
+}
+
+int FileRegistry::modify_file(const std::array<uint8_t, 32>& fingerprint,
+                              const std::function<int(StorageNode&, MerkleTree&)>& fn) {
+    std::shared_ptr<HostedFile> file = find(fingerprint);
+    if (!file) {
+        return -1;
+    }
+    
+    int ret;
+    {
+        std::unique_lock<std::shared_mutex> file_lock(file->mutex_);
+        if (file->load_tree_locked() != 0) {
+            return -1;
+        }
+        ret = fn(*file->storage_, *file->tree_);
+        account(*file);
+    }
+    // fn 失败时也可能已修改了部分块，同样按实际的树根重新索引
+    if (rekey(file) != 0) {
+        ret = -1;
+    }
+    enforce_budget();
+    return ret;
+}
+
+int FileRegistry::rekey(const std::shared_ptr<HostedFile>& file) {
+    for (;;) {
+        std::array<uint8_t, 32> old_fp, new_fp;
+        {
+            std::shared_lock<std::shared_mutex> file_lock(file->mutex_);
+            old_fp = file->fingerprint_;
+            new_fp = file->root_locked();
+        }
+        if (old_fp == new_fp) {
+            return 0;
+        }
+        
+        // 锁顺序与 add_file 一致（先分片后文件），两个分片按地址顺序加锁
+        Shard& from = shard_for(old_fp);
+        Shard& to = shard_for(new_fp);
+        std::unique_lock<std::shared_mutex> first_lock(std::less<Shard*>()(&from, &to) ? from.mutex : to.mutex);
+        std::unique_lock<std::shared_mutex> second_lock;
+        if (&from != &to) {
+            second_lock = std::unique_lock<std::shared_mutex>(std::less<Shard*>()(&from, &to) ? to.mutex : from.mutex);
+        }
+        std::unique_lock<std::shared_mutex> file_lock(file->mutex_);
+        if (file->fingerprint_ != old_fp || file->root_locked() != new_fp) {
+            continue;  // 加锁前又被修改或改过索引，重新读取
+        }
+        auto it = from.files.find(old_fp);
+        if (it == from.files.end() || it->second != file) {
+            return 0;  // 已被删除
+        }
+        if (to.files.count(new_fp) != 0) {
+            return -1;
+        }
+        std::shared_ptr<HostedFile> entry = std::move(it->second);
+        from.files.erase(it);
+        to.files.emplace(new_fp, std::move(entry));
+        file->fingerprint_ = new_fp;
+        return 0;
+    }
+}
+
+size_t FileRegistry::file_count() const {
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        count += shard->files.size();
+    }
+    return count;
+}
+
+size_t FileRegistry::memory_bytes() const {
+    return memory_bytes_.load();
+}
+
+size_t FileRegistry::eviction_failures() const {
+    return eviction_failures_.load();
+}
+
+size_t FileRegistry::owner_memory_bytes(const std::string& owner) const {
+    size_t bytes = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        for (const auto& entry : shard->files) {
+            if (entry.second->owner() == owner) {
+                bytes += entry.second->memory_bytes();
+            }
+        }
+    }
+    return bytes;
+}
+
+void FileRegistry::set_memory_budget(size_t memory_budget) {
+    memory_budget_ = memory_budget;
+    enforce_budget();
+}
+
+int FileRegistry::enforce_budget() {
+    size_t budget = memory_budget_.load();
+    if (budget == 0 || memory_bytes_.load() <= budget) {
+        return 0;
+    }
+    if (evict_cold_trees(budget - budget / 8) != 0) {
+        ++eviction_failures_;
+        return -1;
+    }
+    return 0;
+}
+
+int FileRegistry::evict_cold_trees(size_t target_bytes) {
+    // 其他线程正在逐出时直接返回，由那一轮负责降到预算以内
+    std::unique_lock<std::mutex> evict_lock(evict_mutex_, std::try_to_lock);
+    if (!evict_lock.owns_lock()) {
+        return 0;
+    }
+    
+    // 收集树常驻内存的文件，按最近访问时间从旧到新逐出
+    std::vector<std::pair<uint64_t, std::shared_ptr<HostedFile>>> candidates;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        for (const auto& entry : shard->files) {
+            candidates.emplace_back(entry.second->last_access_.load(std::memory_order_relaxed), entry.second);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    std::error_code ec;
+    std::filesystem::create_directories(spill_dir_, ec);
+    for (auto& candidate : candidates) {
+        if (memory_bytes_.load() <= target_bytes) {
+            break;
+        }
+        HostedFile& file = *candidate.second;
+        std::unique_lock<std::shared_mutex> file_lock(file.mutex_);
+        if (!file.tree_ || file.accounted_bytes_ == 0) {
+            continue;  // 已逐出，或在收集之后被删除
+        }
+        if (file.evict_tree_locked(file.tree_path_.empty() ? tree_path(file.fingerprint_) : file.tree_path_) != 0) {
+            return -1;
+        }
+        account(file);
+    }
+    return 0;
+}
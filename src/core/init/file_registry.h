@@ -0,0 +1,166 @@
+#ifndef FILE_REGISTRY_H
+#define FILE_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../../utils/merkle_tree.h"
+#include "../../utils/disk_merkle_tree.h"
+#include "storage_node.h"
+
+// 存储节点托管的单个文件：块（StorageNode，内存或磁盘块存储）和Merkle树。
+// 树可能常驻内存，也可能已被逐出到磁盘（此时取证明直接读磁盘树，不需要加载回内存）。
+// 读操作可在多个证明线程中并发执行；修改通过 FileRegistry::modify_file 进行。
+class HostedFile {
+public:
+    // 构造函数
+    HostedFile(const std::string& owner, std::unique_ptr<StorageNode> storage, MerkleTree&& tree);
+    
+    // 析构函数：文件已从注册表删除时，最后一个引用释放后才删除逐出的树文件
+    ~HostedFile();
+    
+    HostedFile(const HostedFile&) = delete;
+    HostedFile& operator=(const HostedFile&) = delete;
+    
+    // 文件指纹（Merkle根，modify_file 改变树根后随之更新）/ 所属数据所有者
+    std::array<uint8_t, 32> fingerprint() const;
+    const std::string& owner() const;
+    
+    // 块存储（只读访问；不能与同一文件的 modify_file 并发）
+    const StorageNode& storage() const;
+    
+    // 树的叶子数 / 叶子哈希 / Merkle路径（树在内存或磁盘上均可）
+    size_t leaf_count() const;
+    bool get_leaf(size_t leaf_idx, std::array<uint8_t, 32>& leaf_hash) const;
+    bool get_proof(size_t leaf_idx, std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path) const;
+    
+    // 树是否常驻内存
+    bool tree_resident() const;
+    
+    // 本文件占用的内存：内存中的块 + 常驻内存的树，
+    // 使用去重块存储时再加上块编号表和按引用数分摊的去重块存储密文
+    size_t memory_bytes() const;
+
+private:
+    friend class FileRegistry;
+    
+    std::array<uint8_t, 32> fingerprint_;
+    std::string owner_;
+    std::unique_ptr<StorageNode> storage_;
+    std::unique_ptr<MerkleTree> tree_;            // 常驻内存的树（已逐出时为空）
+    std::unique_ptr<DiskMerkleTree> disk_tree_;   // 逐出到磁盘的树（常驻时为空）
+    std::string tree_path_;                       // 磁盘树文件路径（首次逐出时分配，之后重复使用）
+    bool removed_ = false;                        // 已从注册表删除（析构时删除树文件）
+    mutable std::shared_mutex mutex_;             // 读操作共享，逐出/加载/修改独占
+    mutable std::atomic<uint64_t> last_access_{0};
+    size_t accounted_bytes_ = 0;                  // 已计入注册表总量的字节数（注册表持锁维护）
+    
+    size_t memory_bytes_locked() const;
+    
+    // 当前树根（树在内存或磁盘上均可，调用方持有锁）
+    std::array<uint8_t, 32> root_locked() const;
+    
+    // 把树写到 path 后释放内存树（调用方持有独占锁）
+    int evict_tree_locked(const std::string& path);
+    
+    // 从磁盘树加载回内存（调用方持有独占锁）
+    int load_tree_locked();
+};
+
+// 存储节点的多文件注册表：按文件指纹索引托管的文件，每个文件独立拥有块和Merkle树。
+// 索引按指纹分片，每个分片一把读写锁，证明线程查找文件时只持有所在分片的共享锁，
+// 没有全局锁。所有文件占用的内存超过预算时，按最近访问时间把最冷的树逐出到 spill_dir。
+class FileRegistry {
+public:
+    // 构造函数
+    // spill_dir: 逐出的树文件所在目录；memory_budget: 内存预算（字节，0 表示不限制）
+    explicit FileRegistry(const std::string& spill_dir, size_t memory_budget = 0, size_t num_shards = DEFAULT_SHARDS);
+    
+    // 析构函数
+    ~FileRegistry() = default;
+    
+    FileRegistry(const FileRegistry&) = delete;
+    FileRegistry& operator=(const FileRegistry&) = delete;
+    
+    // 注册文件：指纹取树根，要求树的叶子数与已存储的块数一致；指纹已存在时返回-1
+    // 注册后超出内存预算时逐出冷树，逐出失败不影响返回值（计入 eviction_failures）
+    int add_file(const std::string& owner, std::unique_ptr<StorageNode> storage, MerkleTree&& tree);
+    
+    // 删除文件（已被 find 取出的引用在释放前仍然有效，逐出的树文件在最后一个引用释放时删除）
+    int remove_file(const std::array<uint8_t, 32>& fingerprint);
+    
+    // 查找文件并记录访问（未找到时返回空）
+    std::shared_ptr<HostedFile> find(const std::array<uint8_t, 32>& fingerprint) const;
+    
+    // 修改文件的块和树（树已逐出时先加载回内存），fn 的返回值原样返回；
+    // 修改后树根随之变化，注册表改按新树根索引该文件（之后须用新指纹查找）。
+    // 新树根与另一个已注册的文件相同时无法改索引，返回-1，文件仍按原指纹索引。
+    // 修改后超出内存预算时逐出冷树，逐出失败不影响返回值（计入 eviction_failures）
+    int modify_file(const std::array<uint8_t, 32>& fingerprint,
+                    const std::function<int(StorageNode&, MerkleTree&)>& fn);
+    
+    // 文件数
+    size_t file_count() const;
+    
+    // 所有文件 / 某个数据所有者的文件占用的内存
+    size_t memory_bytes() const;
+    size_t owner_memory_bytes(const std::string& owner) const;
+    
+    // 超出预算后自动逐出（注册、修改、设置预算时触发）失败的次数，注册和修改本身已生效
+    size_t eviction_failures() const;
+    
+    // 设置内存预算（超出时立即逐出）
+    void set_memory_budget(size_t memory_budget);
+    
+    // 按最近访问时间从最冷的文件开始逐出内存树，直到总内存不超过 target_bytes
+    int evict_cold_trees(size_t target_bytes);
+    
+    // 默认分片数
+    static constexpr size_t DEFAULT_SHARDS = 64;
+    
+    // 逐出后的磁盘树常驻内存的顶部层数（托管文件很多时每棵树只常驻很少的节点）
+    static constexpr size_t EVICTED_PINNED_LEVELS = 8;
+
+private:
+    struct FingerprintHash {
+        size_t operator()(const std::array<uint8_t, 32>& fingerprint) const;
+    };
+    
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::array<uint8_t, 32>, std::shared_ptr<HostedFile>, FingerprintHash> files;
+    };
+    
+    std::string spill_dir_;
+    std::atomic<size_t> memory_budget_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> memory_bytes_{0};       // 所有文件已计入的内存总量
+    mutable std::atomic<uint64_t> access_clock_{0};
+    std::atomic<uint64_t> spill_seq_{0};        // 树文件名序号（同一指纹删除后重新注册也不会复用旧文件）
+    std::mutex evict_mutex_;                    // 同一时间只进行一轮逐出
+    std::atomic<size_t> eviction_failures_{0};
+    
+    Shard& shard_for(const std::array<uint8_t, 32>& fingerprint) const;
+    // 分配新的树文件路径：指纹加递增序号
+    std::string tree_path(const std::array<uint8_t, 32>& fingerprint);
+    
+    // 重新统计文件占用并把差值计入总量（调用方持有文件的独占锁）
+    void account(HostedFile& file);
+    
+    // 把文件改按当前树根索引（树根未变时直接返回0）
+    int rekey(const std::shared_ptr<HostedFile>& file);
+    
+    // 超出预算时逐出到预算的 7/8（留出余量，避免每次注册都触发逐出）
+    int enforce_budget();
+};
+
+#endif // FILE_REGISTRY_H
@@ -0,0 +1,22 @@
+#include "ingest.h"
+#include <utility>
+
+int ingest_file(DataOwner& data_owner,
+                StorageNode& storage_node,
+                const std::vector<uint8_t>& raw_file,
+                const std::array<uint8_t, 32>& key,
+                std::array<uint8_t, 32>& file_fingerprint,
+                MerkleTree& merkle_tree) {
+    EncryptedBlockSet encrypted_blocks;
+    if (data_owner.split_and_encrypt(raw_file, key, encrypted_blocks, file_fingerprint) != 0) {
+        return -1;
+    }
+    if (encrypted_blocks.empty()) {
+        return -1;
+    }
+    
+    if (storage_node.store_blocks(std::move(encrypted_blocks)) != 0) {
+        return -1;
+    }
+    return storage_node.adopt_merkle_tree(data_owner.get_file_tree(), merkle_tree);
+}
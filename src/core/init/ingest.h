@@ -0,0 +1,21 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "data_owner.h"
+#include "storage_node.h"
+#include "../../utils/merkle_tree.h"
+
+// 单遍数据入库：分块 → 加密 → 叶子哈希 → 建树 只做一次，
+// 加密块移交给存储节点（不复制密文），存储节点直接接收数据所有者的树（只抽查少量叶子）
+// file_fingerprint: 输出文件指纹，merkle_tree: 输出存储节点侧的Merkle树（根与指纹一致）
+int ingest_file(DataOwner& data_owner,
+                StorageNode& storage_node,
+                const std::vector<uint8_t>& raw_file,
+                const std::array<uint8_t, 32>& key,
+                std::array<uint8_t, 32>& file_fingerprint,
+                MerkleTree& merkle_tree);
+
+#endif // INGEST_H
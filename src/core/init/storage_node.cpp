@@ -1,9 +1,17 @@
 #include "storage_node.h"
 #include "../../utils/crypto_utils.h"
+#include "../../tee_simulator/random_source.h"
+#include "../../../include/config.h"
+#include <algorithm>
+#include <atomic>
 
-int StorageNode::init_tee(EnclaveKeyPair& key_pair, std::vector<uint8_t>& report) {
+StorageNode::~StorageNode() {
+    release_chunks(0);
+}
+
+int StorageNode::init_tee(EnclaveKeyPair& key_pair, std::vector<uint8_t>& report, SignatureScheme scheme) {
     // 初始化飞地密钥对
-    if (tee_init_key_pair(key_pair) != 0) {
+    if (tee_init_key_pair(key_pair, scheme) != 0) {
         return -1;
     }
     
@@ -15,36 +23,558 @@ int StorageNode::init_tee(EnclaveKeyPair& key_pair, std::vector<uint8_t>& report
     return 0;
 }
 
-int StorageNode::build_merkle_tree(const std::vector<EncryptedBlock>& blocks, MerkleTree& merkle_tree) {
+namespace {
+
+// 计算 blocks[first, first + count) 的叶子哈希，blocks 可以是 std::vector<EncryptedBlock>、EncryptedBlockSet 或 BlockStore
+// 每个任务整段调用批量哈希（同一线程内复用摘要引擎）
+template <typename Blocks>
+int hash_blocks(const Blocks& blocks, size_t first, size_t count,
+                std::array<uint8_t, 32>* out, ThreadPool* pool, size_t grain) {
+    if (!pool) {
+        return hash_encrypted_blocks(blocks, first, count, out);
+    }
+    std::atomic<bool> failed{false};
+    pool->parallel_for(count, grain, [&](size_t begin, size_t end) {
+        if (hash_encrypted_blocks(blocks, first + begin, end - begin, out + begin) != 0) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+    });
+    return failed.load() ? -1 : 0;
+}
+
+template <typename Blocks>
+int build_tree_from(const Blocks& blocks, ThreadPool* pool, MerkleTree& merkle_tree) {
     if (blocks.empty()) {
         return -1;
     }
     
-    // 计算每个块的哈希
-    std::vector<std::array<uint8_t, 32>> block_hashes;
-    for (const auto& block : blocks) {
-        block_hashes.push_back(hash_encrypted_block(block));
+    // 计算每个块的哈希（预留整棵树的空间，叶子直接移入Merkle树）
+    MerkleTree::NodeBuffer block_hashes;
+    block_hashes.reserve(MerkleTree::node_count(blocks.size()));
+    block_hashes.resize(blocks.size());
+    if (hash_blocks(blocks, 0, blocks.size(), block_hashes.data(), pool, 1024) != 0) {
+        return -1;
     }
     
     // 构建Merkle树
-    merkle_tree = MerkleTree(block_hashes);
+    merkle_tree = pool ? MerkleTree(std::move(block_hashes), *pool) : MerkleTree(std::move(block_hashes));
+    return 0;
+}
+
+template <typename Blocks>
+int build_disk_tree_from(const Blocks& blocks, ThreadPool* pool, const std::string& path,
+                         std::array<uint8_t, 32>& root) {
+    if (blocks.empty()) {
+        return -1;
+    }
+    
+    DiskMerkleTreeWriter writer;
+    if (writer.open(path) != 0) {
+        return -1;
+    }
+    
+    // 每批计算一定数量的叶子哈希后写出，内存占用与块数无关
+    const size_t batch_size = 4096;
+    std::vector<std::array<uint8_t, 32>> batch(batch_size);
+    for (size_t first = 0; first < blocks.size(); first += batch_size) {
+        size_t count = std::min(batch_size, blocks.size() - first);
+        if (hash_blocks(blocks, first, count, batch.data(), pool, 256) != 0 ||
+            writer.append_leaves(batch.data(), count) != 0) {
+            return -1;
+        }
+    }
+    return writer.finish(&root);
+}
+
+} // namespace
+
+int StorageNode::build_merkle_tree(const std::vector<EncryptedBlock>& blocks, MerkleTree& merkle_tree) {
+    return build_tree_from(blocks, build_pool_.get(), merkle_tree);
+}
+
+int StorageNode::build_merkle_tree(const EncryptedBlockSet& blocks, MerkleTree& merkle_tree) {
+    return build_tree_from(blocks, build_pool_.get(), merkle_tree);
+}
+
+int StorageNode::build_disk_merkle_tree(const std::vector<EncryptedBlock>& blocks, const std::string& path,
+                                        std::array<uint8_t, 32>& root) {
+    return build_disk_tree_from(blocks, build_pool_.get(), path, root);
+}
+
+int StorageNode::build_disk_merkle_tree(const EncryptedBlockSet& blocks, const std::string& path,
+                                        std::array<uint8_t, 32>& root) {
+    return build_disk_tree_from(blocks, build_pool_.get(), path, root);
+}
+
+int StorageNode::build_merkle_tree(MerkleTree& merkle_tree) {
+    if (chunk_store_) {
+        // 叶子哈希入库时已记录，直接取出建树
+        if (chunk_ids_.empty()) {
+            return -1;
+        }
+        MerkleTree::NodeBuffer leaves;
+        leaves.reserve(MerkleTree::node_count(chunk_ids_.size()));
+        leaves.resize(chunk_ids_.size());
+        chunk_store_->get_leaves(chunk_ids_.data(), chunk_ids_.size(), leaves.data());
+        merkle_tree = build_pool_ ? MerkleTree(std::move(leaves), *build_pool_) : MerkleTree(std::move(leaves));
+        return 0;
+    }
+    if (block_store_) {
+        return build_tree_from(*block_store_, build_pool_.get(), merkle_tree);
+    }
+    return build_tree_from(stored_blocks_, build_pool_.get(), merkle_tree);
+}
+
+int StorageNode::build_partial_merkle_tree(size_t kept_levels, PartialMerkleTree& merkle_tree) const {
+    if (get_block_count() == 0) {
+        return -1;
+    }
+    
+    auto source = [this](size_t first, size_t count, std::array<uint8_t, 32>* out) {
+        return hash_stored_blocks(first, count, out);
+    };
+    return merkle_tree.build(get_block_count(), kept_levels, source);
+}
+
+void StorageNode::set_build_threads(size_t num_threads) {
+    if (num_threads == 1) {
+        build_pool_.reset();
+    } else {
+        build_pool_ = std::make_unique<ThreadPool>(num_threads);
+    }
+}
+
+int StorageNode::open_block_store(const std::string& dir, uint64_t segment_bytes) {
+    if (!stored_blocks_.empty() || chunk_store_) {
+        return -1;
+    }
+    
+    auto store = std::make_unique<BlockStore>();
+    if (store->open(dir, segment_bytes) != 0) {
+        return -1;
+    }
+    store->set_sync_interval(BLOCK_STORE_SYNC_INTERVAL);
+    block_store_ = std::move(store);
     return 0;
 }
 
+void StorageNode::set_block_cache(size_t capacity_bytes) {
+    if (capacity_bytes == 0) {
+        block_cache_.reset();
+    } else {
+        block_cache_ = std::make_unique<BlockCache>(capacity_bytes);
+    }
+}
+
+int StorageNode::prefetch_blocks(const std::vector<size_t>& indices) {
+    if (!block_cache_) {
+        return 0;
+    }
+    
+    // 只预取尚未缓存的块（同一批中重复的下标只读一次）
+    std::vector<size_t> missing;
+    missing.reserve(indices.size());
+    for (size_t index : indices) {
+        if (index >= get_block_count()) {
+            return -1;
+        }
+        if (!block_cache_->contains(index, block_store_ != nullptr)) {
+            missing.push_back(index);
+        }
+    }
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+    if (missing.empty()) {
+        return 0;
+    }
+    
+    if (!block_store_) {
+        // 内存存储：块已在内存中，只需批量计算叶子哈希
+        std::vector<EncryptedBlockView> views(missing.size());
+        std::vector<std::array<uint8_t, 32>> leaves(missing.size());
+        for (size_t i = 0; i < missing.size(); ++i) {
+            views[i] = stored_block(missing[i]);
+        }
+        if (hash_encrypted_blocks(views.data(), views.size(), leaves.data()) != 0) {
+            return -1;
+        }
+        for (size_t i = 0; i < missing.size(); ++i) {
+            block_cache_->insert(missing[i], leaves[i]);
+        }
+        return 0;
+    }
+    
+    // 磁盘存储：一次提交所有未命中块的读取，读完一块即哈希并放入缓存
+    if (!prefetch_reader_) {
+        auto reader = std::make_unique<AsyncBlockReader>();
+        if (reader->open(*block_store_) != 0) {
+            return -1;
+        }
+        prefetch_reader_ = std::move(reader);
+    }
+    return prefetch_reader_->read_blocks(missing.data(), missing.size(),
+        [this, &missing](size_t request, int status, const EncryptedBlockView& block) {
+            if (status == 0) {
+                block_cache_->insert(missing[request], hash_encrypted_block(block), &block);
+            }
+        });
+}
+
+bool StorageNode::get_block_leaf(size_t index, std::array<uint8_t, 32>& leaf) const {
+    if (index >= get_block_count()) {
+        return false;
+    }
+    if (chunk_store_) {
+        // 去重存储入库时已记录叶子哈希
+        chunk_store_->get_leaves(&chunk_ids_[index], 1, &leaf);
+        return true;
+    }
+    if (block_cache_ && block_cache_->lookup_leaf(index, leaf)) {
+        return true;
+    }
+    
+    EncryptedBlockView block = stored_block(index);
+    leaf = hash_encrypted_block(block);
+    if (block_cache_) {
+        block_cache_->insert(index, leaf, block_store_ ? &block : nullptr);
+    }
+    return true;
+}
+
+const BlockCache* StorageNode::get_block_cache() const {
+    return block_cache_.get();
+}
+
+int StorageNode::sync_blocks() {
+    return block_store_ ? block_store_->sync() : 0;
+}
+
+int StorageNode::use_chunk_store(std::shared_ptr<ChunkStore> store) {
+    if (!store || block_store_ || get_block_count() != 0) {
+        return -1;
+    }
+    chunk_store_ = std::move(store);
+    return 0;
+}
+
+const ChunkStore* StorageNode::get_chunk_store() const {
+    return chunk_store_.get();
+}
+
+void StorageNode::release_chunks(size_t num_blocks) {
+    if (!chunk_store_) {
+        return;
+    }
+    for (size_t i = num_blocks; i < chunk_ids_.size(); ++i) {
+        chunk_store_->release(chunk_ids_[i]);
+    }
+    chunk_ids_.resize(std::min(num_blocks, chunk_ids_.size()));
+}
+
+int StorageNode::store_chunks(const std::vector<EncryptedBlockView>& views) {
+    std::vector<std::array<uint8_t, 32>> leaves(views.size());
+    std::atomic<bool> failed{false};
+    auto hash_range = [&](size_t begin, size_t end) {
+        if (hash_encrypted_blocks(views.data() + begin, end - begin, leaves.data() + begin) != 0) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+    };
+    if (build_pool_) {
+        build_pool_->parallel_for(views.size(), 1024, hash_range);
+    } else {
+        hash_range(0, views.size());
+    }
+    if (failed.load()) {
+        return -1;
+    }
+    // 先引用所有新块，全部成功后再替换并释放旧块；中途失败时放回已引用的新块，旧块保持不变
+    std::vector<uint32_t> ids;
+    ids.reserve(views.size());
+    for (size_t i = 0; i < views.size(); ++i) {
+        uint32_t id;
+        if (chunk_store_->acquire(views[i], leaves[i], id) != 0) {
+            for (uint32_t acquired : ids) {
+                chunk_store_->release(acquired);
+            }
+            return -1;
+        }
+        ids.push_back(id);
+    }
+    chunk_ids_.swap(ids);
+    for (uint32_t old_id : ids) {
+        chunk_store_->release(old_id);
+    }
+    return 0;
+}
+
+EncryptedBlockView StorageNode::stored_block(size_t index) const {
+    if (chunk_store_) {
+        return chunk_store_->chunk(chunk_ids_[index]);
+    }
+    return block_store_ ? (*block_store_)[index] : stored_blocks_[index];
+}
+
+int StorageNode::replace_stored_block(size_t index, const EncryptedBlockView& block) {
+    if (chunk_store_) {
+        // 先引用新块再释放旧块（新旧内容相同时块不会被删掉）
+        uint32_t id;
+        if (chunk_store_->acquire(block, hash_encrypted_block(block), id) != 0) {
+            return -1;
+        }
+        chunk_store_->release(chunk_ids_[index]);
+        chunk_ids_[index] = id;
+        return 0;
+    }
+    return block_store_ ? block_store_->update(index, block) : stored_blocks_.set_block(index, block);
+}
+
+int StorageNode::append_stored_block(const EncryptedBlockView& block) {
+    if (chunk_store_) {
+        uint32_t id;
+        if (chunk_store_->acquire(block, hash_encrypted_block(block), id) != 0) {
+            return -1;
+        }
+        chunk_ids_.push_back(id);
+        return 0;
+    }
+    return block_store_ ? block_store_->append(block) : stored_blocks_.push_back(block);
+}
+
+int StorageNode::hash_stored_blocks(size_t first, size_t count, std::array<uint8_t, 32>* out) const {
+    if (chunk_store_) {
+        chunk_store_->get_leaves(chunk_ids_.data() + first, count, out);
+        return 0;
+    }
+    if (block_store_) {
+        return hash_encrypted_blocks(*block_store_, first, count, out);
+    }
+    return hash_encrypted_blocks(stored_blocks_, first, count, out);
+}
+
 int StorageNode::store_blocks(const std::vector<EncryptedBlock>& blocks) {
-    stored_blocks_ = blocks;
+    if (block_cache_) {
+        block_cache_->clear();
+    }
+    if (chunk_store_) {
+        return store_chunks(std::vector<EncryptedBlockView>(blocks.begin(), blocks.end()));
+    }
+    if (block_store_) {
+        // 整批顺序写入磁盘存储（替换旧块，旧记录占用的空间不回收）
+        if (block_store_->truncate(0) != 0 || block_store_->append_blocks(blocks) != 0) {
+            return -1;
+        }
+        return 0;
+    }
+    
+    // 槽位取块大小与最长密文中的较大者，保证所有块都能放入
+    size_t max_block_size = Config::BLOCK_SIZE;
+    for (const auto& block : blocks) {
+        max_block_size = std::max(max_block_size, block.ciphertext.size());
+    }
+    
+    EncryptedBlockSet stored(max_block_size);
+    stored.reserve(blocks.size());
+    for (const auto& block : blocks) {
+        if (stored.push_back(block) != 0) {
+            return -1;
+        }
+    }
+    stored_blocks_ = std::move(stored);
+    return 0;
+}
+
+int StorageNode::update_block(size_t index, const EncryptedBlock& block, MerkleTree& merkle_tree) {
+    if (index >= get_block_count() || merkle_tree.leaf_count() != get_block_count()) {
+        return -1;
+    }
+    
+    if (block_cache_) {
+        block_cache_->erase(index);
+    }
+    if (replace_stored_block(index, EncryptedBlockView(block)) != 0 || sync_blocks() != 0) {
+        return -1;
+    }
+    merkle_tree.update_leaf(index, hash_encrypted_block(block));
+    return 0;
+}
+
+int StorageNode::update_blocks(const std::vector<std::pair<size_t, EncryptedBlock>>& updates, MerkleTree& merkle_tree) {
+    if (merkle_tree.leaf_count() != get_block_count()) {
+        return -1;
+    }
+    
+    const size_t max_block_size = block_store_ ? BlockStore::MAX_CIPHERTEXT_SIZE
+                                  : chunk_store_ ? ChunkStore::MAX_CHUNK_SIZE
+                                  : stored_blocks_.max_block_size();
+    std::vector<std::pair<size_t, std::array<uint8_t, 32>>> leaf_updates;
+    leaf_updates.reserve(updates.size());
+    for (const auto& [index, block] : updates) {
+        if (index >= get_block_count() || block.ciphertext.size() > max_block_size) {
+            return -1;
+        }
+        leaf_updates.emplace_back(index, hash_encrypted_block(block));
+    }
+    
+    for (const auto& [index, block] : updates) {
+        if (block_cache_) {
+            block_cache_->erase(index);
+        }
+        if (replace_stored_block(index, EncryptedBlockView(block)) != 0) {
+            return -1;
+        }
+    }
+    if (sync_blocks() != 0) {
+        return -1;
+    }
+    merkle_tree.update_leaves(leaf_updates);
+    return 0;
+}
+
+int StorageNode::append_block(const EncryptedBlock& block, MerkleTree& merkle_tree) {
+    if (merkle_tree.leaf_count() != get_block_count()) {
+        return -1;
+    }
+    
+    if (append_stored_block(EncryptedBlockView(block)) != 0 || sync_blocks() != 0) {
+        return -1;
+    }
+    merkle_tree.append_leaf(hash_encrypted_block(block));
+    return 0;
+}
+
+int StorageNode::truncate_blocks(size_t num_blocks, MerkleTree& merkle_tree) {
+    if (num_blocks > get_block_count() || merkle_tree.leaf_count() != get_block_count()) {
+        return -1;
+    }
+    
+    if (block_cache_) {
+        block_cache_->erase_from(num_blocks);
+    }
+    if (chunk_store_) {
+        release_chunks(num_blocks);
+    } else if (block_store_) {
+        if (block_store_->truncate(num_blocks) != 0 || block_store_->sync() != 0) {
+            return -1;
+        }
+    } else {
+        stored_blocks_.resize(num_blocks);
+    }
+    merkle_tree.truncate(num_blocks);
+    return 0;
+}
+
+int StorageNode::store_blocks(EncryptedBlockSet&& blocks) {
+    if (block_cache_) {
+        block_cache_->clear();
+    }
+    if (chunk_store_) {
+        std::vector<EncryptedBlockView> views(blocks.size());
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            views[i] = blocks[i];
+        }
+        int ret = store_chunks(views);
+        blocks.clear();
+        return ret;
+    }
+    if (block_store_) {
+        int ret = (block_store_->truncate(0) == 0 && block_store_->append_blocks(blocks) == 0) ? 0 : -1;
+        blocks.clear();
+        return ret;
+    }
+    stored_blocks_ = std::move(blocks);
+    return 0;
+}
+
+int StorageNode::store_block(size_t index, const EncryptedBlockView& block) {
+    if (index != get_block_count()) {
+        return -1;
+    }
+    // 密文复制进块集合的连续缓冲区，或追加到磁盘存储（按间隔自动落盘）
+    return append_stored_block(block);
+}
+
+int StorageNode::adopt_merkle_tree(const MerkleTree& tree, MerkleTree& merkle_tree) const {
+    const size_t block_count = get_block_count();
+    if (block_count == 0 || tree.leaf_count() != block_count) {
+        return -1;
+    }
+    
+    // 抽查叶子：随机挑选若干块重新哈希，与树中的叶子比对
+    const size_t samples = std::min<size_t>(16, block_count);
+    for (size_t n = 0; n < samples; ++n) {
+        uint64_t r = 0;
+        if (tee_get_random(reinterpret_cast<uint8_t*>(&r), sizeof(r)) != 0) {
+            return -1;
+        }
+        size_t idx = static_cast<size_t>(r % block_count);
+        std::array<uint8_t, 32> leaf;
+        if (!tree.get_leaf(idx, leaf) || leaf != hash_encrypted_block(stored_block(idx))) {
+            return -1;
+        }
+    }
+    
+    merkle_tree = tree;
     return 0;
 }
 
 bool StorageNode::get_block(size_t index, EncryptedBlock& block) const {
-    if (index >= stored_blocks_.size()) {
+    if (index >= get_block_count()) {
         return false;
     }
+    if (block_store_ && block_cache_ && block_cache_->lookup_block(index, block)) {
+        return true;
+    }
     
-    block = stored_blocks_[index];
+    block = stored_block(index).to_block();
     return true;
 }
 
+bool StorageNode::get_block_view(size_t index, EncryptedBlockView& block) const {
+    if (index >= get_block_count()) {
+        return false;
+    }
+    
+    block = stored_block(index);
+    return true;
+}
+
+const EncryptedBlockSet& StorageNode::get_blocks() const {
+    return stored_blocks_;
+}
+
+const BlockStore* StorageNode::get_block_store() const {
+    return block_store_.get();
+}
+
 size_t StorageNode::get_block_count() const {
-    return stored_blocks_.size();
+    if (chunk_store_) {
+        return chunk_ids_.size();
+    }
+    return block_store_ ? block_store_->size() : stored_blocks_.size();
+}
+
+StorageNodeSink::StorageNodeSink(StorageNode& storage_node) : storage_node_(storage_node) {}
+
+int StorageNodeSink::open_tree(const std::string& tree_path) {
+    if (tree_writer_.open(tree_path) != 0) {
+        return -1;
+    }
+    write_tree_ = true;
+    return 0;
+}
+
+int StorageNodeSink::consume(size_t index, const EncryptedBlockView& block, const std::array<uint8_t, 32>& leaf_hash) {
+    if (write_tree_ && tree_writer_.append_leaf(leaf_hash) != 0) {
+        return -1;
+    }
+    return storage_node_.store_block(index, block);
+}
+
+int StorageNodeSink::finish(std::array<uint8_t, 32>& root) {
+    // 已接收的块先落盘，即使没有可输出的树根
+    if (storage_node_.sync_blocks() != 0 || !write_tree_) {
+        return -1;
+    }
+    write_tree_ = false;
+    return tree_writer_.finish(&root);
 }
@@ -4,40 +4,176 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <memory>
+#include <utility>
 #include "../../../include/common_type.h"
 #include "../../tee_simulator/enclave_sign.h"
 #include "../../tee_simulator/attestation_sim.h"
 #include "../../utils/merkle_tree.h"
+#include "../../utils/disk_merkle_tree.h"
+#include "../../utils/partial_merkle_tree.h"
+#include "../../utils/thread_pool.h"
+#include "../../utils/encrypted_block_set.h"
+#include "../../utils/block_store.h"
+#include "../../utils/block_cache.h"
+#include "../../utils/async_block_reader.h"
+#include "../../utils/chunk_store.h"
+#include "data_owner.h"
 
 class StorageNode {
 public:
     // 构造函数
     StorageNode() = default;
     
-    // 析构函数
-    ~StorageNode() = default;
+    // 析构函数（使用去重块存储时释放本节点持有的块引用）
+    ~StorageNode();
     
     // 初始化TEE环境
     // key_pair: 输出飞地密钥对
     // report: 输出远程证明报告
-    int init_tee(EnclaveKeyPair& key_pair, std::vector<uint8_t>& report);
+    // scheme: 飞地签名方案
+    int init_tee(EnclaveKeyPair& key_pair, std::vector<uint8_t>& report,
+                 SignatureScheme scheme = SignatureScheme::ECDSA_P256);
     
     // 构建数据块的Merkle树
     // blocks: 加密的数据块
     // merkle_tree: 输出构建的Merkle树
     int build_merkle_tree(const std::vector<EncryptedBlock>& blocks, MerkleTree& merkle_tree);
+    int build_merkle_tree(const EncryptedBlockSet& blocks, MerkleTree& merkle_tree);
+    
+    // 构建磁盘上的Merkle树（叶子哈希分批流式写入，不在内存中保存整棵树）
+    // path: 树文件路径（节点重启后用 DiskMerkleTree::open 直接打开，无需重建）
+    // root: 输出Merkle根
+    int build_disk_merkle_tree(const std::vector<EncryptedBlock>& blocks, const std::string& path,
+                               std::array<uint8_t, 32>& root);
+    int build_disk_merkle_tree(const EncryptedBlockSet& blocks, const std::string& path,
+                               std::array<uint8_t, 32>& root);
+    
+    // 基于已存储的数据块构建只保留顶部 kept_levels 层的Merkle树
+    // 取证明时按需从已存储的块重算子树（可用 PartialMerkleTree::levels_for_budget 按内存预算选择层数），
+    // 树在使用期间本节点的存储块不能被修改
+    int build_partial_merkle_tree(size_t kept_levels, PartialMerkleTree& merkle_tree) const;
+    
+    // 基于已存储的数据块构建Merkle树（内存或磁盘块存储均可，节点重启后用于恢复树）
+    int build_merkle_tree(MerkleTree& merkle_tree);
+    
+    // 使用目录 dir 中的磁盘块存储保存数据块（不存在时创建），之后所有块操作都落到磁盘上，
+    // 存储节点能保存的数据量只受磁盘限制。目录中已有数据时直接恢复（只读取索引）。
+    // 必须在存储任何块之前调用
+    int open_block_store(const std::string& dir, uint64_t segment_bytes = BlockStore::DEFAULT_SEGMENT_BYTES);
+    
+    // 把磁盘块存储中未落盘的写入刷到磁盘（内存存储时直接返回0）
+    int sync_blocks();
+    
+    // 把数据块保存到去重块存储 store 中（可由多个存储节点共享，例如同一文件的各个版本），
+    // 本节点只记录每个块下标对应的块编号，内容相同的块只保存一份；叶子哈希在入库时记录，建树时不再重算。
+    // 必须在存储任何块之前调用，不能与磁盘块存储同时使用
+    int use_chunk_store(std::shared_ptr<ChunkStore> store);
+    
+    // 去重块存储（未调用 use_chunk_store 时为空），可读取去重统计
+    const ChunkStore* get_chunk_store() const;
+    
+    // 流式逐块存储时磁盘块存储自动落盘的间隔（块数）
+    static constexpr size_t BLOCK_STORE_SYNC_INTERVAL = 4096;
     
-    // 存储数据块
+    // 设置热块缓存容量（字节，0 表示关闭，默认关闭）
+    // 磁盘存储时缓存块记录和叶子哈希，内存存储时只缓存叶子哈希
+    void set_block_cache(size_t capacity_bytes);
+    
+    // 一批挑战公布后预取被挑战的块：磁盘存储时通过 AsyncBlockReader 批量读取未缓存的块，
+    // 计算叶子哈希后放入热块缓存，之后生成证明时直接命中（未开启缓存时直接返回0）
+    int prefetch_blocks(const std::vector<size_t>& indices);
+    
+    // 获取第 index 块的叶子哈希（优先取自热块缓存，未命中时读块计算并放入缓存）
+    bool get_block_leaf(size_t index, std::array<uint8_t, 32>& leaf) const;
+    
+    // 热块缓存（未开启时为空），可读取命中/未命中计数
+    const BlockCache* get_block_cache() const;
+    
+    // 设置构建Merkle树（叶子哈希 + 下层节点）使用的线程数
+    // num_threads: 1 表示单线程构建（默认），0 表示使用CPU核数
+    void set_build_threads(size_t num_threads);
+    
+    // 存储数据块（替换已存储的所有块）
+    // 内存存储时密文复制进连续存储的块集合；磁盘存储时整批顺序写入并只落盘一次
     int store_blocks(const std::vector<EncryptedBlock>& blocks);
     
-    // 获取指定索引的数据块
+    // 存储数据块（内存存储时移入块集合，不复制密文，也没有逐块分配）
+    int store_blocks(EncryptedBlockSet&& blocks);
+    
+    // 追加存储单个数据块（流式入库用，index 必须等于当前块数，密文复制进块集合或追加到磁盘）
+    int store_block(size_t index, const EncryptedBlockView& block);
+    
+    // 接收数据所有者分块时已构建好的Merkle树，不再重新计算所有叶子哈希和上层节点
+    // 要求叶子数与已存储的块数一致，并随机抽查若干叶子与已存储块的哈希是否相符
+    // tree: 数据所有者的文件树，merkle_tree: 输出（tree 的副本）
+    int adopt_merkle_tree(const MerkleTree& tree, MerkleTree& merkle_tree) const;
+    
+    // 动态更新：替换/追加/截断已存储的数据块，并在 merkle_tree 上增量重算受影响的路径，
+    // 使其根与数据所有者更新后的文件指纹保持一致
+    int update_block(size_t index, const EncryptedBlock& block, MerkleTree& merkle_tree);
+    int update_blocks(const std::vector<std::pair<size_t, EncryptedBlock>>& updates, MerkleTree& merkle_tree);
+    int append_block(const EncryptedBlock& block, MerkleTree& merkle_tree);
+    int truncate_blocks(size_t num_blocks, MerkleTree& merkle_tree);
+    
+    // 获取指定索引的数据块（复制出独立的块；磁盘存储时优先取自热块缓存）
     bool get_block(size_t index, EncryptedBlock& block) const;
     
+    // 获取指定索引数据块的视图（不复制；内存存储时块被修改后失效，磁盘存储时直接指向映射的段文件）
+    bool get_block_view(size_t index, EncryptedBlockView& block) const;
+    
+    // 内存中存储的所有数据块（使用磁盘块存储或去重块存储时为空）
+    const EncryptedBlockSet& get_blocks() const;
+    
+    // 磁盘块存储（未调用 open_block_store 时为空），可交给 AsyncBlockReader 批量读取被挑战的块
+    const BlockStore* get_block_store() const;
+    
     // 获取存储的数据块数量
     size_t get_block_count() const;
 
 private:
-    std::vector<EncryptedBlock> stored_blocks_; // 存储的数据块
+    EncryptedBlockSet stored_blocks_;            // 存储的数据块（密文连续存放）
+    std::unique_ptr<BlockStore> block_store_;    // 磁盘块存储（为空时使用内存存储）
+    std::unique_ptr<ThreadPool> build_pool_;     // 并行建树线程池（单线程时为空）
+    std::unique_ptr<BlockCache> block_cache_;    // 热块缓存（为空时不缓存）
+    std::unique_ptr<AsyncBlockReader> prefetch_reader_;  // 预取用的异步读取器（首次预取时打开）
+    std::shared_ptr<ChunkStore> chunk_store_;    // 去重块存储（为空时不去重）
+    std::vector<uint32_t> chunk_ids_;            // 去重存储时各块下标对应的块编号
+    
+    // 以下辅助函数屏蔽内存/磁盘/去重三种存储的差异
+    EncryptedBlockView stored_block(size_t index) const;  // 不检查下标
+    int replace_stored_block(size_t index, const EncryptedBlockView& block);
+    int append_stored_block(const EncryptedBlockView& block);
+    int hash_stored_blocks(size_t first, size_t count, std::array<uint8_t, 32>* out) const;
+    
+    // 去重存储：释放下标 num_blocks 之后的块引用 / 用 views 替换所有块
+    void release_chunks(size_t num_blocks);
+    int store_chunks(const std::vector<EncryptedBlockView>& views);
+};
+
+// 流式入库时存储节点一侧的接收端：逐块保存到存储节点，
+// 并可选地把叶子哈希流式写入磁盘Merkle树（不在内存中保存整棵树）
+class StorageNodeSink : public BlockSink {
+public:
+    // 构造函数
+    explicit StorageNodeSink(StorageNode& storage_node);
+    
+    // 析构函数
+    ~StorageNodeSink() override = default;
+    
+    // 同时把叶子哈希写入 tree_path 处的磁盘Merkle树（在第一个块到达前调用）
+    int open_tree(const std::string& tree_path);
+    
+    int consume(size_t index, const EncryptedBlockView& block, const std::array<uint8_t, 32>& leaf_hash) override;
+    
+    // 入库结束：把已接收的块落盘并完成磁盘树的写入，root 输出其根（应与数据所有者的文件指纹一致）
+    // 未调用 open_tree 时块照常落盘，但没有树根可输出，返回-1
+    int finish(std::array<uint8_t, 32>& root);
+
+private:
+    StorageNode& storage_node_;
+    DiskMerkleTreeWriter tree_writer_;
+    bool write_tree_ = false;
 };
 
 #endif // STORAGE_NODE_H
@@ -1,5 +1,6 @@
 #include "proof_builder.h"
 #include "challenge.h"
+#include "../init/storage_node.h"
 #include "../../tee_simulator/random_source.h"
 #include "../../tee_simulator/enclave_sign.h"
 #include "../../utils/crypto_utils.h"
@@ -10,34 +11,25 @@
 
 #include <cstdio>
 
-int ProofBuilder::build_proof_package(const EnclaveKeyPair& enclave_key,
-                                     const MerkleTree& merkle_tree,
-                                     double current_rep,
-                                     uint64_t time_slot_id,
-                                     uint64_t t_start,
-                                     const std::array<uint8_t, 32>& prev_proof_hash,
-                                     size_t total_blocks,
-                                     ProofPackage& proof) {
-    // 1. 生成挑战随机数（调用TEE模拟熵源）
-    ChallengeGenerator challenge_gen;
-    if (challenge_gen.generate_random_challenge(proof.random_r) != 0) {
-        return -1;
-    }
-
-    // 2. 计算挑战块索引（i = R mod N）
-    proof.challenge_idx = challenge_gen.calculate_challenge_index(proof.random_r, total_blocks);
+namespace {
 
+// 已确定挑战（random_r、challenge_idx）后填充证明包除签名外的其余部分
+template <typename Tree>
+int fill_proof_package(const Tree& merkle_tree,
+                       double current_rep,
+                       uint64_t time_slot_id,
+                       uint64_t t_start,
+                       const std::array<uint8_t, 32>& prev_proof_hash,
+                       ProofPackage& proof) {
     // 3. 获取Merkle路径（验证证据）
     std::vector<std::pair<std::array<uint8_t, 32>, bool>> merkle_path;
     if (!merkle_tree.get_proof(proof.challenge_idx, merkle_path)) {
         return -1;
     }
     
-    // 序列化Merkle路径（存储到证明包）
-    proof.merkle_path.clear();
-    for (const auto& [hash, dir] : merkle_path) {
-        proof.merkle_path.insert(proof.merkle_path.end(), hash.begin(), hash.end());
-        proof.merkle_path.push_back(dir ? 0x01 : 0x00);
+    // 序列化Merkle路径（紧凑格式：深度 + 方向位图 + 连续哈希，存储到证明包）
+    if (encode_merkle_path(merkle_path, proof.merkle_path) != 0) {
+        return -1;
     }
 
     // 4. 计算动态时间槽长度（T = T_min + (T_max - T_min)*(1 - Rep)）
@@ -48,19 +40,42 @@ int ProofBuilder::build_proof_package(const EnclaveKeyPair& enclave_key,
     proof.prev_hash = prev_proof_hash;
     proof.rep_snapshot = current_rep;
     proof.t_start = t_start;
+    return 0;
+}
 
-    // 6. 飞地签名（签名内容：时间槽ID + t_start + t_slot + rep_snapshot + random_r）
-    std::vector<uint8_t> sign_data;
-    sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&time_slot_id), 
-                     reinterpret_cast<const uint8_t*>(&time_slot_id) + 8);
-    sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&t_start), 
-                     reinterpret_cast<const uint8_t*>(&t_start) + 8);
+// 签名内容：时间槽ID + t_start + t_slot + rep_snapshot + random_r
+void proof_sign_data(const ProofPackage& proof, std::vector<uint8_t>& sign_data) {
+    sign_data.clear();
+    sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&proof.time_slot_id), 
+                     reinterpret_cast<const uint8_t*>(&proof.time_slot_id) + 8);
+    sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&proof.t_start), 
+                     reinterpret_cast<const uint8_t*>(&proof.t_start) + 8);
     sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&proof.t_slot), 
                      reinterpret_cast<const uint8_t*>(&proof.t_slot) + 4);
-    sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&current_rep), 
-                     reinterpret_cast<const uint8_t*>(&current_rep) + 8);
+    sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&proof.rep_snapshot), 
+                     reinterpret_cast<const uint8_t*>(&proof.rep_snapshot) + 8);
     sign_data.insert(sign_data.end(), proof.random_r.begin(), proof.random_r.end());
+}
 
+// 填充证明包并由飞地签名
+template <typename Tree>
+int complete_proof_package(const EnclaveKeyPair& enclave_key,
+                           const Tree& merkle_tree,
+                           double current_rep,
+                           uint64_t time_slot_id,
+                           uint64_t t_start,
+                           const std::array<uint8_t, 32>& prev_proof_hash,
+                           ProofPackage& proof) {
+    if (fill_proof_package(merkle_tree, current_rep, time_slot_id, t_start, prev_proof_hash, proof) != 0) {
+        return -1;
+    }
+
+    // 6. 飞地签名（记录签名方案，供验证者在迁移期间同时接受两种方案）
+    if (tee_key_scheme(enclave_key.pk, proof.sig_scheme) != 0) {
+        return -1;
+    }
+    std::vector<uint8_t> sign_data;
+    proof_sign_data(proof, sign_data);
     if (tee_enclave_sign(enclave_key, sign_data.data(), sign_data.size(), proof.enclave_sig) != 0) {
         return -1;
     }
@@ -68,6 +83,229 @@ int ProofBuilder::build_proof_package(const EnclaveKeyPair& enclave_key,
     return 0;
 }
 
+// 一批已填充的证明包一次性批量签名（签名器只查找一次）
+int sign_proof_packages(const EnclaveKeyPair& enclave_key, std::vector<ProofPackage>& proofs) {
+    SignatureScheme scheme;
+    if (tee_key_scheme(enclave_key.pk, scheme) != 0) {
+        return -1;
+    }
+    std::vector<std::vector<uint8_t>> messages(proofs.size());
+    for (size_t i = 0; i < proofs.size(); ++i) {
+        proof_sign_data(proofs[i], messages[i]);
+    }
+    std::vector<std::array<uint8_t, 64>> sigs;
+    if (tee_enclave_sign_batch(enclave_key, messages, sigs) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < proofs.size(); ++i) {
+        proofs[i].enclave_sig = sigs[i];
+        proofs[i].sig_scheme = scheme;
+    }
+    return 0;
+}
+
+// 同一批证明包按挑战顺序链接：第一个保留调用方给出的前向哈希，之后指向前一个证明包
+void chain_proof_packages(std::vector<ProofPackage>& proofs) {
+    for (size_t i = 1; i < proofs.size(); ++i) {
+        hash_proof_package(proofs[i - 1], proofs[i].prev_hash);
+    }
+}
+
+// 内存树与磁盘树共用的证明包构建流程（二者的 get_proof 输出格式相同）
+template <typename Tree>
+int build_proof_package_from(const EnclaveKeyPair& enclave_key,
+                             const Tree& merkle_tree,
+                             double current_rep,
+                             uint64_t time_slot_id,
+                             uint64_t t_start,
+                             const std::array<uint8_t, 32>& prev_proof_hash,
+                             size_t total_blocks,
+                             ProofPackage& proof) {
+    // 1. 生成挑战随机数（调用TEE模拟熵源）
+    ChallengeGenerator challenge_gen;
+    if (challenge_gen.generate_random_challenge(proof.random_r) != 0) {
+        return -1;
+    }
+
+    // 2. 计算挑战块索引（i = R mod N）
+    proof.challenge_idx = challenge_gen.calculate_challenge_index(proof.random_r, total_blocks);
+
+    return complete_proof_package(enclave_key, merkle_tree, current_rep, time_slot_id, t_start,
+                                  prev_proof_hash, proof);
+}
+
+template <typename Tree>
+int build_proof_packages_from(const EnclaveKeyPair& enclave_key,
+                              const Tree& merkle_tree,
+                              AsyncBlockReader& reader,
+                              double current_rep,
+                              uint64_t time_slot_id,
+                              uint64_t t_start,
+                              const std::array<uint8_t, 32>& prev_proof_hash,
+                              size_t total_blocks,
+                              size_t count,
+                              std::vector<ProofPackage>& proofs) {
+    // 1. 一次生成本时间槽的全部挑战
+    ChallengeGenerator challenge_gen;
+    std::vector<std::pair<std::array<uint8_t, 32>, uint32_t>> challenges;
+    if (challenge_gen.generate_batch_challenges(count, total_blocks, challenges) != 0) {
+        return -1;
+    }
+    proofs.assign(count, ProofPackage());
+    std::vector<size_t> indices(count);
+    for (size_t i = 0; i < count; ++i) {
+        proofs[i].random_r = challenges[i].first;
+        proofs[i].challenge_idx = challenges[i].second;
+        indices[i] = challenges[i].second;
+    }
+
+    // 2. 批量提交被挑战块的读取；每读完一块即哈希并与树中叶子比对（确认仍持有数据），再构建证明包
+    bool failed = false;
+    auto on_block = [&](size_t request, int status, const EncryptedBlockView& block) {
+        std::array<uint8_t, 32> leaf;
+        if (failed || status != 0 || !merkle_tree.get_leaf(indices[request], leaf) ||
+            leaf != hash_encrypted_block(block) ||
+            fill_proof_package(merkle_tree, current_rep, time_slot_id, t_start,
+                               prev_proof_hash, proofs[request]) != 0) {
+            failed = true;
+        }
+    };
+    if (reader.read_blocks(indices.data(), count, on_block) != 0 || failed) {
+        return -1;
+    }
+
+    // 3. 整批签名后按挑战顺序链接（链接哈希覆盖签名）
+    if (sign_proof_packages(enclave_key, proofs) != 0) {
+        return -1;
+    }
+    chain_proof_packages(proofs);
+    return 0;
+}
+
+template <typename Tree>
+int build_proof_packages_from(const EnclaveKeyPair& enclave_key,
+                              const Tree& merkle_tree,
+                              const StorageNode& storage_node,
+                              const std::vector<std::pair<std::array<uint8_t, 32>, uint32_t>>& challenges,
+                              double current_rep,
+                              uint64_t time_slot_id,
+                              uint64_t t_start,
+                              const std::array<uint8_t, 32>& prev_proof_hash,
+                              std::vector<ProofPackage>& proofs) {
+    proofs.assign(challenges.size(), ProofPackage());
+    for (size_t i = 0; i < challenges.size(); ++i) {
+        // 被挑战块的叶子哈希（预取后命中热块缓存）须与树中叶子一致
+        std::array<uint8_t, 32> stored_leaf, tree_leaf;
+        if (!storage_node.get_block_leaf(challenges[i].second, stored_leaf) ||
+            !merkle_tree.get_leaf(challenges[i].second, tree_leaf) || stored_leaf != tree_leaf) {
+            return -1;
+        }
+        proofs[i].random_r = challenges[i].first;
+        proofs[i].challenge_idx = challenges[i].second;
+        if (fill_proof_package(merkle_tree, current_rep, time_slot_id, t_start,
+                               prev_proof_hash, proofs[i]) != 0) {
+            return -1;
+        }
+    }
+    if (sign_proof_packages(enclave_key, proofs) != 0) {
+        return -1;
+    }
+    chain_proof_packages(proofs);
+    return 0;
+}
+
+} // namespace
+
+int ProofBuilder::build_proof_package(const EnclaveKeyPair& enclave_key,
+                                     const MerkleTree& merkle_tree,
+                                     double current_rep,
+                                     uint64_t time_slot_id,
+                                     uint64_t t_start,
+                                     const std::array<uint8_t, 32>& prev_proof_hash,
+                                     size_t total_blocks,
+                                     ProofPackage& proof) {
+    return build_proof_package_from(enclave_key, merkle_tree, current_rep, time_slot_id,
+                                    t_start, prev_proof_hash, total_blocks, proof);
+}
+
+int ProofBuilder::build_proof_package(const EnclaveKeyPair& enclave_key,
+                                     const DiskMerkleTree& merkle_tree,
+                                     double current_rep,
+                                     uint64_t time_slot_id,
+                                     uint64_t t_start,
+                                     const std::array<uint8_t, 32>& prev_proof_hash,
+                                     size_t total_blocks,
+                                     ProofPackage& proof) {
+    return build_proof_package_from(enclave_key, merkle_tree, current_rep, time_slot_id,
+                                    t_start, prev_proof_hash, total_blocks, proof);
+}
+
+int ProofBuilder::build_proof_package(const EnclaveKeyPair& enclave_key,
+                                     const PartialMerkleTree& merkle_tree,
+                                     double current_rep,
+                                     uint64_t time_slot_id,
+                                     uint64_t t_start,
+                                     const std::array<uint8_t, 32>& prev_proof_hash,
+                                     size_t total_blocks,
+                                     ProofPackage& proof) {
+    return build_proof_package_from(enclave_key, merkle_tree, current_rep, time_slot_id,
+                                    t_start, prev_proof_hash, total_blocks, proof);
+}
+
+int ProofBuilder::build_proof_packages(const EnclaveKeyPair& enclave_key,
+                                      const MerkleTree& merkle_tree,
+                                      AsyncBlockReader& reader,
+                                      double current_rep,
+                                      uint64_t time_slot_id,
+                                      uint64_t t_start,
+                                      const std::array<uint8_t, 32>& prev_proof_hash,
+                                      size_t total_blocks,
+                                      size_t count,
+                                      std::vector<ProofPackage>& proofs) {
+    return build_proof_packages_from(enclave_key, merkle_tree, reader, current_rep, time_slot_id,
+                                     t_start, prev_proof_hash, total_blocks, count, proofs);
+}
+
+int ProofBuilder::build_proof_packages(const EnclaveKeyPair& enclave_key,
+                                      const DiskMerkleTree& merkle_tree,
+                                      AsyncBlockReader& reader,
+                                      double current_rep,
+                                      uint64_t time_slot_id,
+                                      uint64_t t_start,
+                                      const std::array<uint8_t, 32>& prev_proof_hash,
+                                      size_t total_blocks,
+                                      size_t count,
+                                      std::vector<ProofPackage>& proofs) {
+    return build_proof_packages_from(enclave_key, merkle_tree, reader, current_rep, time_slot_id,
+                                     t_start, prev_proof_hash, total_blocks, count, proofs);
+}
+
+int ProofBuilder::build_proof_packages(const EnclaveKeyPair& enclave_key,
+                                      const MerkleTree& merkle_tree,
+                                      const StorageNode& storage_node,
+                                      const std::vector<std::pair<std::array<uint8_t, 32>, uint32_t>>& challenges,
+                                      double current_rep,
+                                      uint64_t time_slot_id,
+                                      uint64_t t_start,
+                                      const std::array<uint8_t, 32>& prev_proof_hash,
+                                      std::vector<ProofPackage>& proofs) {
+    return build_proof_packages_from(enclave_key, merkle_tree, storage_node, challenges, current_rep,
+                                     time_slot_id, t_start, prev_proof_hash, proofs);
+}
+
+int ProofBuilder::build_proof_packages(const EnclaveKeyPair& enclave_key,
+                                      const DiskMerkleTree& merkle_tree,
+                                      const StorageNode& storage_node,
+                                      const std::vector<std::pair<std::array<uint8_t, 32>, uint32_t>>& challenges,
+                                      double current_rep,
+                                      uint64_t time_slot_id,
+                                      uint64_t t_start,
+                                      const std::array<uint8_t, 32>& prev_proof_hash,
+                                      std::vector<ProofPackage>& proofs) {
+    return build_proof_packages_from(enclave_key, merkle_tree, storage_node, challenges, current_rep,
+                                     time_slot_id, t_start, prev_proof_hash, proofs);
+}
+
 int ProofBuilder::build_segment_credential(double rep_low, double rep_high,
                                           uint64_t epoch_start, uint64_t epoch_end,
                                           const std::vector<ProofPackage>& proofs_in_segment,
@@ -82,19 +320,20 @@ int ProofBuilder::build_segment_credential(double rep_low, double rep_high,
     seg_cred.epoch_end = epoch_end;
 
     // 1. 计算分段Merkle根（叶子：每个证明包的SHA3-256哈希）
-    std::vector<std::array<uint8_t, 32>> proof_hashes;
+    MerkleTree::NodeBuffer proof_hashes;
+    proof_hashes.reserve(MerkleTree::node_count(proofs_in_segment.size()));
     for (const auto& proof : proofs_in_segment) {
         std::array<uint8_t, 32> proof_hash;
-        sha3_256_hash(reinterpret_cast<const uint8_t*>(&proof), sizeof(ProofPackage), proof_hash);
+        hash_proof_package(proof, proof_hash);
         proof_hashes.push_back(proof_hash);
     }
-    MerkleTree seg_merkle(proof_hashes);
+    MerkleTree seg_merkle(std::move(proof_hashes));
     seg_cred.seg_root = seg_merkle.get_root();
 
     // 2. 计算锚点哈希（首尾证明包哈希拼接）
     std::array<uint8_t, 32> first_hash, last_hash;
-    sha3_256_hash(reinterpret_cast<const uint8_t*>(&proofs_in_segment[0]), sizeof(ProofPackage), first_hash);
-    sha3_256_hash(reinterpret_cast<const uint8_t*>(&proofs_in_segment.back()), sizeof(ProofPackage), last_hash);
+    hash_proof_package(proofs_in_segment[0], first_hash);
+    hash_proof_package(proofs_in_segment.back(), last_hash);
     memcpy(seg_cred.anchor_hash.data(), first_hash.data(), 32);
     memcpy(seg_cred.anchor_hash.data() + 32, last_hash.data(), 32);
 
@@ -7,6 +7,11 @@
 #include "../../../include/common_type.h"
 #include "../../tee_simulator/enclave_sign.h"
 #include "../../utils/merkle_tree.h"
+#include "../../utils/disk_merkle_tree.h"
+#include "../../utils/partial_merkle_tree.h"
+#include "../../utils/async_block_reader.h"
+
+class StorageNode;
 
 class ProofBuilder {
 public:
@@ -26,6 +31,74 @@ public:
                            size_t total_blocks,
                            ProofPackage& proof);
     
+    // 构建链式证明包（Merkle路径取自磁盘上的树，只读取路径上的节点）
+    int build_proof_package(const EnclaveKeyPair& enclave_key,
+                           const DiskMerkleTree& merkle_tree,
+                           double current_rep,
+                           uint64_t time_slot_id,
+                           uint64_t t_start,
+                           const std::array<uint8_t, 32>& prev_proof_hash,
+                           size_t total_blocks,
+                           ProofPackage& proof);
+    
+    // 构建链式证明包（Merkle路径由只保留顶部若干层的树按需重建子树得到）
+    int build_proof_package(const EnclaveKeyPair& enclave_key,
+                           const PartialMerkleTree& merkle_tree,
+                           double current_rep,
+                           uint64_t time_slot_id,
+                           uint64_t t_start,
+                           const std::array<uint8_t, 32>& prev_proof_hash,
+                           size_t total_blocks,
+                           ProofPackage& proof);
+    
+    // 批量响应一个时间槽内的 count 个挑战：被挑战块通过 reader 一次性异步提交读取，
+    // 每读完一块即在调用线程中哈希并与树中叶子比对（确认确实持有数据），随后生成证明包。
+    // 证明包按挑战顺序链接：第一个的前向哈希为 prev_proof_hash，之后为前一个证明包的哈希
+    int build_proof_packages(const EnclaveKeyPair& enclave_key,
+                            const MerkleTree& merkle_tree,
+                            AsyncBlockReader& reader,
+                            double current_rep,
+                            uint64_t time_slot_id,
+                            uint64_t t_start,
+                            const std::array<uint8_t, 32>& prev_proof_hash,
+                            size_t total_blocks,
+                            size_t count,
+                            std::vector<ProofPackage>& proofs);
+    
+    int build_proof_packages(const EnclaveKeyPair& enclave_key,
+                            const DiskMerkleTree& merkle_tree,
+                            AsyncBlockReader& reader,
+                            double current_rep,
+                            uint64_t time_slot_id,
+                            uint64_t t_start,
+                            const std::array<uint8_t, 32>& prev_proof_hash,
+                            size_t total_blocks,
+                            size_t count,
+                            std::vector<ProofPackage>& proofs);
+    
+    // 基于已公布的一批挑战（ChallengeGenerator::generate_batch_challenges 的输出）生成证明包：
+    // 被挑战块的叶子哈希取自存储节点（挑战公布后先调用 StorageNode::prefetch_blocks，此时直接命中热块缓存），
+    // 与树中叶子比对后构建证明包，证明包按挑战顺序链接
+    int build_proof_packages(const EnclaveKeyPair& enclave_key,
+                            const MerkleTree& merkle_tree,
+                            const StorageNode& storage_node,
+                            const std::vector<std::pair<std::array<uint8_t, 32>, uint32_t>>& challenges,
+                            double current_rep,
+                            uint64_t time_slot_id,
+                            uint64_t t_start,
+                            const std::array<uint8_t, 32>& prev_proof_hash,
+                            std::vector<ProofPackage>& proofs);
+    
+    int build_proof_packages(const EnclaveKeyPair& enclave_key,
+                            const DiskMerkleTree& merkle_tree,
+                            const StorageNode& storage_node,
+                            const std::vector<std::pair<std::array<uint8_t, 32>, uint32_t>>& challenges,
+                            double current_rep,
+                            uint64_t time_slot_id,
+                            uint64_t t_start,
+                            const std::array<uint8_t, 32>& prev_proof_hash,
+                            std::vector<ProofPackage>& proofs);
+    
     // 生成信誉分段凭证（当信誉变化超阈值时）
     int build_segment_credential(double rep_low, double rep_high,
                                 uint64_t epoch_start, uint64_t epoch_end,
@@ -66,22 +66,23 @@ bool AggregateVerifier::spot_check(const SegmentCredential& credential,
     }
     
     // 1. 验证分段Merkle根
-    std::vector<std::array<uint8_t, 32>> proof_hashes;
+    MerkleTree::NodeBuffer proof_hashes;
+    proof_hashes.reserve(MerkleTree::node_count(proofs_in_segment.size()));
     for (const auto& proof : proofs_in_segment) {
         std::array<uint8_t, 32> proof_hash;
-        sha3_256_hash(reinterpret_cast<const uint8_t*>(&proof), sizeof(ProofPackage), proof_hash);
+        hash_proof_package(proof, proof_hash);
         proof_hashes.push_back(proof_hash);
     }
     
-    MerkleTree seg_merkle(proof_hashes);
+    MerkleTree seg_merkle(std::move(proof_hashes));
     if (seg_merkle.get_root() != credential.seg_root) {
         return false;
     }
     
     // 2. 验证锚点哈希
     std::array<uint8_t, 32> first_hash, last_hash;
-    sha3_256_hash(reinterpret_cast<const uint8_t*>(&proofs_in_segment[0]), sizeof(ProofPackage), first_hash);
-    sha3_256_hash(reinterpret_cast<const uint8_t*>(&proofs_in_segment.back()), sizeof(ProofPackage), last_hash);
+    hash_proof_package(proofs_in_segment[0], first_hash);
+    hash_proof_package(proofs_in_segment.back(), last_hash);
     
     std::array<uint8_t, 64> computed_anchor;
     memcpy(computed_anchor.data(), first_hash.data(), 32);
@@ -93,6 +94,7 @@ bool AggregateVerifier::spot_check(const SegmentCredential& credential,
     
     // 3. 随机抽查部分证明
     SingleVerifier single_verifier;
+    single_verifier.set_key_cache(key_cache_);
     size_t num_to_check = std::min(check_count, proofs_in_segment.size());
     
     // 使用当前时间作为随机种子
@@ -115,3 +117,11 @@ bool AggregateVerifier::spot_check(const SegmentCredential& credential,
     
     return true;
 }
+
+void AggregateVerifier::set_key_cache(VerifyKeyCache* cache) {
+    key_cache_ = cache ? cache : &VerifyKeyCache::shared();
+}
+
+VerifyKeyCache* AggregateVerifier::get_key_cache() const {
+    return key_cache_;
+}
@@ -6,6 +6,7 @@
 #include <cstdint>
 #include "../../../include/common_type.h"
 #include "../../tee_simulator/enclave_sign.h"
+#include "../../tee_simulator/verify_key_cache.h"
 #include "../../utils/merkle_tree.h"
 
 class AggregateVerifier {
@@ -31,6 +32,15 @@ public:
                    const std::vector<ProofPackage>& proofs_in_segment,
                    const std::array<uint8_t, 65>& enclave_pub_key,
                    size_t check_count = 3);
+    
+    // 指定抽查时签名验证使用的公钥缓存（默认为进程共享缓存）
+    void set_key_cache(VerifyKeyCache* cache);
+    
+    // 当前使用的公钥缓存
+    VerifyKeyCache* get_key_cache() const;
+
+private:
+    VerifyKeyCache* key_cache_ = &VerifyKeyCache::shared();
 };
 
 #endif // AGGREGATE_VERIFIER_H
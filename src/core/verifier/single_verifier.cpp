@@ -11,7 +11,11 @@ bool SingleVerifier::verify(const ProofPackage& proof,
                            double current_rep,
                            uint64_t submit_time,
                            uint32_t max_delay) {
-    // 1. 验证签名
+    // 1. 验证签名（证明包声明的签名方案须与飞地公钥一致，两种方案都接受）
+    SignatureScheme key_scheme;
+    if (tee_key_scheme(enclave_pub_key, key_scheme) != 0 || key_scheme != proof.sig_scheme) {
+        return false;
+    }
     std::vector<uint8_t> sign_data;
     sign_data.insert(sign_data.end(), reinterpret_cast<const uint8_t*>(&proof.time_slot_id), 
                      reinterpret_cast<const uint8_t*>(&proof.time_slot_id) + 8);
@@ -23,7 +27,7 @@ bool SingleVerifier::verify(const ProofPackage& proof,
                      reinterpret_cast<const uint8_t*>(&proof.rep_snapshot) + 8);
     sign_data.insert(sign_data.end(), proof.random_r.begin(), proof.random_r.end());
     
-    if (!tee_verify_signature(enclave_pub_key, sign_data.data(), sign_data.size(), proof.enclave_sig)) {
+    if (!key_cache_->verify(enclave_pub_key, sign_data.data(), sign_data.size(), proof.enclave_sig)) {
         return false;
     }
     
@@ -46,10 +50,19 @@ bool SingleVerifier::verify(const ProofPackage& proof,
     }
     
     // 5. 验证Merkle路径格式（实际验证需要挑战块的哈希）
-    // 这里只验证路径格式是否正确
-    if (proof.merkle_path.size() % 33 != 0) {
-        return false; // 每个路径元素应该是32字节哈希 + 1字节方向标记
+    // 这里只验证路径格式是否正确（深度 + 方向位图 + 连续哈希，长度与深度严格匹配）
+    MerklePathView path;
+    if (!path.parse(proof.merkle_path)) {
+        return false;
     }
     
     return true;
 }
+
+void SingleVerifier::set_key_cache(VerifyKeyCache* cache) {
+    key_cache_ = cache ? cache : &VerifyKeyCache::shared();
+}
+
+VerifyKeyCache* SingleVerifier::get_key_cache() const {
+    return key_cache_;
+}
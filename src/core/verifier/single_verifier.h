@@ -5,6 +5,7 @@
 #include <array>
 #include "../../../include/common_type.h"
 #include "../../tee_simulator/enclave_sign.h"
+#include "../../tee_simulator/verify_key_cache.h"
 #include "../../utils/merkle_tree.h"
 
 class SingleVerifier {
@@ -26,6 +27,15 @@ public:
                double current_rep,
                uint64_t submit_time,
                uint32_t max_delay);
+    
+    // 指定签名验证使用的公钥缓存（默认为进程共享缓存；缓存需比验证者存活更久）
+    void set_key_cache(VerifyKeyCache* cache);
+    
+    // 当前使用的公钥缓存
+    VerifyKeyCache* get_key_cache() const;
+
+private:
+    VerifyKeyCache* key_cache_ = &VerifyKeyCache::shared();
 };
 
 #endif // SINGLE_VERIFIER_H
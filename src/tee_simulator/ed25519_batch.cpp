@@ -0,0 +1,572 @@
+#include "ed25519_batch.h"
+#include "random_source.h"
+#include <openssl/bn.h>
+#include <openssl/evp.h>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace {
+
+// ---------------- GF(2^255 - 19)：5个51位分量，分量之间的进位延后处理 ----------------
+
+using u128 = unsigned __int128;
+constexpr uint64_t MASK51 = (1ULL << 51) - 1;
+
+struct Fe {
+    uint64_t v[5];
+};
+
+// 弱约简：每个分量回到51位附近（值仍可能不小于 p）
+inline void fe_carry(Fe& h) {
+    uint64_t c;
+    c = h.v[0] >> 51; h.v[0] &= MASK51; h.v[1] += c;
+    c = h.v[1] >> 51; h.v[1] &= MASK51; h.v[2] += c;
+    c = h.v[2] >> 51; h.v[2] &= MASK51; h.v[3] += c;
+    c = h.v[3] >> 51; h.v[3] &= MASK51; h.v[4] += c;
+    c = h.v[4] >> 51; h.v[4] &= MASK51; h.v[0] += c * 19;
+    c = h.v[0] >> 51; h.v[0] &= MASK51; h.v[1] += c;
+}
+
+// 不进位的加法：输入为约简后的值时输出分量小于 2^53，可直接作为乘法输入或减法的被减数
+inline Fe fe_add(const Fe& f, const Fe& g) {
+    Fe h;
+    for (int i = 0; i < 5; ++i) {
+        h.v[i] = f.v[i] + g.v[i];
+    }
+    return h;
+}
+
+// f - g：加上 4p 避免下溢（要求 g 的分量小于 2^53）
+inline Fe fe_sub(const Fe& f, const Fe& g) {
+    Fe h;
+    h.v[0] = f.v[0] + 0x1FFFFFFFFFFFB4ULL - g.v[0];
+    for (int i = 1; i < 5; ++i) {
+        h.v[i] = f.v[i] + 0x1FFFFFFFFFFFFCULL - g.v[i];
+    }
+    fe_carry(h);
+    return h;
+}
+
+inline Fe fe_neg(const Fe& f) {
+    Fe zero = {{0, 0, 0, 0, 0}};
+    return fe_sub(zero, f);
+}
+
+inline Fe fe_mul(const Fe& f, const Fe& g) {
+    const uint64_t g1_19 = g.v[1] * 19, g2_19 = g.v[2] * 19, g3_19 = g.v[3] * 19, g4_19 = g.v[4] * 19;
+    u128 r0 = (u128)f.v[0] * g.v[0] + (u128)f.v[1] * g4_19 + (u128)f.v[2] * g3_19 +
+              (u128)f.v[3] * g2_19 + (u128)f.v[4] * g1_19;
+    u128 r1 = (u128)f.v[0] * g.v[1] + (u128)f.v[1] * g.v[0] + (u128)f.v[2] * g4_19 +
+              (u128)f.v[3] * g3_19 + (u128)f.v[4] * g2_19;
+    u128 r2 = (u128)f.v[0] * g.v[2] + (u128)f.v[1] * g.v[1] + (u128)f.v[2] * g.v[0] +
+              (u128)f.v[3] * g4_19 + (u128)f.v[4] * g3_19;
+    u128 r3 = (u128)f.v[0] * g.v[3] + (u128)f.v[1] * g.v[2] + (u128)f.v[2] * g.v[1] +
+              (u128)f.v[3] * g.v[0] + (u128)f.v[4] * g4_19;
+    u128 r4 = (u128)f.v[0] * g.v[4] + (u128)f.v[1] * g.v[3] + (u128)f.v[2] * g.v[2] +
+              (u128)f.v[3] * g.v[1] + (u128)f.v[4] * g.v[0];
+    
+    Fe h;
+    r1 += (uint64_t)(r0 >> 51); h.v[0] = (uint64_t)r0 & MASK51;
+    r2 += (uint64_t)(r1 >> 51); h.v[1] = (uint64_t)r1 & MASK51;
+    r3 += (uint64_t)(r2 >> 51); h.v[2] = (uint64_t)r2 & MASK51;
+    r4 += (uint64_t)(r3 >> 51); h.v[3] = (uint64_t)r3 & MASK51;
+    uint64_t c = (uint64_t)(r4 >> 51); h.v[4] = (uint64_t)r4 & MASK51;
+    h.v[0] += c * 19;
+    h.v[1] += h.v[0] >> 51; h.v[0] &= MASK51;
+    return h;
+}
+
+inline Fe fe_sq(const Fe& f) {
+    return fe_mul(f, f);
+}
+
+inline Fe fe_sq_n(Fe f, int n) {
+    for (int i = 0; i < n; ++i) {
+        f = fe_sq(f);
+    }
+    return f;
+}
+
+// 读取32字节小端编码（忽略最高位）
+Fe fe_frombytes(const uint8_t* s) {
+    uint64_t w[4];
+    memcpy(w, s, 32);
+    Fe h;
+    h.v[0] = w[0] & MASK51;
+    h.v[1] = ((w[0] >> 51) | (w[1] << 13)) & MASK51;
+    h.v[2] = ((w[1] >> 38) | (w[2] << 26)) & MASK51;
+    h.v[3] = ((w[2] >> 25) | (w[3] << 39)) & MASK51;
+    h.v[4] = (w[3] >> 12) & MASK51;
+    return h;
+}
+
+// 完全约简到 [0, p) 后输出32字节小端编码
+void fe_tobytes(uint8_t* s, Fe h) {
+    fe_carry(h);
+    fe_carry(h);
+    // h >= p 当且仅当 h + 19 >= 2^255
+    uint64_t q = (h.v[0] + 19) >> 51;
+    q = (h.v[1] + q) >> 51;
+    q = (h.v[2] + q) >> 51;
+    q = (h.v[3] + q) >> 51;
+    q = (h.v[4] + q) >> 51;
+    h.v[0] += 19 * q;
+    h.v[1] += h.v[0] >> 51; h.v[0] &= MASK51;
+    h.v[2] += h.v[1] >> 51; h.v[1] &= MASK51;
+    h.v[3] += h.v[2] >> 51; h.v[2] &= MASK51;
+    h.v[4] += h.v[3] >> 51; h.v[3] &= MASK51;
+    h.v[4] &= MASK51;
+    
+    uint64_t w[4];
+    w[0] = h.v[0] | (h.v[1] << 51);
+    w[1] = (h.v[1] >> 13) | (h.v[2] << 38);
+    w[2] = (h.v[2] >> 26) | (h.v[3] << 25);
+    w[3] = (h.v[3] >> 39) | (h.v[4] << 12);
+    memcpy(s, w, 32);
+}
+
+bool fe_is_zero(const Fe& f) {
+    uint8_t s[32];
+    fe_tobytes(s, f);
+    uint8_t acc = 0;
+    for (uint8_t b : s) {
+        acc |= b;
+    }
+    return acc == 0;
+}
+
+bool fe_is_odd(const Fe& f) {
+    uint8_t s[32];
+    fe_tobytes(s, f);
+    return (s[0] & 1) != 0;
+}
+
+Fe fe_from_u64(uint64_t x) {
+    Fe h = {{x & MASK51, x >> 51, 0, 0, 0}};
+    return h;
+}
+
+// z^(2^250 - 1)，同时输出 z^11（求逆与开方共用的加法链）
+Fe fe_pow_2_250_1(const Fe& z, Fe& z11) {
+    Fe z2 = fe_sq(z);
+    Fe z9 = fe_mul(fe_sq_n(z2, 2), z);
+    z11 = fe_mul(z9, z2);
+    Fe t = fe_mul(fe_sq(z11), z9);            // 2^5 - 1
+    t = fe_mul(fe_sq_n(t, 5), t);             // 2^10 - 1
+    Fe t10 = t;
+    t = fe_mul(fe_sq_n(t, 10), t10);          // 2^20 - 1
+    t = fe_mul(fe_sq_n(t, 20), t);            // 2^40 - 1
+    t = fe_mul(fe_sq_n(t, 10), t10);          // 2^50 - 1
+    Fe t50 = t;
+    t = fe_mul(fe_sq_n(t, 50), t50);          // 2^100 - 1
+    t = fe_mul(fe_sq_n(t, 100), t);           // 2^200 - 1
+    return fe_mul(fe_sq_n(t, 50), t50);       // 2^250 - 1
+}
+
+// z^(p - 2) = z^(2^255 - 21)
+Fe fe_invert(const Fe& z) {
+    Fe z11;
+    Fe t = fe_pow_2_250_1(z, z11);
+    return fe_mul(fe_sq_n(t, 5), z11);
+}
+
+// z^((p - 5) / 8) = z^(2^252 - 3)
+Fe fe_pow22523(const Fe& z) {
+    Fe z11;
+    Fe t = fe_pow_2_250_1(z, z11);
+    return fe_mul(fe_sq_n(t, 2), z);
+}
+
+// ---------------- 扭曲 Edwards 曲线 -x^2 + y^2 = 1 + d x^2 y^2，扩展坐标 ----------------
+
+struct Ge {
+    Fe X, Y, Z, T;
+};
+
+// 加法用的预处理形式：(Y + X, Y - X, Z, 2dT)
+struct GeCached {
+    Fe YplusX, YminusX, Z, T2d;
+};
+
+struct CurveConstants {
+    Fe d;
+    Fe d2;
+    Fe sqrt_m1;
+    Ge base;
+    BIGNUM* order;  // 群阶 L
+    
+    CurveConstants();
+    ~CurveConstants() {
+        BN_free(order);
+    }
+};
+
+const CurveConstants& curve();
+
+Ge ge_identity() {
+    Ge p;
+    p.X = fe_from_u64(0);
+    p.Y = fe_from_u64(1);
+    p.Z = fe_from_u64(1);
+    p.T = fe_from_u64(0);
+    return p;
+}
+
+GeCached ge_to_cached(const Ge& p) {
+    GeCached c;
+    c.YplusX = fe_add(p.Y, p.X);
+    c.YminusX = fe_sub(p.Y, p.X);
+    c.Z = p.Z;
+    c.T2d = fe_mul(p.T, curve().d2);
+    return c;
+}
+
+// add-2008-hwcd-3（a = -1，完备公式）
+Ge ge_add(const Ge& p, const GeCached& q) {
+    Fe a = fe_mul(fe_sub(p.Y, p.X), q.YminusX);
+    Fe b = fe_mul(fe_add(p.Y, p.X), q.YplusX);
+    Fe c = fe_mul(p.T, q.T2d);
+    Fe d = fe_mul(p.Z, q.Z);
+    d = fe_add(d, d);
+    Fe e = fe_sub(b, a);
+    Fe f = fe_sub(d, c);
+    Fe g = fe_add(d, c);
+    Fe h = fe_add(b, a);
+    Ge r;
+    r.X = fe_mul(e, f);
+    r.Y = fe_mul(g, h);
+    r.T = fe_mul(e, h);
+    r.Z = fe_mul(f, g);
+    return r;
+}
+
+Ge ge_add(const Ge& p, const Ge& q) {
+    return ge_add(p, ge_to_cached(q));
+}
+
+// dbl-2008-hwcd（a = -1）
+Ge ge_dbl(const Ge& p) {
+    Fe a = fe_sq(p.X);
+    Fe b = fe_sq(p.Y);
+    Fe c = fe_sq(p.Z);
+    c = fe_add(c, c);
+    Fe e = fe_sub(fe_sub(fe_sq(fe_add(p.X, p.Y)), a), b);
+    Fe g = fe_sub(b, a);           // -A + B
+    Fe f = fe_sub(g, c);
+    Fe h = fe_sub(fe_neg(a), b);   // -A - B
+    Ge r;
+    r.X = fe_mul(e, f);
+    r.Y = fe_mul(g, h);
+    r.T = fe_mul(e, h);
+    r.Z = fe_mul(f, g);
+    return r;
+}
+
+// 解码32字节点编码（RFC 8032 第5.1.3节），拒绝非规范的 y 和不在曲线上的点
+bool ge_frombytes(Ge& p, const uint8_t* s, const CurveConstants& k) {
+    Fe y = fe_frombytes(s);
+    uint8_t check[32];
+    fe_tobytes(check, y);
+    check[31] |= s[31] & 0x80;
+    if (memcmp(check, s, 32) != 0) {
+        return false;
+    }
+    bool x_odd = (s[31] & 0x80) != 0;
+    
+    Fe one = fe_from_u64(1);
+    Fe y2 = fe_sq(y);
+    Fe u = fe_sub(y2, one);
+    Fe v = fe_add(fe_mul(y2, k.d), one);
+    Fe v3 = fe_mul(fe_sq(v), v);
+    Fe v7 = fe_mul(fe_sq(v3), v);
+    Fe x = fe_mul(fe_mul(u, v3), fe_pow22523(fe_mul(u, v7)));
+    
+    Fe vx2 = fe_mul(v, fe_sq(x));
+    if (!fe_is_zero(fe_sub(vx2, u))) {
+        if (!fe_is_zero(fe_add(vx2, u))) {
+            return false;
+        }
+        x = fe_mul(x, k.sqrt_m1);
+    }
+    if (fe_is_zero(x) && x_odd) {
+        return false;
+    }
+    if (fe_is_odd(x) != x_odd) {
+        x = fe_neg(x);
+    }
+    
+    p.X = x;
+    p.Y = y;
+    p.Z = one;
+    p.T = fe_mul(x, y);
+    return true;
+}
+
+bool ge_is_identity(const Ge& p) {
+    return fe_is_zero(p.X) && fe_is_zero(fe_sub(p.Y, p.Z));
+}
+
+CurveConstants::CurveConstants() {
+    // d = -121665 / 121666
+    d = fe_neg(fe_mul(fe_from_u64(121665), fe_invert(fe_from_u64(121666))));
+    d2 = fe_add(d, d);
+    fe_carry(d2);
+    
+    // sqrt(-1) = 2^((p - 1) / 4)，(p - 1) / 4 = 2^253 - 5
+    Fe two = fe_from_u64(2);
+    Fe z11;
+    Fe t = fe_pow_2_250_1(two, z11);                    // 2^(2^250 - 1)
+    t = fe_sq_n(t, 3);                                  // 2^(2^253 - 8)
+    sqrt_m1 = fe_mul(t, fe_mul(fe_sq(two), two));       // 乘 2^3
+    
+    // 基点：y = 4/5，x 为偶数
+    Fe y = fe_mul(fe_from_u64(4), fe_invert(fe_from_u64(5)));
+    uint8_t enc[32];
+    fe_tobytes(enc, y);
+    ge_frombytes(base, enc, *this);
+    
+    order = nullptr;
+    BN_hex2bn(&order, "1000000000000000000000000000000014def9dea2f79cd65812631a5cf5d3ed");
+}
+
+const CurveConstants& curve() {
+    static const CurveConstants constants;
+    return constants;
+}
+
+// ---------------- 多标量乘法 ----------------
+
+// 小端标量从 bit 开始的 c 位（c <= 16）
+inline uint32_t scalar_window(const uint8_t* s, size_t bit, unsigned c) {
+    size_t byte = bit >> 3;
+    uint32_t v = 0;
+    for (size_t i = 0; i < 3 && byte + i < 32; ++i) {
+        v |= static_cast<uint32_t>(s[byte + i]) << (8 * i);
+    }
+    return (v >> (bit & 7)) & ((1u << c) - 1);
+}
+
+// 按点数选择窗口宽度：每个窗口约 m 次加点 + 2^(c+1) 次桶求和
+unsigned pick_window(size_t m) {
+    unsigned best = 1;
+    double best_cost = 0;
+    for (unsigned c = 1; c <= 16; ++c) {
+        double windows = (253 + c - 1) / c;
+        double cost = windows * (static_cast<double>(m) + 2.0 * (1u << c));
+        if (c == 1 || cost < best_cost) {
+            best = c;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+// Σ [scalars[i]] points[i]，标量为 32 字节小端且小于 2^253（Pippenger 桶方法）
+Ge multi_scalar_mul(const std::vector<Ge>& points, const std::vector<std::array<uint8_t, 32>>& scalars) {
+    const size_t m = points.size();
+    std::vector<GeCached> cached(m);
+    for (size_t i = 0; i < m; ++i) {
+        cached[i] = ge_to_cached(points[i]);
+    }
+    
+    const unsigned c = pick_window(m);
+    const size_t windows = (253 + c - 1) / c;
+    const size_t bucket_count = (1u << c) - 1;
+    std::vector<Ge> buckets(bucket_count);
+    std::vector<uint8_t> used(bucket_count);
+    
+    Ge acc = ge_identity();
+    for (size_t w = windows; w-- > 0;) {
+        for (unsigned i = 0; i < c && w + 1 != windows; ++i) {
+            acc = ge_dbl(acc);
+        }
+        std::fill(used.begin(), used.end(), 0);
+        for (size_t i = 0; i < m; ++i) {
+            uint32_t digit = scalar_window(scalars[i].data(), w * c, c);
+            if (digit == 0) {
+                continue;
+            }
+            if (used[digit - 1]) {
+                buckets[digit - 1] = ge_add(buckets[digit - 1], cached[i]);
+            } else {
+                buckets[digit - 1] = points[i];
+                used[digit - 1] = 1;
+            }
+        }
+        // Σ digit * bucket[digit]：从高到低累加前缀和
+        Ge running, sum;
+        bool have_running = false, have_sum = false;
+        for (size_t d = bucket_count; d-- > 0;) {
+            if (used[d]) {
+                running = have_running ? ge_add(running, buckets[d]) : buckets[d];
+                have_running = true;
+            }
+            if (have_running) {
+                sum = have_sum ? ge_add(sum, running) : running;
+                have_sum = true;
+            }
+        }
+        if (have_sum) {
+            acc = ge_add(acc, sum);
+        }
+    }
+    return acc;
+}
+
+// BIGNUM 转 32 字节小端
+bool bn_to_scalar(const BIGNUM* bn, std::array<uint8_t, 32>& out) {
+    return BN_bn2lebinpad(bn, out.data(), static_cast<int>(out.size())) == 32;
+}
+
+struct BnCtxDeleter {
+    void operator()(BN_CTX* ctx) const { BN_CTX_free(ctx); }
+};
+
+} // namespace
+
+int ed25519_verify_batch(const std::vector<Ed25519BatchItem>& items) {
+    if (items.empty()) {
+        return 1;
+    }
+    const CurveConstants& k = curve();
+    if (!k.order) {
+        return -1;
+    }
+    
+    // 随机系数 z_i（128位）
+    std::vector<uint8_t> z_bytes(items.size() * 16);
+    if (tee_get_random(z_bytes.data(), z_bytes.size()) != 0) {
+        return -1;
+    }
+    
+    std::unique_ptr<BN_CTX, BnCtxDeleter> ctx(BN_CTX_new());
+    BIGNUM* s = BN_new();
+    BIGNUM* z = BN_new();
+    BIGNUM* h = BN_new();
+    BIGNUM* b_coeff = BN_new();
+    std::vector<BIGNUM*> key_coeffs;
+    auto cleanup = [&]() {
+        BN_free(s);
+        BN_free(z);
+        BN_free(h);
+        BN_free(b_coeff);
+        for (BIGNUM* bn : key_coeffs) {
+            BN_free(bn);
+        }
+    };
+    if (!ctx || !s || !z || !h || !b_coeff) {
+        cleanup();
+        return -1;
+    }
+    BN_zero(b_coeff);
+    
+    // 点：R_1..R_n，之后是去重后的公钥 A_j，最后是基点 B
+    std::vector<Ge> points;
+    std::vector<std::array<uint8_t, 32>> scalars;
+    points.reserve(items.size() + 2);
+    scalars.reserve(items.size() + 2);
+    std::vector<Ge> key_points;
+    std::map<std::array<uint8_t, 32>, size_t> key_index;
+    
+    EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
+    const EVP_MD* sha512 = EVP_sha512();
+    int result = 1;
+    for (size_t i = 0; i < items.size() && result == 1; ++i) {
+        const Ed25519BatchItem& item = items[i];
+        
+        // S < L
+        if (!BN_lebin2bn(item.sig + 32, 32, s)) {
+            result = -1;
+            break;
+        }
+        if (BN_cmp(s, k.order) >= 0) {
+            result = 0;
+            break;
+        }
+        Ge r;
+        if (!ge_frombytes(r, item.sig, k)) {
+            result = 0;
+            break;
+        }
+        std::array<uint8_t, 32> pk;
+        memcpy(pk.data(), item.pub_key, 32);
+        auto found = key_index.find(pk);
+        if (found == key_index.end()) {
+            Ge a;
+            if (!ge_frombytes(a, item.pub_key, k)) {
+                result = 0;
+                break;
+            }
+            BIGNUM* coeff = BN_new();
+            if (!coeff) {
+                result = -1;
+                break;
+            }
+            BN_zero(coeff);
+            found = key_index.emplace(pk, key_points.size()).first;
+            key_points.push_back(a);
+            key_coeffs.push_back(coeff);
+        }
+        
+        // k_i = SHA-512(R || A || M) mod L
+        uint8_t digest[64];
+        unsigned int digest_len = 0;
+        if (!md_ctx || EVP_DigestInit_ex(md_ctx, sha512, nullptr) != 1 ||
+            EVP_DigestUpdate(md_ctx, item.sig, 32) != 1 ||
+            EVP_DigestUpdate(md_ctx, item.pub_key, 32) != 1 ||
+            EVP_DigestUpdate(md_ctx, item.msg, item.len) != 1 ||
+            EVP_DigestFinal_ex(md_ctx, digest, &digest_len) != 1 ||
+            !BN_lebin2bn(digest, 64, h) || !BN_lebin2bn(&z_bytes[i * 16], 16, z)) {
+            result = -1;
+            break;
+        }
+        
+        // A_j 的系数 += z_i k_i，B 的系数 += z_i S_i，R_i 的系数为 z_i
+        BIGNUM* coeff = key_coeffs[found->second];
+        std::array<uint8_t, 32> z_scalar;
+        if (!BN_mod_mul(h, h, z, k.order, ctx.get()) ||
+            !BN_mod_add(coeff, coeff, h, k.order, ctx.get()) ||
+            !BN_mod_mul(s, s, z, k.order, ctx.get()) ||
+            !BN_mod_add(b_coeff, b_coeff, s, k.order, ctx.get()) ||
+            !bn_to_scalar(z, z_scalar)) {
+            result = -1;
+            break;
+        }
+        points.push_back(r);
+        scalars.push_back(z_scalar);
+    }
+    EVP_MD_CTX_free(md_ctx);
+    
+    if (result == 1) {
+        for (size_t j = 0; j < key_points.size(); ++j) {
+            std::array<uint8_t, 32> scalar;
+            if (!bn_to_scalar(key_coeffs[j], scalar)) {
+                result = -1;
+                break;
+            }
+            points.push_back(key_points[j]);
+            scalars.push_back(scalar);
+        }
+    }
+    if (result == 1) {
+        // B 的系数取负：L - Σ z_i S_i
+        std::array<uint8_t, 32> scalar;
+        if (!BN_mod_sub(b_coeff, k.order, b_coeff, k.order, ctx.get()) || !bn_to_scalar(b_coeff, scalar)) {
+            result = -1;
+        } else {
+            points.push_back(k.base);
+            scalars.push_back(scalar);
+        }
+    }
+    cleanup();
+    if (result != 1) {
+        return result;
+    }
+    
+    Ge sum = multi_scalar_mul(points, scalars);
+    sum = ge_dbl(ge_dbl(ge_dbl(sum)));
+    return ge_is_identity(sum) ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#ifndef ED25519_BATCH_H
+#define ED25519_BATCH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Ed25519 批量验证条目（只保存指针，验证期间指向的数据需保持有效）
+struct Ed25519BatchItem {
+    const uint8_t* pub_key; // 32字节公钥
+    const uint8_t* msg;     // 消息
+    size_t len;             // 消息长度
+    const uint8_t* sig;     // 64字节签名 R || S
+};
+
+// 随机线性组合批量验证（RFC 8032 第8.4节）
+// 对每个签名取128位随机系数 z_i，检查
+//   [8]( [-Σ z_i S_i]B + Σ [z_i]R_i + Σ [z_i k_i]A_i ) == 0，k_i = SHA-512(R_i || A_i || M_i) mod L
+// 整个和式用一次多标量乘法（Pippenger 桶方法）计算，同一公钥的项合并为一个点。
+// 与 OpenSSL 的逐个验证（不乘余因子）相比，本检查额外接受 R 或 A 含小阶分量的签名，
+// 只有持有私钥的一方能构造这类签名，对本项目的飞地签名没有影响。
+// 全部有效返回1，存在无效签名（或编码无效）返回0，内部错误返回-1
+int ed25519_verify_batch(const std::vector<Ed25519BatchItem>& items);
+
+#endif // ED25519_BATCH_H
@@ -1,204 +1,571 @@
 #include "enclave_sign.h"
-#include <openssl/provider.h>
+#include "ed25519_batch.h"
+#include "nonce_pool.h"
+#include "verify_key_cache.h"
+#include "../utils/hash_engine.h"
 #include <openssl/evp.h>
 #include <openssl/ec.h>
 #include <openssl/bn.h>
 #include <openssl/err.h>
-#include <openssl/rand.h>
+#include <openssl/core_names.h>
+#include <openssl/param_build.h>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
-// 初始化飞地密钥对（使用OpenSSL 3.0+推荐的EVP接口）
-int tee_init_key_pair(EnclaveKeyPair& key_pair) {
-    // 1. 加载 legacy provider（解决旧曲线兼容性问题）
-    OSSL_PROVIDER* legacy = OSSL_PROVIDER_load(nullptr, "legacy");
-    if (!legacy) {
-        std::cerr << "[错误] 加载 legacy provider 失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
-        return -1;
+namespace {
+
+// 从原始字节构建 P-256 密钥对象：sk 为空时只含公钥（验证用）
+EVP_PKEY* load_p256_key(const std::array<uint8_t, 32>* sk, const std::array<uint8_t, 65>& pk) {
+    OSSL_PARAM_BLD* bld = OSSL_PARAM_BLD_new();
+    BIGNUM* priv = sk ? BN_bin2bn(sk->data(), static_cast<int>(sk->size()), nullptr) : nullptr;
+    OSSL_PARAM* params = nullptr;
+    if (bld && (!sk || priv) &&
+        OSSL_PARAM_BLD_push_utf8_string(bld, OSSL_PKEY_PARAM_GROUP_NAME, "prime256v1", 0) == 1 &&
+        OSSL_PARAM_BLD_push_octet_string(bld, OSSL_PKEY_PARAM_PUB_KEY, pk.data(), pk.size()) == 1 &&
+        (!priv || OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_PRIV_KEY, priv) == 1)) {
+        params = OSSL_PARAM_BLD_to_param(bld);
     }
+    
+    EVP_PKEY* pkey = nullptr;
+    EVP_PKEY_CTX* ctx = params ? EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr) : nullptr;
+    if (!ctx || EVP_PKEY_fromdata_init(ctx) != 1 ||
+        EVP_PKEY_fromdata(ctx, &pkey, sk ? EVP_PKEY_KEYPAIR : EVP_PKEY_PUBLIC_KEY, params) != 1) {
+        pkey = nullptr;
+    }
+    
+    EVP_PKEY_CTX_free(ctx);
+    OSSL_PARAM_free(params);
+    BN_clear_free(priv);
+    OSSL_PARAM_BLD_free(bld);
+    return pkey;
+}
 
-    // 2. 验证曲线是否支持（通过创建曲线组）
-    int nid = NID_X9_62_prime256v1;
-    EC_GROUP* group = EC_GROUP_new_by_curve_name(nid);
-    if (!group) {
-        std::cerr << "[错误] OpenSSL 不支持 secp256r1 曲线（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
-        OSSL_PROVIDER_unload(legacy);
-        return -1;
+// Ed25519 公钥在65字节数组中的布局：0xED || 32字节公钥 || 32字节0
+bool is_ed25519_pub_key(const std::array<uint8_t, 65>& pk) {
+    if (pk[0] != ED25519_PUB_KEY_TAG) {
+        return false;
     }
-    EC_GROUP_free(group);
+    uint8_t padding = 0;
+    for (size_t i = 33; i < pk.size(); ++i) {
+        padding |= pk[i];
+    }
+    return padding == 0;
+}
 
-    // 3. 创建EVP_PKEY上下文
-    EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr);
-    if (!pctx) {
-        std::cerr << "[错误] 创建EVP_PKEY_CTX失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
-        OSSL_PROVIDER_unload(legacy);
-        return -1;
+// 从原始字节构建 Ed25519 密钥对象：sk 为空时只含公钥（验证用）
+EVP_PKEY* load_ed25519_key(const std::array<uint8_t, 32>* sk, const std::array<uint8_t, 65>& pk) {
+    if (!is_ed25519_pub_key(pk)) {
+        return nullptr;
+    }
+    if (sk) {
+        return EVP_PKEY_new_raw_private_key(EVP_PKEY_ED25519, nullptr, sk->data(), sk->size());
     }
+    return EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519, nullptr, pk.data() + 1, 32);
+}
 
-    // 4. 初始化密钥生成
-    if (EVP_PKEY_keygen_init(pctx) <= 0) {
-        std::cerr << "[错误] 初始化密钥生成失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
-        EVP_PKEY_CTX_free(pctx);
-        OSSL_PROVIDER_unload(legacy);
+// 生成 Ed25519 密钥对
+int init_ed25519_key_pair(EnclaveKeyPair& key_pair) {
+    EVP_PKEY* pkey = EVP_PKEY_Q_keygen(nullptr, nullptr, "ED25519");
+    if (!pkey) {
+        std::cerr << "[错误] 生成Ed25519密钥对失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
         return -1;
     }
-
-    // 5. 设置曲线参数
-    if (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, nid) <= 0) {
-        std::cerr << "[错误] 设置曲线参数失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
-        EVP_PKEY_CTX_free(pctx);
-        OSSL_PROVIDER_unload(legacy);
+    size_t sk_len = key_pair.sk.size();
+    size_t pk_len = 32;
+    key_pair.pk.fill(0);
+    key_pair.pk[0] = ED25519_PUB_KEY_TAG;
+    if (EVP_PKEY_get_raw_private_key(pkey, key_pair.sk.data(), &sk_len) != 1 || sk_len != 32 ||
+        EVP_PKEY_get_raw_public_key(pkey, key_pair.pk.data() + 1, &pk_len) != 1 || pk_len != 32) {
+        std::cerr << "[错误] Ed25519密钥提取失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
+        EVP_PKEY_free(pkey);
         return -1;
     }
+    EVP_PKEY_free(pkey);
+    return 0;
+}
 
-    // 6. 生成密钥对
-    EVP_PKEY* pkey = nullptr;
-    if (EVP_PKEY_keygen(pctx, &pkey) <= 0) {
-        std::cerr << "[错误] 生成EC密钥对失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
-        EVP_PKEY_CTX_free(pctx);
-        OSSL_PROVIDER_unload(legacy);
+// 当前线程的 Ed25519 签名上下文（EdDSA 只能通过 DigestSign 一次性签名，每次签名前重新初始化）
+EVP_MD_CTX* thread_ed25519_context() {
+    struct Holder {
+        EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+        ~Holder() {
+            EVP_MD_CTX_free(ctx);
+        }
+    };
+    thread_local Holder holder;
+    return holder.ctx;
+}
+
+// DER 编码的 ECDSA 签名转换为定长 r || s
+int der_to_raw_signature(const uint8_t* der, size_t der_len, std::array<uint8_t, 64>& sig) {
+    const unsigned char* p = der;
+    ECDSA_SIG* ecdsa_sig = d2i_ECDSA_SIG(nullptr, &p, static_cast<long>(der_len));
+    if (!ecdsa_sig) {
         return -1;
     }
-    EVP_PKEY_CTX_free(pctx);
+    const BIGNUM* r = nullptr;
+    const BIGNUM* s = nullptr;
+    ECDSA_SIG_get0(ecdsa_sig, &r, &s);
+    int ret = (BN_bn2binpad(r, sig.data(), 32) == 32 && BN_bn2binpad(s, sig.data() + 32, 32) == 32) ? 0 : -1;
+    ECDSA_SIG_free(ecdsa_sig);
+    return ret;
+}
 
-    // 新增：验证生成的密钥是否为EC类型
-    if (EVP_PKEY_base_id(pkey) != EVP_PKEY_EC) {
-        std::cerr << "[错误] 生成的密钥不是EC类型（实际类型：" << EVP_PKEY_base_id(pkey) << "）" << std::endl;
-        EVP_PKEY_free(pkey);
-        OSSL_PROVIDER_unload(legacy);
-        return -1;
+// 每个线程缓存最近使用的若干个签名器的签名上下文（上下文持有密钥对象的引用，签名器销毁后仍可安全释放）
+class ThreadSignContexts {
+public:
+    ~ThreadSignContexts() {
+        for (const Entry& entry : entries_) {
+            EVP_PKEY_CTX_free(entry.ctx);
+        }
+    }
+    
+    EVP_PKEY_CTX* find_or_create(uint64_t signer_id, EVP_PKEY* pkey) {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i].signer_id == signer_id) {
+                return entries_[i].ctx;
+            }
+        }
+        
+        EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_from_pkey(nullptr, pkey, nullptr);
+        if (!ctx || EVP_PKEY_sign_init(ctx) != 1) {
+            EVP_PKEY_CTX_free(ctx);
+            return nullptr;
+        }
+        if (entries_.size() == MAX_ENTRIES) {
+            EVP_PKEY_CTX_free(entries_.front().ctx);
+            entries_.erase(entries_.begin());
+        }
+        entries_.push_back({signer_id, ctx});
+        return ctx;
     }
 
-    // 7. 提取私钥（32字节）
-    size_t sk_len = 32;//key_pair.sk.size();
-    // 新增：检查密钥是否有效
-    if (EVP_PKEY_size(pkey) == 0) {
-        std::cerr << "[错误] 生成的密钥无效" << std::endl;
-        EVP_PKEY_free(pkey);
-        OSSL_PROVIDER_unload(legacy);
-        return -1;
+private:
+    static constexpr size_t MAX_ENTRIES = 8;
+    struct Entry {
+        uint64_t signer_id;
+        EVP_PKEY_CTX* ctx;
+    };
+    std::vector<Entry> entries_;
+};
+
+std::atomic<uint64_t> next_signer_id{1};
+
+// tee_enclave_sign 内部签名器的随机数池深度（0 表示不使用）
+std::atomic<size_t> nonce_pool_depth{0};
+
+// 当前线程最近使用的签名器（tee_enclave_sign 按私钥复用）
+const EnclaveSigner* cached_signer(const EnclaveKeyPair& key_pair) {
+    struct CachedSigner {
+        std::array<uint8_t, 32> sk{};
+        std::unique_ptr<EnclaveSigner> signer;
+        ~CachedSigner() {
+            OPENSSL_cleanse(sk.data(), sk.size());
+        }
+    };
+    thread_local CachedSigner cache;
+    if (!cache.signer || cache.sk != key_pair.sk || cache.signer->public_key() != key_pair.pk) {
+        auto signer = std::make_unique<EnclaveSigner>();
+        if (signer->init(key_pair) != 0) {
+            return nullptr;
+        }
+        cache.signer = std::move(signer);
+        cache.sk = key_pair.sk;
     }
-    if (EVP_PKEY_get_raw_private_key(pkey, key_pair.sk.data(), &sk_len) <= 0) {
-        unsigned long err_code = ERR_get_error();
-        std::cerr << "[错误] 私钥提取失败（错误码：" << err_code << "，信息：" << ERR_error_string(err_code, nullptr) << "）" << std::endl;
-        //std::cerr << "[错误] 私钥提取失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
-        EVP_PKEY_free(pkey);
-        OSSL_PROVIDER_unload(legacy);
+    // 随机数池深度变化后对之后的签名生效
+    if (cache.signer->scheme() == SignatureScheme::ECDSA_P256) {
+        size_t depth = nonce_pool_depth.load(std::memory_order_relaxed);
+        const NoncePool* pool = cache.signer->nonce_pool();
+        if ((pool ? pool->depth() : 0) != depth && cache.signer->enable_nonce_pool(depth) != 0) {
+            return nullptr;
+        }
+    }
+    return cache.signer.get();
+}
+
+} // namespace
+
+// 初始化飞地密钥对（使用OpenSSL 3.0+推荐的EVP接口；P-256 由默认 provider 提供，无需加载 legacy provider）
+int tee_init_key_pair(EnclaveKeyPair& key_pair, SignatureScheme scheme) {
+    if (scheme == SignatureScheme::ED25519) {
+        return init_ed25519_key_pair(key_pair);
+    }
+    
+    // 1. 生成 P-256 密钥对
+    EVP_PKEY* pkey = EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256");
+    if (!pkey) {
+        std::cerr << "[错误] 生成EC密钥对失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
         return -1;
     }
-    if (sk_len != 32) {
-        std::cerr << "[错误] 私钥长度错误（实际：" << sk_len << "，预期：32）" << std::endl;
+
+    // 2. 提取私钥（32字节大端，不足时左侧补0）
+    // EC 密钥不支持 EVP_PKEY_get_raw_private_key，私钥以大整数参数的形式导出
+    BIGNUM* priv = nullptr;
+    if (EVP_PKEY_get_bn_param(pkey, OSSL_PKEY_PARAM_PRIV_KEY, &priv) != 1 ||
+        BN_bn2binpad(priv, key_pair.sk.data(), static_cast<int>(key_pair.sk.size())) != 32) {
+        std::cerr << "[错误] 私钥提取失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
+        BN_clear_free(priv);
         EVP_PKEY_free(pkey);
-        OSSL_PROVIDER_unload(legacy);
         return -1;
     }
+    BN_clear_free(priv);
 
-    // 8. 提取公钥（65字节）
-    size_t pk_len = key_pair.pk.size();
-    if (EVP_PKEY_get_raw_public_key(pkey, key_pair.pk.data(), &pk_len) <= 0) {
+    // 3. 提取公钥（65字节非压缩格式：0x04 || X || Y）
+    size_t pk_len = 0;
+    if (EVP_PKEY_get_octet_string_param(pkey, OSSL_PKEY_PARAM_PUB_KEY, key_pair.pk.data(),
+                                        key_pair.pk.size(), &pk_len) != 1) {
         std::cerr << "[错误] 公钥提取失败（OpenSSL错误：" << ERR_error_string(ERR_get_error(), nullptr) << "）" << std::endl;
         EVP_PKEY_free(pkey);
-        OSSL_PROVIDER_unload(legacy);
         return -1;
     }
     if (pk_len != 65) {
         std::cerr << "[错误] 公钥长度错误（实际：" << pk_len << "，预期：65）" << std::endl;
         EVP_PKEY_free(pkey);
-        OSSL_PROVIDER_unload(legacy);
         return -1;
     }
 
-    // 9. 清理资源
+    // 4. 清理资源
     EVP_PKEY_free(pkey);
-    OSSL_PROVIDER_unload(legacy);
     return 0;
 }
 
 int tee_enclave_sign(const EnclaveKeyPair& key_pair, const uint8_t* data, size_t data_len, std::array<unsigned char, 64>& sig) {
-    // 1. 从私钥创建EVP_PKEY对象
-    EVP_PKEY* pkey = EVP_PKEY_new_raw_private_key(EVP_PKEY_EC, nullptr, key_pair.sk.data(), 32);
-    if (!pkey) {
+    const EnclaveSigner* signer = cached_signer(key_pair);
+    if (!signer) {
         std::cerr << "私钥加载失败" << std::endl;
         return -1;
     }
+    return signer->sign(data, data_len, sig);
+}
 
-    // 2. 创建签名上下文
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    if (!ctx) {
-        std::cerr << "签名上下文创建失败" << std::endl;
-        EVP_PKEY_free(pkey);
+void tee_set_nonce_pool_depth(size_t depth) {
+    nonce_pool_depth.store(depth, std::memory_order_relaxed);
+}
+
+int tee_enclave_sign_batch(const EnclaveKeyPair& key_pair,
+                           const std::vector<std::vector<uint8_t>>& messages,
+                           std::vector<std::array<uint8_t, 64>>& sigs) {
+    const EnclaveSigner* signer = cached_signer(key_pair);
+    if (!signer) {
+        std::cerr << "私钥加载失败" << std::endl;
         return -1;
     }
+    return signer->sign_batch(messages, sigs);
+}
 
-    // 3. 初始化ECDSA-SHA256签名
-    if (EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, pkey) != 1) {
-        std::cerr << "签名初始化失败" << std::endl;
-        EVP_MD_CTX_free(ctx);
-        EVP_PKEY_free(pkey);
-        return -1;
+int tee_key_scheme(const std::array<uint8_t, 65>& pub_key, SignatureScheme& scheme) {
+    if (pub_key[0] == 0x04) {
+        scheme = SignatureScheme::ECDSA_P256;
+        return 0;
+    }
+    if (is_ed25519_pub_key(pub_key)) {
+        scheme = SignatureScheme::ED25519;
+        return 0;
     }
+    return -1;
+}
 
-    // 4. 传入待签名数据
-    if (EVP_DigestSignUpdate(ctx, data, data_len) != 1) {
-        std::cerr << "签名数据更新失败" << std::endl;
-        EVP_MD_CTX_free(ctx);
-        EVP_PKEY_free(pkey);
-        return -1;
+EVP_PKEY* tee_load_public_key(const std::array<uint8_t, 65>& pub_key) {
+    if (pub_key[0] == ED25519_PUB_KEY_TAG) {
+        return load_ed25519_key(nullptr, pub_key);
     }
+    return load_p256_key(nullptr, pub_key);
+}
 
-    // 5. 获取签名结果（ECDSA签名：r(32) + s(32) → 64字节）
-    size_t sig_len = sig.size();
-    if (EVP_DigestSignFinal(ctx, sig.data(), &sig_len) != 1 || sig_len != 64) {
-        std::cerr << "签名生成失败" << std::endl;
-        EVP_MD_CTX_free(ctx);
-        EVP_PKEY_free(pkey);
+int tee_signature_to_der(const std::array<uint8_t, 64>& sig, std::vector<uint8_t>& der) {
+    ECDSA_SIG* ecdsa_sig = ECDSA_SIG_new();
+    BIGNUM* r = BN_bin2bn(sig.data(), 32, nullptr);
+    BIGNUM* s = BN_bin2bn(sig.data() + 32, 32, nullptr);
+    if (!ecdsa_sig || !r || !s || ECDSA_SIG_set0(ecdsa_sig, r, s) != 1) {
+        BN_free(r);
+        BN_free(s);
+        ECDSA_SIG_free(ecdsa_sig);
         return -1;
     }
-
-    // 6. 释放资源
-    EVP_MD_CTX_free(ctx);
-    EVP_PKEY_free(pkey);
+    
+    int len = i2d_ECDSA_SIG(ecdsa_sig, nullptr);
+    if (len <= 0) {
+        ECDSA_SIG_free(ecdsa_sig);
+        return -1;
+    }
+    der.resize(static_cast<size_t>(len));
+    unsigned char* p = der.data();
+    i2d_ECDSA_SIG(ecdsa_sig, &p);
+    ECDSA_SIG_free(ecdsa_sig);
     return 0;
 }
 
 bool tee_verify_signature(const std::array<unsigned char, 65>& pub_key, const uint8_t* data, size_t data_len, const std::array<unsigned char, 64>& sig) {
     // 1. 从公钥创建EVP_PKEY对象
-    EVP_PKEY* pkey = EVP_PKEY_new_raw_public_key(EVP_PKEY_EC, nullptr, pub_key.data(), 65);
+    EVP_PKEY* pkey = tee_load_public_key(pub_key);
     if (!pkey) {
         std::cerr << "公钥加载失败" << std::endl;
         return false;
     }
 
-    // 2. 创建验证上下文
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    if (!ctx) {
-        std::cerr << "验证上下文创建失败" << std::endl;
+    // 2. 签名转换为DER编码（Ed25519 签名直接使用原始64字节）
+    bool ed25519 = pub_key[0] == ED25519_PUB_KEY_TAG;
+    std::vector<uint8_t> der;
+    if (ed25519) {
+        der.assign(sig.begin(), sig.end());
+    } else if (tee_signature_to_der(sig, der) != 0) {
         EVP_PKEY_free(pkey);
         return false;
     }
 
-    // 3. 初始化ECDSA-SHA256验证
-    if (EVP_DigestVerifyInit(ctx, nullptr, EVP_sha256(), nullptr, pkey) != 1) {
-        std::cerr << "验证初始化失败" << std::endl;
-        EVP_MD_CTX_free(ctx);
+    // 3. 创建验证上下文
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    if (!ctx) {
+        std::cerr << "验证上下文创建失败" << std::endl;
         EVP_PKEY_free(pkey);
         return false;
     }
 
-    // 4. 传入待验证数据
-    if (EVP_DigestVerifyUpdate(ctx, data, data_len) != 1) {
-        std::cerr << "验证数据更新失败" << std::endl;
+    // 4. 初始化ECDSA-SHA256验证（Ed25519 不指定摘要算法）
+    if (EVP_DigestVerifyInit(ctx, nullptr, ed25519 ? nullptr : EVP_sha256(), nullptr, pkey) != 1) {
+        std::cerr << "验证初始化失败" << std::endl;
         EVP_MD_CTX_free(ctx);
         EVP_PKEY_free(pkey);
         return false;
     }
 
     // 5. 执行验证（成功返回1，失败返回0）
-    int verify_ret = EVP_DigestVerifyFinal(ctx, sig.data(), sig.size());
+    int verify_ret = EVP_DigestVerify(ctx, der.data(), der.size(), data, data_len);
 
     // 6. 释放资源
     EVP_MD_CTX_free(ctx);
     EVP_PKEY_free(pkey);
 
     return (verify_ret == 1);
-}
\ No newline at end of file
+}
+
+bool tee_verify_batch(const std::vector<SignatureBatchItem>& items, std::vector<uint8_t>& results,
+                      VerifyKeyCache* key_cache) {
+    VerifyKeyCache& cache = key_cache ? *key_cache : VerifyKeyCache::shared();
+    results.assign(items.size(), 0);
+    
+    // Ed25519 签名收集为一批，其余逐个验证
+    std::vector<Ed25519BatchItem> batch;
+    std::vector<size_t> batch_index;
+    for (size_t i = 0; i < items.size(); ++i) {
+        const SignatureBatchItem& item = items[i];
+        if (is_ed25519_pub_key(*item.pub_key)) {
+            batch.push_back({item.pub_key->data() + 1, item.data, item.len, item.sig->data()});
+            batch_index.push_back(i);
+        } else {
+            results[i] = cache.verify(*item.pub_key, item.data, item.len, *item.sig) ? 1 : 0;
+        }
+    }
+    
+    if (!batch.empty()) {
+        if (ed25519_verify_batch(batch) == 1) {
+            for (size_t i : batch_index) {
+                results[i] = 1;
+            }
+        } else {
+            // 整批未通过（或批量验证出错）：逐个验证找出无效签名
+            for (size_t i : batch_index) {
+                const SignatureBatchItem& item = items[i];
+                results[i] = cache.verify(*item.pub_key, item.data, item.len, *item.sig) ? 1 : 0;
+            }
+        }
+    }
+    
+    for (uint8_t ok : results) {
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+EnclaveSigner::EnclaveSigner()
+    : pkey_(nullptr), id_(next_signer_id.fetch_add(1)), pk_{}, scheme_(SignatureScheme::ECDSA_P256),
+      priv_(nullptr) {}
+
+EnclaveSigner::~EnclaveSigner() {
+    nonce_pool_.reset();
+    BN_clear_free(priv_);
+    EVP_PKEY_free(pkey_);
+}
+
+int EnclaveSigner::init(const EnclaveKeyPair& key_pair) {
+    SignatureScheme scheme;
+    if (tee_key_scheme(key_pair.pk, scheme) != 0) {
+        return -1;
+    }
+    
+    bool matched = false;
+    EVP_PKEY* pkey = nullptr;
+    BIGNUM* priv = nullptr;
+    if (scheme == SignatureScheme::ED25519) {
+        // 由私钥种子导出的公钥须与给定公钥一致
+        pkey = load_ed25519_key(&key_pair.sk, key_pair.pk);
+        uint8_t derived[32];
+        size_t derived_len = sizeof(derived);
+        matched = pkey && EVP_PKEY_get_raw_public_key(pkey, derived, &derived_len) == 1 &&
+                  derived_len == 32 && memcmp(derived, key_pair.pk.data() + 1, 32) == 0;
+    } else {
+        // 检查私钥与公钥匹配（导入时只校验公钥在曲线上）
+        pkey = load_p256_key(&key_pair.sk, key_pair.pk);
+        EVP_PKEY_CTX* check = pkey ? EVP_PKEY_CTX_new_from_pkey(nullptr, pkey, nullptr) : nullptr;
+        matched = check && EVP_PKEY_pairwise_check(check) == 1;
+        EVP_PKEY_CTX_free(check);
+        // 私钥标量另存一份，供随机数池签名使用
+        priv = matched ? BN_bin2bn(key_pair.sk.data(), static_cast<int>(key_pair.sk.size()), nullptr) : nullptr;
+        if (priv) {
+            BN_set_flags(priv, BN_FLG_CONSTTIME);
+        }
+        matched = matched && priv;
+    }
+    if (!matched) {
+        BN_clear_free(priv);
+        EVP_PKEY_free(pkey);
+        return -1;
+    }
+    
+    if (scheme == SignatureScheme::ED25519) {
+        nonce_pool_.reset();
+    }
+    BN_clear_free(priv_);
+    priv_ = priv;
+    EVP_PKEY_free(pkey_);
+    pkey_ = pkey;
+    pk_ = key_pair.pk;
+    scheme_ = scheme;
+    // 换了密钥的签名器使用新编号，线程缓存中旧密钥的上下文不会再被命中
+    id_ = next_signer_id.fetch_add(1);
+    return 0;
+}
+
+bool EnclaveSigner::is_valid() const {
+    return pkey_ != nullptr;
+}
+
+const std::array<uint8_t, 65>& EnclaveSigner::public_key() const {
+    return pk_;
+}
+
+SignatureScheme EnclaveSigner::scheme() const {
+    return scheme_;
+}
+
+int EnclaveSigner::enable_nonce_pool(size_t depth) {
+    if (depth == 0) {
+        nonce_pool_.reset();
+        return 0;
+    }
+    if (!pkey_ || scheme_ != SignatureScheme::ECDSA_P256) {
+        return -1;
+    }
+    nonce_pool_ = std::make_unique<NoncePool>(depth);
+    return 0;
+}
+
+const NoncePool* EnclaveSigner::nonce_pool() const {
+    return nonce_pool_.get();
+}
+
+int EnclaveSigner::sign_with_pool(const std::array<uint8_t, 32>& digest, std::array<uint8_t, 64>& sig) const {
+    P256Context& p256 = p256_context();
+    if (!p256.group || !p256.ctx) {
+        return -1;
+    }
+    const BIGNUM* order = EC_GROUP_get0_order(p256.group);
+    
+    BN_CTX_start(p256.ctx);
+    BIGNUM* e = BN_CTX_get(p256.ctx);
+    BIGNUM* r = BN_CTX_get(p256.ctx);
+    BIGNUM* k_inv = BN_CTX_get(p256.ctx);
+    BIGNUM* s = BN_CTX_get(p256.ctx);
+    bool ok = s != nullptr && BN_bin2bn(digest.data(), static_cast<int>(digest.size()), e) != nullptr;
+    if (ok) {
+        BN_set_flags(k_inv, BN_FLG_CONSTTIME);
+        BN_set_flags(s, BN_FLG_CONSTTIME);
+    }
+    // s = k^-1 · (e + r·d) mod n；s 为0时（概率可忽略）换一个随机数
+    // 模拟实现：模乘使用 BN_mod_mul，未做常数时间处理（实际飞地中由 SGX 密码库完成）
+    bool done = false;
+    while (ok && !done) {
+        EcdsaNonce nonce;
+        ok = nonce_pool_->take(nonce) == 0 &&
+             BN_bin2bn(nonce.r.data(), 32, r) != nullptr &&
+             BN_bin2bn(nonce.k_inv.data(), 32, k_inv) != nullptr &&
+             BN_mod_mul(s, r, priv_, order, p256.ctx) == 1 &&
+             BN_mod_add(s, s, e, order, p256.ctx) == 1 &&
+             BN_mod_mul(s, s, k_inv, order, p256.ctx) == 1;
+        OPENSSL_cleanse(&nonce, sizeof(nonce));
+        done = ok && !BN_is_zero(s);
+    }
+    ok = ok && BN_bn2binpad(r, sig.data(), 32) == 32 && BN_bn2binpad(s, sig.data() + 32, 32) == 32;
+    
+    if (s) {
+        BN_clear(k_inv);
+        BN_clear(s);
+    }
+    BN_CTX_end(p256.ctx);
+    return ok ? 0 : -1;
+}
+
+EVP_PKEY_CTX* EnclaveSigner::thread_context() const {
+    thread_local ThreadSignContexts contexts;
+    return contexts.find_or_create(id_, pkey_);
+}
+
+int EnclaveSigner::sign(const uint8_t* data, size_t len, std::array<uint8_t, 64>& sig) const {
+    if (!pkey_) {
+        return -1;
+    }
+    if (scheme_ == SignatureScheme::ED25519) {
+        EVP_MD_CTX* md_ctx = thread_ed25519_context();
+        size_t sig_len = sig.size();
+        if (!md_ctx || EVP_MD_CTX_reset(md_ctx) != 1 ||
+            EVP_DigestSignInit(md_ctx, nullptr, nullptr, nullptr, pkey_) != 1 ||
+            EVP_DigestSign(md_ctx, sig.data(), &sig_len, data, len) != 1 || sig_len != sig.size()) {
+            return -1;
+        }
+        return 0;
+    }
+    
+    // 摘要由线程局部的摘要引擎计算，上下文只做签名（ECDSA 每次签名使用新的随机数 k）
+    std::array<uint8_t, 32> digest;
+    if (HashEngine::local(HashAlgorithm::SHA256).digest(data, len, digest) != 0) {
+        return -1;
+    }
+    if (nonce_pool_) {
+        return sign_with_pool(digest, sig);
+    }
+    EVP_PKEY_CTX* ctx = thread_context();
+    if (!ctx) {
+        return -1;
+    }
+    uint8_t der[80];
+    size_t der_len = sizeof(der);
+    if (EVP_PKEY_sign(ctx, der, &der_len, digest.data(), digest.size()) != 1) {
+        return -1;
+    }
+    return der_to_raw_signature(der, der_len, sig);
+}
+
+int EnclaveSigner::sign_batch(const std::vector<std::vector<uint8_t>>& messages,
+                              std::vector<std::array<uint8_t, 64>>& sigs,
+                              ThreadPool* pool) const {
+    sigs.resize(messages.size());
+    std::atomic<bool> failed{false};
+    auto sign_range = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (sign(messages[i].data(), messages[i].size(), sigs[i]) != 0) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+    if (pool) {
+        pool->parallel_for(messages.size(), 16, sign_range);
+    } else {
+        sign_range(0, messages.size());
+    }
+    return failed.load() ? -1 : 0;
+}
@@ -4,21 +4,127 @@
 #include <cstdint>
 #include <cstddef>
 #include <array>
+#include <vector>
+#include <memory>
+#include <openssl/types.h>
+#include "../../include/common_type.h"
+#include "../utils/thread_pool.h"
 
 // 飞地密钥对（模拟：实际SGX中密钥存储在飞地内，不可泄露）
+// P-256：sk 为私钥标量，pk 为 0x04 || X || Y
+// Ed25519：sk 为32字节私钥种子，pk 为 0xED || 32字节公钥，其余字节为0
 struct EnclaveKeyPair {
     std::array<uint8_t, 32> sk; // 私钥（256位）
-    std::array<uint8_t, 65> pk; // 公钥（65位，非压缩格式）
+    std::array<uint8_t, 65> pk; // 公钥（65字节，首字节标识签名方案）
 };
 
-// 初始化飞地密钥对（后期替换为SGX的密钥生成）
-int tee_init_key_pair(EnclaveKeyPair& key_pair);
+// Ed25519 公钥在65字节公钥数组中的首字节
+constexpr uint8_t ED25519_PUB_KEY_TAG = 0xED;
+
+// 初始化飞地密钥对（后期替换为SGX的密钥生成），scheme 选择签名方案
+int tee_init_key_pair(EnclaveKeyPair& key_pair, SignatureScheme scheme = SignatureScheme::ECDSA_P256);
+
+// 由公钥首字节得到签名方案，无法识别返回-1
+int tee_key_scheme(const std::array<uint8_t, 65>& pub_key, SignatureScheme& scheme);
 
 // 飞地签名（后期替换为SGX的sgx_ecdsa_sign）
 // data: 待签名数据，len: 数据长度，sig: 输出签名（64位）
+// 内部使用按私钥缓存在当前线程的 EnclaveSigner，同一密钥连续签名时不再重复解析密钥
 int tee_enclave_sign(const EnclaveKeyPair& key_pair, const uint8_t* data, size_t len, std::array<uint8_t, 64>& sig);
 
-// 验证飞地签名
+// 设置 tee_enclave_sign 内部签名器的 ECDSA 随机数预计算池深度（0 表示不使用，默认不使用）
+// 开启后每个调用线程的签名器各自带一个后台补充的池（见 NoncePool），对之后的签名生效
+void tee_set_nonce_pool_depth(size_t depth);
+
+// 批量飞地签名：sigs[i] 为 messages[i] 的签名
+int tee_enclave_sign_batch(const EnclaveKeyPair& key_pair,
+                           const std::vector<std::vector<uint8_t>>& messages,
+                           std::vector<std::array<uint8_t, 64>>& sigs);
+
+// 验证飞地签名，签名方案由公钥决定（每次调用都重新解析公钥；验证大量证明时使用 VerifyKeyCache）
 bool tee_verify_signature(const std::array<uint8_t, 65>& pub_key, const uint8_t* data, size_t len, const std::array<uint8_t, 64>& sig);
 
+// 批量验证条目（只保存指针，验证期间指向的数据需保持有效）
+struct SignatureBatchItem {
+    const std::array<uint8_t, 65>* pub_key;
+    const uint8_t* data;
+    size_t len;
+    const std::array<uint8_t, 64>* sig;
+};
+
+class VerifyKeyCache;
+
+// 批量验证飞地签名：results 调整为 items.size() 个，results[i] 为第 i 个签名是否有效（1/0），全部有效返回 true
+// Ed25519 签名用随机线性组合一次验证整批（见 ed25519_batch.h），整批未通过时逐个验证找出无效签名；
+// P-256 签名无法批量验证，逐个验证。两种方案的签名可以混在同一批中。
+// 逐个验证通过 key_cache 复用解析好的公钥（为空时使用 VerifyKeyCache::shared()）
+bool tee_verify_batch(const std::vector<SignatureBatchItem>& items, std::vector<uint8_t>& results,
+                      VerifyKeyCache* key_cache = nullptr);
+
+// 从65字节公钥构建公钥对象（P-256 或 Ed25519，调用方负责释放），失败返回空
+EVP_PKEY* tee_load_public_key(const std::array<uint8_t, 65>& pub_key);
+
+// 64字节 r || s 签名转换为 ECDSA 的 DER 编码，成功返回0，失败返回-1
+int tee_signature_to_der(const std::array<uint8_t, 64>& sig, std::vector<uint8_t>& der);
+
+class NoncePool;
+
+// 飞地签名器（ECDSA P-256 + SHA-256，签名为 r || s；或 Ed25519，签名为 R || S；均为64字节）
+// 每个飞地创建一次：初始化时把私钥解析为 EVP_PKEY，之后签名不再重建密钥对象。
+// 签名上下文按线程缓存（每个线程第一次用本签名器签名时创建并初始化，之后只做摘要和签名），
+// 同一实例可被多个线程同时使用。
+class EnclaveSigner {
+public:
+    // 构造函数
+    EnclaveSigner();
+    
+    // 析构函数
+    ~EnclaveSigner();
+    
+    EnclaveSigner(const EnclaveSigner&) = delete;
+    EnclaveSigner& operator=(const EnclaveSigner&) = delete;
+    
+    // 解析密钥对（私钥与公钥需匹配），成功返回0，失败返回-1
+    int init(const EnclaveKeyPair& key_pair);
+    
+    // 是否已成功初始化
+    bool is_valid() const;
+    
+    // 签名者公钥
+    const std::array<uint8_t, 65>& public_key() const;
+    
+    // 签名方案
+    SignatureScheme scheme() const;
+    
+    // 开启 ECDSA 随机数预计算池：后台线程预先计算 (k^-1, r)，签名时只做与消息相关的模运算
+    // depth 为池深度，0 表示关闭；Ed25519 的随机数由消息决定，无法预计算，返回-1
+    // 不能与 sign 并发调用
+    int enable_nonce_pool(size_t depth);
+    
+    // 当前的随机数池（未开启时为空）
+    const NoncePool* nonce_pool() const;
+    
+    // 签名 data[0, len)，输出与 tee_enclave_sign 格式相同，成功返回0，失败返回-1
+    int sign(const uint8_t* data, size_t len, std::array<uint8_t, 64>& sig) const;
+    
+    // 批量签名：sigs 调整为 messages.size() 个，pool 非空时分给线程池并行签名（每个线程使用自己的上下文）
+    int sign_batch(const std::vector<std::vector<uint8_t>>& messages,
+                   std::vector<std::array<uint8_t, 64>>& sigs,
+                   ThreadPool* pool = nullptr) const;
+
+private:
+    EVP_PKEY* pkey_;               // 解析后的私钥
+    uint64_t id_;                  // 进程内唯一编号（线程缓存按编号查找签名上下文，编号不会复用）
+    std::array<uint8_t, 65> pk_;   // 公钥
+    SignatureScheme scheme_;       // 签名方案
+    BIGNUM* priv_;                 // P-256 私钥标量（使用随机数池签名时需要）
+    std::unique_ptr<NoncePool> nonce_pool_;
+    
+    // 当前线程用于本签名器的签名上下文（首次调用时创建），失败返回空
+    EVP_PKEY_CTX* thread_context() const;
+    
+    // 用池中的随机数对摘要签名
+    int sign_with_pool(const std::array<uint8_t, 32>& digest, std::array<uint8_t, 64>& sig) const;
+};
+
 #endif // ENCLAVE_SIGN_H
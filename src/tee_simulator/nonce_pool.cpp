@@ -0,0 +1,185 @@
+#include "nonce_pool.h"
+#include <openssl/bn.h>
+#include <openssl/crypto.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 当前进程号
+unsigned long current_pid() {
+#ifdef _WIN32
+    return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    return static_cast<unsigned long>(getpid());
+#endif
+}
+
+} // namespace
+
+P256Context::P256Context()
+    : group(EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1)), ctx(BN_CTX_new()) {}
+
+P256Context::~P256Context() {
+    BN_CTX_free(ctx);
+    EC_GROUP_free(group);
+}
+
+P256Context& p256_context() {
+    thread_local P256Context context;
+    return context;
+}
+
+NoncePool::NoncePool(size_t depth)
+    : depth_(depth == 0 ? 1 : depth), pid_(current_pid()),
+      refill_cv_(std::make_unique<std::condition_variable>()),
+      refill_thread_(std::make_unique<std::thread>(&NoncePool::refill_loop, this)) {}
+
+NoncePool::~NoncePool() {
+    if (forked()) {
+        // 子进程中补充线程不存在，互斥量也可能停留在 fork 时的加锁状态：不加锁、不等待，
+        // 丢弃线程对象和条件变量
+        refill_thread_.release();
+        refill_cv_.release();
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        refill_cv_->notify_all();
+        refill_thread_->join();
+    }
+    for (EcdsaNonce& nonce : nonces_) {
+        OPENSSL_cleanse(&nonce, sizeof(nonce));
+    }
+}
+
+bool NoncePool::forked() const {
+    return current_pid() != pid_;
+}
+
+void NoncePool::refill_loop() {
+    const size_t low_water = depth_ / 4;
+    bool idle = false;
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (nonces_.size() >= depth_) {
+            refill_cv_->wait(lock, [this] { return stop_ || nonces_.size() < depth_; });
+            continue;
+        }
+        // 池量充足时等到一段时间内没有取用再补充；补充过程中一旦有新的取用，重新等待空闲
+        if (nonces_.size() >= low_water && !(idle && takes_ == seen)) {
+            seen = takes_;
+            idle = !refill_cv_->wait_for(lock, REFILL_IDLE, [&] { return stop_ || takes_ != seen; });
+            continue;
+        }
+        
+        // 标量乘法在锁外进行，不阻塞取随机数
+        lock.unlock();
+        EcdsaNonce nonce;
+        int ret = generate(nonce);
+        lock.lock();
+        if (ret == 0) {
+            nonces_.push_back(nonce);
+        }
+        OPENSSL_cleanse(&nonce, sizeof(nonce));
+        if (ret != 0) {
+            // 生成失败（熵源异常）时不再空转，签名会退回当场计算
+            refill_cv_->wait(lock, [this] { return stop_; });
+        }
+    }
+}
+
+int NoncePool::take(EcdsaNonce& nonce) {
+    if (forked()) {
+        // 池中的随机数父进程也持有，子进程不能使用
+        on_demand_.fetch_add(1, std::memory_order_relaxed);
+        return generate(nonce);
+    }
+    bool from_pool = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++takes_;
+        if (!nonces_.empty()) {
+            nonce = nonces_.front();
+            OPENSSL_cleanse(&nonces_.front(), sizeof(EcdsaNonce));
+            nonces_.pop_front();
+            from_pool = true;
+        }
+    }
+    refill_cv_->notify_one();
+    if (from_pool) {
+        pooled_.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    on_demand_.fetch_add(1, std::memory_order_relaxed);
+    return generate(nonce);
+}
+
+size_t NoncePool::depth() const {
+    return depth_;
+}
+
+size_t NoncePool::available() const {
+    if (forked()) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nonces_.size();
+}
+
+NoncePool::Stats NoncePool::stats() const {
+    Stats s;
+    s.pooled = pooled_.load(std::memory_order_relaxed);
+    s.on_demand = on_demand_.load(std::memory_order_relaxed);
+    return s;
+}
+
+int NoncePool::generate(EcdsaNonce& nonce) {
+    P256Context& p256 = p256_context();
+    if (!p256.group || !p256.ctx) {
+        return -1;
+    }
+    const BIGNUM* order = EC_GROUP_get0_order(p256.group);
+    
+    BN_CTX_start(p256.ctx);
+    BIGNUM* k = BN_CTX_get(p256.ctx);
+    BIGNUM* x = BN_CTX_get(p256.ctx);
+    BIGNUM* k_inv = BN_CTX_get(p256.ctx);
+    EC_POINT* point = EC_POINT_new(p256.group);
+    bool ok = k_inv != nullptr && point != nullptr;
+    if (ok) {
+        BN_set_flags(k, BN_FLG_CONSTTIME);
+    }
+    // k ∈ [1, n)，r = (k·G).x mod n，r 为0时换一个 k
+    while (ok) {
+        ok = BN_priv_rand_range(k, order) == 1;
+        if (!ok || BN_is_zero(k)) {
+            continue;
+        }
+        ok = EC_POINT_mul(p256.group, point, k, nullptr, nullptr, p256.ctx) == 1 &&
+             EC_POINT_get_affine_coordinates(p256.group, point, x, nullptr, p256.ctx) == 1 &&
+             BN_nnmod(x, x, order, p256.ctx) == 1;
+        if (ok && !BN_is_zero(x)) {
+            break;
+        }
+    }
+    ok = ok && BN_mod_inverse(k_inv, k, order, p256.ctx) != nullptr &&
+         BN_bn2binpad(k_inv, nonce.k_inv.data(), 32) == 32 &&
+         BN_bn2binpad(x, nonce.r.data(), 32) == 32;
+    
+    if (k_inv) {
+        BN_clear(k);
+        BN_clear(k_inv);
+    }
+    EC_POINT_free(point);
+    BN_CTX_end(p256.ctx);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,104 @@
+#ifndef NONCE_POOL_H
+#define NONCE_POOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+
+// 预计算的 ECDSA P-256 签名随机数（与消息、私钥无关）
+// k 为随机数，r = (k·G).x mod n，k_inv = k^-1 mod n；签名时只需计算 s = k_inv · (e + r·d) mod n
+struct EcdsaNonce {
+    std::array<uint8_t, 32> k_inv; // 大端
+    std::array<uint8_t, 32> r;     // 大端
+};
+
+// ECDSA 随机数预计算池
+// 后台线程把池补满到 depth 个，签名时从池中取出一个随机数，省去签名路径上的 k·G 标量乘法。
+// 补充在签名空闲期进行（REFILL_IDLE 内没有取用），避免与时间槽结束时的集中签名争抢CPU；
+// 池中剩余不足 depth / 4 时不再等待空闲，立即补充。
+// 每个随机数只发出一次：取出时从池中移除，复制给调用方后池中的副本立即清零；
+// 池空时（突发签名超过池深度）当场计算，不会复用旧随机数。同一实例可被多个线程同时使用。
+// fork 后子进程与父进程持有同一批随机数，且子进程中没有补充线程：
+// 子进程中的实例不再使用池（全部当场计算），析构时也不等待补充线程。
+class NoncePool {
+public:
+    static constexpr std::chrono::milliseconds REFILL_IDLE{1};
+    
+    // 统计
+    struct Stats {
+        uint64_t pooled = 0;     // 从池中取出的随机数个数
+        uint64_t on_demand = 0;  // 池空时当场计算的个数
+    };
+    
+    // 构造函数：depth 为池深度（至少为1），创建后后台线程立即开始预计算
+    explicit NoncePool(size_t depth);
+    
+    // 析构函数：停止后台线程并清零池中剩余的随机数（fork 出的子进程中只清零）
+    ~NoncePool();
+    
+    NoncePool(const NoncePool&) = delete;
+    NoncePool& operator=(const NoncePool&) = delete;
+    
+    // 取出一个随机数，成功返回0，失败返回-1（调用方用完后应清零）
+    int take(EcdsaNonce& nonce);
+    
+    // 池深度
+    size_t depth() const;
+    
+    // 当前池中可用的随机数个数
+    size_t available() const;
+    
+    // 当前统计
+    Stats stats() const;
+    
+    // 计算一个新的随机数，成功返回0，失败返回-1
+    static int generate(EcdsaNonce& nonce);
+
+private:
+    const size_t depth_;
+    const unsigned long pid_;  // 创建池的进程号
+    mutable std::mutex mutex_;
+    std::unique_ptr<std::condition_variable> refill_cv_;
+    std::deque<EcdsaNonce> nonces_;
+    bool stop_ = false;
+    uint64_t takes_ = 0;  // 取用次数（补充线程据此判断是否空闲）
+    std::atomic<uint64_t> pooled_{0};
+    std::atomic<uint64_t> on_demand_{0};
+    // 补充线程及其条件变量放在堆上：子进程中线程不存在，而条件变量仍记着父进程中的等待者
+    // （析构会一直等待它们退出），两者只能丢弃
+    std::unique_ptr<std::thread> refill_thread_;
+    
+    void refill_loop();
+    
+    // 当前进程是否为 fork 出的子进程
+    bool forked() const;
+};
+
+// 线程局部的 P-256 群对象和大数上下文（群对象创建时会构建基点的预计算表）
+struct P256Context {
+    EC_GROUP* group;
+    BN_CTX* ctx;
+    
+    // 构造函数
+    P256Context();
+    
+    // 析构函数
+    ~P256Context();
+    
+    P256Context(const P256Context&) = delete;
+    P256Context& operator=(const P256Context&) = delete;
+};
+
+// 获取当前线程的 P-256 上下文（首次调用时创建，线程退出时释放）
+P256Context& p256_context();
+
+#endif // NONCE_POOL_H
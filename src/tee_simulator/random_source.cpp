@@ -1,8 +1,131 @@
 #include "random_source.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
 #include <openssl/rand.h>
+#include <array>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 当前进程号（fork 后子进程与父进程的线程局部状态相同，需要据此重新播种）
+unsigned long current_pid() {
+#ifdef _WIN32
+    return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    return static_cast<unsigned long>(getpid());
+#endif
+}
+
+// 线程局部的 AES-256-CTR DRBG
+// 每次补充用当前密钥加密 KEY_SIZE + BUFFER_SIZE 字节的零：前32字节立即替换密钥，其余作为输出缓冲。
+// 密钥每次补充都会更换，因此 CTR 计数器每次都从0开始。
+class ThreadDrbg {
+public:
+    ~ThreadDrbg() {
+        OPENSSL_cleanse(key_.data(), key_.size());
+        OPENSSL_cleanse(buffer_, sizeof(buffer_));
+        EVP_CIPHER_CTX_free(ctx_);
+    }
+    
+    int generate(uint8_t* out, size_t len) {
+        if (!seeded_ || since_reseed_ >= RANDOM_RESEED_INTERVAL || pid_ != current_pid()) {
+            if (reseed() != 0) {
+                return -1;
+            }
+        }
+        while (len > 0) {
+            if (pos_ == sizeof(buffer_) && refill() != 0) {
+                return -1;
+            }
+            size_t n = sizeof(buffer_) - pos_;
+            if (n > len) {
+                n = len;
+            }
+            memcpy(out, buffer_ + pos_, n);
+            OPENSSL_cleanse(buffer_ + pos_, n);
+            pos_ += n;
+            out += n;
+            len -= n;
+            since_reseed_ += n;
+        }
+        return 0;
+    }
+    
+    void request_reseed() {
+        seeded_ = false;
+    }
+
+private:
+    static constexpr size_t KEY_SIZE = 32;
+    static constexpr size_t BUFFER_SIZE = 4096;
+    
+    EVP_CIPHER_CTX* ctx_ = nullptr;
+    std::array<uint8_t, KEY_SIZE> key_{};
+    uint8_t buffer_[KEY_SIZE + BUFFER_SIZE];
+    size_t pos_ = sizeof(buffer_);   // 下一个可用字节（等于缓冲区大小表示已取完）
+    size_t since_reseed_ = 0;
+    bool seeded_ = false;
+    unsigned long pid_ = 0;
+    
+    // 新种子与当前密钥异或（即使熵源输出有问题也不会比原状态更弱），并丢弃旧密钥生成的缓冲
+    int reseed() {
+        std::array<uint8_t, KEY_SIZE> seed;
+        if (RAND_bytes(seed.data(), static_cast<int>(seed.size())) != 1) {
+            return -1;
+        }
+        for (size_t i = 0; i < KEY_SIZE; ++i) {
+            key_[i] ^= seed[i];
+        }
+        OPENSSL_cleanse(seed.data(), seed.size());
+        OPENSSL_cleanse(buffer_, sizeof(buffer_));
+        pos_ = sizeof(buffer_);
+        since_reseed_ = 0;
+        pid_ = current_pid();
+        seeded_ = true;
+        return 0;
+    }
+    
+    int refill() {
+        static const uint8_t zero_iv[16] = {0};
+        if (!ctx_) {
+            ctx_ = EVP_CIPHER_CTX_new();
+            if (!ctx_ || EVP_EncryptInit_ex(ctx_, EVP_aes_256_ctr(), nullptr, nullptr, nullptr) != 1) {
+                return -1;
+            }
+        }
+        memset(buffer_, 0, sizeof(buffer_));
+        int out_len = 0;
+        if (EVP_EncryptInit_ex(ctx_, nullptr, nullptr, key_.data(), zero_iv) != 1 ||
+            EVP_EncryptUpdate(ctx_, buffer_, &out_len, buffer_, static_cast<int>(sizeof(buffer_))) != 1 ||
+            out_len != static_cast<int>(sizeof(buffer_))) {
+            return -1;
+        }
+        memcpy(key_.data(), buffer_, KEY_SIZE);
+        OPENSSL_cleanse(buffer_, KEY_SIZE);
+        pos_ = KEY_SIZE;
+        return 0;
+    }
+};
+
+ThreadDrbg& thread_drbg() {
+    thread_local ThreadDrbg drbg;
+    return drbg;
+}
+
+} // namespace
 
 int tee_get_random(uint8_t* buf, size_t len) {
     if (buf == nullptr || len == 0) return -1;
-    // 模拟：用OpenSSL生成伪随机数（后期替换为RDRAND）
-    return RAND_bytes(buf, len) == 1 ? 0 : -1;
+    // 模拟：用线程局部的 DRBG 生成伪随机数（种子来自 OpenSSL，后期替换为RDRAND）
+    return thread_drbg().generate(buf, len);
+}
+
+void tee_random_reseed() {
+    thread_drbg().request_reseed();
 }
@@ -5,6 +5,17 @@
 #include <cstddef>
 
 // 模拟硬件熵源：生成len字节真随机数（后期替换为SGX的sgx_read_rand）
+// buf 为空或 len 为0时返回-1，成功返回0，失败返回-1；可被多个线程同时调用
+// 每个线程持有自己的 AES-256-CTR DRBG（种子来自 RAND_bytes），从缓冲区中取字节，
+// 小请求不再每次都进入 OpenSSL 的共享 DRBG：
+// - 每次补充缓冲区时多生成32字节作为新密钥（快速密钥擦除），已取出的字节立即从缓冲区清零；
+// - 每输出 RANDOM_RESEED_INTERVAL 字节从 RAND_bytes 重新播种，进程 fork 后子进程也会重新播种。
 int tee_get_random(uint8_t* buf, size_t len);
 
+// 每个线程的 DRBG 两次从系统熵源重新播种之间最多输出的字节数
+constexpr size_t RANDOM_RESEED_INTERVAL = 1 << 20;
+
+// 让当前线程的 DRBG 在下次取随机数时重新播种
+void tee_random_reseed();
+
 #endif // RANDOM_SOURCE_H
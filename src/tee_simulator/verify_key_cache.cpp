@@ -0,0 +1,226 @@
+#include "verify_key_cache.h"
+#include "enclave_sign.h"
+#include "../utils/hash_engine.h"
+#include "../utils/siphash.h"
+#include <openssl/evp.h>
+
+// 解析好的公钥：验证上下文用完后放回空闲列表，供下一次验证（可能来自其他线程）复用
+// P-256 复用完成 verify_init 的 EVP_PKEY_CTX（摘要在外部计算）；
+// Ed25519 只能一次性验证，复用 EVP_MD_CTX 对象，每次验证前重新初始化
+class VerifyKeyCache::VerifyKey {
+public:
+    VerifyKey(EVP_PKEY* pkey, bool ed25519) : pkey_(pkey), ed25519_(ed25519) {}
+    
+    ~VerifyKey() {
+        for (EVP_PKEY_CTX* ctx : idle_) {
+            EVP_PKEY_CTX_free(ctx);
+        }
+        for (EVP_MD_CTX* ctx : idle_md_) {
+            EVP_MD_CTX_free(ctx);
+        }
+        EVP_PKEY_free(pkey_);
+    }
+    
+    VerifyKey(const VerifyKey&) = delete;
+    VerifyKey& operator=(const VerifyKey&) = delete;
+    
+    bool verify(const uint8_t* data, size_t len, const std::array<uint8_t, 64>& sig) {
+        if (ed25519_) {
+            EVP_MD_CTX* ctx = take(idle_md_);
+            if (!ctx) {
+                ctx = EVP_MD_CTX_new();
+            }
+            bool ok = ctx && EVP_MD_CTX_reset(ctx) == 1 &&
+                      EVP_DigestVerifyInit(ctx, nullptr, nullptr, nullptr, pkey_) == 1 &&
+                      EVP_DigestVerify(ctx, sig.data(), sig.size(), data, len) == 1;
+            if (ctx && !give_back(idle_md_, ctx)) {
+                EVP_MD_CTX_free(ctx);
+            }
+            return ok;
+        }
+        
+        std::vector<uint8_t> der;
+        if (tee_signature_to_der(sig, der) != 0) {
+            return false;
+        }
+        std::array<uint8_t, 32> digest;
+        if (HashEngine::local(HashAlgorithm::SHA256).digest(data, len, digest) != 0) {
+            return false;
+        }
+        EVP_PKEY_CTX* ctx = take(idle_);
+        if (!ctx) {
+            ctx = EVP_PKEY_CTX_new_from_pkey(nullptr, pkey_, nullptr);
+            if (!ctx || EVP_PKEY_verify_init(ctx) != 1) {
+                EVP_PKEY_CTX_free(ctx);
+                return false;
+            }
+        }
+        bool ok = EVP_PKEY_verify(ctx, der.data(), der.size(), digest.data(), digest.size()) == 1;
+        if (!give_back(idle_, ctx)) {
+            EVP_PKEY_CTX_free(ctx);
+        }
+        return ok;
+    }
+
+private:
+    // 每个公钥最多保留的空闲上下文数（约等于同时验证同一飞地的线程数）
+    static constexpr size_t MAX_IDLE = 8;
+    
+    EVP_PKEY* pkey_;
+    bool ed25519_;
+    std::mutex mutex_;
+    std::vector<EVP_PKEY_CTX*> idle_;
+    std::vector<EVP_MD_CTX*> idle_md_;
+    
+    template <typename Ctx>
+    Ctx* take(std::vector<Ctx*>& idle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle.empty()) {
+            return nullptr;
+        }
+        Ctx* ctx = idle.back();
+        idle.pop_back();
+        return ctx;
+    }
+    
+    // 放回空闲列表，列表已满返回 false（由调用方释放）
+    template <typename Ctx>
+    bool give_back(std::vector<Ctx*>& idle, Ctx* ctx) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle.size() >= MAX_IDLE) {
+            return false;
+        }
+        idle.push_back(ctx);
+        return true;
+    }
+};
+
+double VerifyKeyCache::Stats::hit_rate() const {
+    uint64_t total = hits + misses;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+}
+
+namespace {
+
+// 公钥由证明提交方控制：对完整公钥做带进程随机密钥的 SipHash，对方无法构造出落入同一桶/分片的公钥
+uint64_t pub_key_hash(const std::array<uint8_t, 65>& pk) {
+    return keyed_hash(pk.data(), pk.size());
+}
+
+} // namespace
+
+size_t VerifyKeyCache::PubKeyHash::operator()(const std::array<uint8_t, 65>& pk) const {
+    // 对完整公钥（P-256 的 X||Y、Ed25519 的标记||公钥||补0）做带密钥的 SipHash
+    return static_cast<size_t>(pub_key_hash(pk));
+}
+
+VerifyKeyCache::VerifyKeyCache(size_t capacity, size_t shards) {
+    if (shards == 0) {
+        shards = 1;
+    }
+    size_t per_shard = (capacity + shards - 1) / shards;
+    if (per_shard == 0) {
+        per_shard = 1;
+    }
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+        shards_.back()->capacity = per_shard;
+    }
+}
+
+VerifyKeyCache::Shard& VerifyKeyCache::shard_for(const std::array<uint8_t, 65>& pub_key) {
+    // 分片用哈希值的高32位选取，与分片内哈希表取桶使用的低位无关
+    uint64_t h = pub_key_hash(pub_key);
+    return *shards_[(h >> 32) % shards_.size()];
+}
+
+std::shared_ptr<VerifyKeyCache::VerifyKey> VerifyKeyCache::acquire(const std::array<uint8_t, 65>& pub_key) {
+    Shard& shard = shard_for(pub_key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(pub_key);
+        if (it != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second->second;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    
+    // 解析公钥较慢，放在锁外进行；无效公钥不进入缓存
+    EVP_PKEY* pkey = tee_load_public_key(pub_key);
+    if (!pkey) {
+        return nullptr;
+    }
+    auto key = std::make_shared<VerifyKey>(pkey, pub_key[0] == ED25519_PUB_KEY_TAG);
+    
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(pub_key);
+    if (it != shard.index.end()) {
+        // 其他线程已经插入了同一公钥，使用已缓存的对象
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->second;
+    }
+    if (shard.lru.size() >= shard.capacity) {
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lru.emplace_front(pub_key, key);
+    shard.index.emplace(pub_key, shard.lru.begin());
+    return key;
+}
+
+bool VerifyKeyCache::verify(const std::array<uint8_t, 65>& pub_key, const uint8_t* data, size_t len,
+                            const std::array<uint8_t, 64>& sig) {
+    std::shared_ptr<VerifyKey> key = acquire(pub_key);
+    if (!key) {
+        return false;
+    }
+    return key->verify(data, len, sig);
+}
+
+VerifyKeyCache::Stats VerifyKeyCache::stats() const {
+    Stats s;
+    s.hits = hits_.load(std::memory_order_relaxed);
+    s.misses = misses_.load(std::memory_order_relaxed);
+    s.evictions = evictions_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void VerifyKeyCache::reset_stats() {
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+    evictions_.store(0, std::memory_order_relaxed);
+}
+
+size_t VerifyKeyCache::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->lru.size();
+    }
+    return total;
+}
+
+size_t VerifyKeyCache::capacity() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->capacity;
+    }
+    return total;
+}
+
+void VerifyKeyCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->lru.clear();
+    }
+}
+
+VerifyKeyCache& VerifyKeyCache::shared() {
+    static VerifyKeyCache cache;
+    return cache;
+}
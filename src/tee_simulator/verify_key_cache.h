@@ -0,0 +1,95 @@
+#ifndef VERIFY_KEY_CACHE_H
+#define VERIFY_KEY_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <openssl/types.h>
+
+// 验证公钥缓存（验证者侧）
+// 按65字节公钥缓存解析好的公钥对象（P-256 或 Ed25519）和可复用的验证上下文，
+// 同一飞地的后续证明直接取上下文验证，不再重复解析公钥、创建和初始化上下文。
+// 按公钥哈希分片，每个分片独立加锁、按最近最少使用淘汰；同一实例可被多个线程同时使用。
+class VerifyKeyCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 8192;
+    static constexpr size_t DEFAULT_SHARDS = 16;
+    
+    // 命中统计
+    struct Stats {
+        uint64_t hits = 0;       // 命中缓存的验证次数
+        uint64_t misses = 0;     // 需要解析公钥的验证次数（含公钥无效的情况）
+        uint64_t evictions = 0;  // 因容量不足被淘汰的公钥数
+        
+        // 命中率，尚无验证时为0
+        double hit_rate() const;
+    };
+    
+    // 构造函数
+    // capacity: 最多缓存的公钥数（平均分到各分片，每个分片至少1个）
+    // shards: 分片数
+    explicit VerifyKeyCache(size_t capacity = DEFAULT_CAPACITY, size_t shards = DEFAULT_SHARDS);
+    
+    // 析构函数
+    ~VerifyKeyCache() = default;
+    
+    VerifyKeyCache(const VerifyKeyCache&) = delete;
+    VerifyKeyCache& operator=(const VerifyKeyCache&) = delete;
+    
+    // 验证飞地签名，语义与 tee_verify_signature 相同
+    bool verify(const std::array<uint8_t, 65>& pub_key, const uint8_t* data, size_t len,
+                const std::array<uint8_t, 64>& sig);
+    
+    // 当前统计（各计数器分别读取，并发验证时不是严格的同一时刻快照）
+    Stats stats() const;
+    
+    // 清零统计
+    void reset_stats();
+    
+    // 当前缓存的公钥数
+    size_t size() const;
+    
+    // 容量（各分片容量之和）
+    size_t capacity() const;
+    
+    // 清空缓存（正在使用中的公钥在验证结束后释放）
+    void clear();
+    
+    // 进程共享的默认缓存（验证者未指定缓存时使用）
+    static VerifyKeyCache& shared();
+
+private:
+    // 解析好的公钥及其空闲验证上下文
+    class VerifyKey;
+    
+    struct PubKeyHash {
+        size_t operator()(const std::array<uint8_t, 65>& pk) const;
+    };
+    
+    using LruList = std::list<std::pair<std::array<uint8_t, 65>, std::shared_ptr<VerifyKey>>>;
+    
+    struct Shard {
+        mutable std::mutex mutex;
+        size_t capacity = 0;
+        LruList lru;  // 表头为最近使用
+        std::unordered_map<std::array<uint8_t, 65>, LruList::iterator, PubKeyHash> index;
+    };
+    
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    
+    Shard& shard_for(const std::array<uint8_t, 65>& pub_key);
+    
+    // 查找或解析公钥，公钥无效返回空
+    std::shared_ptr<VerifyKey> acquire(const std::array<uint8_t, 65>& pub_key);
+};
+
+#endif // VERIFY_KEY_CACHE_H
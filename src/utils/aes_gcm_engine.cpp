@@ -0,0 +1,203 @@
+#include "aes_gcm_engine.h"
+#include "crypto_utils.h"
+#include "../tee_simulator/random_source.h"
+#include <openssl/evp.h>
+#include <atomic>
+#include <limits>
+
+AesGcmEngine::AesGcmEngine(const std::array<uint8_t, 32>& key)
+    : ctx_(EVP_CIPHER_CTX_new()), valid_(false) {
+    // 只设置算法和密钥，IV在每次加密时设置
+    valid_ = ctx_ != nullptr &&
+             EVP_EncryptInit_ex(ctx_, EVP_aes_256_gcm(), nullptr, key.data(), nullptr) == 1;
+}
+
+AesGcmEngine::~AesGcmEngine() {
+    // EVP_CIPHER_CTX_free 会清除上下文中的密钥材料
+    EVP_CIPHER_CTX_free(ctx_);
+}
+
+bool AesGcmEngine::is_valid() const {
+    return valid_;
+}
+
+int AesGcmEngine::encrypt(const uint8_t* plaintext, size_t len,
+                          const std::array<uint8_t, 12>& iv,
+                          uint8_t* ciphertext,
+                          std::array<uint8_t, 16>& auth_tag) {
+    if (!valid_ || len > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        return -1;
+    }
+
+    // 算法和密钥传空：保留已展开的密钥，只重置IV和GCM状态
+    int out_len = 0;
+    if (EVP_EncryptInit_ex(ctx_, nullptr, nullptr, nullptr, iv.data()) != 1 ||
+        EVP_EncryptUpdate(ctx_, ciphertext, &out_len, plaintext, static_cast<int>(len)) != 1) {
+        return -1;
+    }
+    // GCM为流模式，Final不再输出数据
+    int final_len = 0;
+    if (EVP_EncryptFinal_ex(ctx_, ciphertext + out_len, &final_len) != 1 ||
+        static_cast<size_t>(out_len + final_len) != len) {
+        return -1;
+    }
+
+    // 获取认证标签
+    return EVP_CIPHER_CTX_ctrl(ctx_, EVP_CTRL_GCM_GET_TAG, 16, auth_tag.data()) == 1 ? 0 : -1;
+}
+
+ParallelBlockEncryptor::ParallelBlockEncryptor(const std::array<uint8_t, 32>& key, ThreadPool* pool)
+    : pool_(pool) {
+    size_t num_engines = (pool_ ? pool_->size() : 0) + 1;
+    engines_.reserve(num_engines);
+    for (size_t i = 0; i < num_engines; ++i) {
+        engines_.push_back(std::make_unique<AesGcmEngine>(key));
+    }
+}
+
+bool ParallelBlockEncryptor::engines_valid() const {
+    for (const auto& engine : engines_) {
+        if (!engine->is_valid()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AesGcmEngine& ParallelBlockEncryptor::current_engine() {
+    // 工作线程用自己编号的引擎，调用线程（current_worker 返回池大小）用最后一个
+    size_t worker = pool_ ? pool_->current_worker() : 0;
+    return *engines_[std::min(worker, engines_.size() - 1)];
+}
+
+void ParallelBlockEncryptor::run(size_t num_blocks, const std::function<void(size_t, size_t)>& fn) {
+    if (pool_) {
+        pool_->parallel_for(num_blocks, 256, fn);
+    } else {
+        fn(0, num_blocks);
+    }
+}
+
+int ParallelBlockEncryptor::encrypt_blocks(const uint8_t* data, size_t len, size_t block_size,
+                                           std::vector<EncryptedBlock>& blocks,
+                                           std::array<uint8_t, 32>* leaf_hashes) {
+    if (block_size == 0 || !engines_valid()) {
+        return -1;
+    }
+
+    size_t num_blocks = (len + block_size - 1) / block_size;
+    blocks.resize(num_blocks);
+    if (num_blocks == 0) {
+        return 0;
+    }
+
+    // 批量生成所有块的随机IV（一次随机数调用代替每块一次）
+    std::vector<uint8_t> ivs(num_blocks * 12);
+    if (tee_get_random(ivs.data(), ivs.size()) != 0) {
+        return -1;
+    }
+
+    std::atomic<bool> failed{false};
+    run(num_blocks, [&](size_t begin, size_t end) {
+        AesGcmEngine& engine = current_engine();
+        for (size_t i = begin; i < end; ++i) {
+            size_t start = i * block_size;
+            size_t block_len = std::min(block_size, len - start);
+            EncryptedBlock& block = blocks[i];
+            std::copy(ivs.begin() + i * 12, ivs.begin() + (i + 1) * 12, block.iv.begin());
+            block.ciphertext.resize(block_len);
+            if (engine.encrypt(data + start, block_len, block.iv,
+                               block.ciphertext.data(), block.auth_tag) != 0) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            if (leaf_hashes) {
+                leaf_hashes[i] = hash_encrypted_block(block);
+            }
+        }
+    });
+    return failed.load() ? -1 : 0;
+}
+
+int ParallelBlockEncryptor::encrypt_blocks(const uint8_t* data, size_t len,
+                                           EncryptedBlockSet& blocks,
+                                           std::array<uint8_t, 32>* leaf_hashes) {
+    size_t block_size = blocks.max_block_size();
+    if (block_size == 0 || !engines_valid()) {
+        return -1;
+    }
+
+    size_t num_blocks = (len + block_size - 1) / block_size;
+    blocks.resize(num_blocks);
+    if (num_blocks == 0) {
+        return 0;
+    }
+
+    // IV直接批量生成到集合的IV列中（IV列是连续无填充的12字节数组）
+    static_assert(sizeof(std::array<uint8_t, 12>) == 12, "IV列必须连续存放");
+    if (tee_get_random(blocks.iv(0).data(), num_blocks * 12) != 0) {
+        return -1;
+    }
+
+    std::atomic<bool> failed{false};
+    run(num_blocks, [&](size_t begin, size_t end) {
+        AesGcmEngine& engine = current_engine();
+        for (size_t i = begin; i < end; ++i) {
+            size_t start = i * block_size;
+            size_t block_len = std::min(block_size, len - start);
+            if (engine.encrypt(data + start, block_len, blocks.iv(i),
+                               blocks.ciphertext_data(i), blocks.auth_tag(i)) != 0) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            blocks.set_ciphertext_size(i, block_len);
+            if (leaf_hashes) {
+                leaf_hashes[i] = hash_encrypted_block(blocks[i]);
+            }
+        }
+    });
+    return failed.load() ? -1 : 0;
+}
+
+int ParallelBlockEncryptor::encrypt_chunks(const uint8_t* data, const std::vector<size_t>& chunk_ends,
+                                           const std::array<uint8_t, 32>& iv_key,
+                                           EncryptedBlockSet& blocks,
+                                           std::array<uint8_t, 32>* leaf_hashes) {
+    if (!engines_valid()) {
+        return -1;
+    }
+    
+    const size_t num_chunks = chunk_ends.size();
+    for (size_t i = 0; i < num_chunks; ++i) {
+        size_t start = i == 0 ? 0 : chunk_ends[i - 1];
+        if (chunk_ends[i] < start || chunk_ends[i] - start > blocks.max_block_size()) {
+            return -1;
+        }
+    }
+    blocks.resize(num_chunks);
+    
+    std::atomic<bool> failed{false};
+    run(num_chunks, [&](size_t begin, size_t end) {
+        AesGcmEngine& engine = current_engine();
+        std::array<uint8_t, 32> mac;
+        for (size_t i = begin; i < end; ++i) {
+            size_t start = i == 0 ? 0 : chunk_ends[i - 1];
+            size_t chunk_len = chunk_ends[i] - start;
+            if (hmac_sha256(iv_key, data + start, chunk_len, mac) != 0) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            std::copy(mac.begin(), mac.begin() + 12, blocks.iv(i).begin());
+            if (engine.encrypt(data + start, chunk_len, blocks.iv(i),
+                               blocks.ciphertext_data(i), blocks.auth_tag(i)) != 0) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            blocks.set_ciphertext_size(i, chunk_len);
+            if (leaf_hashes) {
+                leaf_hashes[i] = hash_encrypted_block(blocks[i]);
+            }
+        }
+    });
+    return failed.load() ? -1 : 0;
+}
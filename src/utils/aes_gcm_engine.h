@@ -0,0 +1,87 @@
+#ifndef AES_GCM_ENGINE_H
+#define AES_GCM_ENGINE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <openssl/types.h>
+#include "../../include/common_type.h"
+#include "thread_pool.h"
+#include "encrypted_block_set.h"
+
+// 可复用的 AES-256-GCM 加密引擎
+// 构造时设置一次密钥（密钥扩展只做一次），之后每次加密只替换IV，
+// 避免 aes_gcm_encrypt 每块都创建 EVP_CIPHER_CTX 并重新展开密钥。
+// 单个实例非线程安全，多线程加密使用 ParallelBlockEncryptor（每个线程一个引擎）。
+class AesGcmEngine {
+public:
+    explicit AesGcmEngine(const std::array<uint8_t, 32>& key);
+    ~AesGcmEngine();
+
+    AesGcmEngine(const AesGcmEngine&) = delete;
+    AesGcmEngine& operator=(const AesGcmEngine&) = delete;
+
+    // 上下文和密钥是否初始化成功
+    bool is_valid() const;
+
+    // 加密 len 字节到 ciphertext（调用方预分配 len 字节），输出与 aes_gcm_encrypt 相同
+    // 成功返回0，失败返回-1
+    int encrypt(const uint8_t* plaintext, size_t len,
+                const std::array<uint8_t, 12>& iv,
+                uint8_t* ciphertext,
+                std::array<uint8_t, 16>& auth_tag);
+
+private:
+    EVP_CIPHER_CTX* ctx_;  // 已设置密钥的加密上下文
+    bool valid_;
+};
+
+// 并行分块加密
+// 每个工作线程（以及调用线程）各持有一个 AesGcmEngine，
+// 所有块的IV一次性批量生成，密文直接写入预分配的输出块。
+class ParallelBlockEncryptor {
+public:
+    // pool 为空时在调用线程串行加密
+    ParallelBlockEncryptor(const std::array<uint8_t, 32>& key, ThreadPool* pool);
+
+    // 析构函数
+    ~ParallelBlockEncryptor() = default;
+
+    // 将 data 按 block_size 切分并加密到 blocks（大小调整为块数，最后一块可能不满）
+    // leaf_hashes 非空时同时计算每块的Merkle叶子哈希（调用方预分配块数个元素）
+    // 成功返回0，失败返回-1
+    int encrypt_blocks(const uint8_t* data, size_t len, size_t block_size,
+                       std::vector<EncryptedBlock>& blocks,
+                       std::array<uint8_t, 32>* leaf_hashes = nullptr);
+    
+    // 同上，按 blocks.max_block_size() 切分，密文直接写入集合的连续缓冲区（无逐块分配）
+    int encrypt_blocks(const uint8_t* data, size_t len,
+                       EncryptedBlockSet& blocks,
+                       std::array<uint8_t, 32>* leaf_hashes = nullptr);
+    
+    // 按 chunk_ends（各块结束偏移，见 CdcChunker::split）把 data 切成变长块加密到 blocks，
+    // 块长不能超过 blocks.max_block_size()。每块的IV不随机生成，而是取 HMAC-SHA256(iv_key, 明文) 的前12字节
+    // （收敛加密：同一密钥下相同明文得到相同密文，存储节点可以去重；代价是暴露了哪些块内容相同）
+    int encrypt_chunks(const uint8_t* data, const std::vector<size_t>& chunk_ends,
+                       const std::array<uint8_t, 32>& iv_key,
+                       EncryptedBlockSet& blocks,
+                       std::array<uint8_t, 32>* leaf_hashes = nullptr);
+
+private:
+    ThreadPool* pool_;
+    std::vector<std::unique_ptr<AesGcmEngine>> engines_;  // 下标为工作线程编号，最后一个给调用线程
+    
+    // 所有引擎是否可用
+    bool engines_valid() const;
+    
+    // 当前线程使用的引擎
+    AesGcmEngine& current_engine();
+    
+    // 把 [0, num_blocks) 分给线程池（或调用线程）执行 fn(begin, end)
+    void run(size_t num_blocks, const std::function<void(size_t, size_t)>& fn);
+};
+
+#endif // AES_GCM_ENGINE_H
@@ -0,0 +1,414 @@
+#include "async_block_reader.h"
+#include "file_io.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <utility>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TEE_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace {
+
+// 线程池 + pread 回退实现：读线程完成后把结果放入完成队列，由调用线程统一回调
+class ThreadPoolBackend : public AsyncBlockReader::Backend {
+public:
+    // 构造函数
+    explicit ThreadPoolBackend(size_t num_threads) : pool_(num_threads) {}
+    
+    int open_segment(size_t segment, const std::string& path) override {
+        auto file = std::make_unique<RandomAccessFile>();
+        if (file->open(path, false) != 0) {
+            return -1;
+        }
+        if (files_.size() <= segment) {
+            files_.resize(segment + 1);
+        }
+        files_[segment] = std::move(file);
+        return 0;
+    }
+    
+    int submit(size_t segment, uint64_t offset, uint8_t* buf, size_t len, size_t tag) override {
+        const RandomAccessFile* file = files_[segment].get();
+        pool_.submit([this, file, offset, buf, len, tag]() {
+            int status = file->read_at(offset, buf, len);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.emplace_back(tag, status);
+            }
+            cv_.notify_one();
+        });
+        return 0;
+    }
+    
+    int wait(std::vector<std::pair<size_t, int>>& completed) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !done_.empty(); });
+        completed.insert(completed.end(), done_.begin(), done_.end());
+        done_.clear();
+        return 0;
+    }
+
+private:
+    std::vector<std::unique_ptr<RandomAccessFile>> files_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::pair<size_t, int>> done_;
+    ThreadPool pool_;  // 最后声明、最先析构：先等读线程退出再释放完成队列
+};
+
+#ifdef TEE_HAVE_IO_URING
+
+// io_uring 实现：提交队列和完成队列通过 mmap 与内核共享，
+// 一次 io_uring_enter 同时提交所有新请求并等待至少一个完成
+class IoUringBackend : public AsyncBlockReader::Backend {
+public:
+    // 构造函数
+    IoUringBackend() = default;
+    
+    // 析构函数
+    ~IoUringBackend() override {
+        if (sqes_) {
+            munmap(sqes_, sqes_bytes_);
+        }
+        if (cq_ring_ && cq_ring_ != sq_ring_) {
+            munmap(cq_ring_, cq_ring_bytes_);
+        }
+        if (sq_ring_) {
+            munmap(sq_ring_, sq_ring_bytes_);
+        }
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+        }
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+    
+    // 创建至少 entries 项的队列（内核不支持时返回-1，由调用方退回线程池）
+    int setup(unsigned entries) {
+        io_uring_params params{};
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd_ < 0) {
+            return -1;
+        }
+        
+        sq_ring_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_bytes_ = cq_ring_bytes_ = std::max(sq_ring_bytes_, cq_ring_bytes_);
+        }
+        sq_ring_ = map_ring(sq_ring_bytes_, IORING_OFF_SQ_RING);
+        if (!sq_ring_) {
+            return -1;
+        }
+        cq_ring_ = single_mmap ? sq_ring_ : map_ring(cq_ring_bytes_, IORING_OFF_CQ_RING);
+        if (!cq_ring_) {
+            return -1;
+        }
+        sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map_ring(sqes_bytes_, IORING_OFF_SQES));
+        if (!sqes_) {
+            return -1;
+        }
+        
+        uint8_t* sq = static_cast<uint8_t*>(sq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        uint8_t* cq = static_cast<uint8_t*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        // 标签即槽位号，小于队列深度（不超过 sq_entries）；按标签预先分配，在途期间不会重新分配
+        iovecs_.resize(params.sq_entries);
+        lens_.resize(params.sq_entries);
+        return 0;
+    }
+    
+    int open_segment(size_t segment, const std::string& path) override {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return -1;
+        }
+        if (fds_.size() <= segment) {
+            fds_.resize(segment + 1, -1);
+        }
+        fds_[segment] = fd;
+        return 0;
+    }
+    
+    int submit(size_t segment, uint64_t offset, uint8_t* buf, size_t len, size_t tag) override {
+        // 只有本线程写提交队列尾，内核只读；在途请求数不超过队列长度，槽位一定空闲
+        if (tag >= iovecs_.size()) {
+            return -1;
+        }
+        unsigned tail = *sq_tail_;
+        unsigned idx = tail & sq_mask_;
+        // iovec 按标签存放而不是按提交队列项：5.5 之前的内核（无 IORING_FEAT_SUBMIT_STABLE）
+        // 在请求真正执行时才读取 iovec，提交队列项可能已被后续请求复用，而标签在收割完成事件之前不会复用
+        iovecs_[tag].iov_base = buf;
+        iovecs_[tag].iov_len = len;
+        
+        io_uring_sqe& sqe = sqes_[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;  // 5.1 起支持
+        sqe.fd = fds_[segment];
+        sqe.off = offset;
+        sqe.addr = reinterpret_cast<uint64_t>(&iovecs_[tag]);
+        sqe.len = 1;
+        sqe.user_data = tag;
+        lens_[tag] = len;
+        
+        sq_array_[idx] = idx;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++pending_;
+        return 0;
+    }
+    
+    int wait(std::vector<std::pair<size_t, int>>& completed) override {
+        // 先收割已完成的请求，没有时再提交并等待
+        if (reap(completed) > 0 && pending_ == 0) {
+            return 0;
+        }
+        while (true) {
+            long ret = syscall(__NR_io_uring_enter, ring_fd_, pending_, completed.empty() ? 1u : 0u,
+                               IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "[错误] io_uring_enter 失败（errno：" << errno << "）" << std::endl;
+                return -1;
+            }
+            pending_ -= static_cast<unsigned>(ret);
+            reap(completed);
+            if (!completed.empty() && pending_ == 0) {
+                return 0;
+            }
+        }
+    }
+
+private:
+    int ring_fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sq_ring_bytes_ = 0;
+    size_t cq_ring_bytes_ = 0;
+    size_t sqes_bytes_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned pending_ = 0;           // 已写入提交队列、尚未交给内核的请求数
+    std::vector<iovec> iovecs_;      // 每个标签（槽位）一项，完成事件收割前保持有效
+    std::vector<size_t> lens_;       // 每个 tag 期望读取的字节数（短读视为失败）
+    std::vector<int> fds_;
+    
+    void* map_ring(size_t bytes, off_t offset) {
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+    
+    // 取出完成队列中的所有事件，返回取出的个数
+    size_t reap(std::vector<std::pair<size_t, int>>& completed) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        size_t count = 0;
+        for (; head != tail; ++head, ++count) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            size_t tag = static_cast<size_t>(cqe.user_data);
+            int status = (cqe.res >= 0 && static_cast<size_t>(cqe.res) == lens_[tag]) ? 0 : -1;
+            completed.emplace_back(tag, status);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+};
+
+#endif // TEE_HAVE_IO_URING
+
+} // namespace
+
+AsyncBlockReader::AsyncBlockReader() = default;
+
+AsyncBlockReader::~AsyncBlockReader() {
+    close();
+}
+
+int AsyncBlockReader::open(const BlockStore& store, size_t queue_depth, bool allow_io_uring) {
+    close();
+    if (!store.is_open() || queue_depth == 0) {
+        return -1;
+    }
+    
+#ifdef TEE_HAVE_IO_URING
+    if (allow_io_uring) {
+        auto ring = std::make_unique<IoUringBackend>();
+        if (ring->setup(static_cast<unsigned>(queue_depth)) == 0) {
+            backend_ = std::move(ring);
+            uses_io_uring_ = true;
+        }
+    }
+#else
+    (void)allow_io_uring;
+#endif
+    if (!backend_) {
+        backend_ = std::make_unique<ThreadPoolBackend>(std::min(queue_depth, FALLBACK_THREADS));
+    }
+    return attach(store, queue_depth);
+}
+
+int AsyncBlockReader::open(const BlockStore& store, std::unique_ptr<Backend> backend, size_t queue_depth) {
+    close();
+    if (!store.is_open() || !backend || queue_depth == 0) {
+        return -1;
+    }
+    backend_ = std::move(backend);
+    return attach(store, queue_depth);
+}
+
+int AsyncBlockReader::attach(const BlockStore& store, size_t queue_depth) {
+    store_ = &store;
+    slots_.resize(queue_depth);
+    free_slots_.clear();
+    for (size_t i = queue_depth; i > 0; --i) {
+        free_slots_.push_back(i - 1);
+    }
+    return 0;
+}
+
+void AsyncBlockReader::close() {
+    // 先析构后端（等待读线程退出 / 关闭 io_uring 并取消在途请求），再释放读取缓冲区
+    backend_.reset();
+    slots_.clear();
+    free_slots_.clear();
+    store_ = nullptr;
+    opened_segments_ = 0;
+    uses_io_uring_ = false;
+}
+
+bool AsyncBlockReader::is_open() const {
+    return store_ != nullptr;
+}
+
+bool AsyncBlockReader::uses_io_uring() const {
+    return uses_io_uring_;
+}
+
+int AsyncBlockReader::open_segments(size_t segment) {
+    // 块存储在两批读取之间可能追加了新段
+    for (; opened_segments_ <= segment; ++opened_segments_) {
+        if (backend_->open_segment(opened_segments_, store_->segment_path(opened_segments_)) != 0) {
+            std::cerr << "[错误] 打开段文件失败：" << store_->segment_path(opened_segments_) << std::endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int AsyncBlockReader::read_blocks(const size_t* indices, size_t count, const Completion& on_complete) {
+    if (!is_open()) {
+        return -1;
+    }
+    
+    int ret = 0;
+    size_t next = 0;
+    size_t in_flight = 0;
+    std::vector<std::pair<size_t, int>> completed;
+    while (next < count || in_flight > 0) {
+        // 用空闲槽位提交尽可能多的请求
+        while (next < count && !free_slots_.empty()) {
+            size_t request = next++;
+            BlockLocation location;
+            if (!store_->locate(indices[request], location) || open_segments(location.segment) != 0) {
+                on_complete(request, -1, EncryptedBlockView());
+                ret = -1;
+                continue;
+            }
+            size_t slot_index = free_slots_.back();
+            Slot& slot = slots_[slot_index];
+            slot.request = request;
+            slot.ciphertext_size = location.ciphertext_size;
+            slot.buffer.resize(BlockStore::RECORD_HEADER_SIZE + location.ciphertext_size);
+            if (backend_->submit(location.segment, location.offset, slot.buffer.data(), slot.buffer.size(),
+                                 slot_index) != 0) {
+                on_complete(request, -1, EncryptedBlockView());
+                ret = -1;
+                continue;
+            }
+            free_slots_.pop_back();
+            ++in_flight;
+        }
+        if (in_flight == 0) {
+            if (next < count) {
+                // 没有空闲槽位也没有在途请求，剩余请求无法提交
+                for (; next < count; ++next) {
+                    on_complete(next, -1, EncryptedBlockView());
+                }
+                return -1;
+            }
+            break;
+        }
+        
+        // 收割完成的请求并在本线程回调
+        completed.clear();
+        if (backend_->wait(completed) != 0) {
+            // 在途请求的缓冲区可能仍被后端写入，不能再复用槽位：
+            // 记下在途请求后关闭读取器，其余请求全部以失败回调
+            std::vector<size_t> failed;
+            std::vector<bool> is_free(slots_.size(), false);
+            for (size_t slot_index : free_slots_) {
+                is_free[slot_index] = true;
+            }
+            for (size_t i = 0; i < slots_.size(); ++i) {
+                if (!is_free[i]) {
+                    failed.push_back(slots_[i].request);
+                }
+            }
+            close();
+            for (size_t request : failed) {
+                on_complete(request, -1, EncryptedBlockView());
+            }
+            for (; next < count; ++next) {
+                on_complete(next, -1, EncryptedBlockView());
+            }
+            return -1;
+        }
+        for (const auto& [slot_index, status] : completed) {
+            Slot& slot = slots_[slot_index];
+            if (status == 0) {
+                on_complete(slot.request, 0, BlockStore::decode_record(slot.buffer.data(), slot.ciphertext_size));
+            } else {
+                on_complete(slot.request, -1, EncryptedBlockView());
+                ret = -1;
+            }
+            free_slots_.push_back(slot_index);
+            --in_flight;
+        }
+    }
+    return ret;
+}
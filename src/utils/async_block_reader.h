@@ -0,0 +1,95 @@
+#ifndef ASYNC_BLOCK_READER_H
+#define ASYNC_BLOCK_READER_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include "block_store.h"
+
+// 磁盘块存储的异步批量读取：一次提交一批块的读取，由调用线程收割完成事件并依次回调，
+// 不需要为每个请求占用一个线程，读盘与回调中的计算（哈希、构建证明）相互重叠。
+// Linux 上使用 io_uring（直接通过系统调用，不依赖 liburing），
+// 内核不支持或其他平台时退回到线程池 + pread。
+// 与 BlockStore 的读操作一样，读取期间不能对块存储执行写操作。
+class AsyncBlockReader {
+public:
+    // 单个请求完成时的回调：request 为请求在本批中的下标，status 为0表示成功，
+    // block 指向读取缓冲区，只在回调期间有效
+    using Completion = std::function<void(size_t request, int status, const EncryptedBlockView& block)>;
+    
+    // 构造函数
+    AsyncBlockReader();
+    
+    // 析构函数：自动关闭
+    ~AsyncBlockReader();
+    
+    AsyncBlockReader(const AsyncBlockReader&) = delete;
+    AsyncBlockReader& operator=(const AsyncBlockReader&) = delete;
+    
+    // 绑定块存储（store 必须在关闭读取器之前保持打开）
+    // queue_depth: 同时在途的读取数；allow_io_uring=false 时强制使用线程池
+    int open(const BlockStore& store, size_t queue_depth = DEFAULT_QUEUE_DEPTH, bool allow_io_uring = true);
+    
+    // 读取后端：提交读取，等待并取回完成的请求
+    class Backend {
+    public:
+        virtual ~Backend() = default;
+        
+        // 打开第 segment 段（按顺序依次打开）
+        virtual int open_segment(size_t segment, const std::string& path) = 0;
+        
+        // 提交一次读取：把第 segment 段 offset 处的 len 字节读入 buf，完成时以 tag 报告
+        virtual int submit(size_t segment, uint64_t offset, uint8_t* buf, size_t len, size_t tag) = 0;
+        
+        // 等待至少一个请求完成，把完成的 (tag, status) 追加到 completed。
+        // 返回非0时在途请求的状态未知，读取器随即关闭（析构后端）后才释放缓冲区
+        virtual int wait(std::vector<std::pair<size_t, int>>& completed) = 0;
+    };
+    
+    // 使用指定的后端绑定块存储（用于自定义读取方式或注入故障）
+    int open(const BlockStore& store, std::unique_ptr<Backend> backend, size_t queue_depth = DEFAULT_QUEUE_DEPTH);
+    void close();
+    bool is_open() const;
+    
+    // 是否使用 io_uring
+    bool uses_io_uring() const;
+    
+    // 读取 indices 中的 count 个块：请求一次性提交（超过队列深度时随完成补充），
+    // 每完成一个就在调用线程中回调 on_complete，阻塞直到全部完成。
+    // 下标越界或读取失败的请求以非0 status 回调，且整体返回-1；
+    // 后端等待失败时关闭读取器，在途和未提交的请求都以-1回调
+    int read_blocks(const size_t* indices, size_t count, const Completion& on_complete);
+    
+    // 默认队列深度
+    static constexpr size_t DEFAULT_QUEUE_DEPTH = 256;
+    
+    // 回退路径的读线程数
+    static constexpr size_t FALLBACK_THREADS = 8;
+
+private:
+    // 一个在途读取占用的槽位，缓冲区在各批之间复用
+    struct Slot {
+        std::vector<uint8_t> buffer;
+        size_t request = 0;
+        size_t ciphertext_size = 0;
+    };
+    
+    const BlockStore* store_ = nullptr;
+    std::unique_ptr<Backend> backend_;
+    std::vector<Slot> slots_;
+    std::vector<size_t> free_slots_;
+    size_t opened_segments_ = 0;  // 已在后端打开的段数
+    bool uses_io_uring_ = false;
+    
+    // 确保第 segment 段（及之前的段）已在后端打开
+    int open_segments(size_t segment);
+    
+    // 后端就绪后绑定块存储并分配槽位
+    int attach(const BlockStore& store, size_t queue_depth);
+};
+
+#endif // ASYNC_BLOCK_READER_H
@@ -0,0 +1,192 @@
+#include "block_cache.h"
+#include <algorithm>
+
+BlockCache::BlockCache(size_t capacity_bytes, size_t num_shards)
+    : capacity_bytes_(capacity_bytes),
+      shard_capacity_(capacity_bytes / std::max<size_t>(num_shards, 1)) {
+    shards_.resize(std::max<size_t>(num_shards, 1));
+    for (auto& shard : shards_) {
+        shard = std::make_unique<Shard>();
+    }
+}
+
+BlockCache::Shard& BlockCache::shard_for(size_t index) const {
+    // 相邻块落在不同分片，同一批挑战的锁竞争分散开
+    return *shards_[index % shards_.size()];
+}
+
+size_t BlockCache::entry_bytes(size_t record_size) {
+    // 叶子哈希、记录本身，以及哈希表节点等固定开销的粗略估计
+    return sizeof(Entry) + 32 + record_size;
+}
+
+void BlockCache::remove_entry(Shard& shard, size_t pos) {
+    Entry& entry = shard.entries[pos];
+    shard.bytes -= entry_bytes(entry.record.size());
+    shard.slots.erase(entry.index);
+    entry.used = false;
+    entry.referenced = false;
+    std::vector<uint8_t>().swap(entry.record);
+    shard.free_entries.push_back(pos);
+}
+
+void BlockCache::make_room(Shard& shard, size_t bytes) {
+    // CLOCK：访问位为1的项清零后跳过（第二次机会），为0的项淘汰
+    while (shard.bytes + bytes > shard_capacity_ && !shard.slots.empty()) {
+        if (shard.hand >= shard.entries.size()) {
+            shard.hand = 0;
+        }
+        Entry& entry = shard.entries[shard.hand];
+        if (entry.used) {
+            if (entry.referenced) {
+                entry.referenced = false;
+            } else {
+                remove_entry(shard, shard.hand);
+                ++shard.evictions;
+            }
+        }
+        ++shard.hand;
+    }
+}
+
+bool BlockCache::lookup_leaf(size_t index, std::array<uint8_t, 32>& leaf) {
+    Shard& shard = shard_for(index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.slots.find(index);
+    if (it == shard.slots.end()) {
+        ++shard.misses;
+        return false;
+    }
+    Entry& entry = shard.entries[it->second];
+    entry.referenced = true;
+    leaf = entry.leaf;
+    ++shard.hits;
+    return true;
+}
+
+bool BlockCache::lookup_block(size_t index, EncryptedBlock& block) {
+    Shard& shard = shard_for(index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.slots.find(index);
+    if (it == shard.slots.end() || shard.entries[it->second].record.empty()) {
+        ++shard.misses;
+        return false;
+    }
+    Entry& entry = shard.entries[it->second];
+    entry.referenced = true;
+    const uint8_t* record = entry.record.data();
+    std::copy(record, record + 12, block.iv.begin());
+    std::copy(record + 12, record + 28, block.auth_tag.begin());
+    block.ciphertext.assign(record + 28, record + entry.record.size());
+    ++shard.hits;
+    return true;
+}
+
+bool BlockCache::contains(size_t index, bool with_block) const {
+    Shard& shard = shard_for(index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.slots.find(index);
+    return it != shard.slots.end() && (!with_block || !shard.entries[it->second].record.empty());
+}
+
+void BlockCache::insert(size_t index, const std::array<uint8_t, 32>& leaf, const EncryptedBlockView* block) {
+    size_t record_size = block ? 28 + block->ciphertext_size : 0;
+    size_t bytes = entry_bytes(record_size);
+    if (bytes > shard_capacity_) {
+        return;
+    }
+    
+    Shard& shard = shard_for(index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.slots.find(index);
+    if (it != shard.slots.end()) {
+        remove_entry(shard, it->second);
+    }
+    make_room(shard, bytes);
+    
+    size_t pos;
+    if (!shard.free_entries.empty()) {
+        pos = shard.free_entries.back();
+        shard.free_entries.pop_back();
+    } else {
+        pos = shard.entries.size();
+        shard.entries.emplace_back();
+    }
+    Entry& entry = shard.entries[pos];
+    entry.index = index;
+    entry.leaf = leaf;
+    entry.used = true;
+    entry.referenced = false;  // 新项从访问位0开始，只被访问一次的块最先淘汰
+    if (block) {
+        entry.record.resize(record_size);
+        std::copy(block->iv->begin(), block->iv->end(), entry.record.begin());
+        std::copy(block->auth_tag->begin(), block->auth_tag->end(), entry.record.begin() + 12);
+        std::copy(block->ciphertext, block->ciphertext + block->ciphertext_size, entry.record.begin() + 28);
+    }
+    shard.slots[index] = pos;
+    shard.bytes += bytes;
+}
+
+void BlockCache::erase(size_t index) {
+    Shard& shard = shard_for(index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.slots.find(index);
+    if (it != shard.slots.end()) {
+        remove_entry(shard, it->second);
+    }
+}
+
+void BlockCache::erase_from(size_t first) {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (size_t pos = 0; pos < shard->entries.size(); ++pos) {
+            if (shard->entries[pos].used && shard->entries[pos].index >= first) {
+                remove_entry(*shard, pos);
+            }
+        }
+    }
+}
+
+void BlockCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->slots.clear();
+        shard->entries.clear();
+        shard->free_entries.clear();
+        shard->hand = 0;
+        shard->bytes = 0;
+    }
+}
+
+size_t BlockCache::memory_bytes() const {
+    size_t bytes = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        bytes += shard->bytes;
+    }
+    return bytes;
+}
+
+size_t BlockCache::capacity_bytes() const {
+    return capacity_bytes_;
+}
+
+BlockCache::Stats BlockCache::stats() const {
+    Stats total;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->hits;
+        total.misses += shard->misses;
+        total.evictions += shard->evictions;
+    }
+    return total;
+}
+
+void BlockCache::reset_stats() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->hits = 0;
+        shard->misses = 0;
+        shard->evictions = 0;
+    }
+}
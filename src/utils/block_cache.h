@@ -0,0 +1,102 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "../../include/common_type.h"
+#include "encrypted_block_set.h"
+
+// 热块缓存：按块下标缓存叶子哈希，以及可选的块记录（IV || 认证标签 || 密文）
+// 按下标分片，每个分片一把锁，分片内用 CLOCK 算法淘汰（命中只置访问位，不移动链表）。
+// 容量按字节计（叶子哈希和块记录都计入），可在多线程中并发使用。
+class BlockCache {
+public:
+    // 命中/未命中/淘汰计数
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+    
+    // 构造函数：capacity_bytes 为总容量，平均分给 num_shards 个分片
+    explicit BlockCache(size_t capacity_bytes, size_t num_shards = DEFAULT_SHARDS);
+    
+    // 析构函数
+    ~BlockCache() = default;
+    
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+    
+    // 查找第 index 块的叶子哈希
+    bool lookup_leaf(size_t index, std::array<uint8_t, 32>& leaf);
+    
+    // 查找第 index 块（只缓存了叶子哈希时视为未命中）
+    bool lookup_block(size_t index, EncryptedBlock& block);
+    
+    // 是否已缓存第 index 块（with_block=true 时要求同时缓存了块记录；不计入命中统计）
+    bool contains(size_t index, bool with_block) const;
+    
+    // 插入或替换第 index 块的缓存项（block 为空时只缓存叶子哈希）
+    void insert(size_t index, const std::array<uint8_t, 32>& leaf, const EncryptedBlockView* block = nullptr);
+    
+    // 使第 index 块的缓存项失效（块被修改时调用）
+    void erase(size_t index);
+    
+    // 使下标不小于 first 的缓存项全部失效（截断时调用）
+    void erase_from(size_t first);
+    
+    void clear();
+    
+    // 当前占用字节数与容量
+    size_t memory_bytes() const;
+    size_t capacity_bytes() const;
+    
+    Stats stats() const;
+    void reset_stats();
+    
+    // 默认分片数
+    static constexpr size_t DEFAULT_SHARDS = 16;
+
+private:
+    struct Entry {
+        size_t index = 0;
+        std::array<uint8_t, 32> leaf{};
+        std::vector<uint8_t> record;  // 为空表示只缓存了叶子哈希
+        bool referenced = false;      // CLOCK 访问位
+        bool used = false;
+    };
+    
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<size_t, size_t> slots;  // 块下标 -> entries 中的位置
+        std::vector<Entry> entries;
+        std::vector<size_t> free_entries;
+        size_t hand = 0;    // CLOCK 指针
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+    
+    size_t capacity_bytes_;
+    size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    
+    Shard& shard_for(size_t index) const;
+    
+    // 缓存项占用的字节数（含固定开销）
+    static size_t entry_bytes(size_t record_size);
+    
+    // 从分片中移除 entries[pos]（调用方持有锁）
+    static void remove_entry(Shard& shard, size_t pos);
+    
+    // 淘汰直到分片能再放下 bytes 字节（调用方持有锁）
+    void make_room(Shard& shard, size_t bytes);
+};
+
+#endif // BLOCK_CACHE_H
@@ -0,0 +1,434 @@
+#include "block_store.h"
+#include "crypto_utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+static_assert(sizeof(BlockStoreHeader) == 64, "块存储索引文件头必须为64字节");
+
+namespace {
+
+const uint8_t BLOCK_STORE_MAGIC[8] = {'T', 'E', 'E', 'B', 'L', 'K', 'S', '\0'};
+const uint32_t BLOCK_STORE_VERSION = 1;
+const uint64_t HEADER_SIZE = sizeof(BlockStoreHeader);
+
+// 索引项：低48位为全局偏移，高16位为密文长度
+const uint64_t OFFSET_MASK = (static_cast<uint64_t>(1) << 48) - 1;
+
+// 批量追加时的写缓冲区大小（4 MB）
+const size_t WRITE_BUFFER_BYTES = static_cast<size_t>(4) << 20;
+
+uint64_t make_entry(uint64_t offset, size_t ciphertext_size) {
+    return offset | (static_cast<uint64_t>(ciphertext_size) << 48);
+}
+
+} // namespace
+
+BlockStore::~BlockStore() {
+    close();
+}
+
+std::string BlockStore::segment_path(size_t segment) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment_%06zu.dat", segment);
+    return (std::filesystem::path(dir_) / name).string();
+}
+
+int BlockStore::open(const std::string& dir, uint64_t segment_bytes) {
+    close();
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "[错误] 创建块存储目录失败：" << dir << std::endl;
+        return -1;
+    }
+    dir_ = dir;
+    
+    const std::string index_path = (std::filesystem::path(dir_) / "index.dat").string();
+    if (index_file_.open(index_path, true, true) != 0) {
+        return -1;
+    }
+    
+    BlockStoreHeader header;
+    if (index_file_.size() == 0) {
+        // 新建：段大小必须能放下最长的记录，且全局偏移不超过48位
+        if (segment_bytes < RECORD_HEADER_SIZE + MAX_CIPHERTEXT_SIZE || segment_bytes > OFFSET_MASK) {
+            index_file_.close();
+            return -1;
+        }
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, BLOCK_STORE_MAGIC, sizeof(header.magic));
+        header.version = BLOCK_STORE_VERSION;
+        header.segment_bytes = segment_bytes;
+        if (index_file_.write_at(0, &header, sizeof(header)) != 0 || index_file_.sync() != 0) {
+            index_file_.close();
+            return -1;
+        }
+    } else {
+        // 重新打开：只读取文件头和索引项
+        if (index_file_.read_at(0, &header, sizeof(header)) != 0 ||
+            std::memcmp(header.magic, BLOCK_STORE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != BLOCK_STORE_VERSION ||
+            header.segment_bytes < RECORD_HEADER_SIZE + MAX_CIPHERTEXT_SIZE ||
+            header.segment_bytes > OFFSET_MASK ||
+            header.tail > OFFSET_MASK ||
+            index_file_.size() < HEADER_SIZE ||
+            header.block_count > (index_file_.size() - HEADER_SIZE) / sizeof(uint64_t)) {
+            std::cerr << "[错误] 块存储索引文件无效：" << index_path << std::endl;
+            index_file_.close();
+            return -1;
+        }
+        index_.resize(static_cast<size_t>(header.block_count));
+        if (!index_.empty() &&
+            index_file_.read_at(HEADER_SIZE, index_.data(), index_.size() * sizeof(uint64_t)) != 0) {
+            close();
+            return -1;
+        }
+    }
+    segment_bytes_ = header.segment_bytes;
+    tail_ = header.tail;
+    dirty_from_ = index_.size();
+    
+    // 映射已写入数据的段（重新打开时这些段必须已存在且为完整大小，不创建也不扩展），
+    // 写入句柄指向 tail 所在的段（tail 恰好位于段边界时该段可能尚未创建）
+    size_t data_segments = static_cast<size_t>((tail_ + segment_bytes_ - 1) / segment_bytes_);
+    for (size_t segment = 0; segment < data_segments; ++segment) {
+        if (map_segment(segment, false) != 0) {
+            std::cerr << "[错误] 块存储段文件缺失或不完整：" << segment_path(segment) << std::endl;
+            close();
+            return -1;
+        }
+    }
+    if (activate_segment(static_cast<size_t>(tail_ / segment_bytes_)) != 0) {
+        close();
+        return -1;
+    }
+    
+    // 索引项不能指向已写入范围之外，记录也不能跨出所在的段
+    for (uint64_t entry : index_) {
+        uint64_t offset = entry & OFFSET_MASK;
+        uint64_t record_size = RECORD_HEADER_SIZE + (entry >> 48);
+        if (offset + record_size > tail_ || offset % segment_bytes_ + record_size > segment_bytes_) {
+            std::cerr << "[错误] 块存储索引项越界：" << index_path << std::endl;
+            close();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void BlockStore::close() {
+    if (index_file_.is_open()) {
+        sync();
+    }
+    active_.close();
+    index_file_.close();
+    segments_.clear();
+    index_.clear();
+    dir_.clear();
+    segment_bytes_ = 0;
+    tail_ = 0;
+    active_segment_ = 0;
+    active_dirty_ = false;
+    dirty_from_ = 0;
+    dirty_ = false;
+    unsynced_appends_ = 0;
+}
+
+bool BlockStore::is_open() const {
+    return index_file_.is_open();
+}
+
+size_t BlockStore::size() const {
+    return index_.size();
+}
+
+bool BlockStore::empty() const {
+    return index_.empty();
+}
+
+int BlockStore::map_segment(size_t segment, bool create) {
+    if (segment < segments_.size() && segments_[segment]) {
+        return 0;
+    }
+    
+    // 段文件创建时即扩展到完整大小，之后整段映射，写入不需要重新映射
+    const std::string path = segment_path(segment);
+    if (create) {
+        RandomAccessFile file;
+        if (file.open(path, true, true) != 0) {
+            return -1;
+        }
+        if (file.size() < segment_bytes_ && file.resize(segment_bytes_) != 0) {
+            std::cerr << "[错误] 扩展段文件失败：" << path << std::endl;
+            return -1;
+        }
+        file.close();
+    }
+    
+    auto mapped = std::make_unique<MappedFile>();
+    if (mapped->open(path) != 0 || mapped->size() < segment_bytes_) {
+        return -1;
+    }
+    mapped->advise_random();
+    if (segments_.size() <= segment) {
+        segments_.resize(segment + 1);
+    }
+    segments_[segment] = std::move(mapped);
+    return 0;
+}
+
+int BlockStore::activate_segment(size_t segment) {
+    if (active_.is_open() && active_segment_ == segment) {
+        return 0;
+    }
+    if (active_.is_open()) {
+        if (active_dirty_ && active_.sync() != 0) {
+            return -1;
+        }
+        active_.close();
+    }
+    active_dirty_ = false;
+    if (map_segment(segment) != 0 || active_.open(segment_path(segment), true) != 0) {
+        return -1;
+    }
+    active_segment_ = segment;
+    return 0;
+}
+
+uint64_t BlockStore::place_record(size_t record_size) {
+    if (tail_ % segment_bytes_ + record_size > segment_bytes_) {
+        tail_ = (tail_ / segment_bytes_ + 1) * segment_bytes_;
+    }
+    uint64_t offset = tail_;
+    tail_ += record_size;
+    return offset;
+}
+
+int BlockStore::write_at(uint64_t offset, const uint8_t* data, size_t len) {
+    if (activate_segment(static_cast<size_t>(offset / segment_bytes_)) != 0 ||
+        active_.write_at(offset % segment_bytes_, data, len) != 0) {
+        std::cerr << "[错误] 写入段文件失败" << std::endl;
+        return -1;
+    }
+    active_dirty_ = true;
+    dirty_ = true;
+    return 0;
+}
+
+void BlockStore::encode_record(const EncryptedBlockView& block, std::vector<uint8_t>& out) {
+    out.insert(out.end(), block.iv->begin(), block.iv->end());
+    out.insert(out.end(), block.auth_tag->begin(), block.auth_tag->end());
+    out.insert(out.end(), block.ciphertext, block.ciphertext + block.ciphertext_size);
+}
+
+void BlockStore::mark_dirty(size_t index) {
+    dirty_from_ = std::min(dirty_from_, index);
+    dirty_ = true;
+}
+
+int BlockStore::append(const EncryptedBlockView& block) {
+    if (!is_open() || block.ciphertext_size > MAX_CIPHERTEXT_SIZE) {
+        return -1;
+    }
+    std::vector<uint8_t> record;
+    record.reserve(RECORD_HEADER_SIZE + block.ciphertext_size);
+    encode_record(block, record);
+    uint64_t offset = place_record(record.size());
+    if (write_at(offset, record.data(), record.size()) != 0) {
+        return -1;
+    }
+    index_.push_back(make_entry(offset, block.ciphertext_size));
+    mark_dirty(index_.size() - 1);
+    
+    if (sync_interval_ > 0 && ++unsynced_appends_ >= sync_interval_) {
+        return sync();
+    }
+    return 0;
+}
+
+template <typename Blocks>
+int BlockStore::append_all(const Blocks& blocks) {
+    if (!is_open()) {
+        return -1;
+    }
+    
+    // 中途失败时撤销本批已加入的索引项和分配的空间（已写出的记录成为段尾之后的垃圾）
+    const size_t old_size = index_.size();
+    const uint64_t old_tail = tail_;
+    auto rollback = [&]() {
+        index_.resize(old_size);
+        tail_ = old_tail;
+        return -1;
+    };
+    
+    // 相邻记录攒进写缓冲区，满了或换段时整块写出
+    std::vector<uint8_t> buffer;
+    buffer.reserve(WRITE_BUFFER_BYTES);
+    uint64_t buffer_offset = 0;
+    index_.reserve(index_.size() + blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        EncryptedBlockView block(blocks[i]);
+        if (block.ciphertext_size > MAX_CIPHERTEXT_SIZE) {
+            return rollback();
+        }
+        size_t record_size = RECORD_HEADER_SIZE + block.ciphertext_size;
+        uint64_t offset = place_record(record_size);
+        if (!buffer.empty() &&
+            (offset != buffer_offset + buffer.size() || buffer.size() + record_size > WRITE_BUFFER_BYTES)) {
+            if (write_at(buffer_offset, buffer.data(), buffer.size()) != 0) {
+                return rollback();
+            }
+            buffer.clear();
+        }
+        if (buffer.empty()) {
+            buffer_offset = offset;
+        }
+        encode_record(block, buffer);
+        index_.push_back(make_entry(offset, block.ciphertext_size));
+        mark_dirty(index_.size() - 1);
+    }
+    if (!buffer.empty() && write_at(buffer_offset, buffer.data(), buffer.size()) != 0) {
+        return rollback();
+    }
+    
+    // 整批只落盘一次
+    return sync();
+}
+
+int BlockStore::append_blocks(const EncryptedBlockSet& blocks) {
+    return append_all(blocks);
+}
+
+int BlockStore::append_blocks(const std::vector<EncryptedBlock>& blocks) {
+    return append_all(blocks);
+}
+
+int BlockStore::update(size_t index, const EncryptedBlockView& block) {
+    if (!is_open() || index >= index_.size() || block.ciphertext_size > MAX_CIPHERTEXT_SIZE) {
+        return -1;
+    }
+    std::vector<uint8_t> record;
+    record.reserve(RECORD_HEADER_SIZE + block.ciphertext_size);
+    encode_record(block, record);
+    uint64_t offset = place_record(record.size());
+    if (write_at(offset, record.data(), record.size()) != 0) {
+        return -1;
+    }
+    index_[index] = make_entry(offset, block.ciphertext_size);
+    mark_dirty(index);
+    return 0;
+}
+
+int BlockStore::truncate(size_t num_blocks) {
+    if (!is_open() || num_blocks > index_.size()) {
+        return -1;
+    }
+    index_.resize(num_blocks);
+    mark_dirty(num_blocks);
+    return 0;
+}
+
+int BlockStore::sync() {
+    if (!is_open()) {
+        return -1;
+    }
+    unsynced_appends_ = 0;
+    if (!dirty_) {
+        return 0;
+    }
+    
+    // 先让记录落盘，再写索引项和文件头，索引永远不会指向未落盘的记录
+    if (active_dirty_ && active_.sync() != 0) {
+        return -1;
+    }
+    active_dirty_ = false;
+    
+    if (dirty_from_ < index_.size() &&
+        index_file_.write_at(HEADER_SIZE + dirty_from_ * sizeof(uint64_t), index_.data() + dirty_from_,
+                             (index_.size() - dirty_from_) * sizeof(uint64_t)) != 0) {
+        return -1;
+    }
+    BlockStoreHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BLOCK_STORE_MAGIC, sizeof(header.magic));
+    header.version = BLOCK_STORE_VERSION;
+    header.block_count = index_.size();
+    header.tail = tail_;
+    header.segment_bytes = segment_bytes_;
+    if (index_file_.write_at(0, &header, sizeof(header)) != 0 || index_file_.sync() != 0) {
+        std::cerr << "[错误] 写入块存储索引失败" << std::endl;
+        return -1;
+    }
+    dirty_from_ = index_.size();
+    dirty_ = false;
+    return 0;
+}
+
+void BlockStore::set_sync_interval(size_t num_blocks) {
+    sync_interval_ = num_blocks;
+}
+
+EncryptedBlockView BlockStore::decode_record(const uint8_t* record, size_t ciphertext_size) {
+    // std::array<uint8_t, N> 与 N 字节数组布局相同，可直接指向记录中的IV和标签
+    return EncryptedBlockView(record + RECORD_HEADER_SIZE, ciphertext_size,
+                              *reinterpret_cast<const std::array<uint8_t, 12>*>(record),
+                              *reinterpret_cast<const std::array<uint8_t, 16>*>(record + 12));
+}
+
+EncryptedBlockView BlockStore::operator[](size_t index) const {
+    uint64_t entry = index_[index];
+    uint64_t offset = entry & OFFSET_MASK;
+    const uint8_t* record = segments_[static_cast<size_t>(offset / segment_bytes_)]->data() + offset % segment_bytes_;
+    return decode_record(record, static_cast<size_t>(entry >> 48));
+}
+
+bool BlockStore::locate(size_t index, BlockLocation& location) const {
+    if (index >= index_.size()) {
+        return false;
+    }
+    uint64_t offset = index_[index] & OFFSET_MASK;
+    location.segment = static_cast<size_t>(offset / segment_bytes_);
+    location.offset = offset % segment_bytes_;
+    location.ciphertext_size = static_cast<size_t>(index_[index] >> 48);
+    return true;
+}
+
+bool BlockStore::get_block_view(size_t index, EncryptedBlockView& block) const {
+    if (index >= index_.size()) {
+        return false;
+    }
+    block = (*this)[index];
+    return true;
+}
+
+bool BlockStore::get_block(size_t index, EncryptedBlock& block) const {
+    EncryptedBlockView view;
+    if (!get_block_view(index, view)) {
+        return false;
+    }
+    block = view.to_block();
+    return true;
+}
+
+int hash_encrypted_blocks(const BlockStore& blocks, size_t first, size_t count,
+                          std::array<uint8_t, 32>* out) {
+    if (first > blocks.size() || count > blocks.size() - first) {
+        return -1;
+    }
+    // 分批收集映射中的块视图，交给批量哈希
+    const size_t batch = 256;
+    EncryptedBlockView views[batch];
+    for (size_t done = 0; done < count; done += batch) {
+        size_t n = std::min(batch, count - done);
+        for (size_t i = 0; i < n; ++i) {
+            views[i] = blocks[first + done + i];
+        }
+        if (hash_encrypted_blocks(views, n, out + done) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
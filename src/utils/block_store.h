@@ -0,0 +1,151 @@
+#ifndef BLOCK_STORE_H
+#define BLOCK_STORE_H
+
+#include <vector>
+#include <array>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "../../include/common_type.h"
+#include "encrypted_block_set.h"
+#include "file_io.h"
+
+// 磁盘块存储目录格式（所有整数按小端存放）：
+//   segment_NNNNNN.dat  只追加的段文件，创建时即扩展到 segment_bytes（稀疏文件），整段只读映射；
+//                       每条记录为 IV(12) || 认证标签(16) || 密文，记录不跨段
+//   index.dat           [0, 64) 文件头 BlockStoreHeader，之后每块一个8字节索引项：
+//                       低48位为记录的全局偏移（段号 * segment_bytes + 段内偏移），高16位为密文长度
+// 重写块时在段尾追加新记录并修改索引项（旧记录成为垃圾，不回收），截断只减少块数。
+// 落盘顺序：先 fsync 段文件，再写索引项和文件头并 fsync 索引，
+// 崩溃后重新打开只会看到最后一次 sync 时的状态。
+struct BlockStoreHeader {
+    uint8_t magic[8];        // "TEEBLKS\0"
+    uint32_t version;        // 格式版本（当前为1）
+    uint32_t reserved;       // 保留（0）
+    uint64_t block_count;    // 块数
+    uint64_t tail;           // 下一条记录的全局偏移
+    uint64_t segment_bytes;  // 段文件大小
+    uint8_t padding[24];     // 保留（0）
+};
+
+// 块记录在段文件中的位置（供绕过内存映射的异步读取使用）
+struct BlockLocation {
+    size_t segment;          // 段号
+    uint64_t offset;         // 记录在段内的偏移
+    size_t ciphertext_size;  // 密文长度（记录长度为 BlockStore::RECORD_HEADER_SIZE + ciphertext_size）
+};
+
+// 持久化的只追加块存储：容量只受磁盘限制，内存中只保存每块8字节的索引，
+// 读取通过内存映射完成（get_block_view 零复制）。
+// 读操作可以在多线程中并发执行，但不能与写操作并发。
+class BlockStore {
+public:
+    // 构造函数
+    BlockStore() = default;
+    
+    // 析构函数：落盘并关闭
+    ~BlockStore();
+    
+    BlockStore(const BlockStore&) = delete;
+    BlockStore& operator=(const BlockStore&) = delete;
+    
+    // 打开目录 dir 中的块存储，不存在时创建（创建时使用 segment_bytes，已存在时以文件头为准）
+    // 重新打开只读取索引文件，不扫描段文件
+    int open(const std::string& dir, uint64_t segment_bytes = DEFAULT_SEGMENT_BYTES);
+    void close();
+    bool is_open() const;
+    
+    // 块数
+    size_t size() const;
+    bool empty() const;
+    
+    // 追加一块（不落盘；设置了 set_sync_interval 时每累计 N 块自动 sync）
+    int append(const EncryptedBlockView& block);
+    
+    // 批量追加：记录攒成大块顺序写入，全部写完后只 sync 一次
+    int append_blocks(const EncryptedBlockSet& blocks);
+    int append_blocks(const std::vector<EncryptedBlock>& blocks);
+    
+    // 重写第 index 块（在段尾追加新记录）
+    int update(size_t index, const EncryptedBlockView& block);
+    
+    // 截断为前 num_blocks 块
+    int truncate(size_t num_blocks);
+    
+    // 把已写入的记录和索引落盘
+    int sync();
+    
+    // 单块追加时每累计 num_blocks 块自动 sync 一次（0 表示只在显式 sync 时落盘）
+    void set_sync_interval(size_t num_blocks);
+    
+    // 读取第 index 块（复制）
+    bool get_block(size_t index, EncryptedBlock& block) const;
+    
+    // 第 index 块的视图，直接指向映射的段文件（在存储关闭前有效）
+    bool get_block_view(size_t index, EncryptedBlockView& block) const;
+    
+    // 第 index 块的视图（不检查下标）
+    EncryptedBlockView operator[](size_t index) const;
+    
+    // 第 index 块记录的位置
+    bool locate(size_t index, BlockLocation& location) const;
+    
+    // 第 segment 段的文件路径
+    std::string segment_path(size_t segment) const;
+    
+    // 把从段文件读出的一条记录解析为块视图（视图指向 record）
+    static EncryptedBlockView decode_record(const uint8_t* record, size_t ciphertext_size);
+    
+    // 记录头：IV(12) || 认证标签(16)
+    static constexpr size_t RECORD_HEADER_SIZE = 12 + 16;
+    
+    // 默认段文件大小（1 GiB）
+    static constexpr uint64_t DEFAULT_SEGMENT_BYTES = static_cast<uint64_t>(1) << 30;
+    
+    // 单块密文的最大长度（索引项中长度占16位）
+    static constexpr size_t MAX_CIPHERTEXT_SIZE = 0xFFFF;
+
+private:
+    std::string dir_;
+    uint64_t segment_bytes_ = 0;
+    uint64_t tail_ = 0;                                 // 下一条记录的全局偏移
+    std::vector<uint64_t> index_;                       // 每块的索引项
+    std::vector<std::unique_ptr<MappedFile>> segments_; // 各段的只读映射
+    RandomAccessFile active_;                           // 当前写入的段
+    size_t active_segment_ = 0;
+    bool active_dirty_ = false;                         // 当前段是否有未 fsync 的写入
+    RandomAccessFile index_file_;
+    size_t dirty_from_ = 0;     // 自上次 sync 以来修改过的最小索引下标
+    bool dirty_ = false;        // 是否有未落盘的写入
+    size_t sync_interval_ = 0;
+    size_t unsynced_appends_ = 0;
+    
+    // 打开第 segment 段的只读映射；create 为 true 时段文件不存在则创建并扩展到段大小，
+    // 为 false 时（重新打开已有的段）要求文件已存在且为完整大小
+    int map_segment(size_t segment, bool create = true);
+    
+    // 切换写入句柄到第 segment 段（先 fsync 上一段，保证落盘顺序）
+    int activate_segment(size_t segment);
+    
+    // 为 record_size 字节的记录分配全局偏移（当前段放不下时换到下一段的起点）
+    uint64_t place_record(size_t record_size);
+    
+    // 在全局偏移 offset 处写入 len 字节（不跨段）
+    int write_at(uint64_t offset, const uint8_t* data, size_t len);
+    
+    // 把记录编码到 out 末尾
+    static void encode_record(const EncryptedBlockView& block, std::vector<uint8_t>& out);
+    
+    // 记录修改过的索引下标
+    void mark_dirty(size_t index);
+    
+    template <typename Blocks>
+    int append_all(const Blocks& blocks);
+};
+
+// 批量计算 blocks[first, first + count) 的叶子哈希（与 crypto_utils 中其他容器的重载一致）
+int hash_encrypted_blocks(const BlockStore& blocks, size_t first, size_t count,
+                          std::array<uint8_t, 32>* out);
+
+#endif // BLOCK_STORE_H
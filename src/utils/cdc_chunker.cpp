@@ -0,0 +1,368 @@
+#include "cdc_chunker.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEAR_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace {
+
+// 滚动哈希窗口：64位哈希每读入一个字节左移一位，64 字节之前的内容已全部移出
+constexpr size_t WINDOW = 64;
+
+// 每次计算位图的数据段长度（位图 2 * 4 KB，常驻缓存）；段之间只重叠不到一个最大块长
+constexpr size_t REGION_BYTES = static_cast<size_t>(256) << 10;
+
+// Gear 表：256 个伪随机64位数，由固定种子的 splitmix64 生成（所有节点切出的块边界一致）
+struct GearTable {
+    uint64_t v[256];
+};
+
+constexpr GearTable make_gear_table() {
+    GearTable table{};
+    uint64_t state = 0x5445455f43444331ULL;
+    for (size_t i = 0; i < 256; ++i) {
+        state += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        table.v[i] = z ^ (z >> 31);
+    }
+    return table;
+}
+
+alignas(64) constexpr GearTable GEAR = make_gear_table();
+
+// 位图内核：计算位置 [begin, begin + count) 的哈希是否满足两个掩码，
+// 位置 begin + 64w + j 对应 bits[w] 的第 j 位（整字写入，count 不是64的倍数时末字高位为0）
+using GearFn = void (*)(const uint8_t* data, size_t begin, size_t count,
+                        uint64_t mask_s, uint64_t mask_l, uint64_t* bits_s, uint64_t* bits_l);
+
+void gear_bitmaps_scalar(const uint8_t* data, size_t begin, size_t count,
+                         uint64_t mask_s, uint64_t mask_l, uint64_t* bits_s, uint64_t* bits_l) {
+    // 从 begin 之前 63 字节开始滚动（文件开头不足时缺少的字节不计入）
+    uint64_t h = 0;
+    for (size_t p = begin >= WINDOW - 1 ? begin - (WINDOW - 1) : 0; p < begin; ++p) {
+        h = (h << 1) + GEAR.v[data[p]];
+    }
+    for (size_t w = 0; w * 64 < count; ++w) {
+        const size_t n = std::min<size_t>(64, count - w * 64);
+        const uint8_t* src = data + begin + w * 64;
+        uint64_t word_s = 0;
+        uint64_t word_l = 0;
+        for (size_t j = 0; j < n; ++j) {
+            h = (h << 1) + GEAR.v[src[j]];
+            word_s |= static_cast<uint64_t>((h & mask_s) == 0) << j;
+            word_l |= static_cast<uint64_t>((h & mask_l) == 0) << j;
+        }
+        bits_s[w] = word_s;
+        bits_l[w] = word_l;
+    }
+}
+
+#ifdef GEAR_X86_SIMD
+
+// 向量内核把 [begin, begin + count) 均分为 LANES 路（每路长度为64的倍数），每路从起点前 64 字节开始预热。
+// 每路每次 gather 读入 8 个字节，再逐字节 gather 查 Gear 表；要求 begin >= 64，count 为 64 * LANES 的倍数
+
+#define GEAR_INLINE inline __attribute__((always_inline))
+
+// 各路滚动 8 个字节（words 的每个64位元素是一路接下来的 8 个字节）；
+// RECORD 时命中掩码的路在累加字上置当前位，bit 随之左移
+template <bool RECORD>
+__attribute__((target("avx2"))) GEAR_INLINE
+void gear_step8_avx2(__m256i words, __m256i& h, __m256i ms, __m256i ml,
+                     __m256i& bit, __m256i& acc_s, __m256i& acc_l) {
+    const __m256i byte_mask = _mm256_set1_epi64x(0xFF);
+    const __m256i zero = _mm256_setzero_si256();
+    const long long* table = reinterpret_cast<const long long*>(GEAR.v);
+    for (int b = 0; b < 8; ++b) {
+        __m256i idx = _mm256_and_si256(_mm256_srli_epi64(words, 8 * b), byte_mask);
+        h = _mm256_add_epi64(_mm256_slli_epi64(h, 1), _mm256_i64gather_epi64(table, idx, 8));
+        if (RECORD) {
+            __m256i hit_s = _mm256_cmpeq_epi64(_mm256_and_si256(h, ms), zero);
+            __m256i hit_l = _mm256_cmpeq_epi64(_mm256_and_si256(h, ml), zero);
+            acc_s = _mm256_or_si256(acc_s, _mm256_and_si256(hit_s, bit));
+            acc_l = _mm256_or_si256(acc_l, _mm256_and_si256(hit_l, bit));
+            bit = _mm256_slli_epi64(bit, 1);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void gear_bitmaps_avx2(const uint8_t* data, size_t begin, size_t count,
+                       uint64_t mask_s, uint64_t mask_l, uint64_t* bits_s, uint64_t* bits_l) {
+    constexpr size_t LANES = 4;
+    const size_t lane_len = count / LANES;
+    const size_t lane_words = lane_len / 64;
+    const long long* base = reinterpret_cast<const long long*>(data + begin - WINDOW);
+    const __m256i lane_off = _mm256_set_epi64x(3 * lane_len, 2 * lane_len, lane_len, 0);
+    const __m256i ms = _mm256_set1_epi64x(static_cast<long long>(mask_s));
+    const __m256i ml = _mm256_set1_epi64x(static_cast<long long>(mask_l));
+    __m256i h = _mm256_setzero_si256();
+    __m256i bit = h, acc_s = h, acc_l = h;
+    
+    for (size_t k = 0; k < WINDOW; k += 8) {
+        __m256i words = _mm256_i64gather_epi64(base, _mm256_add_epi64(lane_off, _mm256_set1_epi64x(k)), 1);
+        gear_step8_avx2<false>(words, h, ms, ml, bit, acc_s, acc_l);
+    }
+    alignas(32) uint64_t out_s[LANES];
+    alignas(32) uint64_t out_l[LANES];
+    for (size_t w = 0; w < lane_words; ++w) {
+        bit = _mm256_set1_epi64x(1);
+        acc_s = _mm256_setzero_si256();
+        acc_l = _mm256_setzero_si256();
+        for (size_t k = 0; k < 64; k += 8) {
+            __m256i off = _mm256_add_epi64(lane_off, _mm256_set1_epi64x(WINDOW + w * 64 + k));
+            gear_step8_avx2<true>(_mm256_i64gather_epi64(base, off, 1), h, ms, ml, bit, acc_s, acc_l);
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(out_s), acc_s);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(out_l), acc_l);
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            bits_s[lane * lane_words + w] = out_s[lane];
+            bits_l[lane * lane_words + w] = out_l[lane];
+        }
+    }
+}
+
+template <bool RECORD>
+__attribute__((target("avx512f"))) GEAR_INLINE
+void gear_step8_avx512(__m512i words, __m512i& h, __m512i ms, __m512i ml,
+                       __m512i& bit, __m512i& acc_s, __m512i& acc_l) {
+    // 全掩码的 maskz/mask 形式与普通形式等价（普通形式在 GCC 12 下会误报未初始化）
+    const __m512i byte_mask = _mm512_set1_epi64(0xFF);
+    const __m512i zero = _mm512_setzero_si512();
+    for (int b = 0; b < 8; ++b) {
+        __m512i idx = _mm512_and_si512(_mm512_maskz_srli_epi64(0xFF, words, 8 * b), byte_mask);
+        __m512i g = _mm512_mask_i64gather_epi64(zero, 0xFF, idx, GEAR.v, 8);
+        h = _mm512_add_epi64(_mm512_maskz_slli_epi64(0xFF, h, 1), g);
+        if (RECORD) {
+            acc_s = _mm512_mask_or_epi64(acc_s, _mm512_testn_epi64_mask(h, ms), acc_s, bit);
+            acc_l = _mm512_mask_or_epi64(acc_l, _mm512_testn_epi64_mask(h, ml), acc_l, bit);
+            bit = _mm512_maskz_slli_epi64(0xFF, bit, 1);
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+void gear_bitmaps_avx512(const uint8_t* data, size_t begin, size_t count,
+                         uint64_t mask_s, uint64_t mask_l, uint64_t* bits_s, uint64_t* bits_l) {
+    constexpr size_t LANES = 8;
+    const size_t lane_len = count / LANES;
+    const size_t lane_words = lane_len / 64;
+    const void* base = data + begin - WINDOW;
+    const __m512i lane_off = _mm512_set_epi64(7 * lane_len, 6 * lane_len, 5 * lane_len, 4 * lane_len,
+                                              3 * lane_len, 2 * lane_len, lane_len, 0);
+    const __m512i ms = _mm512_set1_epi64(static_cast<long long>(mask_s));
+    const __m512i ml = _mm512_set1_epi64(static_cast<long long>(mask_l));
+    __m512i h = _mm512_setzero_si512();
+    __m512i bit = h, acc_s = h, acc_l = h;
+    
+    for (size_t k = 0; k < WINDOW; k += 8) {
+        __m512i off = _mm512_add_epi64(lane_off, _mm512_set1_epi64(k));
+        __m512i words = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xFF, off, base, 1);
+        gear_step8_avx512<false>(words, h, ms, ml, bit, acc_s, acc_l);
+    }
+    alignas(64) uint64_t out_s[LANES];
+    alignas(64) uint64_t out_l[LANES];
+    for (size_t w = 0; w < lane_words; ++w) {
+        bit = _mm512_set1_epi64(1);
+        acc_s = _mm512_setzero_si512();
+        acc_l = _mm512_setzero_si512();
+        for (size_t k = 0; k < 64; k += 8) {
+            __m512i off = _mm512_add_epi64(lane_off, _mm512_set1_epi64(WINDOW + w * 64 + k));
+            __m512i words = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xFF, off, base, 1);
+            gear_step8_avx512<true>(words, h, ms, ml, bit, acc_s, acc_l);
+        }
+        _mm512_store_si512(out_s, acc_s);
+        _mm512_store_si512(out_l, acc_l);
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            bits_s[lane * lane_words + w] = out_s[lane];
+            bits_l[lane * lane_words + w] = out_l[lane];
+        }
+    }
+}
+
+#endif // GEAR_X86_SIMD
+
+struct KernelEntry {
+    GearFn fn;
+    size_t lanes;
+};
+
+KernelEntry kernel_entry(GearKernel kernel) {
+    switch (kernel) {
+#ifdef GEAR_X86_SIMD
+        case GearKernel::AVX2:   return {gear_bitmaps_avx2, 4};
+        case GearKernel::AVX512: return {gear_bitmaps_avx512, 8};
+#endif
+        default:                 return {gear_bitmaps_scalar, 1};
+    }
+}
+
+GearKernel detect_best_kernel() {
+    for (GearKernel kernel : {GearKernel::AVX512, GearKernel::AVX2}) {
+        if (gear_kernel_supported(kernel)) {
+            return kernel;
+        }
+    }
+    return GearKernel::SCALAR;
+}
+
+std::atomic<GearKernel>& active_kernel() {
+    static std::atomic<GearKernel> kernel{detect_best_kernel()};
+    return kernel;
+}
+
+// 计算位置 [begin, begin + count) 的两张位图（begin 为64的倍数）：
+// 文件开头不足 64 字节预热的第一个字和无法凑满所有路的尾部由标量内核计算
+void compute_bitmaps(GearKernel kernel, const uint8_t* data, size_t begin, size_t count,
+                     uint64_t mask_s, uint64_t mask_l, uint64_t* bits_s, uint64_t* bits_l) {
+    KernelEntry entry = kernel_entry(kernel);
+    size_t done = 0;
+    if (entry.lanes > 1 && begin < WINDOW) {
+        done = std::min(count, WINDOW - begin);
+        gear_bitmaps_scalar(data, begin, done, mask_s, mask_l, bits_s, bits_l);
+    }
+    if (entry.lanes > 1) {
+        const size_t group = 64 * entry.lanes;
+        size_t vec = (count - done) / group * group;
+        if (vec > 0) {
+            entry.fn(data, begin + done, vec, mask_s, mask_l, bits_s + done / 64, bits_l + done / 64);
+            done += vec;
+        }
+    }
+    if (done < count) {
+        gear_bitmaps_scalar(data, begin + done, count - done, mask_s, mask_l, bits_s + done / 64, bits_l + done / 64);
+    }
+}
+
+// 位图中 [from, to) 内第一个置位的位置，没有时返回 to
+size_t find_first(const uint64_t* bits, size_t from, size_t to) {
+    size_t w = from / 64;
+    if (from >= to) {
+        return to;
+    }
+    uint64_t word = bits[w] & (~static_cast<uint64_t>(0) << (from % 64));
+    while (true) {
+        if (word != 0) {
+            size_t pos = w * 64 + static_cast<size_t>(__builtin_ctzll(word));
+            return std::min(pos, to);
+        }
+        if (++w * 64 >= to) {
+            return to;
+        }
+        word = bits[w];
+    }
+}
+
+} // namespace
+
+CdcChunker::CdcChunker(const ChunkingParams& params)
+    : params_(params), mask_small_(0), mask_large_(0) {
+    if (params_.avg_size >= MIN_AVG_SIZE) {
+        // 平均块长 2^bits：块长不足平均值时要求哈希最高 bits+2 位全为0，之后只要求最高 bits-2 位
+        int bits = 63 - __builtin_clzll(static_cast<unsigned long long>(params_.avg_size));
+        mask_small_ = ~static_cast<uint64_t>(0) << (64 - (bits + 2));
+        mask_large_ = ~static_cast<uint64_t>(0) << (64 - (bits - 2));
+    }
+}
+
+bool CdcChunker::is_valid() const {
+    return params_.min_size > 0 && params_.min_size <= params_.avg_size &&
+           params_.avg_size <= params_.max_size && params_.max_size <= MAX_CHUNK_SIZE &&
+           params_.avg_size >= MIN_AVG_SIZE;
+}
+
+const ChunkingParams& CdcChunker::params() const {
+    return params_;
+}
+
+int CdcChunker::split(const uint8_t* data, size_t len, std::vector<size_t>& chunk_ends) const {
+    return split_with(active_kernel().load(std::memory_order_relaxed), data, len, chunk_ends);
+}
+
+int CdcChunker::split_with(GearKernel kernel, const uint8_t* data, size_t len,
+                           std::vector<size_t>& chunk_ends) const {
+    chunk_ends.clear();
+    if (!is_valid() || !gear_kernel_supported(kernel)) {
+        return -1;
+    }
+    chunk_ends.reserve(len / params_.avg_size + 1);
+    
+    // 位图覆盖的位置区间 [base, base + avail)，段长至少比最大块长多一个预热窗口
+    const size_t region = std::max(REGION_BYTES, params_.max_size + 2 * WINDOW);
+    std::vector<uint64_t> bits_s(region / 64 + 1);
+    std::vector<uint64_t> bits_l(region / 64 + 1);
+    size_t base = 0;
+    size_t avail = 0;
+    
+    size_t start = 0;
+    while (start < len) {
+        const size_t remaining = len - start;
+        if (remaining <= params_.min_size) {
+            chunk_ends.push_back(len);
+            break;
+        }
+        // 块的最后一个字节为 p 时块长为 p - start + 1，候选位置 p 的范围为 [first, limit)
+        const size_t limit = start + std::min(params_.max_size, remaining);
+        const size_t first = start + params_.min_size - 1;
+        if (limit > base + avail) {
+            base = first & ~static_cast<size_t>(63);
+            avail = std::min(region, len - base);
+            compute_bitmaps(kernel, data, base, avail, mask_small_, mask_large_, bits_s.data(), bits_l.data());
+        }
+        
+        // 块长不到平均值时用难满足的掩码，之后用易满足的掩码，都不满足时在最大块长（或文件末尾）处切
+        const size_t normal = std::max(first, std::min(start + params_.avg_size - 1, limit));
+        size_t cut = find_first(bits_s.data(), first - base, normal - base) + base;
+        if (cut == normal) {
+            cut = find_first(bits_l.data(), normal - base, limit - base) + base;
+        }
+        size_t end = cut < limit ? cut + 1 : limit;
+        chunk_ends.push_back(end);
+        start = end;
+    }
+    return 0;
+}
+
+bool gear_kernel_supported(GearKernel kernel) {
+#ifdef GEAR_X86_SIMD
+    __builtin_cpu_init();
+    switch (kernel) {
+        case GearKernel::SCALAR: return true;
+        case GearKernel::AVX2:   return __builtin_cpu_supports("avx2");
+        case GearKernel::AVX512: return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#else
+    return kernel == GearKernel::SCALAR;
+#endif
+}
+
+GearKernel gear_active_kernel() {
+    return active_kernel().load(std::memory_order_relaxed);
+}
+
+int gear_set_active_kernel(GearKernel kernel) {
+    if (!gear_kernel_supported(kernel)) {
+        return -1;
+    }
+    active_kernel().store(kernel, std::memory_order_relaxed);
+    return 0;
+}
+
+const char* gear_kernel_name(GearKernel kernel) {
+    switch (kernel) {
+        case GearKernel::SCALAR: return "scalar";
+        case GearKernel::AVX2:   return "avx2";
+        case GearKernel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
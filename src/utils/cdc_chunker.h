@@ -0,0 +1,71 @@
+#ifndef CDC_CHUNKER_H
+#define CDC_CHUNKER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "../../include/config.h"
+
+// Gear 滚动哈希扫描内核的实现类型
+enum class GearKernel {
+    SCALAR,  // 逐字节滚动（所有平台可用）
+    AVX2,    // 4路并行（AVX2 gather）
+    AVX512   // 8路并行（AVX-512F gather）
+};
+
+// 内容定义分块的块长参数
+struct ChunkingParams {
+    size_t min_size = 256;                     // 最小块长
+    size_t avg_size = Config::BLOCK_SIZE;      // 期望平均块长（向下取整到2的幂）
+    size_t max_size = Config::BLOCK_SIZE * 4;  // 最大块长
+};
+
+// FastCDC 风格的内容定义分块（CDC）
+// 切点由 Gear 滚动哈希决定：位置 p 的哈希只取决于 p 及其之前共 64 字节的内容，
+// 在文件中插入/删除数据只影响附近的切点，之后的块边界重新对齐，跨版本的相同内容得到相同的块；
+// 固定大小分块在插入一个字节后所有后续块都会改变。
+// 归一化分块：块长不到平均值时使用更难满足的掩码，超过平均值后使用更容易满足的掩码，块长集中在平均值附近。
+// 扫描和选切点分两步：先由向量内核把一段数据分成多路并行计算每个位置是否满足两个掩码（得到两张位图，
+// 每路先用前 64 字节预热，结果与逐字节计算完全一致），再顺序在位图上按块长规则选切点。
+class CdcChunker {
+public:
+    // 构造函数
+    explicit CdcChunker(const ChunkingParams& params = ChunkingParams());
+    
+    // 析构函数
+    ~CdcChunker() = default;
+    
+    // 参数是否有效：0 < min_size <= avg_size <= max_size <= MAX_CHUNK_SIZE，且 avg_size >= MIN_AVG_SIZE
+    bool is_valid() const;
+    
+    // 切分 data[0, len)，chunk_ends 输出各块的结束偏移（递增，最后一个等于 len；空输入输出为空）
+    // 除最后一块外块长都在 [min_size, max_size] 内。参数无效时返回-1
+    int split(const uint8_t* data, size_t len, std::vector<size_t>& chunk_ends) const;
+    
+    // 使用指定内核切分（测试/基准用，结果与 split 相同），当前CPU不支持该内核时返回-1
+    int split_with(GearKernel kernel, const uint8_t* data, size_t len, std::vector<size_t>& chunk_ends) const;
+    
+    const ChunkingParams& params() const;
+    
+    static constexpr size_t MIN_AVG_SIZE = 64;
+    static constexpr size_t MAX_CHUNK_SIZE = static_cast<size_t>(1) << 20;
+
+private:
+    ChunkingParams params_;
+    uint64_t mask_small_;  // 块长小于平均值时的切点掩码（位数多，难满足）
+    uint64_t mask_large_;  // 块长达到平均值后的切点掩码（位数少，易满足；是 mask_small_ 的子集）
+};
+
+// 当前CPU是否支持指定内核
+bool gear_kernel_supported(GearKernel kernel);
+
+// 当前 CdcChunker::split 使用的内核
+GearKernel gear_active_kernel();
+
+// 强制 CdcChunker::split 使用指定内核（基准对比用），不支持时返回-1且不做修改
+int gear_set_active_kernel(GearKernel kernel);
+
+// 内核名称（用于日志/基准输出）
+const char* gear_kernel_name(GearKernel kernel);
+
+#endif // CDC_CHUNKER_H
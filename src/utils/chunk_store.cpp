@@ -0,0 +1,83 @@
+#include "chunk_store.h"
+#include "siphash.h"
+#include <mutex>
+
+size_t ChunkStore::LeafHasher::operator()(const std::array<uint8_t, 32>& leaf) const {
+    // 叶子由上传的块内容决定，可被构造成前若干字节相同：用带进程随机密钥的 SipHash 选桶
+    return static_cast<size_t>(keyed_hash(leaf.data(), leaf.size()));
+}
+
+int ChunkStore::acquire(const EncryptedBlockView& chunk, const std::array<uint8_t, 32>& leaf,
+                        uint32_t& id, bool* added) {
+    if (chunk.ciphertext_size > MAX_CHUNK_SIZE) {
+        return -1;
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = index_.find(leaf);
+    const bool found = it != index_.end();
+    if (found) {
+        id = it->second;
+        ++refs_[id];
+    } else {
+        if (free_ids_.empty()) {
+            id = static_cast<uint32_t>(chunks_.size());
+            chunks_.push_back(chunk.to_block());
+            leaves_.push_back(leaf);
+            refs_.push_back(1);
+        } else {
+            id = free_ids_.back();
+            free_ids_.pop_back();
+            chunks_[id] = chunk.to_block();
+            leaves_[id] = leaf;
+            refs_[id] = 1;
+        }
+        index_.emplace(leaf, id);
+        stored_bytes_ += chunk.ciphertext_size;
+    }
+    logical_bytes_ += chunk.ciphertext_size;
+    ++references_;
+    if (added) {
+        *added = !found;
+    }
+    return 0;
+}
+
+void ChunkStore::release(uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (id >= refs_.size() || refs_[id] == 0) {
+        return;
+    }
+    
+    const size_t size = chunks_[id].ciphertext.size();
+    logical_bytes_ -= size;
+    --references_;
+    if (--refs_[id] == 0) {
+        index_.erase(leaves_[id]);
+        stored_bytes_ -= size;
+        chunks_[id] = EncryptedBlock();
+        free_ids_.push_back(id);
+    }
+}
+
+EncryptedBlockView ChunkStore::chunk(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return EncryptedBlockView(chunks_[id]);
+}
+
+void ChunkStore::get_leaves(const uint32_t* ids, size_t count, std::array<uint8_t, 32>* out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = leaves_[ids[i]];
+    }
+}
+
+ChunkStore::Stats ChunkStore::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    Stats s;
+    s.unique_chunks = index_.size();
+    s.references = references_;
+    s.stored_bytes = stored_bytes_;
+    s.logical_bytes = logical_bytes_;
+    return s;
+}
@@ -0,0 +1,72 @@
+#ifndef CHUNK_STORE_H
+#define CHUNK_STORE_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <shared_mutex>
+#include <unordered_map>
+#include "../../include/common_type.h"
+#include "encrypted_block_set.h"
+
+// 去重的加密块存储：内容相同的加密块（按叶子哈希识别）只保存一份，按引用计数管理。
+// 配合内容定义分块和收敛加密（见 ParallelBlockEncryptor::encrypt_chunks）使用时，
+// 同一文件的多个版本、或同一所有者的多个文件中未改动的块只占一份空间。
+// 多个 StorageNode 可以共享同一个实例（见 StorageNode::use_chunk_store），所有接口线程安全。
+// 每块单独保存（不按最大块长预留槽位），块地址在其引用计数归零前不变。
+class ChunkStore {
+public:
+    // 构造函数
+    ChunkStore() = default;
+    
+    // 析构函数
+    ~ChunkStore() = default;
+    
+    ChunkStore(const ChunkStore&) = delete;
+    ChunkStore& operator=(const ChunkStore&) = delete;
+    
+    // 引用一块：已保存相同的块时只增加引用计数，否则复制保存
+    // leaf: 该块的叶子哈希（调用方计算），id: 输出块编号，added: 非空时输出是否新保存了这块
+    // 密文超过 MAX_CHUNK_SIZE 时返回-1
+    int acquire(const EncryptedBlockView& chunk, const std::array<uint8_t, 32>& leaf,
+                uint32_t& id, bool* added = nullptr);
+    
+    // 释放一次引用，引用计数归零时删除该块（编号之后可能被复用）
+    void release(uint32_t id);
+    
+    // 第 id 块的视图（不检查编号），在该块的引用被全部释放前有效
+    EncryptedBlockView chunk(uint32_t id) const;
+    
+    // 批量读取叶子哈希：out[i] 为第 ids[i] 块的叶子哈希（保存时已记录，不重新计算）
+    void get_leaves(const uint32_t* ids, size_t count, std::array<uint8_t, 32>* out) const;
+    
+    // 去重统计
+    struct Stats {
+        size_t unique_chunks = 0;   // 当前保存的不同块数
+        size_t references = 0;      // 所有引用数（去重前的块数）
+        uint64_t stored_bytes = 0;  // 实际保存的密文字节数
+        uint64_t logical_bytes = 0; // 去重前的密文字节数
+    };
+    Stats stats() const;
+    
+    static constexpr size_t MAX_CHUNK_SIZE = static_cast<size_t>(1) << 20;
+
+private:
+    struct LeafHasher {
+        size_t operator()(const std::array<uint8_t, 32>& leaf) const;
+    };
+    
+    mutable std::shared_mutex mutex_;
+    std::deque<EncryptedBlock> chunks_;               // 按编号存放（deque 追加时已有元素地址不变）
+    std::vector<std::array<uint8_t, 32>> leaves_;     // 各块叶子哈希
+    std::vector<uint32_t> refs_;                      // 各块引用计数（0 表示空闲编号）
+    std::vector<uint32_t> free_ids_;                  // 可复用的空闲编号
+    std::unordered_map<std::array<uint8_t, 32>, uint32_t, LeafHasher> index_;  // 叶子哈希 -> 编号
+    uint64_t stored_bytes_ = 0;
+    uint64_t logical_bytes_ = 0;
+    size_t references_ = 0;
+};
+
+#endif // CHUNK_STORE_H
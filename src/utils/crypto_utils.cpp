@@ -1,8 +1,12 @@
 #include "crypto_utils.h"
+#include "hash_engine.h"
+#include "sha256_multi.h"
 #include <openssl/evp.h>
 #include <openssl/aes.h>
 #include <openssl/sha.h>
+#include <openssl/crypto.h>
 #include <cstring>
+#include <algorithm>
 #include <iostream>
 #include "../../include/common_type.h"
 
@@ -77,53 +81,155 @@ int aes_gcm_decrypt(const std::array<uint8_t, 32>& key,
 //     SHA256_Final(hash_out.data(), &ctx);
 // }
 void sha256_hash(const uint8_t* data, size_t len, std::array<unsigned char, 32>& hash_out) {
-    // 1. 创建并初始化哈希上下文
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    if (!ctx) {
-        std::cerr << "SHA256 上下文创建失败" << std::endl;
-        return;
+    // 使用线程局部的摘要引擎（复用上下文和预获取的算法对象）
+    if (HashEngine::local(HashAlgorithm::SHA256).digest(data, len, hash_out) != 0) {
+        std::cerr << "SHA256 计算失败" << std::endl;
     }
+}
 
-    // 2. 初始化 SHA256 哈希（使用默认 provider）
-    if (EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr) != 1) {
-        std::cerr << "SHA256 初始化失败" << std::endl;
-        EVP_MD_CTX_free(ctx);
-        return;
+void sha3_256_hash(const uint8_t* data, size_t len, std::array<uint8_t, 32>& hash_out) {
+    if (HashEngine::local(HashAlgorithm::SHA3_256).digest(data, len, hash_out) != 0) {
+        std::cerr << "SHA3-256 计算失败" << std::endl;
     }
+}
 
-    // 3. 传入数据计算哈希
-    if (EVP_DigestUpdate(ctx, data, len) != 1) {
-        std::cerr << "SHA256 数据更新失败" << std::endl;
-        EVP_MD_CTX_free(ctx);
-        return;
+void hash_proof_package(const ProofPackage& proof, std::array<uint8_t, 32>& hash_out) {
+    // 定长部分：time_slot_id(8) || prev_hash(32) || rep_snapshot(8) || t_slot(4) || random_r(32) ||
+    //           challenge_idx(4) || merkle_path 长度(8)，之后是路径内容，最后 enclave_sig(64) || t_start(8) || sig_scheme(1)
+    uint8_t head[8 + 32 + 8 + 4 + 32 + 4 + 8];
+    uint8_t tail[64 + 8 + 1];
+    auto put_le = [](uint8_t* out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    };
+    uint64_t rep_bits;
+    memcpy(&rep_bits, &proof.rep_snapshot, sizeof(rep_bits));
+    
+    uint8_t* p = head;
+    put_le(p, proof.time_slot_id, 8);
+    p += 8;
+    memcpy(p, proof.prev_hash.data(), 32);
+    p += 32;
+    put_le(p, rep_bits, 8);
+    p += 8;
+    put_le(p, proof.t_slot, 4);
+    p += 4;
+    memcpy(p, proof.random_r.data(), 32);
+    p += 32;
+    put_le(p, proof.challenge_idx, 4);
+    p += 4;
+    put_le(p, proof.merkle_path.size(), 8);
+    
+    memcpy(tail, proof.enclave_sig.data(), 64);
+    put_le(tail + 64, proof.t_start, 8);
+    tail[72] = static_cast<uint8_t>(proof.sig_scheme);
+    
+    HashEngine& engine = HashEngine::local(HashAlgorithm::SHA3_256);
+    if (engine.init() != 0 || engine.update(head, sizeof(head)) != 0 ||
+        engine.update(proof.merkle_path.data(), proof.merkle_path.size()) != 0 ||
+        engine.update(tail, sizeof(tail)) != 0 || engine.final(hash_out) != 0) {
+        std::cerr << "SHA3-256 计算失败" << std::endl;
     }
+}
 
-    // 4. 获取最终哈希结果（len 会自动设为 32）
-    unsigned int hash_len;
-    if (EVP_DigestFinal_ex(ctx, hash_out.data(), &hash_len) != 1) {
-        std::cerr << "SHA256 结果获取失败" << std::endl;
+int hmac_sha256(const std::array<uint8_t, 32>& key, const uint8_t* data, size_t len,
+                std::array<uint8_t, 32>& mac_out) {
+    // HMAC(K, m) = H((K ^ opad) || H((K ^ ipad) || m))，密钥不超过分组长度（64字节）时右侧补0
+    std::array<uint8_t, 64> ipad;
+    std::array<uint8_t, 64> opad;
+    ipad.fill(0x36);
+    opad.fill(0x5c);
+    for (size_t i = 0; i < key.size(); ++i) {
+        ipad[i] ^= key[i];
+        opad[i] ^= key[i];
+    }
+    
+    // 使用 HMAC 专用的线程局部引擎，不打断调用方在 HashEngine::local 上进行中的增量摘要
+    thread_local HashEngine engine(HashAlgorithm::SHA256);
+    std::array<uint8_t, 32> inner;
+    int ret = 0;
+    if (engine.init() != 0 || engine.update(ipad.data(), ipad.size()) != 0 ||
+        engine.update(data, len) != 0 || engine.final(inner) != 0 ||
+        engine.init() != 0 || engine.update(opad.data(), opad.size()) != 0 ||
+        engine.update(inner.data(), inner.size()) != 0 || engine.final(mac_out) != 0) {
+        ret = -1;
     }
+    // 由密钥派生的填充块和内层摘要用完即清除
+    OPENSSL_cleanse(ipad.data(), ipad.size());
+    OPENSSL_cleanse(opad.data(), opad.size());
+    OPENSSL_cleanse(inner.data(), inner.size());
+    return ret;
+}
 
-    // 5. 释放上下文（避免内存泄漏）
-    EVP_MD_CTX_free(ctx);
+std::array<uint8_t, 32> hash_encrypted_block(const EncryptedBlock& block) {
+    return hash_encrypted_block(EncryptedBlockView(block));
 }
 
-void sha3_256_hash(const uint8_t* data, size_t len, std::array<uint8_t, 32>& hash_out) {
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    EVP_DigestInit_ex(ctx, EVP_sha3_256(), nullptr);
-    EVP_DigestUpdate(ctx, data, len);
-    EVP_DigestFinal_ex(ctx, hash_out.data(), nullptr);
-    EVP_MD_CTX_free(ctx);
+namespace {
+
+// IV、密文、认证标签依次送入摘要引擎（与拼接后一次性哈希的结果相同）
+int digest_encrypted_block(HashEngine& engine, const EncryptedBlockView& block,
+                           std::array<uint8_t, 32>& hash_out) {
+    if (engine.init() != 0 ||
+        engine.update(block.iv->data(), block.iv->size()) != 0 ||
+        engine.update(block.ciphertext, block.ciphertext_size) != 0 ||
+        engine.update(block.auth_tag->data(), block.auth_tag->size()) != 0) {
+        return -1;
+    }
+    return engine.final(hash_out);
 }
 
-std::array<uint8_t, 32> hash_encrypted_block(const EncryptedBlock& block) {
-    std::vector<uint8_t> data;
-    // 合并IV、密文和认证标签进行哈希
-    data.insert(data.end(), block.iv.begin(), block.iv.end());
-    data.insert(data.end(), block.ciphertext.begin(), block.ciphertext.end());
-    data.insert(data.end(), block.auth_tag.begin(), block.auth_tag.end());
-    
+// 批量哈希：每批最多 HASH_BATCH 块组装成分段消息（IV || 密文 || 认证标签，不复制数据），
+// 交给多路SHA-256内核（满块的加密块长度相同，可以按路数并行计算）
+constexpr size_t HASH_BATCH = 64;
+
+template <typename Blocks>
+int hash_blocks_batched(const Blocks& blocks, size_t first, size_t count,
+                        std::array<uint8_t, 32>* out) {
+    if (first > blocks.size() || count > blocks.size() - first) {
+        return -1;
+    }
+    static_assert(sizeof(std::array<uint8_t, 32>) == 32, "哈希输出必须连续存放");
+    Sha256Segments msgs[HASH_BATCH];
+    for (size_t done = 0; done < count; done += HASH_BATCH) {
+        size_t n = std::min(HASH_BATCH, count - done);
+        for (size_t i = 0; i < n; ++i) {
+            EncryptedBlockView block(blocks[first + done + i]);
+            msgs[i] = {{block.iv->data(), block.ciphertext, block.auth_tag->data()},
+                       {block.iv->size(), block.ciphertext_size, block.auth_tag->size()}};
+        }
+        sha256_segments_x_n(msgs, n, out[done].data());
+    }
+    return 0;
+}
+
+} // namespace
+
+std::array<uint8_t, 32> hash_encrypted_block(const EncryptedBlockView& block) {
     std::array<uint8_t, 32> hash;
-    sha256_hash(data.data(), data.size(), hash);
+    if (digest_encrypted_block(HashEngine::local(HashAlgorithm::SHA256), block, hash) != 0) {
+        std::cerr << "数据块哈希计算失败" << std::endl;
+    }
     return hash;
 }
+
+int hash_encrypted_blocks(const EncryptedBlockView* blocks, size_t count, std::array<uint8_t, 32>* out) {
+    struct ViewArray {
+        const EncryptedBlockView* views;
+        size_t count;
+        size_t size() const { return count; }
+        const EncryptedBlockView& operator[](size_t i) const { return views[i]; }
+    };
+    return hash_blocks_batched(ViewArray{blocks, count}, 0, count, out);
+}
+
+int hash_encrypted_blocks(const EncryptedBlockSet& blocks, size_t first, size_t count,
+                          std::array<uint8_t, 32>* out) {
+    return hash_blocks_batched(blocks, first, count, out);
+}
+
+int hash_encrypted_blocks(const std::vector<EncryptedBlock>& blocks, size_t first, size_t count,
+                          std::array<uint8_t, 32>* out) {
+    return hash_blocks_batched(blocks, first, count, out);
+}
@@ -5,6 +5,7 @@
 #include <array>
 #include <cstdint>
 #include "D:\Code\C\tee_sim_proof_project\include\common_type.h"
+#include "encrypted_block_set.h"
 
 // AES-GCM加密（方案：数据块加密）
 int aes_gcm_encrypt(const std::array<uint8_t, 32>& key, // 256位密钥
@@ -20,13 +21,34 @@ int aes_gcm_decrypt(const std::array<uint8_t, 32>& key,
                     const std::array<uint8_t, 16>& auth_tag,
                     std::vector<uint8_t>& plaintext);
 
-// SHA-256哈希
+// SHA-256哈希（内部复用线程局部的 HashEngine，线程安全）
 void sha256_hash(const uint8_t* data, size_t len, std::array<uint8_t, 32>& hash_out);
 
 // SHA3-256哈希（用于链式指针）
 void sha3_256_hash(const uint8_t* data, size_t len, std::array<uint8_t, 32>& hash_out);
 
-// 计算数据块的哈希（用于Merkle树叶子）
+// 证明包哈希（链式指针、分段凭证的叶子和锚点）：SHA3-256(规范序列化)
+// 各定长字段按小端序依次写入，Merkle路径写入长度（8字节）和内容，不含对象内存中的指针和填充字节
+void hash_proof_package(const ProofPackage& proof, std::array<uint8_t, 32>& hash_out);
+
+// HMAC-SHA256（同样复用线程局部的 HashEngine，线程安全），成功返回0，失败返回-1
+int hmac_sha256(const std::array<uint8_t, 32>& key, const uint8_t* data, size_t len,
+                std::array<uint8_t, 32>& mac_out);
+
+// 计算数据块的哈希（用于Merkle树叶子）：SHA-256(IV || 密文 || 认证标签)
+// 三个字段依次送入线程局部的增量摘要引擎，不拼接临时缓冲区
 std::array<uint8_t, 32> hash_encrypted_block(const EncryptedBlock& block);
+std::array<uint8_t, 32> hash_encrypted_block(const EncryptedBlockView& block);
+
+// 批量计算 blocks[first, first + count) 的叶子哈希，第 i 块写入 out[i]
+// 建树时的热点路径：各字段直接作为分段消息交给多路SHA-256内核（长度相同的块按路数并行计算），
+// 结果与逐块 hash_encrypted_block 一致。成功返回0，失败返回-1
+int hash_encrypted_blocks(const EncryptedBlockSet& blocks, size_t first, size_t count,
+                          std::array<uint8_t, 32>* out);
+int hash_encrypted_blocks(const std::vector<EncryptedBlock>& blocks, size_t first, size_t count,
+                          std::array<uint8_t, 32>* out);
+
+// 批量计算 count 个块视图的叶子哈希（其他容器可先收集视图再调用）
+int hash_encrypted_blocks(const EncryptedBlockView* blocks, size_t count, std::array<uint8_t, 32>* out);
 
 #endif // CRYPTO_UTILS_H
@@ -0,0 +1,280 @@
+#include "disk_merkle_tree.h"
+#include "sha256_multi.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(DiskMerkleHeader) == 64, "磁盘Merkle树文件头必须为64字节");
+
+namespace {
+
+const uint8_t DISK_MERKLE_MAGIC[8] = {'T', 'E', 'E', 'M', 'R', 'K', 'L', '\0'};
+const uint32_t DISK_MERKLE_VERSION = 1;
+const uint64_t HEADER_SIZE = sizeof(DiskMerkleHeader);
+
+// 流式写入/构建时每次读写的节点数（偶数，1 MB）
+const size_t CHUNK_NODES = static_cast<size_t>(1) << 15;
+
+// 根据叶子数计算各层大小（叶子层→根）
+std::vector<size_t> level_sizes(uint64_t leaf_count) {
+    std::vector<size_t> sizes(1, static_cast<size_t>(leaf_count));
+    while (sizes.back() > 1) {
+        sizes.push_back((sizes.back() + 1) / 2);
+    }
+    return sizes;
+}
+
+} // namespace
+
+// ==================== DiskMerkleTreeWriter ====================
+
+DiskMerkleTreeWriter::~DiskMerkleTreeWriter() {
+    abort();
+}
+
+void DiskMerkleTreeWriter::abort() {
+    if (file_.is_open()) {
+        file_.close();
+        std::remove((path_ + ".tmp").c_str());
+    }
+    pending_.clear();
+    leaf_count_ = 0;
+}
+
+int DiskMerkleTreeWriter::open(const std::string& path) {
+    abort();
+    path_ = path;
+    if (file_.open(path_ + ".tmp", true, true, true) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int DiskMerkleTreeWriter::flush_pending() {
+    if (pending_.empty()) {
+        return 0;
+    }
+    uint64_t offset = HEADER_SIZE + (leaf_count_ - pending_.size()) * 32;
+    if (file_.write_at(offset, pending_.data(), pending_.size() * 32) != 0) {
+        std::cerr << "[错误] 写入Merkle树叶子失败" << std::endl;
+        return -1;
+    }
+    pending_.clear();
+    return 0;
+}
+
+int DiskMerkleTreeWriter::append_leaf(const std::array<uint8_t, 32>& leaf_hash) {
+    return append_leaves(&leaf_hash, 1);
+}
+
+int DiskMerkleTreeWriter::append_leaves(const std::array<uint8_t, 32>* leaf_hashes, size_t count) {
+    if (!file_.is_open()) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pending_.push_back(leaf_hashes[i]);
+        ++leaf_count_;
+        if (pending_.size() == CHUNK_NODES && flush_pending() != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int DiskMerkleTreeWriter::finish(std::array<uint8_t, 32>* root) {
+    if (!file_.is_open() || leaf_count_ == 0 || flush_pending() != 0) {
+        abort();
+        return -1;
+    }
+    
+    // 逐层构建：分块读回上一层，两两批量哈希后追加写出下一层
+    std::vector<size_t> sizes = level_sizes(leaf_count_);
+    // 缓冲区按叶子数裁剪，小树不必分配整块
+    const size_t chunk = std::min<size_t>(CHUNK_NODES, static_cast<size_t>(leaf_count_) + 1);
+    std::vector<std::array<uint8_t, 32>> in(chunk);
+    std::vector<std::array<uint8_t, 32>> out(chunk / 2 + 1);
+    uint64_t prev_start = 0;
+    for (size_t level = 0; level + 1 < sizes.size(); ++level) {
+        uint64_t curr_start = prev_start + sizes[level];
+        for (size_t first = 0; first < sizes[level]; first += CHUNK_NODES) {
+            size_t n = std::min(CHUNK_NODES, sizes[level] - first);
+            if (file_.read_at(HEADER_SIZE + (prev_start + first) * 32, in.data(), n * 32) != 0) {
+                abort();
+                return -1;
+            }
+            // 奇数节点：复制自身（补全），只可能出现在整层的最后一块
+            if (n % 2 == 1) {
+                in[n] = in[n - 1];
+                ++n;
+            }
+            sha256_64x_n(in[0].data(), n / 2, out[0].data());
+            if (file_.write_at(HEADER_SIZE + (curr_start + first / 2) * 32, out.data(), n / 2 * 32) != 0) {
+                abort();
+                return -1;
+            }
+        }
+        prev_start = curr_start;
+    }
+    
+    DiskMerkleHeader header = {};
+    memcpy(header.magic, DISK_MERKLE_MAGIC, sizeof(header.magic));
+    header.version = DISK_MERKLE_VERSION;
+    header.hash_size = 32;
+    header.leaf_count = leaf_count_;
+    header.level_count = static_cast<uint32_t>(sizes.size());
+    if (file_.read_at(HEADER_SIZE + prev_start * 32, header.root, 32) != 0 ||
+        file_.write_at(0, &header, sizeof(header)) != 0 || (sync_ && file_.sync() != 0)) {
+        abort();
+        return -1;
+    }
+    file_.close();
+    
+    if (replace_file(path_ + ".tmp", path_) != 0) {
+        std::cerr << "[错误] 替换Merkle树文件失败：" << path_ << std::endl;
+        std::remove((path_ + ".tmp").c_str());
+        return -1;
+    }
+    if (root != nullptr) {
+        memcpy(root->data(), header.root, 32);
+    }
+    leaf_count_ = 0;
+    return 0;
+}
+
+void DiskMerkleTreeWriter::set_sync(bool sync) {
+    sync_ = sync;
+}
+
+int DiskMerkleTreeWriter::write(const std::string& path, const MerkleTree& tree, bool sync) {
+    DiskMerkleTreeWriter writer;
+    writer.set_sync(sync);
+    if (writer.open(path) != 0) {
+        return -1;
+    }
+    std::array<uint8_t, 32> leaf;
+    for (size_t i = 0; i < tree.leaf_count(); ++i) {
+        if (!tree.get_leaf(i, leaf) || writer.append_leaf(leaf) != 0) {
+            return -1;
+        }
+    }
+    return writer.finish();
+}
+
+// ==================== DiskMerkleTree ====================
+
+int DiskMerkleTree::open(const std::string& path, size_t pinned_levels) {
+    close();
+    if (mapped_.open(path) != 0) {
+        return -1;
+    }
+    
+    // 校验文件头
+    DiskMerkleHeader header;
+    if (mapped_.size() < HEADER_SIZE) {
+        close();
+        return -1;
+    }
+    memcpy(&header, mapped_.data(), sizeof(header));
+    if (memcmp(header.magic, DISK_MERKLE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DISK_MERKLE_VERSION || header.hash_size != 32 || header.leaf_count == 0 ||
+        header.leaf_count > (mapped_.size() - HEADER_SIZE) / 32) {
+        std::cerr << "[错误] Merkle树文件格式无效：" << path << std::endl;
+        close();
+        return -1;
+    }
+    
+    level_size_ = level_sizes(header.leaf_count);
+    level_start_.assign(1, 0);
+    for (size_t level = 0; level + 1 < level_size_.size(); ++level) {
+        level_start_.push_back(level_start_.back() + level_size_[level]);
+    }
+    uint64_t total_nodes = level_start_.back() + level_size_.back();
+    // 叶子数已受文件大小约束；用除法比较，不会因篡改的叶子数溢出
+    const uint64_t node_bytes = mapped_.size() - HEADER_SIZE;
+    if (header.level_count != level_size_.size() || node_bytes % 32 != 0 || node_bytes / 32 != total_nodes ||
+        memcmp(header.root, mapped_.data() + HEADER_SIZE + level_start_.back() * 32, 32) != 0) {
+        std::cerr << "[错误] Merkle树文件已损坏：" << path << std::endl;
+        close();
+        return -1;
+    }
+    leaf_count_ = static_cast<size_t>(header.leaf_count);
+    memcpy(root_.data(), header.root, 32);
+    
+    // 复制顶部若干层到内存；其余层按随机访问模式映射，只在取证明时缺页
+    size_t pinned = std::min(pinned_levels, level_size_.size());
+    first_pinned_level_ = level_size_.size() - pinned;
+    pinned_start_.clear();
+    size_t pinned_nodes = 0;
+    for (size_t level = first_pinned_level_; level < level_size_.size(); ++level) {
+        pinned_start_.push_back(pinned_nodes);
+        pinned_nodes += level_size_[level];
+    }
+    pinned_.resize(pinned_nodes);
+    if (pinned_nodes > 0) {
+        memcpy(pinned_.data(), mapped_.data() + HEADER_SIZE + level_start_[first_pinned_level_] * 32,
+               pinned_nodes * 32);
+    }
+    mapped_.advise_random();
+    return 0;
+}
+
+void DiskMerkleTree::close() {
+    mapped_.close();
+    leaf_count_ = 0;
+    root_.fill(0);
+    level_start_.clear();
+    level_size_.clear();
+    pinned_start_.clear();
+    pinned_.clear();
+    first_pinned_level_ = 0;
+}
+
+bool DiskMerkleTree::is_open() const {
+    return mapped_.is_open();
+}
+
+size_t DiskMerkleTree::leaf_count() const {
+    return leaf_count_;
+}
+
+std::array<uint8_t, 32> DiskMerkleTree::get_root() const {
+    return root_;
+}
+
+const uint8_t* DiskMerkleTree::node(size_t level, size_t idx) const {
+    if (level >= first_pinned_level_) {
+        return pinned_[pinned_start_[level - first_pinned_level_] + idx].data();
+    }
+    return mapped_.data() + HEADER_SIZE + (level_start_[level] + idx) * 32;
+}
+
+bool DiskMerkleTree::get_leaf(size_t leaf_idx, std::array<uint8_t, 32>& leaf_hash) const {
+    if (leaf_idx >= leaf_count_) {
+        return false;
+    }
+    memcpy(leaf_hash.data(), node(0, leaf_idx), 32);
+    return true;
+}
+
+bool DiskMerkleTree::get_proof(size_t leaf_idx, std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path) const {
+    path.clear();
+    if (leaf_idx >= leaf_count_) {
+        return false;
+    }
+    
+    size_t current_idx = leaf_idx;
+    for (size_t level = 0; level + 1 < level_size_.size(); ++level) {
+        size_t sibling_idx = current_idx ^ 1;
+        std::array<uint8_t, 32> sibling;
+        if (sibling_idx < level_size_[level]) {
+            memcpy(sibling.data(), node(level, sibling_idx), 32);
+            path.emplace_back(sibling, current_idx % 2 == 0);
+        } else {
+            // 没有兄弟节点，使用当前节点作为兄弟（补全情况）
+            memcpy(sibling.data(), node(level, current_idx), 32);
+            path.emplace_back(sibling, true);
+        }
+        current_idx /= 2;
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef DISK_MERKLE_TREE_H
+#define DISK_MERKLE_TREE_H
+
+#include <vector>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "file_io.h"
+#include "merkle_tree.h"
+
+// 磁盘 Merkle 树文件格式（所有整数按小端存放）：
+//   [0, 64)   文件头 DiskMerkleHeader
+//   [64, ...) 各层节点，按 叶子层→根 的顺序紧密排列（与 MerkleTree 的内存布局一致），
+//             每个节点 32 字节，奇数层末尾节点与自身配对（补全规则与 MerkleTree 相同）
+struct DiskMerkleHeader {
+    uint8_t magic[8];        // "TEEMRKL\0"
+    uint32_t version;        // 格式版本（当前为1）
+    uint32_t hash_size;      // 节点哈希长度（32）
+    uint64_t leaf_count;     // 叶子数量
+    uint32_t level_count;    // 层数（含叶子层和根）
+    uint32_t reserved;       // 保留（0）
+    uint8_t root[32];        // Merkle根（冗余存放，打开时与根节点比对）
+};
+
+// 流式写入磁盘 Merkle 树：叶子逐块写入文件，finish 时按层从文件读回上一层、
+// 批量哈希后写出下一层，内存占用与叶子数无关。
+// 写入过程在临时文件（path + ".tmp"）中进行，finish 成功后原子替换目标文件，
+// 中途崩溃不会留下不完整的树文件。
+class DiskMerkleTreeWriter {
+public:
+    // 构造函数
+    DiskMerkleTreeWriter() = default;
+    
+    // 析构函数：未 finish 的写入会被丢弃
+    ~DiskMerkleTreeWriter();
+    
+    DiskMerkleTreeWriter(const DiskMerkleTreeWriter&) = delete;
+    DiskMerkleTreeWriter& operator=(const DiskMerkleTreeWriter&) = delete;
+    
+    // 开始写入 path
+    int open(const std::string& path);
+    
+    // 追加叶子哈希
+    int append_leaf(const std::array<uint8_t, 32>& leaf_hash);
+    int append_leaves(const std::array<uint8_t, 32>* leaf_hashes, size_t count);
+    
+    // 构建上层节点、写入文件头并落盘；root 非空时输出Merkle根
+    int finish(std::array<uint8_t, 32>* root = nullptr);
+    
+    // finish 时是否 fsync（默认是；可随时从数据块重建的缓存文件可以关闭，只保留原子替换）
+    void set_sync(bool sync);
+    
+    // 将内存中的 MerkleTree 写为磁盘格式
+    static int write(const std::string& path, const MerkleTree& tree, bool sync = true);
+
+private:
+    RandomAccessFile file_;
+    std::string path_;
+    uint64_t leaf_count_ = 0;
+    std::vector<std::array<uint8_t, 32>> pending_; // 尚未写入文件的叶子
+    bool sync_ = true;
+    
+    int flush_pending();
+    void abort();
+};
+
+// 只读磁盘 Merkle 树：文件以只读方式映射，get_proof 只触碰路径上的 O(log n) 个节点所在页；
+// 顶部 pinned_levels 层在打开时复制到内存常驻，避免每次证明都访问这些热点页。
+// 打开只需校验文件头并复制顶部几层，与树的大小基本无关。
+class DiskMerkleTree {
+public:
+    // 构造函数
+    DiskMerkleTree() = default;
+    
+    // 析构函数
+    ~DiskMerkleTree() = default;
+    
+    DiskMerkleTree(const DiskMerkleTree&) = delete;
+    DiskMerkleTree& operator=(const DiskMerkleTree&) = delete;
+    
+    // 打开树文件（pinned_levels：常驻内存的顶部层数，包含根所在层）
+    int open(const std::string& path, size_t pinned_levels = DEFAULT_PINNED_LEVELS);
+    void close();
+    bool is_open() const;
+    
+    // 叶子数量 / Merkle根
+    size_t leaf_count() const;
+    std::array<uint8_t, 32> get_root() const;
+    
+    // 获取指定叶子的哈希（越界时返回false）
+    bool get_leaf(size_t leaf_idx, std::array<uint8_t, 32>& leaf_hash) const;
+    
+    // 获取指定叶子的Merkle路径（格式与 MerkleTree::get_proof 相同，可用 MerkleTree::verify_proof 验证）
+    bool get_proof(size_t leaf_idx, std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path) const;
+    
+    // 默认常驻内存的顶部层数（2^16 个节点，约 2 MB）
+    static constexpr size_t DEFAULT_PINNED_LEVELS = 17;
+
+private:
+    MappedFile mapped_;
+    size_t leaf_count_ = 0;
+    std::array<uint8_t, 32> root_{};
+    std::vector<uint64_t> level_start_;  // 各层第一个节点在文件中的节点下标（不含文件头）
+    std::vector<size_t> level_size_;     // 各层节点数
+    size_t first_pinned_level_ = 0;      // 该层及以上的层常驻内存
+    std::vector<size_t> pinned_start_;   // 常驻层在 pinned_ 中的起始下标
+    MerkleTree::NodeBuffer pinned_;      // 常驻内存的顶部节点
+    
+    const uint8_t* node(size_t level, size_t idx) const;
+};
+
+#endif // DISK_MERKLE_TREE_H
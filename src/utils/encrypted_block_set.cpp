@@ -0,0 +1,122 @@
+#include "encrypted_block_set.h"
+#include <algorithm>
+#include <limits>
+
+EncryptedBlockView::EncryptedBlockView(const uint8_t* ct, size_t ct_size,
+                                       const std::array<uint8_t, 12>& block_iv,
+                                       const std::array<uint8_t, 16>& block_tag)
+    : ciphertext(ct), ciphertext_size(ct_size), iv(&block_iv), auth_tag(&block_tag) {}
+
+EncryptedBlockView::EncryptedBlockView(const EncryptedBlock& block)
+    : ciphertext(block.ciphertext.data()), ciphertext_size(block.ciphertext.size()),
+      iv(&block.iv), auth_tag(&block.auth_tag) {}
+
+EncryptedBlock EncryptedBlockView::to_block() const {
+    EncryptedBlock block;
+    block.ciphertext.assign(ciphertext, ciphertext + ciphertext_size);
+    block.iv = *iv;
+    block.auth_tag = *auth_tag;
+    return block;
+}
+
+EncryptedBlockSet::EncryptedBlockSet(size_t max_block_size)
+    : slot_size_(std::min<size_t>(max_block_size, std::numeric_limits<uint32_t>::max())) {}
+
+EncryptedBlockSet EncryptedBlockSet::from_blocks(const std::vector<EncryptedBlock>& blocks,
+                                                 size_t max_block_size) {
+    EncryptedBlockSet set(max_block_size);
+    set.reserve(blocks.size());
+    for (const auto& block : blocks) {
+        if (set.push_back(block) != 0) {
+            set.clear();
+            break;
+        }
+    }
+    return set;
+}
+
+size_t EncryptedBlockSet::size() const {
+    return sizes_.size();
+}
+
+bool EncryptedBlockSet::empty() const {
+    return sizes_.empty();
+}
+
+size_t EncryptedBlockSet::max_block_size() const {
+    return slot_size_;
+}
+
+void EncryptedBlockSet::reserve(size_t n) {
+    arena_.reserve(n * slot_size_);
+    sizes_.reserve(n);
+    ivs_.reserve(n);
+    tags_.reserve(n);
+}
+
+void EncryptedBlockSet::resize(size_t n) {
+    // 密文缓冲区使用默认初始化的分配器，扩展时不整块写零
+    arena_.resize(n * slot_size_);
+    sizes_.resize(n, 0);
+    ivs_.resize(n);
+    tags_.resize(n);
+}
+
+void EncryptedBlockSet::clear() {
+    arena_.clear();
+    sizes_.clear();
+    ivs_.clear();
+    tags_.clear();
+}
+
+EncryptedBlockView EncryptedBlockSet::operator[](size_t i) const {
+    return EncryptedBlockView(arena_.data() + i * slot_size_, sizes_[i], ivs_[i], tags_[i]);
+}
+
+int EncryptedBlockSet::set_block(size_t i, const EncryptedBlockView& block) {
+    if (i >= size() || block.ciphertext_size > slot_size_) {
+        return -1;
+    }
+    std::copy(block.ciphertext, block.ciphertext + block.ciphertext_size, arena_.begin() + i * slot_size_);
+    sizes_[i] = static_cast<uint32_t>(block.ciphertext_size);
+    ivs_[i] = *block.iv;
+    tags_[i] = *block.auth_tag;
+    return 0;
+}
+
+int EncryptedBlockSet::set_block(size_t i, const EncryptedBlock& block) {
+    return set_block(i, EncryptedBlockView(block));
+}
+
+int EncryptedBlockSet::push_back(const EncryptedBlockView& block) {
+    if (block.ciphertext_size > slot_size_) {
+        return -1;
+    }
+    resize(size() + 1);
+    return set_block(size() - 1, block);
+}
+
+int EncryptedBlockSet::push_back(const EncryptedBlock& block) {
+    return push_back(EncryptedBlockView(block));
+}
+
+uint8_t* EncryptedBlockSet::ciphertext_data(size_t i) {
+    return arena_.data() + i * slot_size_;
+}
+
+void EncryptedBlockSet::set_ciphertext_size(size_t i, size_t len) {
+    sizes_[i] = static_cast<uint32_t>(std::min(len, slot_size_));
+}
+
+std::array<uint8_t, 12>& EncryptedBlockSet::iv(size_t i) {
+    return ivs_[i];
+}
+
+std::array<uint8_t, 16>& EncryptedBlockSet::auth_tag(size_t i) {
+    return tags_[i];
+}
+
+size_t EncryptedBlockSet::memory_bytes() const {
+    return arena_.capacity() + sizes_.capacity() * sizeof(uint32_t) +
+           ivs_.capacity() * sizeof(ivs_[0]) + tags_.capacity() * sizeof(tags_[0]);
+}
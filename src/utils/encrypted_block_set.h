@@ -0,0 +1,94 @@
+#ifndef ENCRYPTED_BLOCK_SET_H
+#define ENCRYPTED_BLOCK_SET_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include "../../include/common_type.h"
+#include "../../include/config.h"
+#include "aligned_allocator.h"
+
+// 加密块的只读视图（不拥有数据，所指容器被修改或销毁后失效）
+struct EncryptedBlockView {
+    const uint8_t* ciphertext = nullptr;           // 密文
+    size_t ciphertext_size = 0;                    // 密文长度
+    const std::array<uint8_t, 12>* iv = nullptr;   // 初始化向量
+    const std::array<uint8_t, 16>* auth_tag = nullptr; // 认证标签
+    
+    EncryptedBlockView() = default;
+    EncryptedBlockView(const uint8_t* ct, size_t ct_size,
+                       const std::array<uint8_t, 12>& block_iv,
+                       const std::array<uint8_t, 16>& block_tag);
+    
+    // 指向独立分配的 EncryptedBlock
+    explicit EncryptedBlockView(const EncryptedBlock& block);
+    
+    // 复制出一个独立的 EncryptedBlock
+    EncryptedBlock to_block() const;
+};
+
+// 加密块集合：所有密文放在一整块连续的缓冲区中（每块占 max_block_size 字节的固定槽位），
+// IV、认证标签和密文长度按列分别存放。整个文件只有几次大块分配，
+// 而 std::vector<EncryptedBlock> 每块都要单独分配一次密文。
+// 固定槽位使得任意块可以原地重写、多个线程可以同时写不同的块。
+class EncryptedBlockSet {
+public:
+    // max_block_size: 单块密文的最大长度（槽位大小）
+    explicit EncryptedBlockSet(size_t max_block_size = Config::BLOCK_SIZE);
+    
+    // 析构函数
+    ~EncryptedBlockSet() = default;
+    
+    // 移动只交换缓冲区；复制会复制全部密文
+    EncryptedBlockSet(EncryptedBlockSet&&) noexcept = default;
+    EncryptedBlockSet& operator=(EncryptedBlockSet&&) noexcept = default;
+    EncryptedBlockSet(const EncryptedBlockSet&) = default;
+    EncryptedBlockSet& operator=(const EncryptedBlockSet&) = default;
+    
+    // 从独立块构造（复制密文），有块超过 max_block_size 时返回空集合
+    static EncryptedBlockSet from_blocks(const std::vector<EncryptedBlock>& blocks,
+                                         size_t max_block_size = Config::BLOCK_SIZE);
+    
+    size_t size() const;
+    bool empty() const;
+    size_t max_block_size() const;
+    
+    // 预留 n 块的空间
+    void reserve(size_t n);
+    
+    // 调整为 n 块（新增块的密文长度为0，IV和标签未初始化，由调用方原地写入）
+    void resize(size_t n);
+    
+    void clear();
+    
+    // 第 i 块的视图（不检查下标）
+    EncryptedBlockView operator[](size_t i) const;
+    
+    // 覆盖第 i 块，密文超过槽位大小或下标越界返回-1
+    int set_block(size_t i, const EncryptedBlockView& block);
+    int set_block(size_t i, const EncryptedBlock& block);
+    
+    // 在末尾追加一块，密文超过槽位大小返回-1
+    int push_back(const EncryptedBlockView& block);
+    int push_back(const EncryptedBlock& block);
+    
+    // 原地写入接口（加密引擎直接把密文写进槽位）：
+    // 第 i 块的槽位起始地址（可写 max_block_size 字节），写完后用 set_ciphertext_size 设置长度
+    uint8_t* ciphertext_data(size_t i);
+    void set_ciphertext_size(size_t i, size_t len);
+    std::array<uint8_t, 12>& iv(size_t i);
+    std::array<uint8_t, 16>& auth_tag(size_t i);
+    
+    // 占用的内存字节数（按容量计）
+    size_t memory_bytes() const;
+
+private:
+    size_t slot_size_;                                   // 每块密文槽位大小
+    std::vector<uint8_t, AlignedAllocator<uint8_t>> arena_; // 所有密文（第 i 块位于 i * slot_size_）
+    std::vector<uint32_t> sizes_;                        // 各块密文长度
+    std::vector<std::array<uint8_t, 12>> ivs_;           // 各块IV
+    std::vector<std::array<uint8_t, 16>> tags_;          // 各块认证标签
+};
+
+#endif // ENCRYPTED_BLOCK_SET_H
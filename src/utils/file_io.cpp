@@ -0,0 +1,293 @@
+#include "file_io.h"
+#include <cstdio>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ==================== RandomAccessFile ====================
+
+RandomAccessFile::~RandomAccessFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+int RandomAccessFile::open(const std::string& path, bool writable, bool create, bool truncate) {
+    close();
+    DWORD access = GENERIC_READ | (writable ? GENERIC_WRITE : 0);
+    DWORD disposition = create ? (truncate ? CREATE_ALWAYS : OPEN_ALWAYS)
+                               : (truncate ? TRUNCATE_EXISTING : OPEN_EXISTING);
+    HANDLE h = CreateFileA(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                           disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) {
+        std::cerr << "[错误] 打开文件失败：" << path << std::endl;
+        return -1;
+    }
+    handle_ = h;
+    return 0;
+}
+
+void RandomAccessFile::close() {
+    if (handle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+    }
+}
+
+bool RandomAccessFile::is_open() const {
+    return handle_ != nullptr;
+}
+
+int RandomAccessFile::read_at(uint64_t offset, void* buf, size_t len) const {
+    uint8_t* out = static_cast<uint8_t*>(buf);
+    while (len > 0) {
+        OVERLAPPED ov = {};
+        ov.Offset = static_cast<DWORD>(offset);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(len > 0x40000000 ? 0x40000000 : len);
+        DWORD done = 0;
+        if (!ReadFile(static_cast<HANDLE>(handle_), out, chunk, &done, &ov) || done == 0) {
+            return -1;
+        }
+        out += done;
+        offset += done;
+        len -= done;
+    }
+    return 0;
+}
+
+int RandomAccessFile::write_at(uint64_t offset, const void* buf, size_t len) {
+    const uint8_t* in = static_cast<const uint8_t*>(buf);
+    while (len > 0) {
+        OVERLAPPED ov = {};
+        ov.Offset = static_cast<DWORD>(offset);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(len > 0x40000000 ? 0x40000000 : len);
+        DWORD done = 0;
+        if (!WriteFile(static_cast<HANDLE>(handle_), in, chunk, &done, &ov) || done == 0) {
+            return -1;
+        }
+        in += done;
+        offset += done;
+        len -= done;
+    }
+    return 0;
+}
+
+int RandomAccessFile::sync() {
+    return FlushFileBuffers(static_cast<HANDLE>(handle_)) ? 0 : -1;
+}
+
+int RandomAccessFile::resize(uint64_t size) {
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+    return SetFileInformationByHandle(static_cast<HANDLE>(handle_), FileEndOfFileInfo, &info, sizeof(info)) ? 0 : -1;
+}
+
+uint64_t RandomAccessFile::size() const {
+    LARGE_INTEGER size;
+    if (handle_ == nullptr || !GetFileSizeEx(static_cast<HANDLE>(handle_), &size)) {
+        return 0;
+    }
+    return static_cast<uint64_t>(size.QuadPart);
+}
+
+#else
+
+int RandomAccessFile::open(const std::string& path, bool writable, bool create, bool truncate) {
+    close();
+    int flags = (writable ? O_RDWR : O_RDONLY) | (create ? O_CREAT : 0) | (truncate ? O_TRUNC : 0);
+    fd_ = ::open(path.c_str(), flags, 0644);
+    if (fd_ < 0) {
+        std::cerr << "[错误] 打开文件失败：" << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+void RandomAccessFile::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool RandomAccessFile::is_open() const {
+    return fd_ >= 0;
+}
+
+int RandomAccessFile::read_at(uint64_t offset, void* buf, size_t len) const {
+    uint8_t* out = static_cast<uint8_t*>(buf);
+    while (len > 0) {
+        ssize_t n = ::pread(fd_, out, len, static_cast<off_t>(offset));
+        if (n <= 0) {
+            return -1;
+        }
+        out += n;
+        offset += static_cast<uint64_t>(n);
+        len -= static_cast<size_t>(n);
+    }
+    return 0;
+}
+
+int RandomAccessFile::write_at(uint64_t offset, const void* buf, size_t len) {
+    const uint8_t* in = static_cast<const uint8_t*>(buf);
+    while (len > 0) {
+        ssize_t n = ::pwrite(fd_, in, len, static_cast<off_t>(offset));
+        if (n <= 0) {
+            return -1;
+        }
+        in += n;
+        offset += static_cast<uint64_t>(n);
+        len -= static_cast<size_t>(n);
+    }
+    return 0;
+}
+
+int RandomAccessFile::sync() {
+    return ::fsync(fd_) == 0 ? 0 : -1;
+}
+
+int RandomAccessFile::resize(uint64_t size) {
+    return ::ftruncate(fd_, static_cast<off_t>(size)) == 0 ? 0 : -1;
+}
+
+uint64_t RandomAccessFile::size() const {
+    struct stat st;
+    if (fd_ < 0 || ::fstat(fd_, &st) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(st.st_size);
+}
+
+#endif
+
+// ==================== MappedFile ====================
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::is_open() const {
+    return data_ != nullptr;
+}
+
+const uint8_t* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+#ifdef _WIN32
+
+int MappedFile::open(const std::string& path) {
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "[错误] 打开文件失败：" << path << std::endl;
+        return -1;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return -1;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        std::cerr << "[错误] 创建文件映射失败：" << path << std::endl;
+        return -1;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        std::cerr << "[错误] 映射文件失败：" << path << std::endl;
+        return -1;
+    }
+    file_handle_ = file;
+    mapping_handle_ = mapping;
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(size.QuadPart);
+    return 0;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if (mapping_handle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+        mapping_handle_ = nullptr;
+    }
+    if (file_handle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+        file_handle_ = nullptr;
+    }
+    size_ = 0;
+}
+
+void MappedFile::advise_random() const {
+    // Windows 没有等价的逐映射提示，保持默认行为
+}
+
+#else
+
+int MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "[错误] 打开文件失败：" << path << std::endl;
+        return -1;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return -1;
+    }
+    void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // 映射建立后即可关闭描述符
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "[错误] 映射文件失败：" << path << std::endl;
+        return -1;
+    }
+    data_ = static_cast<const uint8_t*>(addr);
+    size_ = static_cast<size_t>(st.st_size);
+    return 0;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+}
+
+void MappedFile::advise_random() const {
+    if (data_ != nullptr) {
+        ::madvise(const_cast<uint8_t*>(data_), size_, MADV_RANDOM);
+    }
+}
+
+#endif
+
+int replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0 ? 0 : -1;
+#endif
+}
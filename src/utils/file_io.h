@@ -0,0 +1,83 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 可随机读写的文件（POSIX: pread/pwrite，Windows: 带偏移的 ReadFile/WriteFile）
+// 所有读写都显式给出偏移，不依赖也不修改文件指针，可在多线程中并发读
+class RandomAccessFile {
+public:
+    // 构造函数
+    RandomAccessFile() = default;
+    
+    // 析构函数：自动关闭文件
+    ~RandomAccessFile();
+    
+    RandomAccessFile(const RandomAccessFile&) = delete;
+    RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+    
+    // 打开文件（writable=false 时只读；create=true 时不存在则创建，truncate=true 时清空）
+    int open(const std::string& path, bool writable, bool create = false, bool truncate = false);
+    void close();
+    bool is_open() const;
+    
+    // 在 offset 处读/写 len 字节（短读/短写视为失败）
+    int read_at(uint64_t offset, void* buf, size_t len) const;
+    int write_at(uint64_t offset, const void* buf, size_t len);
+    
+    // 将已写入数据刷到磁盘
+    int sync();
+    
+    // 把文件大小设为 size（扩展部分读出为0，支持时不实际占用磁盘空间）
+    int resize(uint64_t size);
+    
+    // 当前文件大小（失败时返回0）
+    uint64_t size() const;
+
+private:
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// 只读内存映射文件：映射后按需缺页，不会把整个文件读入内存
+// 映射期间允许其他句柄写入同一文件（写入的内容通过映射立即可见）
+class MappedFile {
+public:
+    // 构造函数
+    MappedFile() = default;
+    
+    // 析构函数：自动解除映射
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // 映射整个文件（空文件映射失败）
+    int open(const std::string& path);
+    void close();
+    bool is_open() const;
+    
+    const uint8_t* data() const;
+    size_t size() const;
+    
+    // 提示内核按随机访问模式处理（关闭预读，适合 Merkle 路径这类稀疏访问）
+    void advise_random() const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+// 原子替换：把 from 重命名为 to（to 已存在时覆盖）
+int replace_file(const std::string& from, const std::string& to);
+
+#endif // FILE_IO_H
@@ -0,0 +1,77 @@
+#include "hash_engine.h"
+#include <openssl/evp.h>
+#include <iostream>
+
+namespace {
+
+// 进程内共享的预获取算法对象，首次使用时获取，进程退出时释放
+class FetchedDigests {
+public:
+    FetchedDigests()
+        : sha256_(EVP_MD_fetch(nullptr, "SHA256", nullptr)),
+          sha3_256_(EVP_MD_fetch(nullptr, "SHA3-256", nullptr)) {}
+
+    ~FetchedDigests() {
+        EVP_MD_free(sha256_);
+        EVP_MD_free(sha3_256_);
+    }
+
+    const EVP_MD* get(HashAlgorithm algo) const {
+        return algo == HashAlgorithm::SHA256 ? sha256_ : sha3_256_;
+    }
+
+private:
+    EVP_MD* sha256_;
+    EVP_MD* sha3_256_;
+};
+
+const EVP_MD* fetched_digest(HashAlgorithm algo) {
+    static FetchedDigests digests;
+    return digests.get(algo);
+}
+
+} // namespace
+
+HashEngine::HashEngine(HashAlgorithm algo)
+    : md_(fetched_digest(algo)), ctx_(EVP_MD_CTX_new()) {
+    if (!md_ || !ctx_) {
+        std::cerr << "摘要引擎初始化失败" << std::endl;
+    }
+}
+
+HashEngine::~HashEngine() {
+    EVP_MD_CTX_free(ctx_);
+}
+
+int HashEngine::init() {
+    if (!md_ || !ctx_) return -1;
+    // 复用同一上下文重新初始化，不重新分配内存
+    return EVP_DigestInit_ex2(ctx_, md_, nullptr) == 1 ? 0 : -1;
+}
+
+int HashEngine::update(const uint8_t* data, size_t len) {
+    if (!ctx_) return -1;
+    return EVP_DigestUpdate(ctx_, data, len) == 1 ? 0 : -1;
+}
+
+int HashEngine::final(std::array<uint8_t, 32>& hash_out) {
+    if (!ctx_) return -1;
+    unsigned int hash_len = 0;
+    if (EVP_DigestFinal_ex(ctx_, hash_out.data(), &hash_len) != 1 || hash_len != 32) {
+        return -1;
+    }
+    return 0;
+}
+
+int HashEngine::digest(const uint8_t* data, size_t len, std::array<uint8_t, 32>& hash_out) {
+    if (init() != 0 || update(data, len) != 0) {
+        return -1;
+    }
+    return final(hash_out);
+}
+
+HashEngine& HashEngine::local(HashAlgorithm algo) {
+    thread_local HashEngine sha256_engine(HashAlgorithm::SHA256);
+    thread_local HashEngine sha3_256_engine(HashAlgorithm::SHA3_256);
+    return algo == HashAlgorithm::SHA256 ? sha256_engine : sha3_256_engine;
+}
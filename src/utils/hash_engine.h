@@ -0,0 +1,44 @@
+#ifndef HASH_ENGINE_H
+#define HASH_ENGINE_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <openssl/types.h>
+
+// 支持的摘要算法
+enum class HashAlgorithm {
+    SHA256,   // Merkle树节点、数据块哈希
+    SHA3_256  // 证明包链式指针
+};
+
+// 可复用的摘要引擎
+// 算法对象在进程内只获取一次（EVP_MD_fetch），上下文在多次哈希之间复用，
+// 避免每次哈希都创建/释放 EVP_MD_CTX 和查找算法实现。
+// 单个实例非线程安全，多线程场景使用 HashEngine::local() 获取线程局部实例。
+class HashEngine {
+public:
+    explicit HashEngine(HashAlgorithm algo);
+    ~HashEngine();
+
+    HashEngine(const HashEngine&) = delete;
+    HashEngine& operator=(const HashEngine&) = delete;
+
+    // 增量接口：init → update（可多次）→ final，调用方无需先拼接缓冲区
+    // 成功返回0，失败返回-1
+    int init();
+    int update(const uint8_t* data, size_t len);
+    int final(std::array<uint8_t, 32>& hash_out);
+
+    // 一次性计算 data 的摘要
+    int digest(const uint8_t* data, size_t len, std::array<uint8_t, 32>& hash_out);
+
+    // 获取当前线程缓存的引擎实例（首次调用时创建，线程退出时释放）
+    static HashEngine& local(HashAlgorithm algo);
+
+private:
+    const EVP_MD* md_;  // 预获取的算法对象（进程共享，不归本实例所有）
+    EVP_MD_CTX* ctx_;   // 复用的摘要上下文
+};
+
+#endif // HASH_ENGINE_H
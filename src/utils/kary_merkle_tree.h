@@ -0,0 +1,189 @@
+#ifndef KARY_MERKLE_TREE_H
+#define KARY_MERKLE_TREE_H
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "aligned_allocator.h"
+#include "hash_engine.h"
+#include "sha256_multi.h"
+
+// 节点哈希策略：把 count 条长度为 message_len 的连续消息分别哈希为 32 字节，结果连续写入 out
+
+// SHA-256（默认）：二叉树的 64 字节消息走批量内核，其余逐条复用线程局部 HashEngine
+struct Sha256MerkleHash {
+    static void hash_messages(const uint8_t* in, size_t message_len, size_t count, uint8_t* out) {
+        if (message_len == 64) {
+            sha256_64x_n(in, count, out);
+            return;
+        }
+        HashEngine& engine = HashEngine::local(HashAlgorithm::SHA256);
+        std::array<uint8_t, 32> digest;
+        for (size_t i = 0; i < count; ++i) {
+            engine.digest(in + i * message_len, message_len, digest);
+            memcpy(out + i * 32, digest.data(), 32);
+        }
+    }
+};
+
+// SHA3-256
+struct Sha3MerkleHash {
+    static void hash_messages(const uint8_t* in, size_t message_len, size_t count, uint8_t* out) {
+        HashEngine& engine = HashEngine::local(HashAlgorithm::SHA3_256);
+        std::array<uint8_t, 32> digest;
+        for (size_t i = 0; i < count; ++i) {
+            engine.digest(in + i * message_len, message_len, digest);
+            memcpy(out + i * 32, digest.data(), 32);
+        }
+    }
+};
+
+// k叉Merkle树的单层证明：当前节点在父节点中的位置 + 其余 Arity-1 个兄弟（按位置顺序，跳过自身）
+template <size_t Arity>
+struct KaryProofStep {
+    uint8_t position;
+    std::array<std::array<uint8_t, 32>, Arity - 1> siblings;
+};
+
+// k叉Merkle树（Arity = 2/4/8/16）
+// 父节点 = Hash(第0个子节点 || ... || 第Arity-1个子节点)，一层末尾不足 Arity 个子节点时
+// 用该组最后一个子节点补齐（Arity=2 时即"奇数节点与自身配对"）。
+// BasicMerkleTree<2, Sha256MerkleHash> 的根和路径与 MerkleTree 逐位一致；
+// MerkleTree 仍是二叉 SHA-256 的主实现（增量更新、并行构建、多重证明、磁盘格式都基于它），
+// 本模板用于在证明深度、证明大小和验证耗时之间选择其他分叉数。
+// 各层按 叶子层→根 的顺序紧密存放在一块64字节对齐的缓冲区中。
+template <size_t Arity, typename HashPolicy = Sha256MerkleHash>
+class BasicMerkleTree {
+    static_assert(Arity >= 2 && Arity <= 16 && (Arity & (Arity - 1)) == 0, "分叉数必须为 2/4/8/16");
+
+public:
+    using Hash = std::array<uint8_t, 32>;
+    using NodeBuffer = std::vector<Hash, AlignedAllocator<Hash, 64>>;
+    using ProofStep = KaryProofStep<Arity>;
+    
+    // 构造函数
+    BasicMerkleTree() = default;
+    
+    // 初始化：输入所有叶子节点的哈希
+    explicit BasicMerkleTree(const std::vector<Hash>& leaf_hashes) {
+        if (leaf_hashes.empty()) return;
+        nodes_.reserve(node_count(leaf_hashes.size()));
+        nodes_.assign(leaf_hashes.begin(), leaf_hashes.end());
+        build();
+    }
+    
+    // 给定叶子数时整棵树的节点总数
+    static size_t node_count(size_t leaf_count) {
+        if (leaf_count == 0) return 0;
+        size_t total = leaf_count;
+        for (size_t size = leaf_count; size > 1; ) {
+            size = (size + Arity - 1) / Arity;
+            total += size;
+        }
+        return total;
+    }
+    
+    // 一条证明序列化后的字节数（每层：1字节位置 + (Arity-1) 个32字节兄弟哈希）
+    static size_t proof_size_bytes(size_t depth) {
+        return depth * (1 + (Arity - 1) * 32);
+    }
+    
+    // 叶子数量 / 树高（证明的层数）
+    size_t leaf_count() const { return leaf_count_; }
+    size_t depth() const { return level_start_.empty() ? 0 : level_start_.size() - 1; }
+    
+    // 获取Merkle根
+    Hash get_root() const {
+        return nodes_.empty() ? Hash() : nodes_.back();
+    }
+    
+    // 获取指定叶子的证明（从叶子到根）
+    bool get_proof(size_t leaf_idx, std::vector<ProofStep>& proof) const {
+        proof.clear();
+        if (leaf_idx >= leaf_count_) {
+            return false;
+        }
+        
+        size_t current_idx = leaf_idx;
+        for (size_t level = 0; level + 1 < level_start_.size(); ++level) {
+            size_t level_size = level_start_[level + 1] - level_start_[level];
+            size_t group = current_idx / Arity * Arity;
+            size_t last = std::min(group + Arity, level_size) - 1;
+            
+            ProofStep step;
+            step.position = static_cast<uint8_t>(current_idx - group);
+            size_t out = 0;
+            for (size_t i = group; i < group + Arity; ++i) {
+                if (i == current_idx) continue;
+                // 缺失的子节点用该组最后一个子节点补齐
+                step.siblings[out++] = nodes_[level_start_[level] + std::min(i, last)];
+            }
+            proof.push_back(step);
+            current_idx /= Arity;
+        }
+        return true;
+    }
+    
+    // 验证叶子哈希是否属于Merkle树
+    static bool verify_proof(const Hash& leaf_hash, const std::vector<ProofStep>& proof, const Hash& root_hash) {
+        std::array<uint8_t, Arity * 32> message;
+        uint8_t current[32];
+        memcpy(current, leaf_hash.data(), 32);
+        
+        for (const ProofStep& step : proof) {
+            if (step.position >= Arity) {
+                return false;
+            }
+            size_t in = 0;
+            for (size_t i = 0; i < Arity; ++i) {
+                const uint8_t* child = (i == step.position) ? current : step.siblings[in++].data();
+                memcpy(message.data() + i * 32, child, 32);
+            }
+            HashPolicy::hash_messages(message.data(), message.size(), 1, current);
+        }
+        return memcmp(current, root_hash.data(), 32) == 0;
+    }
+
+private:
+    NodeBuffer nodes_;                // 所有层的节点（叶子层在前，根在最后）
+    size_t leaf_count_ = 0;           // 叶子数量
+    std::vector<size_t> level_start_; // 各层起始下标
+    
+    // 逐层计算父节点：完整的组在缓冲区中正好是一条连续消息，整层批量哈希
+    void build() {
+        leaf_count_ = nodes_.size();
+        nodes_.resize(node_count(leaf_count_));
+        
+        level_start_.assign(1, 0);
+        size_t level_size = leaf_count_;
+        while (level_size > 1) {
+            size_t prev_start = level_start_.back();
+            size_t curr_start = prev_start + level_size;
+            size_t full_groups = level_size / Arity;
+            if (full_groups > 0) {
+                HashPolicy::hash_messages(nodes_[prev_start].data(), Arity * 32, full_groups,
+                                          nodes_[curr_start].data());
+            }
+            
+            size_t rest = level_size % Arity;
+            if (rest > 0) {
+                std::array<uint8_t, Arity * 32> message;
+                size_t group = full_groups * Arity;
+                for (size_t i = 0; i < Arity; ++i) {
+                    memcpy(message.data() + i * 32,
+                           nodes_[prev_start + group + std::min(i, rest - 1)].data(), 32);
+                }
+                HashPolicy::hash_messages(message.data(), message.size(), 1,
+                                          nodes_[curr_start + full_groups].data());
+            }
+            
+            level_start_.push_back(curr_start);
+            level_size = (level_size + Arity - 1) / Arity;
+        }
+    }
+};
+
+#endif // KARY_MERKLE_TREE_H
@@ -0,0 +1,74 @@
+#include "merkle_accumulator.h"
+#include "sha256_multi.h"
+#include <cstring>
+
+namespace {
+
+std::array<uint8_t, 32> hash_pair(const std::array<uint8_t, 32>& left, const std::array<uint8_t, 32>& right) {
+    std::array<uint8_t, 64> combined;
+    memcpy(combined.data(), left.data(), 32);
+    memcpy(combined.data() + 32, right.data(), 32);
+    std::array<uint8_t, 32> parent;
+    sha256_64x_n(combined.data(), 1, parent.data());
+    return parent;
+}
+
+} // namespace
+
+void MerkleRootAccumulator::append(const std::array<uint8_t, 32>& leaf_hash) {
+    // 与二进制计数器进位相同：本层已有待配对节点时合并后继续向上
+    std::array<uint8_t, 32> node = leaf_hash;
+    size_t level = 0;
+    while (level < has_pending_.size() && has_pending_[level]) {
+        node = hash_pair(pending_[level], node);
+        has_pending_[level] = false;
+        ++level;
+    }
+    if (level == has_pending_.size()) {
+        pending_.emplace_back();
+        has_pending_.push_back(false);
+    }
+    pending_[level] = node;
+    has_pending_[level] = true;
+    ++leaf_count_;
+}
+
+size_t MerkleRootAccumulator::leaf_count() const {
+    return leaf_count_;
+}
+
+std::array<uint8_t, 32> MerkleRootAccumulator::root() const {
+    if (leaf_count_ == 0) {
+        return std::array<uint8_t, 32>();
+    }
+    
+    // 自底向上收尾：每层的末尾节点要么是待配对节点（左）与下层进位（右）配对，
+    // 要么是该层唯一剩下的节点，与自身配对；层大小为1时即到达根
+    std::array<uint8_t, 32> carry;
+    bool has_carry = false;
+    size_t level_size = leaf_count_;
+    for (size_t level = 0; level_size > 1; ++level) {
+        bool pending = level < has_pending_.size() && has_pending_[level];
+        if (pending && has_carry) {
+            carry = hash_pair(pending_[level], carry);
+        } else if (pending) {
+            carry = hash_pair(pending_[level], pending_[level]);
+            has_carry = true;
+        } else if (has_carry) {
+            carry = hash_pair(carry, carry);
+        }
+        level_size = (level_size + 1) / 2;
+    }
+    
+    // 根所在层：完整子树的根在 pending_ 中，否则是进位上来的节点
+    if (has_carry) {
+        return carry;
+    }
+    return pending_[has_pending_.size() - 1];
+}
+
+void MerkleRootAccumulator::reset() {
+    pending_.clear();
+    has_pending_.clear();
+    leaf_count_ = 0;
+}
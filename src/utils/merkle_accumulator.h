@@ -0,0 +1,34 @@
+#ifndef MERKLE_ACCUMULATOR_H
+#define MERKLE_ACCUMULATOR_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// 流式 Merkle 根累加器：逐个输入叶子，只保存每层至多一个待配对节点（O(log n) 内存），
+// 最终得到的根与对同样叶子构建的 MerkleTree 逐位一致（奇数层末尾节点与自身配对）
+class MerkleRootAccumulator {
+public:
+    // 构造函数
+    MerkleRootAccumulator() = default;
+    
+    // 追加一个叶子
+    void append(const std::array<uint8_t, 32>& leaf_hash);
+    
+    // 已追加的叶子数
+    size_t leaf_count() const;
+    
+    // 计算当前所有叶子的Merkle根（不改变累加器状态，可继续追加；无叶子时返回全0）
+    std::array<uint8_t, 32> root() const;
+    
+    // 清空
+    void reset();
+
+private:
+    std::vector<std::array<uint8_t, 32>> pending_; // 第 l 层等待右兄弟的节点
+    std::vector<bool> has_pending_;                // 第 l 层是否有待配对节点
+    size_t leaf_count_ = 0;
+};
+
+#endif // MERKLE_ACCUMULATOR_H
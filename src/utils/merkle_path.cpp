@@ -0,0 +1,67 @@
+#include "merkle_path.h"
+#include <cstring>
+
+size_t merkle_path_encoded_size(size_t depth) {
+    return 1 + (depth + 7) / 8 + depth * 32;
+}
+
+int encode_merkle_path(const std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path,
+                       std::vector<uint8_t>& out) {
+    size_t depth = path.size();
+    if (depth > MAX_MERKLE_PATH_DEPTH) {
+        return -1;
+    }
+    
+    out.assign(merkle_path_encoded_size(depth), 0);
+    out[0] = static_cast<uint8_t>(depth);
+    uint8_t* bitmask = out.data() + 1;
+    uint8_t* hashes = bitmask + (depth + 7) / 8;
+    for (size_t i = 0; i < depth; ++i) {
+        if (path[i].second) {
+            bitmask[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        }
+        memcpy(hashes + i * 32, path[i].first.data(), 32);
+    }
+    return 0;
+}
+
+bool MerklePathView::parse(const uint8_t* data, size_t len) {
+    bitmask_ = nullptr;
+    hashes_ = nullptr;
+    depth_ = 0;
+    
+    if (data == nullptr || len < 1) {
+        return false;
+    }
+    size_t depth = data[0];
+    if (depth > MAX_MERKLE_PATH_DEPTH || len != merkle_path_encoded_size(depth)) {
+        return false;
+    }
+    
+    // 最后一个位图字节中未使用的高位必须为0，保证编码唯一
+    size_t mask_bytes = (depth + 7) / 8;
+    if (depth % 8 != 0 && (data[mask_bytes] >> (depth % 8)) != 0) {
+        return false;
+    }
+    
+    bitmask_ = data + 1;
+    hashes_ = bitmask_ + mask_bytes;
+    depth_ = depth;
+    return true;
+}
+
+bool MerklePathView::parse(const std::vector<uint8_t>& encoded) {
+    return parse(encoded.data(), encoded.size());
+}
+
+size_t MerklePathView::depth() const {
+    return depth_;
+}
+
+const uint8_t* MerklePathView::sibling(size_t i) const {
+    return hashes_ + i * 32;
+}
+
+bool MerklePathView::is_left(size_t i) const {
+    return (bitmask_[i / 8] >> (i % 8)) & 1;
+}
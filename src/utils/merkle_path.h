@@ -0,0 +1,49 @@
+#ifndef MERKLE_PATH_H
+#define MERKLE_PATH_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+// 紧凑的 Merkle 路径二进制格式（ProofPackage::merkle_path）：
+//   [0]                   深度 d（路径步数，不超过 MAX_MERKLE_PATH_DEPTH）
+//   [1, 1+ceil(d/8))      方向位图：第 i 步对应字节 i/8 的第 i%8 位（低位在前），
+//                         1 表示当前节点在左、兄弟在右，0 表示当前节点在右
+//   [1+ceil(d/8), ...)    d 个 32 字节兄弟哈希，按 叶子→根 的顺序连续存放
+// 相比每步 32 字节哈希 + 1 字节方向，20 层的路径从 660 字节降到 644 字节，
+// 且哈希连续存放，可以不经复制直接在原缓冲区上验证
+const size_t MAX_MERKLE_PATH_DEPTH = 64;
+
+// 编码后的字节数
+size_t merkle_path_encoded_size(size_t depth);
+
+// 将 get_proof 输出的路径编码为紧凑格式（深度超过上限时返回-1）
+int encode_merkle_path(const std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path,
+                       std::vector<uint8_t>& out);
+
+// 紧凑格式路径的只读视图：不持有、不复制数据，底层缓冲区需在视图使用期间保持有效
+class MerklePathView {
+public:
+    // 构造函数
+    MerklePathView() = default;
+    
+    // 解析缓冲区（长度必须与深度严格匹配，且位图中超出深度的位必须为0）
+    bool parse(const uint8_t* data, size_t len);
+    bool parse(const std::vector<uint8_t>& encoded);
+    
+    // 路径步数
+    size_t depth() const;
+    
+    // 第 i 步的兄弟哈希（32字节）/ 当前节点是否在左
+    const uint8_t* sibling(size_t i) const;
+    bool is_left(size_t i) const;
+
+private:
+    const uint8_t* bitmask_ = nullptr;
+    const uint8_t* hashes_ = nullptr;
+    size_t depth_ = 0;
+};
+
+#endif // MERKLE_PATH_H
@@ -1,72 +1,305 @@
 #include "merkle_tree.h"
 #include "crypto_utils.h"
+#include "sha256_multi.h"
+#include "thread_pool.h"
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
+// 整层批量哈希要求节点哈希在 vector 中紧密排列
+static_assert(sizeof(std::array<uint8_t, 32>) == 32, "Merkle节点哈希必须紧密排列");
+
+namespace {
+
+// 并行构建时每棵子树至少包含的叶子数（2的幂）
+const size_t MIN_PARALLEL_SUBTREE = static_cast<size_t>(1) << 12;
+
+// 计算上一层（大小 prev_size）下标 [first, last) 范围内的父节点
+void hash_parents(const std::array<uint8_t, 32>* prev_layer, size_t prev_size,
+                  std::array<uint8_t, 32>* curr_layer, size_t first, size_t last) {
+    // 相邻两个节点（左+右）在内存中正好是一条连续的64字节消息，批量哈希
+    size_t full_end = std::min(last, prev_size / 2);
+    if (full_end > first) {
+        sha256_64x_n(prev_layer[2 * first].data(), full_end - first, curr_layer[first].data());
+    }
+    
+    if (last > full_end) {
+        // 奇数节点：复制自身（补全）
+        std::array<uint8_t, 64> combined;
+        memcpy(combined.data(), prev_layer[prev_size - 1].data(), 32);
+        memcpy(combined.data() + 32, prev_layer[prev_size - 1].data(), 32);
+        sha256_64x_n(combined.data(), 1, curr_layer[full_end].data());
+    }
+}
+
+} // namespace
+
 MerkleTree::MerkleTree(const std::vector<std::array<uint8_t, 32>>& leaf_hashes) {
     if (leaf_hashes.empty()) return;
     
-    // 初始化叶子层
-    layers_.push_back(leaf_hashes);
+    // 初始化叶子层（一次性预留整棵树的空间）
+    nodes_.reserve(node_count(leaf_hashes.size()));
+    nodes_.assign(leaf_hashes.begin(), leaf_hashes.end());
+    build(nullptr);
+}
+
+MerkleTree::MerkleTree(NodeBuffer&& leaf_hashes) : nodes_(std::move(leaf_hashes)) {
+    if (nodes_.empty()) return;
+    build(nullptr);
+}
+
+MerkleTree::MerkleTree(NodeBuffer&& leaf_hashes, ThreadPool& pool) : nodes_(std::move(leaf_hashes)) {
+    if (nodes_.empty()) return;
+    build(&pool);
+}
+
+size_t MerkleTree::node_count(size_t leaf_count) {
+    if (leaf_count == 0) return 0;
+    
+    size_t total = leaf_count;
+    for (size_t level_size = leaf_count; level_size > 1; ) {
+        level_size = (level_size + 1) / 2;
+        total += level_size;
+    }
+    return total;
+}
+
+size_t MerkleTree::leaf_count() const {
+    return leaf_count_;
+}
+
+size_t MerkleTree::memory_bytes() const {
+    return nodes_.capacity() * sizeof(nodes_[0]) + level_start_.capacity() * sizeof(size_t);
+}
+
+void MerkleTree::layout(size_t leaf_capacity) {
+    std::vector<size_t> new_start(1, 0);
+    for (size_t size = leaf_capacity; size > 1; ) {
+        new_start.push_back(new_start.back() + size);
+        size = (size + 1) / 2;
+    }
     
-    // 构建上层节点（每层哈希两两合并）
-    while (layers_.back().size() > 1) {
-        const auto& prev_layer = layers_.back();
-        std::vector<std::array<uint8_t, 32>> curr_layer;
+    if (leaf_capacity_ == 0) {
+        // 首次布局：叶子已位于缓冲区开头
+        nodes_.resize(node_count(leaf_capacity));
+    } else {
+        // 扩容：按层把现有节点搬到新位置（新旧叶子层都从0开始，无需搬移）
+        NodeBuffer grown;
+        grown.resize(node_count(leaf_capacity));
+        for (size_t level = 0; level <= height(); ++level) {
+            std::copy_n(nodes_.begin() + level_start_[level], level_size(level),
+                        grown.begin() + new_start[level]);
+        }
+        nodes_.swap(grown);
+    }
+    leaf_capacity_ = leaf_capacity;
+    level_start_.swap(new_start);
+}
+
+size_t MerkleTree::level_size(size_t level) const {
+    size_t size = leaf_count_;
+    for (size_t l = 0; l < level; ++l) {
+        size = (size + 1) / 2;
+    }
+    return size;
+}
+
+size_t MerkleTree::height() const {
+    size_t level = 0;
+    for (size_t size = leaf_count_; size > 1; size = (size + 1) / 2) {
+        ++level;
+    }
+    return level;
+}
+
+void MerkleTree::build(ThreadPool* pool) {
+    leaf_count_ = nodes_.size();
+    layout(leaf_count_);
+    
+    // 各层起始下标和大小
+    const std::vector<size_t>& level_start = level_start_;
+    std::vector<size_t> level_size(1, leaf_count_);
+    while (level_size.back() > 1) {
+        level_size.push_back((level_size.back() + 1) / 2);
+    }
+    size_t top = level_size.size() - 1;
+    size_t level = 0;
+    
+    // 1. 并行阶段：每棵高度为 subtree_height 的子树独立计算自己的下层节点
+    //    子树按2的幂对齐，奇数补全只会出现在最后一棵子树内部，与串行构建一致
+    if (pool != nullptr && pool->size() > 1 && leaf_count_ >= 2 * MIN_PARALLEL_SUBTREE) {
+        size_t target_subtrees = pool->size() * 4;
+        size_t subtree_height = 0;
+        while ((static_cast<size_t>(1) << subtree_height) < MIN_PARALLEL_SUBTREE ||
+               (leaf_count_ >> subtree_height) > target_subtrees) {
+            ++subtree_height;
+        }
+        subtree_height = std::min(subtree_height, top);
+        size_t subtree_leaves = static_cast<size_t>(1) << subtree_height;
+        size_t subtrees = (leaf_count_ + subtree_leaves - 1) / subtree_leaves;
         
-        for (size_t i = 0; i < prev_layer.size(); i += 2) {
-            std::array<uint8_t, 64> combined;
-            
-            if (i + 1 < prev_layer.size()) {
-                // 合并两个节点（左+右）
-                memcpy(combined.data(), prev_layer[i].data(), 32);
-                memcpy(combined.data() + 32, prev_layer[i + 1].data(), 32);
-            } else {
-                // 奇数节点：复制自身（补全）
-                memcpy(combined.data(), prev_layer[i].data(), 32);
-                memcpy(combined.data() + 32, prev_layer[i].data(), 32);
+        pool->parallel_for(subtrees, 1, [&](size_t begin, size_t end) {
+            for (size_t s = begin; s < end; ++s) {
+                for (size_t l = 0; l < subtree_height; ++l) {
+                    size_t span = subtree_leaves >> (l + 1);  // 子树在第 l+1 层的节点数
+                    size_t first = s * span;
+                    size_t last = std::min(first + span, level_size[l + 1]);
+                    hash_parents(nodes_.data() + level_start[l], level_size[l],
+                                 nodes_.data() + level_start[l + 1], first, last);
+                }
             }
-            
-            // 计算SHA-256哈希作为父节点
-            std::array<uint8_t, 32> parent_hash;
-            sha256_hash(combined.data(), 64, parent_hash);
-            curr_layer.push_back(parent_hash);
+        });
+        level = subtree_height;
+    }
+    
+    // 2. 串行构建剩余的上层节点（每层哈希两两合并）
+    for (; level < top; ++level) {
+        hash_parents(nodes_.data() + level_start[level], level_size[level],
+                     nodes_.data() + level_start[level + 1], 0, level_size[level + 1]);
+    }
+}
+
+void MerkleTree::rehash(std::vector<size_t> dirty) {
+    size_t top = height();
+    size_t prev_size = leaf_count_;
+    
+    for (size_t level = 0; level < top; ++level) {
+        // 父节点下标（dirty 升序，右移后仍升序，去掉相邻重复即可）
+        for (size_t& idx : dirty) {
+            idx >>= 1;
         }
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
         
-        layers_.push_back(curr_layer);
+        // 连续的父节点一次批量哈希
+        const std::array<uint8_t, 32>* prev_layer = nodes_.data() + level_start_[level];
+        std::array<uint8_t, 32>* curr_layer = nodes_.data() + level_start_[level + 1];
+        for (size_t i = 0; i < dirty.size(); ) {
+            size_t j = i + 1;
+            while (j < dirty.size() && dirty[j] == dirty[j - 1] + 1) {
+                ++j;
+            }
+            hash_parents(prev_layer, prev_size, curr_layer, dirty[i], dirty[j - 1] + 1);
+            i = j;
+        }
+        prev_size = (prev_size + 1) / 2;
+    }
+}
+
+bool MerkleTree::get_leaf(size_t leaf_idx, std::array<uint8_t, 32>& leaf_hash) const {
+    if (leaf_idx >= leaf_count_) {
+        return false;
+    }
+    leaf_hash = nodes_[leaf_idx];
+    return true;
+}
+
+bool MerkleTree::update_leaf(size_t leaf_idx, const std::array<uint8_t, 32>& leaf_hash) {
+    if (leaf_idx >= leaf_count_) {
+        return false;
+    }
+    nodes_[leaf_idx] = leaf_hash;
+    rehash(std::vector<size_t>(1, leaf_idx));
+    return true;
+}
+
+bool MerkleTree::update_leaves(const std::vector<std::pair<size_t, std::array<uint8_t, 32>>>& updates) {
+    std::vector<size_t> dirty;
+    dirty.reserve(updates.size());
+    for (const auto& [leaf_idx, leaf_hash] : updates) {
+        if (leaf_idx >= leaf_count_) {
+            return false;
+        }
+        dirty.push_back(leaf_idx);
     }
+    if (dirty.empty()) {
+        return true;
+    }
+    
+    // 同一叶子出现多次时以最后一次为准
+    for (const auto& [leaf_idx, leaf_hash] : updates) {
+        nodes_[leaf_idx] = leaf_hash;
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+    rehash(std::move(dirty));
+    return true;
+}
+
+void MerkleTree::append_leaf(const std::array<uint8_t, 32>& leaf_hash) {
+    append_leaves(std::vector<std::array<uint8_t, 32>>(1, leaf_hash));
+}
+
+void MerkleTree::append_leaves(const std::vector<std::array<uint8_t, 32>>& leaf_hashes) {
+    if (leaf_hashes.empty()) {
+        return;
+    }
+    
+    // 容量不足时按2倍扩容，均摊后每次追加的搬移开销为 O(1)
+    size_t new_count = leaf_count_ + leaf_hashes.size();
+    if (new_count > leaf_capacity_) {
+        size_t capacity = std::max<size_t>(leaf_capacity_, 1);
+        while (capacity < new_count) {
+            capacity *= 2;
+        }
+        layout(capacity);
+    }
+    
+    // 新叶子及其祖先之外的节点都不受影响（右边界上的补全节点正是新叶子的祖先）
+    std::copy(leaf_hashes.begin(), leaf_hashes.end(), nodes_.begin() + leaf_count_);
+    std::vector<size_t> dirty(leaf_hashes.size());
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        dirty[i] = leaf_count_ + i;
+    }
+    leaf_count_ = new_count;
+    rehash(std::move(dirty));
+}
+
+bool MerkleTree::truncate(size_t new_leaf_count) {
+    if (new_leaf_count > leaf_count_) {
+        return false;
+    }
+    leaf_count_ = new_leaf_count;
+    
+    // 只有跨越新右边界的节点（新末尾叶子的祖先）需要重算
+    if (leaf_count_ > 0) {
+        rehash(std::vector<size_t>(1, leaf_count_ - 1));
+    }
+    return true;
 }
 
 std::array<uint8_t, 32> MerkleTree::get_root() const {
-    return layers_.empty() ? std::array<uint8_t, 32>() : layers_.back()[0];
+    return leaf_count_ == 0 ? std::array<uint8_t, 32>() : nodes_[level_start_[height()]];
 }
 
 bool MerkleTree::get_proof(size_t leaf_idx, std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path) const {
     path.clear();
     
-    if (layers_.empty() || leaf_idx >= layers_[0].size()) {
+    if (leaf_count_ == 0 || leaf_idx >= leaf_count_) {
         return false;
     }
     
     size_t current_idx = leaf_idx;
+    size_t level = 0;
+    size_t level_size = leaf_count_;
     
-    // 从叶子层向上遍历到根的下一层
-    for (size_t i = 0; i < layers_.size() - 1; ++i) {
-        const auto& current_layer = layers_[i];
-        size_t sibling_idx = (current_idx % 2 == 0) ? current_idx + 1 : current_idx - 1;
+    // 从叶子层向上遍历到根的下一层（仅做下标运算）
+    while (level_size > 1) {
+        size_t sibling_idx = current_idx ^ 1;
         
         // 检查兄弟节点是否存在
-        if (sibling_idx < current_layer.size()) {
+        if (sibling_idx < level_size) {
             // 方向：true表示当前节点在左，兄弟节点在右
             bool is_left = (current_idx % 2 == 0);
-            path.emplace_back(current_layer[sibling_idx], is_left);
+            path.emplace_back(nodes_[level_start_[level] + sibling_idx], is_left);
         } else {
             // 没有兄弟节点，使用当前节点作为兄弟（补全情况）
-            path.emplace_back(current_layer[current_idx], true);
+            path.emplace_back(nodes_[level_start_[level] + current_idx], true);
         }
         
         // 计算上一层的索引
         current_idx = current_idx / 2;
+        ++level;
+        level_size = (level_size + 1) / 2;
     }
     
     return true;
@@ -91,9 +324,145 @@ bool MerkleTree::verify_proof(const std::array<uint8_t, 32>& leaf_hash,
         }
         
         // 计算父节点哈希
-        sha256_hash(combined.data(), 64, current_hash);
+        sha256_64x_n(combined.data(), 1, current_hash.data());
     }
     
     // 检查计算得到的根是否与提供的根匹配
     return memcmp(current_hash.data(), root_hash.data(), 32) == 0;
 }
+
+bool MerkleTree::verify_proof(const std::array<uint8_t, 32>& leaf_hash,
+                              const MerklePathView& path,
+                              const std::array<uint8_t, 32>& root_hash) {
+    // 兄弟哈希直接从路径缓冲区读取，中间结果只用栈上缓冲区
+    std::array<uint8_t, 64> combined;
+    uint8_t current[32];
+    memcpy(current, leaf_hash.data(), 32);
+    
+    for (size_t i = 0; i < path.depth(); ++i) {
+        bool is_left = path.is_left(i);
+        memcpy(combined.data() + (is_left ? 0 : 32), current, 32);
+        memcpy(combined.data() + (is_left ? 32 : 0), path.sibling(i), 32);
+        sha256_64x_n(combined.data(), 1, current);
+    }
+    
+    return memcmp(current, root_hash.data(), 32) == 0;
+}
+
+bool MerkleTree::get_multiproof(const std::vector<size_t>& leaf_indices, MerkleMultiproof& proof) const {
+    proof.leaf_count = leaf_count_;
+    proof.hashes.clear();
+    
+    if (leaf_count_ == 0 || leaf_indices.empty()) {
+        return false;
+    }
+    
+    std::vector<size_t> known(leaf_indices);
+    std::sort(known.begin(), known.end());
+    known.erase(std::unique(known.begin(), known.end()), known.end());
+    if (known.back() >= leaf_count_) {
+        return false;
+    }
+    
+    size_t level_size = leaf_count_;
+    for (size_t level = 0; level_size > 1; ++level) {
+        for (size_t i = 0; i < known.size(); ++i) {
+            size_t idx = known[i];
+            if ((idx & 1) == 0 && i + 1 < known.size() && known[i + 1] == idx + 1) {
+                // 兄弟节点也已知：两者一起跳过
+                ++i;
+                continue;
+            }
+            size_t sibling_idx = idx ^ 1;
+            // 兄弟不存在时（奇数补全）验证方可自行复制，无需发送
+            if (sibling_idx < level_size) {
+                proof.hashes.push_back(nodes_[level_start_[level] + sibling_idx]);
+            }
+        }
+        
+        for (size_t& idx : known) {
+            idx >>= 1;
+        }
+        known.erase(std::unique(known.begin(), known.end()), known.end());
+        level_size = (level_size + 1) / 2;
+    }
+    
+    return true;
+}
+
+bool MerkleTree::verify_multiproof(const std::vector<size_t>& leaf_indices,
+                                   const std::vector<std::array<uint8_t, 32>>& leaf_hashes,
+                                   const MerkleMultiproof& proof,
+                                   const std::array<uint8_t, 32>& root_hash) {
+    if (leaf_indices.empty() || leaf_indices.size() != leaf_hashes.size() || proof.leaf_count == 0) {
+        return false;
+    }
+    
+    // 按下标排序；同一叶子出现多次时哈希必须一致
+    std::vector<std::pair<size_t, std::array<uint8_t, 32>>> known;
+    known.reserve(leaf_indices.size());
+    for (size_t i = 0; i < leaf_indices.size(); ++i) {
+        if (leaf_indices[i] >= proof.leaf_count) {
+            return false;
+        }
+        known.emplace_back(leaf_indices[i], leaf_hashes[i]);
+    }
+    std::sort(known.begin(), known.end());
+    size_t unique_count = 0;
+    for (size_t i = 0; i < known.size(); ++i) {
+        if (unique_count > 0 && known[unique_count - 1].first == known[i].first) {
+            if (known[unique_count - 1].second != known[i].second) {
+                return false;
+            }
+            continue;
+        }
+        known[unique_count++] = known[i];
+    }
+    known.resize(unique_count);
+    
+    // 逐层：先拼出本层所有 左||右 消息，再一次批量哈希得到上一层的已知节点
+    size_t next_hash = 0;
+    size_t level_size = proof.leaf_count;
+    std::vector<std::array<uint8_t, 64>> messages;
+    std::vector<std::array<uint8_t, 32>> digests;
+    std::vector<size_t> parents;
+    while (level_size > 1) {
+        messages.clear();
+        parents.clear();
+        for (size_t i = 0; i < known.size(); ++i) {
+            size_t idx = known[i].first;
+            std::array<uint8_t, 64> combined;
+            if ((idx & 1) == 0 && i + 1 < known.size() && known[i + 1].first == idx + 1) {
+                memcpy(combined.data(), known[i].second.data(), 32);
+                memcpy(combined.data() + 32, known[i + 1].second.data(), 32);
+                ++i;
+            } else {
+                size_t sibling_idx = idx ^ 1;
+                const std::array<uint8_t, 32>* sibling = &known[i].second;
+                if (sibling_idx < level_size) {
+                    if (next_hash >= proof.hashes.size()) {
+                        return false;
+                    }
+                    sibling = &proof.hashes[next_hash++];
+                }
+                bool is_left = (idx % 2 == 0);
+                memcpy(combined.data(), (is_left ? known[i].second : *sibling).data(), 32);
+                memcpy(combined.data() + 32, (is_left ? *sibling : known[i].second).data(), 32);
+            }
+            messages.push_back(combined);
+            parents.push_back(idx >> 1);
+        }
+        
+        digests.resize(messages.size());
+        sha256_64x_n(messages[0].data(), messages.size(), digests[0].data());
+        known.resize(messages.size());
+        for (size_t i = 0; i < parents.size(); ++i) {
+            known[i] = {parents[i], digests[i]};
+        }
+        level_size = (level_size + 1) / 2;
+    }
+    
+    // 证明中的哈希必须恰好用完
+    return next_hash == proof.hashes.size() &&
+           memcmp(known[0].second.data(), root_hash.data(), 32) == 0;
+}
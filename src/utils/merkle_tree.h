@@ -4,14 +4,66 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <cstddef>
+#include <utility>
+#include "aligned_allocator.h"
+#include "merkle_path.h"
+
+class ThreadPool;
+
+// Merkle多重证明：同时证明多个叶子，路径上共享的兄弟节点只出现一次
+// hashes 按 层（叶子层→根）、层内下标升序 排列，只包含无法由已证明节点推出的兄弟节点
+struct MerkleMultiproof {
+    uint64_t leaf_count = 0;                    // 树的叶子数（决定各层大小和奇数补全位置）
+    std::vector<std::array<uint8_t, 32>> hashes; // 去重后的兄弟节点哈希
+};
 
 // Merkle树类
+// 所有层按 叶子层→根 的顺序存放在一块缓存行对齐的连续缓冲区中，
+// 各层起始位置由叶子容量推出（第k+1层容量 = ceil(第k层容量/2)），不单独分配。
+// 构建时容量等于叶子数（各层紧密排列）；追加叶子超出容量时容量翻倍并重排一次，
+// 因此单叶子的修改/追加/截断只需重算该叶子到根的 O(log n) 条路径
 class MerkleTree {
 public:
+    // 节点缓冲区（64字节对齐）
+    using NodeBuffer = std::vector<std::array<uint8_t, 32>, AlignedAllocator<std::array<uint8_t, 32>, 64>>;
+
     //添加默认构造函数
     MerkleTree() = default;
-    // 初始化：输入所有叶子节点的哈希（每个叶子为SHA-256哈希）
+    // 初始化：输入所有叶子节点的哈希（每个叶子为SHA-256哈希），叶子会被复制一次
     MerkleTree(const std::vector<std::array<uint8_t, 32>>& leaf_hashes);
+    // 初始化：移入叶子缓冲区，不复制叶子
+    // 调用方预留 node_count(叶子数) 的容量时，建树过程不会重新分配内存
+    explicit MerkleTree(NodeBuffer&& leaf_hashes);
+    // 并行构建：叶子层切分为若干棵等高子树，由线程池并行计算各子树的下层节点，
+    // 再串行合并顶部几层，得到的根与串行构建逐位一致
+    MerkleTree(NodeBuffer&& leaf_hashes, ThreadPool& pool);
+
+    // 给定叶子数时整棵树的节点总数（用于预留 NodeBuffer 容量）
+    static size_t node_count(size_t leaf_count);
+
+    // 叶子数量
+    size_t leaf_count() const;
+    
+    // 节点缓冲区占用的内存字节数（按容量计）
+    size_t memory_bytes() const;
+    
+    // 获取指定叶子的哈希（越界时返回false）
+    bool get_leaf(size_t leaf_idx, std::array<uint8_t, 32>& leaf_hash) const;
+    
+    // 修改单个叶子并重算其到根的路径（越界时返回false）
+    bool update_leaf(size_t leaf_idx, const std::array<uint8_t, 32>& leaf_hash);
+    
+    // 批量修改叶子：先写入全部叶子，再逐层重算去重后的祖先节点，
+    // 共同祖先只计算一次（任一索引越界时返回false且不做任何修改）
+    bool update_leaves(const std::vector<std::pair<size_t, std::array<uint8_t, 32>>>& updates);
+    
+    // 在末尾追加叶子并重算受影响的路径
+    void append_leaf(const std::array<uint8_t, 32>& leaf_hash);
+    void append_leaves(const std::vector<std::array<uint8_t, 32>>& leaf_hashes);
+    
+    // 截断为前 new_leaf_count 个叶子（大于当前叶子数时返回false），不释放容量
+    bool truncate(size_t new_leaf_count);
 
     // 获取Merkle根
     std::array<uint8_t, 32> get_root() const;
@@ -24,9 +76,40 @@ public:
     static bool verify_proof(const std::array<uint8_t, 32>& leaf_hash,
                              const std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path,
                              const std::array<uint8_t, 32>& root_hash);
+    
+    // 直接在紧凑格式的路径缓冲区上验证（不复制路径、不分配内存）
+    static bool verify_proof(const std::array<uint8_t, 32>& leaf_hash,
+                             const MerklePathView& path,
+                             const std::array<uint8_t, 32>& root_hash);
+    
+    // 获取一组叶子的多重证明（索引可无序、可重复，任一越界时返回false）
+    bool get_multiproof(const std::vector<size_t>& leaf_indices, MerkleMultiproof& proof) const;
+    
+    // 验证一组叶子哈希是否属于Merkle树，leaf_indices 与 leaf_hashes 一一对应
+    // 逐层批量计算父节点，共享祖先只计算一次
+    static bool verify_multiproof(const std::vector<size_t>& leaf_indices,
+                                  const std::vector<std::array<uint8_t, 32>>& leaf_hashes,
+                                  const MerkleMultiproof& proof,
+                                  const std::array<uint8_t, 32>& root_hash);
 
 private:
-    std::vector<std::vector<std::array<uint8_t, 32>>> layers_; // Merkle树各层
+    NodeBuffer nodes_;                // 所有层的节点（叶子层在前，根所在层在最后）
+    size_t leaf_count_ = 0;           // 叶子数量
+    size_t leaf_capacity_ = 0;        // 叶子容量（决定各层起始位置）
+    std::vector<size_t> level_start_; // 各层在 nodes_ 中的起始下标（按容量计算）
+
+    // 按叶子容量重新计算各层起始位置并调整缓冲区大小（已有节点按层搬移到新位置）
+    void layout(size_t leaf_capacity);
+    
+    // 第 level 层当前的节点数 / 当前树高（根所在层号）
+    size_t level_size(size_t level) const;
+    size_t height() const;
+
+    // 在叶子层之后依次计算各上层节点（pool 为空时串行构建）
+    void build(ThreadPool* pool);
+    
+    // 从已修改的叶子（升序去重）出发逐层重算祖先节点
+    void rehash(std::vector<size_t> dirty);
 };
 
 #endif // MERKLE_TREE_H
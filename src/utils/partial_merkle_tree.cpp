@@ -0,0 +1,144 @@
+#include "partial_merkle_tree.h"
+#include "sha256_multi.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 整棵树的高度（根所在层号）
+size_t tree_height(size_t leaf_count) {
+    size_t height = 0;
+    for (size_t size = leaf_count; size > 1; size = (size + 1) / 2) {
+        ++height;
+    }
+    return height;
+}
+
+} // namespace
+
+int PartialMerkleTree::build(size_t leaf_count, size_t kept_levels, LeafSource source) {
+    if (leaf_count == 0 || !source) {
+        return -1;
+    }
+    
+    leaf_count_ = leaf_count;
+    source_ = std::move(source);
+    size_t levels = tree_height(leaf_count) + 1;
+    cut_level_ = levels - std::min(std::max<size_t>(kept_levels, 1), levels);
+    
+    // 子树按 2^cut 对齐，每棵子树的根就是整棵树第 cut 层的节点
+    size_t subtrees = ((leaf_count - 1) >> cut_level_) + 1;
+    MerkleTree::NodeBuffer cut_nodes;
+    cut_nodes.reserve(MerkleTree::node_count(subtrees));
+    std::vector<MerkleTree::NodeBuffer> subtree_levels;
+    for (size_t s = 0; s < subtrees; ++s) {
+        if (build_subtree(s, subtree_levels) != 0) {
+            leaf_count_ = 0;
+            return -1;
+        }
+        cut_nodes.push_back(subtree_levels.back()[0]);
+    }
+    top_ = MerkleTree(std::move(cut_nodes));
+    return 0;
+}
+
+int PartialMerkleTree::build_subtree(size_t subtree, std::vector<MerkleTree::NodeBuffer>& levels) const {
+    size_t first = subtree << cut_level_;
+    size_t count = std::min(leaf_count_ - first, static_cast<size_t>(1) << cut_level_);
+    
+    levels.resize(cut_level_ + 1);
+    levels[0].resize(count);
+    if (source_(first, count, levels[0].data()) != 0) {
+        return -1;
+    }
+    
+    // 子树起点按 2^cut 对齐，各层的奇偶性与整棵树一致；最后一棵不满的子树在本地只剩
+    // 一个节点后继续与自身配对，这与整棵树中该节点位于奇数层末尾时的补全完全相同
+    for (size_t level = 0; level < cut_level_; ++level) {
+        const MerkleTree::NodeBuffer& prev = levels[level];
+        MerkleTree::NodeBuffer& curr = levels[level + 1];
+        curr.resize((prev.size() + 1) / 2);
+        size_t pairs = prev.size() / 2;
+        if (pairs > 0) {
+            sha256_64x_n(prev[0].data(), pairs, curr[0].data());
+        }
+        if (prev.size() % 2 == 1) {
+            std::array<uint8_t, 64> combined;
+            memcpy(combined.data(), prev.back().data(), 32);
+            memcpy(combined.data() + 32, prev.back().data(), 32);
+            sha256_64x_n(combined.data(), 1, curr.back().data());
+        }
+    }
+    return 0;
+}
+
+size_t PartialMerkleTree::levels_for_budget(size_t leaf_count, size_t memory_bytes) {
+    if (leaf_count == 0) {
+        return 1;
+    }
+    
+    // 自顶向下逐层加入，直到超出预算
+    std::vector<size_t> sizes(1, leaf_count);
+    while (sizes.back() > 1) {
+        sizes.push_back((sizes.back() + 1) / 2);
+    }
+    size_t kept = 0;
+    size_t used = 0;
+    for (size_t level = sizes.size(); level-- > 0; ) {
+        used += sizes[level] * 32;
+        if (used > memory_bytes) {
+            break;
+        }
+        ++kept;
+    }
+    return std::max<size_t>(kept, 1);
+}
+
+size_t PartialMerkleTree::leaf_count() const {
+    return leaf_count_;
+}
+
+std::array<uint8_t, 32> PartialMerkleTree::get_root() const {
+    return leaf_count_ == 0 ? std::array<uint8_t, 32>() : top_.get_root();
+}
+
+size_t PartialMerkleTree::subtree_leaves() const {
+    return static_cast<size_t>(1) << cut_level_;
+}
+
+size_t PartialMerkleTree::memory_bytes() const {
+    return MerkleTree::node_count(top_.leaf_count()) * 32;
+}
+
+bool PartialMerkleTree::get_proof(size_t leaf_idx, std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path) const {
+    path.clear();
+    if (leaf_idx >= leaf_count_) {
+        return false;
+    }
+    
+    // 1. 下半段：重建挑战叶子所在的子树
+    size_t subtree = leaf_idx >> cut_level_;
+    std::vector<MerkleTree::NodeBuffer> levels;
+    if (cut_level_ > 0 && build_subtree(subtree, levels) != 0) {
+        return false;
+    }
+    size_t current_idx = leaf_idx - (subtree << cut_level_);
+    for (size_t level = 0; level < cut_level_; ++level) {
+        size_t sibling_idx = current_idx ^ 1;
+        if (sibling_idx < levels[level].size()) {
+            path.emplace_back(levels[level][sibling_idx], current_idx % 2 == 0);
+        } else {
+            // 没有兄弟节点，使用当前节点作为兄弟（补全情况）
+            path.emplace_back(levels[level][current_idx], true);
+        }
+        current_idx /= 2;
+    }
+    
+    // 2. 上半段：取自保存的顶部各层
+    std::vector<std::pair<std::array<uint8_t, 32>, bool>> upper;
+    if (!top_.get_proof(subtree, upper)) {
+        return false;
+    }
+    path.insert(path.end(), upper.begin(), upper.end());
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef PARTIAL_MERKLE_TREE_H
+#define PARTIAL_MERKLE_TREE_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include "merkle_tree.h"
+
+// 只保留顶部若干层的 Merkle 树
+// 树高为 H（叶子层为第0层，根为第H层）时只保存第 cut..H 层（cut = H+1-保留层数），
+// 第 cut 层的每个节点是一棵 2^cut 个叶子的子树的根。取证明时通过 LeafSource 重新计算
+// 挑战叶子所在子树的全部叶子哈希，在本地重建这棵子树得到下半段路径，上半段取自保存的顶层。
+// 每次取证明最多重算 2^cut 个叶子哈希，内存只需顶部各层（约 2^(H-cut+1) 个节点）。
+class PartialMerkleTree {
+public:
+    // 叶子哈希来源：计算下标 [first, first+count) 的叶子哈希写入 out，成功返回0
+    using LeafSource = std::function<int(size_t first, size_t count, std::array<uint8_t, 32>* out)>;
+    
+    // 构造函数
+    PartialMerkleTree() = default;
+    
+    // 析构函数
+    ~PartialMerkleTree() = default;
+    
+    // 构建：按子树依次从 source 取叶子哈希，只保留顶部 kept_levels 层（至少1层，即根）
+    // source 在树的整个生命周期内都会被调用，需保证其引用的数据一直有效
+    int build(size_t leaf_count, size_t kept_levels, LeafSource source);
+    
+    // 在内存预算（字节）内能保留的最多顶部层数（预算不足时仍至少保留根所在层）
+    static size_t levels_for_budget(size_t leaf_count, size_t memory_bytes);
+    
+    // 叶子数量 / Merkle根
+    size_t leaf_count() const;
+    std::array<uint8_t, 32> get_root() const;
+    
+    // 每次取证明需要重算的叶子数（2^cut）
+    size_t subtree_leaves() const;
+    
+    // 保存的节点占用的内存（字节）
+    size_t memory_bytes() const;
+    
+    // 获取指定叶子的Merkle路径（格式与 MerkleTree::get_proof 相同）
+    bool get_proof(size_t leaf_idx, std::vector<std::pair<std::array<uint8_t, 32>, bool>>& path) const;
+
+private:
+    size_t leaf_count_ = 0;
+    size_t cut_level_ = 0; // 第 cut_level_ 层及以上保存在 top_ 中
+    MerkleTree top_;       // 以第 cut_level_ 层节点为叶子的上半棵树
+    LeafSource source_;
+    
+    // 计算第 subtree 棵子树（叶子 [subtree<<cut, ...)）的各层节点，levels 输出 cut_level_+1 层
+    int build_subtree(size_t subtree, std::vector<MerkleTree::NodeBuffer>& levels) const;
+};
+
+#endif // PARTIAL_MERKLE_TREE_H
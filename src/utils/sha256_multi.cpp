@@ -0,0 +1,616 @@
+#include "sha256_multi.h"
+#include "hash_engine.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <atomic>
+#include <initializer_list>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+// 向量辅助函数全部强制内联，不存在跨函数传递向量的调用约定问题
+#pragma GCC diagnostic ignored "-Wpsabi"
+#define SHA256_INLINE inline __attribute__((always_inline))
+#else
+#define SHA256_INLINE inline
+#endif
+
+namespace {
+
+// SHA-256 轮常量
+alignas(16) constexpr uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// 初始哈希值
+constexpr uint32_t H[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// 64字节消息的第二个块只有填充（0x80 || 0...0 || 长度512位），其消息扩展为常量，
+// 预先计算 K[t] + W[t]，第二个块的64轮无需再做消息扩展
+struct PaddingSchedule {
+    uint32_t kw[64];
+};
+
+constexpr uint32_t rotr32(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+constexpr PaddingSchedule make_padding_schedule() {
+    PaddingSchedule pad{};
+    uint32_t w[64] = {};
+    w[0] = 0x80000000;
+    w[15] = 512;
+    for (int t = 16; t < 64; ++t) {
+        uint32_t s0 = rotr32(w[t - 15], 7) ^ rotr32(w[t - 15], 18) ^ (w[t - 15] >> 3);
+        uint32_t s1 = rotr32(w[t - 2], 17) ^ rotr32(w[t - 2], 19) ^ (w[t - 2] >> 10);
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+    for (int t = 0; t < 64; ++t) {
+        pad.kw[t] = K[t] + w[t];
+    }
+    return pad;
+}
+
+alignas(16) constexpr PaddingSchedule PAD = make_padding_schedule();
+
+SHA256_INLINE uint32_t load_be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+SHA256_INLINE void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+// ---- 通用多路实现 ----
+// V 为GCC向量类型（每个分量一条消息），运算符对各分量逐一生效；
+// 所有辅助函数强制内联，由调用方的 target 属性决定最终生成的指令集
+
+template <typename V> SHA256_INLINE void set_lane(V& v, size_t j, uint32_t x) { v[j] = x; }
+template <typename V> SHA256_INLINE uint32_t get_lane(const V& v, size_t j) { return v[j]; }
+
+template <typename V> SHA256_INLINE V rotr(const V& x, int n) { return (x >> n) | (x << (32 - n)); }
+template <typename V> SHA256_INLINE V big_sigma0(const V& x) { return rotr(x, 2) ^ rotr(x, 13) ^ rotr(x, 22); }
+template <typename V> SHA256_INLINE V big_sigma1(const V& x) { return rotr(x, 6) ^ rotr(x, 11) ^ rotr(x, 25); }
+template <typename V> SHA256_INLINE V small_sigma0(const V& x) { return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3); }
+template <typename V> SHA256_INLINE V small_sigma1(const V& x) { return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10); }
+template <typename V> SHA256_INLINE V ch(const V& e, const V& f, const V& g) { return g ^ (e & (f ^ g)); }
+template <typename V> SHA256_INLINE V maj(const V& a, const V& b, const V& c) { return (a & b) | (c & (a | b)); }
+
+template <typename V>
+SHA256_INLINE void round(V& a, V& b, V& c, V& d, V& e, V& f, V& g, V& h, const V& kw) {
+    V t1 = h + big_sigma1(e) + ch(e, f, g) + kw;
+    V t2 = big_sigma0(a) + maj(a, b, c);
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+}
+
+// 计算 sizeof(V)/4 条相邻的64字节消息（输入步长64字节，输出步长32字节）
+template <typename V>
+SHA256_INLINE void sha256_64_lanes(const uint8_t* in, uint8_t* out) {
+    constexpr size_t lanes = sizeof(V) / sizeof(uint32_t);
+
+    V w[16];
+    for (int t = 0; t < 16; ++t) {
+        for (size_t j = 0; j < lanes; ++j) {
+            set_lane(w[t], j, load_be32(in + j * 64 + t * 4));
+        }
+    }
+
+    const V zero{};
+    V a = zero + H[0], b = zero + H[1], c = zero + H[2], d = zero + H[3];
+    V e = zero + H[4], f = zero + H[5], g = zero + H[6], h = zero + H[7];
+
+    // 第一个块：消息本身
+#pragma GCC unroll 16
+    for (int t = 0; t < 16; ++t) {
+        round(a, b, c, d, e, f, g, h, w[t] + K[t]);
+    }
+#pragma GCC unroll 48
+    for (int t = 16; t < 64; ++t) {
+        w[t & 15] += small_sigma1(w[(t - 2) & 15]) + w[(t - 7) & 15] + small_sigma0(w[(t - 15) & 15]);
+        round(a, b, c, d, e, f, g, h, w[t & 15] + K[t]);
+    }
+
+    a += H[0]; b += H[1]; c += H[2]; d += H[3];
+    e += H[4]; f += H[5]; g += H[6]; h += H[7];
+
+    // 第二个块：常量填充
+    V s[8] = {a, b, c, d, e, f, g, h};
+#pragma GCC unroll 64
+    for (int t = 0; t < 64; ++t) {
+        round(a, b, c, d, e, f, g, h, zero + PAD.kw[t]);
+    }
+    s[0] += a; s[1] += b; s[2] += c; s[3] += d;
+    s[4] += e; s[5] += f; s[6] += g; s[7] += h;
+
+    for (size_t j = 0; j < lanes; ++j) {
+        for (int i = 0; i < 8; ++i) {
+            store_be32(out + j * 32 + i * 4, get_lane(s[i], j));
+        }
+    }
+}
+
+// ---- 分段消息（任意长度）----
+
+size_t segments_total(const Sha256Segments& msg) {
+    size_t total = 0;
+    for (size_t s = 0; s < SHA256_MAX_SEGMENTS; ++s) {
+        total += msg.len[s];
+    }
+    return total;
+}
+
+// 填充后的块数（消息 || 0x80 || 0...0 || 64位长度）
+size_t padded_block_count(size_t total) {
+    return (total + 8) / 64 + 1;
+}
+
+// 取出分段消息填充后的第 b 个64字节块
+void load_padded_block(const Sha256Segments& msg, size_t total, size_t b, size_t num_blocks, uint8_t* block) {
+    const size_t off = b * 64;
+    size_t filled = 0;
+    size_t seg_start = 0;
+    for (size_t s = 0; s < SHA256_MAX_SEGMENTS && filled < 64; ++s) {
+        size_t seg_end = seg_start + msg.len[s];
+        if (seg_end > off + filled) {
+            size_t from = off + filled - seg_start;
+            size_t n = std::min(msg.len[s] - from, 64 - filled);
+            memcpy(block + filled, msg.data[s] + from, n);
+            filled += n;
+        }
+        seg_start = seg_end;
+    }
+    if (filled == 64) {
+        return;
+    }
+    memset(block + filled, 0, 64 - filled);
+    if (off + filled == total) {
+        block[filled] = 0x80;
+    }
+    if (b + 1 == num_blocks) {
+        uint64_t bits = static_cast<uint64_t>(total) * 8;
+        for (int i = 0; i < 8; ++i) {
+            block[63 - i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+    }
+}
+
+// 第 b 个填充块的地址：整块落在某一段内时直接指向该段，否则组装到 scratch 中
+SHA256_INLINE const uint8_t* padded_block_ptr(const Sha256Segments& msg, size_t total, size_t b,
+                                              size_t num_blocks, uint8_t* scratch) {
+    size_t seg_start = 0;
+    for (size_t s = 0; s < SHA256_MAX_SEGMENTS; ++s) {
+        if (b * 64 >= seg_start && b * 64 + 64 <= seg_start + msg.len[s]) {
+            return msg.data[s] + (b * 64 - seg_start);
+        }
+        seg_start += msg.len[s];
+    }
+    load_padded_block(msg, total, b, num_blocks, scratch);
+    return scratch;
+}
+
+// 对 sizeof(V)/4 路状态各压缩一个64字节块
+// words 按字优先排列：第 t 个消息字的各路依次存放在 words[t*lanes ...]（已转为主机字节序）
+template <typename V>
+SHA256_INLINE void compress_lanes(V state[8], const uint32_t* words) {
+    constexpr size_t lanes = sizeof(V) / sizeof(uint32_t);
+
+    V w[16];
+    for (int t = 0; t < 16; ++t) {
+        memcpy(&w[t], words + t * lanes, sizeof(V));
+    }
+
+    V a = state[0], b = state[1], c = state[2], d = state[3];
+    V e = state[4], f = state[5], g = state[6], h = state[7];
+#pragma GCC unroll 16
+    for (int t = 0; t < 16; ++t) {
+        round(a, b, c, d, e, f, g, h, w[t] + K[t]);
+    }
+#pragma GCC unroll 48
+    for (int t = 16; t < 64; ++t) {
+        w[t & 15] += small_sigma1(w[(t - 2) & 15]) + w[(t - 7) & 15] + small_sigma0(w[(t - 15) & 15]);
+        round(a, b, c, d, e, f, g, h, w[t & 15] + K[t]);
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+// 计算 sizeof(V)/4 条总长度均为 total 的相邻分段消息
+template <typename V>
+SHA256_INLINE void sha256_segments_lanes(const Sha256Segments* msgs, size_t total, uint8_t* out) {
+    constexpr size_t lanes = sizeof(V) / sizeof(uint32_t);
+
+    const V zero{};
+    V state[8];
+    for (int i = 0; i < 8; ++i) {
+        state[i] = zero + H[i];
+    }
+
+    alignas(64) uint32_t words[16 * lanes];
+    alignas(16) uint8_t scratch[64];
+    const size_t num_blocks = padded_block_count(total);
+    for (size_t b = 0; b < num_blocks; ++b) {
+        for (size_t j = 0; j < lanes; ++j) {
+            const uint8_t* block = padded_block_ptr(msgs[j], total, b, num_blocks, scratch);
+            for (int t = 0; t < 16; ++t) {
+                words[t * lanes + j] = load_be32(block + t * 4);
+            }
+        }
+        compress_lanes(state, words);
+    }
+
+    for (size_t j = 0; j < lanes; ++j) {
+        for (int i = 0; i < 8; ++i) {
+            store_be32(out + j * 32 + i * 4, get_lane(state[i], j));
+        }
+    }
+}
+
+// 单条分段消息：逐段送入OpenSSL增量摘要
+void sha256_segments_scalar(const Sha256Segments* msgs, size_t n, uint8_t* out) {
+    HashEngine& engine = HashEngine::local(HashAlgorithm::SHA256);
+    std::array<uint8_t, 32> hash;
+    for (size_t i = 0; i < n; ++i) {
+        engine.init();
+        for (size_t s = 0; s < SHA256_MAX_SEGMENTS; ++s) {
+            if (msgs[i].len[s] > 0) {
+                engine.update(msgs[i].data[s], msgs[i].len[s]);
+            }
+        }
+        engine.final(hash);
+        memcpy(out + 32 * i, hash.data(), 32);
+    }
+}
+
+// 标量路径：逐条调用OpenSSL（与 sha256_hash 完全相同的实现）
+void sha256_64_scalar(const uint8_t* in, size_t n, uint8_t* out) {
+    HashEngine& engine = HashEngine::local(HashAlgorithm::SHA256);
+    std::array<uint8_t, 32> hash;
+    for (size_t i = 0; i < n; ++i) {
+        engine.digest(in + 64 * i, 64, hash);
+        memcpy(out + 32 * i, hash.data(), 32);
+    }
+}
+
+#ifdef SHA256_X86_SIMD
+
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+typedef uint32_t v16u32 __attribute__((vector_size(64)));
+
+// 以下函数的 n 均为对应路数的整数倍
+__attribute__((target("sse4.1")))
+void sha256_64_sse4(const uint8_t* in, size_t n, uint8_t* out) {
+    for (size_t i = 0; i < n; i += 4) {
+        sha256_64_lanes<v4u32>(in + 64 * i, out + 32 * i);
+    }
+}
+
+__attribute__((target("avx2")))
+void sha256_64_avx2(const uint8_t* in, size_t n, uint8_t* out) {
+    for (size_t i = 0; i < n; i += 8) {
+        sha256_64_lanes<v8u32>(in + 64 * i, out + 32 * i);
+    }
+}
+
+__attribute__((target("avx512f")))
+void sha256_64_avx512(const uint8_t* in, size_t n, uint8_t* out) {
+    for (size_t i = 0; i < n; i += 16) {
+        sha256_64_lanes<v16u32>(in + 64 * i, out + 32 * i);
+    }
+}
+
+// SHA扩展指令：state0 保存 ABEF，state1 保存 CDGH，每条 sha256rnds2 执行两轮
+__attribute__((target("sha,sse4.1")))
+void sha256_64_shani(const uint8_t* in, size_t n, uint8_t* out) {
+    const __m128i bswap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    const __m128i init_abef = _mm_set_epi32(static_cast<int>(H[0]), static_cast<int>(H[1]),
+                                            static_cast<int>(H[4]), static_cast<int>(H[5]));
+    const __m128i init_cdgh = _mm_set_epi32(static_cast<int>(H[2]), static_cast<int>(H[3]),
+                                            static_cast<int>(H[6]), static_cast<int>(H[7]));
+
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* msg = in + 64 * i;
+        __m128i state0 = init_abef;
+        __m128i state1 = init_cdgh;
+
+        // 第一个块：4组消息字在 w 中循环复用
+        __m128i w[4];
+        for (int g = 0; g < 16; ++g) {
+            __m128i& wg = w[g & 3];
+            if (g < 4) {
+                wg = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(msg + 16 * g)), bswap_mask);
+            } else {
+                __m128i tmp = _mm_alignr_epi8(w[(g - 1) & 3], w[(g - 2) & 3], 4);
+                wg = _mm_sha256msg1_epu32(wg, w[(g - 3) & 3]);
+                wg = _mm_sha256msg2_epu32(_mm_add_epi32(wg, tmp), w[(g - 1) & 3]);
+            }
+            __m128i kw = _mm_add_epi32(wg, _mm_load_si128(reinterpret_cast<const __m128i*>(K + 4 * g)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, kw);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(kw, 0x0E));
+        }
+        state0 = _mm_add_epi32(state0, init_abef);
+        state1 = _mm_add_epi32(state1, init_cdgh);
+
+        // 第二个块：直接使用预计算的 K+W
+        const __m128i save0 = state0;
+        const __m128i save1 = state1;
+        for (int g = 0; g < 16; ++g) {
+            __m128i kw = _mm_load_si128(reinterpret_cast<const __m128i*>(PAD.kw + 4 * g));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, kw);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(kw, 0x0E));
+        }
+        state0 = _mm_add_epi32(state0, save0);
+        state1 = _mm_add_epi32(state1, save1);
+
+        // ABEF/CDGH → ABCD/EFGH，并转为大端输出
+        __m128i feba = _mm_shuffle_epi32(state0, 0x1B);
+        __m128i dchg = _mm_shuffle_epi32(state1, 0xB1);
+        __m128i abcd = _mm_blend_epi16(feba, dchg, 0xF0);
+        __m128i efgh = _mm_alignr_epi8(dchg, feba, 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32 * i), _mm_shuffle_epi8(abcd, bswap_mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32 * i + 16), _mm_shuffle_epi8(efgh, bswap_mask));
+    }
+}
+
+// 分段消息的多路版本：msgs 中 n 条消息按路数分组，组内总长度相同（由调用方保证）
+__attribute__((target("sse4.1")))
+void sha256_segments_sse4(const Sha256Segments* msgs, size_t n, size_t total, uint8_t* out) {
+    for (size_t i = 0; i < n; i += 4) {
+        sha256_segments_lanes<v4u32>(msgs + i, total, out + 32 * i);
+    }
+}
+
+__attribute__((target("avx2")))
+void sha256_segments_avx2(const Sha256Segments* msgs, size_t n, size_t total, uint8_t* out) {
+    for (size_t i = 0; i < n; i += 8) {
+        sha256_segments_lanes<v8u32>(msgs + i, total, out + 32 * i);
+    }
+}
+
+__attribute__((target("avx512f")))
+void sha256_segments_avx512(const Sha256Segments* msgs, size_t n, size_t total, uint8_t* out) {
+    for (size_t i = 0; i < n; i += 16) {
+        sha256_segments_lanes<v16u32>(msgs + i, total, out + 32 * i);
+    }
+}
+
+// SHA扩展指令压缩一个64字节块（state0 为 ABEF，state1 为 CDGH）
+__attribute__((target("sha,sse4.1")))
+inline void shani_compress(__m128i& state0, __m128i& state1, const uint8_t* block, const __m128i& bswap_mask) {
+    const __m128i save0 = state0;
+    const __m128i save1 = state1;
+    __m128i w[4];
+    for (int g = 0; g < 16; ++g) {
+        __m128i& wg = w[g & 3];
+        if (g < 4) {
+            wg = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * g)), bswap_mask);
+        } else {
+            __m128i tmp = _mm_alignr_epi8(w[(g - 1) & 3], w[(g - 2) & 3], 4);
+            wg = _mm_sha256msg1_epu32(wg, w[(g - 3) & 3]);
+            wg = _mm_sha256msg2_epu32(_mm_add_epi32(wg, tmp), w[(g - 1) & 3]);
+        }
+        __m128i kw = _mm_add_epi32(wg, _mm_load_si128(reinterpret_cast<const __m128i*>(K + 4 * g)));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, kw);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(kw, 0x0E));
+    }
+    state0 = _mm_add_epi32(state0, save0);
+    state1 = _mm_add_epi32(state1, save1);
+}
+
+// 分段消息逐条用SHA扩展指令计算（各消息长度可以不同）
+__attribute__((target("sha,sse4.1")))
+void sha256_segments_shani(const Sha256Segments* msgs, size_t n, uint8_t* out) {
+    const __m128i bswap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    alignas(16) uint8_t block[64];
+    for (size_t i = 0; i < n; ++i) {
+        __m128i state0 = _mm_set_epi32(static_cast<int>(H[0]), static_cast<int>(H[1]),
+                                       static_cast<int>(H[4]), static_cast<int>(H[5]));
+        __m128i state1 = _mm_set_epi32(static_cast<int>(H[2]), static_cast<int>(H[3]),
+                                       static_cast<int>(H[6]), static_cast<int>(H[7]));
+        const size_t total = segments_total(msgs[i]);
+        const size_t num_blocks = padded_block_count(total);
+        for (size_t b = 0; b < num_blocks; ++b) {
+            shani_compress(state0, state1, padded_block_ptr(msgs[i], total, b, num_blocks, block), bswap_mask);
+        }
+
+        __m128i feba = _mm_shuffle_epi32(state0, 0x1B);
+        __m128i dchg = _mm_shuffle_epi32(state1, 0xB1);
+        __m128i abcd = _mm_blend_epi16(feba, dchg, 0xF0);
+        __m128i efgh = _mm_alignr_epi8(dchg, feba, 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32 * i), _mm_shuffle_epi8(abcd, bswap_mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32 * i + 16), _mm_shuffle_epi8(efgh, bswap_mask));
+    }
+}
+
+#endif // SHA256_X86_SIMD
+
+using KernelFn = void (*)(const uint8_t*, size_t, uint8_t*);
+
+struct KernelEntry {
+    KernelFn fn;
+    size_t lanes;
+};
+
+KernelEntry kernel_entry(Sha256Kernel kernel) {
+    switch (kernel) {
+#ifdef SHA256_X86_SIMD
+        case Sha256Kernel::SSE4:   return {sha256_64_sse4, 4};
+        case Sha256Kernel::AVX2:   return {sha256_64_avx2, 8};
+        case Sha256Kernel::AVX512: return {sha256_64_avx512, 16};
+        case Sha256Kernel::SHANI:  return {sha256_64_shani, 1};
+#endif
+        default:                   return {sha256_64_scalar, 1};
+    }
+}
+
+// 按批量吞吐从高到低选择当前CPU支持的内核
+// （16路AVX-512 > SHA扩展 > 8路AVX2 > 4路SSE4.1 > 标量）
+Sha256Kernel detect_best_kernel() {
+    for (Sha256Kernel kernel : {Sha256Kernel::AVX512, Sha256Kernel::SHANI, Sha256Kernel::AVX2,
+                                Sha256Kernel::SSE4}) {
+        if (sha256_kernel_supported(kernel)) {
+            return kernel;
+        }
+    }
+    return Sha256Kernel::SCALAR;
+}
+
+std::atomic<Sha256Kernel>& active_kernel() {
+    static std::atomic<Sha256Kernel> kernel{detect_best_kernel()};
+    return kernel;
+}
+
+// 不足一组路数的尾部消息使用单路最快实现
+KernelFn tail_kernel() {
+    static const KernelFn fn = sha256_kernel_supported(Sha256Kernel::SHANI)
+                                   ? kernel_entry(Sha256Kernel::SHANI).fn
+                                   : kernel_entry(Sha256Kernel::SCALAR).fn;
+    return fn;
+}
+
+void run_kernel(Sha256Kernel kernel, const uint8_t* in, size_t n, uint8_t* out) {
+    KernelEntry entry = kernel_entry(kernel);
+    size_t full = n - n % entry.lanes;
+    if (full > 0) {
+        entry.fn(in, full, out);
+    }
+    if (full < n) {
+        tail_kernel()(in + 64 * full, n - full, out + 32 * full);
+    }
+}
+
+using SegmentsLanesFn = void (*)(const Sha256Segments*, size_t, size_t, uint8_t*);
+using SegmentsFn = void (*)(const Sha256Segments*, size_t, uint8_t*);
+
+struct SegmentsKernelEntry {
+    SegmentsLanesFn lanes_fn;  // 多路实现（组内等长），单路内核为空
+    size_t lanes;
+};
+
+SegmentsKernelEntry segments_kernel_entry(Sha256Kernel kernel) {
+    switch (kernel) {
+#ifdef SHA256_X86_SIMD
+        case Sha256Kernel::SSE4:   return {sha256_segments_sse4, 4};
+        case Sha256Kernel::AVX2:   return {sha256_segments_avx2, 8};
+        case Sha256Kernel::AVX512: return {sha256_segments_avx512, 16};
+#endif
+        default:                   return {nullptr, 1};
+    }
+}
+
+// 单条计算的分段消息实现（SHA扩展指令优先）
+SegmentsFn segments_single_kernel(Sha256Kernel kernel) {
+#ifdef SHA256_X86_SIMD
+    if (kernel != Sha256Kernel::SCALAR && sha256_kernel_supported(Sha256Kernel::SHANI)) {
+        return sha256_segments_shani;
+    }
+#endif
+    return sha256_segments_scalar;
+}
+
+void run_segments_kernel(Sha256Kernel kernel, const Sha256Segments* msgs, size_t n, uint8_t* out) {
+    SegmentsKernelEntry entry = segments_kernel_entry(kernel);
+    SegmentsFn single = segments_single_kernel(kernel);
+    size_t i = 0;
+    while (i < n) {
+        // 从 i 开始数出总长度相同的连续消息，取路数的整数倍走多路实现
+        size_t total = segments_total(msgs[i]);
+        size_t run = 1;
+        if (entry.lanes_fn) {
+            while (i + run < n && segments_total(msgs[i + run]) == total) {
+                ++run;
+            }
+        }
+        size_t full = entry.lanes_fn ? run - run % entry.lanes : 0;
+        if (full > 0) {
+            entry.lanes_fn(msgs + i, full, total, out + 32 * i);
+        }
+        if (full < run) {
+            single(msgs + i + full, run - full, out + 32 * (i + full));
+        }
+        i += run;
+    }
+}
+
+} // namespace
+
+void sha256_64x_n(const uint8_t* in, size_t n, uint8_t* out) {
+    run_kernel(active_kernel().load(std::memory_order_relaxed), in, n, out);
+}
+
+int sha256_64x_n_with(Sha256Kernel kernel, const uint8_t* in, size_t n, uint8_t* out) {
+    if (!sha256_kernel_supported(kernel)) {
+        return -1;
+    }
+    run_kernel(kernel, in, n, out);
+    return 0;
+}
+
+bool sha256_kernel_supported(Sha256Kernel kernel) {
+#ifdef SHA256_X86_SIMD
+    __builtin_cpu_init();
+    switch (kernel) {
+        case Sha256Kernel::SCALAR: return true;
+        case Sha256Kernel::SSE4:   return __builtin_cpu_supports("sse4.1");
+        case Sha256Kernel::AVX2:   return __builtin_cpu_supports("avx2");
+        case Sha256Kernel::AVX512: return __builtin_cpu_supports("avx512f");
+        case Sha256Kernel::SHANI:  return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+    }
+    return false;
+#else
+    return kernel == Sha256Kernel::SCALAR;
+#endif
+}
+
+Sha256Kernel sha256_active_kernel() {
+    return active_kernel().load(std::memory_order_relaxed);
+}
+
+int sha256_set_active_kernel(Sha256Kernel kernel) {
+    if (!sha256_kernel_supported(kernel)) {
+        return -1;
+    }
+    active_kernel().store(kernel, std::memory_order_relaxed);
+    return 0;
+}
+
+const char* sha256_kernel_name(Sha256Kernel kernel) {
+    switch (kernel) {
+        case Sha256Kernel::SCALAR: return "scalar";
+        case Sha256Kernel::SSE4:   return "sse4";
+        case Sha256Kernel::AVX2:   return "avx2";
+        case Sha256Kernel::AVX512: return "avx512";
+        case Sha256Kernel::SHANI:  return "sha-ni";
+    }
+    return "unknown";
+}
+
+void sha256_segments_x_n(const Sha256Segments* msgs, size_t n, uint8_t* out) {
+    run_segments_kernel(active_kernel().load(std::memory_order_relaxed), msgs, n, out);
+}
+
+int sha256_segments_x_n_with(Sha256Kernel kernel, const Sha256Segments* msgs, size_t n, uint8_t* out) {
+    if (!sha256_kernel_supported(kernel)) {
+        return -1;
+    }
+    run_segments_kernel(kernel, msgs, n, out);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#ifndef SHA256_MULTI_H
+#define SHA256_MULTI_H
+
+#include <cstdint>
+#include <cstddef>
+
+// SHA-256 批量计算内核的实现类型
+enum class Sha256Kernel {
+    SCALAR,  // 逐条调用OpenSSL（所有平台可用）
+    SSE4,    // 4路并行（SSE4.1）
+    AVX2,    // 8路并行（AVX2）
+    AVX512,  // 16路并行（AVX-512F）
+    SHANI    // Intel SHA扩展指令（逐条消息）
+};
+
+// 批量计算 n 条 64 字节消息的 SHA-256（Merkle树内部节点：左子哈希||右子哈希）
+// in: n*64 字节连续输入，out: n*32 字节连续输出（第 i 条消息的哈希写入 out + 32*i）
+// 结果与 sha256_hash(in + 64*i, 64, ...) 逐字节一致，启动时按CPU能力自动选择最快内核
+void sha256_64x_n(const uint8_t* in, size_t n, uint8_t* out);
+
+// 使用指定内核计算（测试/基准用），当前CPU不支持该内核时返回-1
+int sha256_64x_n_with(Sha256Kernel kernel, const uint8_t* in, size_t n, uint8_t* out);
+
+// 分段消息：由至多 SHA256_MAX_SEGMENTS 段内存按顺序拼接而成（如加密块的 IV || 密文 || 认证标签），
+// 哈希时直接从各段读取，调用方无需先复制到一起；未用到的段长度置0
+constexpr size_t SHA256_MAX_SEGMENTS = 3;
+struct Sha256Segments {
+    const uint8_t* data[SHA256_MAX_SEGMENTS];
+    size_t len[SHA256_MAX_SEGMENTS];
+};
+
+// 批量计算 n 条分段消息的 SHA-256（第 i 条的哈希写入 out + 32*i）
+// 总长度相同的相邻消息按当前内核的路数并行计算（如全部为满块的加密块），其余逐条计算
+void sha256_segments_x_n(const Sha256Segments* msgs, size_t n, uint8_t* out);
+
+// 使用指定内核计算分段消息（测试/基准用），当前CPU不支持该内核时返回-1
+int sha256_segments_x_n_with(Sha256Kernel kernel, const Sha256Segments* msgs, size_t n, uint8_t* out);
+
+// 当前CPU是否支持指定内核
+bool sha256_kernel_supported(Sha256Kernel kernel);
+
+// 当前 sha256_64x_n 使用的内核
+Sha256Kernel sha256_active_kernel();
+
+// 强制 sha256_64x_n 使用指定内核（基准对比用），不支持时返回-1且不做修改
+int sha256_set_active_kernel(Sha256Kernel kernel);
+
+// 内核名称（用于日志/基准输出）
+const char* sha256_kernel_name(Sha256Kernel kernel);
+
+#endif // SHA256_MULTI_H
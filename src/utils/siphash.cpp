@@ -0,0 +1,67 @@
+#include "siphash.h"
+#include <openssl/rand.h>
+
+namespace {
+
+inline uint64_t rotl64(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+inline void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1; v1 = rotl64(v1, 13); v1 ^= v0; v0 = rotl64(v0, 32);
+    v2 += v3; v3 = rotl64(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl64(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl64(v1, 17); v1 ^= v2; v2 = rotl64(v2, 32);
+}
+
+inline uint64_t load_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+} // namespace
+
+uint64_t siphash24(const std::array<uint64_t, 2>& key, const uint8_t* data, size_t len) {
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key[0];
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key[1];
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key[0];
+    uint64_t v3 = 0x7465646279746573ULL ^ key[1];
+    size_t full = len & ~static_cast<size_t>(7);
+    for (size_t i = 0; i < full; i += 8) {
+        uint64_t m = load_le64(data + i);
+        v3 ^= m;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    uint64_t last = static_cast<uint64_t>(len) << 56;
+    for (size_t i = full; i < len; ++i) {
+        last |= static_cast<uint64_t>(data[i]) << (8 * (i - full));
+    }
+    v3 ^= last;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= last;
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i) {
+        sip_round(v0, v1, v2, v3);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+const std::array<uint64_t, 2>& process_hash_key() {
+    static const std::array<uint64_t, 2> key = []() {
+        // 取随机数失败时退化为固定密钥（仍是完整的键参与哈希，只是失去抗碰撞构造的能力）
+        std::array<uint64_t, 2> k{};
+        RAND_bytes(reinterpret_cast<unsigned char*>(k.data()), static_cast<int>(sizeof(k)));
+        return k;
+    }();
+    return key;
+}
+
+uint64_t keyed_hash(const uint8_t* data, size_t len) {
+    return siphash24(process_hash_key(), data, len);
+}
@@ -0,0 +1,19 @@
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// SipHash-2-4：带128位密钥的短消息哈希。
+// 用于以对方可控的数据（公钥、文件指纹、叶子哈希）为键的哈希表和分片选择：
+// 密钥未知时无法构造出大量落入同一桶或分片的键。
+uint64_t siphash24(const std::array<uint64_t, 2>& key, const uint8_t* data, size_t len);
+
+// 进程内随机的哈希密钥（首次调用时生成，之后不变）
+const std::array<uint64_t, 2>& process_hash_key();
+
+// 用进程密钥计算 SipHash-2-4
+uint64_t keyed_hash(const uint8_t* data, size_t len);
+
+#endif // SIPHASH_H
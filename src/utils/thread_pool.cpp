@@ -0,0 +1,136 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace {
+// 当前线程所属的线程池及其编号
+thread_local const ThreadPool* tls_pool = nullptr;
+thread_local size_t tls_worker_index = 0;
+}
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers_.size();
+}
+
+size_t ThreadPool::current_worker() const {
+    return tls_pool == this ? tls_worker_index : workers_.size();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    // 工作线程提交到自己的队列，外部线程轮询分散到各队列
+    size_t index = current_worker();
+    if (index >= queues_.size()) {
+        index = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1);
+
+    // 加锁后再通知，避免工作线程检查条件与进入等待之间错过唤醒
+    { std::lock_guard<std::mutex> lock(wake_mutex_); }
+    wake_cv_.notify_one();
+}
+
+bool ThreadPool::run_one(size_t home) {
+    std::function<void()> task;
+    size_t n = queues_.size();
+
+    // 1. 先取本线程队列的队尾
+    if (home < n) {
+        std::lock_guard<std::mutex> lock(queues_[home]->mutex);
+        if (!queues_[home]->tasks.empty()) {
+            task = std::move(queues_[home]->tasks.back());
+            queues_[home]->tasks.pop_back();
+        }
+    }
+
+    // 2. 再从其他队列的队首窃取
+    for (size_t i = 1; !task && i <= n; ++i) {
+        size_t victim = (home + i) % n;
+        std::lock_guard<std::mutex> lock(queues_[victim]->mutex);
+        if (!queues_[victim]->tasks.empty()) {
+            task = std::move(queues_[victim]->tasks.front());
+            queues_[victim]->tasks.pop_front();
+        }
+    }
+
+    if (!task) {
+        return false;
+    }
+    queued_.fetch_sub(1);
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    tls_pool = this;
+    tls_worker_index = index;
+
+    while (true) {
+        if (run_one(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(1, grain);
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workers_.size() <= 1) {
+        fn(0, count);
+        return;
+    }
+
+    std::atomic<size_t> remaining{chunks - 1};
+    for (size_t c = 1; c < chunks; ++c) {
+        size_t begin = c * grain;
+        size_t end = std::min(count, begin + grain);
+        submit([&fn, &remaining, begin, end] {
+            fn(begin, end);
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    // 调用线程处理第一块，然后协助执行池中的任务直到所有块完成
+    fn(0, std::min(count, grain));
+    size_t home = current_worker();
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!run_one(home)) {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池
+// 每个工作线程有自己的任务队列：本线程从队尾取任务（LIFO，缓存友好），
+// 空闲线程从其他线程的队首窃取任务（FIFO，优先拿较大的早期任务）。
+class ThreadPool {
+public:
+    // num_threads: 工作线程数（0 表示使用CPU核数）
+    explicit ThreadPool(size_t num_threads = 0);
+
+    // 析构函数：执行完已提交的任务后退出所有工作线程
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 工作线程数
+    size_t size() const;
+
+    // 提交一个异步任务（任务内部不应抛出异常）
+    void submit(std::function<void()> task);
+
+    // 并行执行 fn(begin, end)，把 [0, count) 按 grain 切分成多个任务，阻塞直到全部完成
+    // 调用线程在等待期间也会执行池中的任务，因此可以在任务内部嵌套调用
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+    // 当前线程在本线程池中的编号（0 ~ size()-1），非本池线程返回 size()
+    size_t current_worker() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<size_t> queued_{0};      // 已入队尚未取出的任务数
+    std::atomic<size_t> next_queue_{0};  // 外部线程提交任务时轮询的队列
+    std::atomic<bool> stopping_{false};
+
+    // 从本线程队列或其他队列取出一个任务执行，没有任务时返回 false
+    bool run_one(size_t home);
+
+    // 工作线程主循环
+    void worker_loop(size_t index);
+};
+
+#endif // THREAD_POOL_H
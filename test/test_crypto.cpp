@@ -1,9 +1,29 @@
 #include <gtest/gtest.h>
 #include "../src/utils/crypto_utils.h"
+#include "../src/utils/hash_engine.h"
+#include "../src/utils/sha256_multi.h"
+#include "../src/utils/aes_gcm_engine.h"
+#include "../src/utils/cdc_chunker.h"
+#include "../src/utils/thread_pool.h"
+#include "../src/utils/siphash.h"
 #include "../src/tee_simulator/random_source.h"
+#include "../src/tee_simulator/enclave_sign.h"
+#include "../src/tee_simulator/verify_key_cache.h"
+#include "../src/tee_simulator/ed25519_batch.h"
+#include "../src/tee_simulator/nonce_pool.h"
 #include <vector>
+#include <set>
 #include <array>
 #include <cstring>
+#include <chrono>
+#include <thread>
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 TEST(CryptoUtilsTest, AesGcmEncryption) {
     // 生成随机密钥
@@ -91,3 +111,641 @@ TEST(CryptoUtilsTest, HashEncryptedBlock) {
     // 哈希应该不同
     EXPECT_NE(hash1, hash2);
 }
+
+TEST(CryptoUtilsTest, HashEncryptedBlocksBatch) {
+    std::vector<EncryptedBlock> blocks(9);
+    EncryptedBlockSet set;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i].ciphertext.resize(i * 100);
+        for (size_t j = 0; j < blocks[i].ciphertext.size(); ++j) {
+            blocks[i].ciphertext[j] = static_cast<uint8_t>(i + j * 3);
+        }
+        blocks[i].iv.fill(static_cast<uint8_t>(i));
+        blocks[i].auth_tag.fill(static_cast<uint8_t>(0xF0 - i));
+        ASSERT_EQ(set.push_back(blocks[i]), 0);
+    }
+    
+    // 流式哈希与 SHA-256(IV || 密文 || 认证标签) 一致（包括空密文）
+    for (const auto& block : blocks) {
+        std::vector<uint8_t> data(block.iv.begin(), block.iv.end());
+        data.insert(data.end(), block.ciphertext.begin(), block.ciphertext.end());
+        data.insert(data.end(), block.auth_tag.begin(), block.auth_tag.end());
+        std::array<uint8_t, 32> expected;
+        sha256_hash(data.data(), data.size(), expected);
+        EXPECT_EQ(hash_encrypted_block(block), expected);
+    }
+    
+    // 批量哈希与逐块哈希一致，越界被拒绝
+    std::vector<std::array<uint8_t, 32>> from_vector(7), from_set(7);
+    ASSERT_EQ(hash_encrypted_blocks(blocks, 2, 7, from_vector.data()), 0);
+    ASSERT_EQ(hash_encrypted_blocks(set, 2, 7, from_set.data()), 0);
+    for (size_t i = 0; i < 7; ++i) {
+        EXPECT_EQ(from_vector[i], hash_encrypted_block(blocks[2 + i]));
+        EXPECT_EQ(from_set[i], from_vector[i]);
+    }
+    EXPECT_EQ(hash_encrypted_blocks(blocks, 3, 7, from_vector.data()), -1);
+    EXPECT_EQ(hash_encrypted_blocks(set, 10, 0, from_set.data()), -1);
+}
+
+TEST(CryptoUtilsTest, EncryptedBlockSet) {
+    EncryptedBlockSet set(64);
+    std::vector<EncryptedBlock> blocks(5);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i].ciphertext.assign(10 * i + 3, static_cast<uint8_t>(i));
+        blocks[i].iv.fill(static_cast<uint8_t>(0x10 + i));
+        blocks[i].auth_tag.fill(static_cast<uint8_t>(0x20 + i));
+        ASSERT_EQ(set.push_back(blocks[i]), 0);
+    }
+    ASSERT_EQ(set.size(), blocks.size());
+    
+    // 视图与独立块内容一致，哈希也一致
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        EncryptedBlock copy = set[i].to_block();
+        EXPECT_EQ(copy.ciphertext, blocks[i].ciphertext);
+        EXPECT_EQ(copy.iv, blocks[i].iv);
+        EXPECT_EQ(copy.auth_tag, blocks[i].auth_tag);
+        EXPECT_EQ(hash_encrypted_block(set[i]), hash_encrypted_block(blocks[i]));
+    }
+    
+    // 原地重写（变短），其他块不受影响
+    EncryptedBlock shorter = blocks[1];
+    shorter.ciphertext.resize(1);
+    ASSERT_EQ(set.set_block(2, shorter), 0);
+    EXPECT_EQ(hash_encrypted_block(set[2]), hash_encrypted_block(shorter));
+    EXPECT_EQ(hash_encrypted_block(set[3]), hash_encrypted_block(blocks[3]));
+    
+    // 超过槽位大小或下标越界被拒绝
+    EncryptedBlock too_large = blocks[0];
+    too_large.ciphertext.resize(65);
+    EXPECT_EQ(set.push_back(too_large), -1);
+    EXPECT_EQ(set.set_block(0, too_large), -1);
+    EXPECT_EQ(set.set_block(5, blocks[0]), -1);
+    EXPECT_EQ(set.size(), blocks.size());
+    
+    set.resize(2);
+    EXPECT_EQ(set.size(), 2u);
+    EXPECT_EQ(hash_encrypted_block(set[1]), hash_encrypted_block(blocks[1]));
+}
+
+TEST(CryptoUtilsTest, HashEngineIncremental) {
+    // SHA-256("abc") 标准测试向量
+    const uint8_t abc[] = {'a', 'b', 'c'};
+    const std::array<uint8_t, 32> expected = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+    };
+    std::array<uint8_t, 32> hash;
+    sha256_hash(abc, sizeof(abc), hash);
+    EXPECT_EQ(hash, expected);
+
+    // 分段增量计算应与一次性计算结果一致
+    std::vector<uint8_t> data(1000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i * 7);
+
+    for (HashAlgorithm algo : {HashAlgorithm::SHA256, HashAlgorithm::SHA3_256}) {
+        std::array<uint8_t, 32> one_shot, incremental;
+        if (algo == HashAlgorithm::SHA256) {
+            sha256_hash(data.data(), data.size(), one_shot);
+        } else {
+            sha3_256_hash(data.data(), data.size(), one_shot);
+        }
+
+        HashEngine engine(algo);
+        ASSERT_EQ(engine.init(), 0);
+        ASSERT_EQ(engine.update(data.data(), 100), 0);
+        ASSERT_EQ(engine.update(data.data() + 100, 0), 0);
+        ASSERT_EQ(engine.update(data.data() + 100, 900), 0);
+        ASSERT_EQ(engine.final(incremental), 0);
+        EXPECT_EQ(one_shot, incremental);
+    }
+}
+
+TEST(CryptoUtilsTest, Sha256MultiBufferKernels) {
+    // 覆盖整组路数与尾部（n 不是路数的整数倍）的情况
+    const size_t max_n = 37;
+    std::vector<uint8_t> input(64 * max_n);
+    ASSERT_EQ(tee_get_random(input.data(), input.size()), 0);
+
+    std::vector<uint8_t> expected(32 * max_n);
+    for (size_t i = 0; i < max_n; ++i) {
+        std::array<uint8_t, 32> hash;
+        sha256_hash(input.data() + 64 * i, 64, hash);
+        memcpy(expected.data() + 32 * i, hash.data(), 32);
+    }
+
+    for (Sha256Kernel kernel : {Sha256Kernel::SCALAR, Sha256Kernel::SSE4, Sha256Kernel::AVX2,
+                                Sha256Kernel::AVX512, Sha256Kernel::SHANI}) {
+        if (!sha256_kernel_supported(kernel)) continue;
+        for (size_t n : {static_cast<size_t>(1), static_cast<size_t>(16), max_n}) {
+            std::vector<uint8_t> output(32 * n);
+            ASSERT_EQ(sha256_64x_n_with(kernel, input.data(), n, output.data()), 0);
+            EXPECT_EQ(memcmp(output.data(), expected.data(), 32 * n), 0) << sha256_kernel_name(kernel) << " n=" << n;
+        }
+    }
+}
+
+TEST(CryptoUtilsTest, Sha256SegmentKernels) {
+    // 覆盖填充边界附近的长度（55/56/63/64/119/120字节）、等长分组与尾部、变长消息
+    std::vector<uint8_t> pool(4096);
+    ASSERT_EQ(tee_get_random(pool.data(), pool.size()), 0);
+    std::vector<size_t> lengths;
+    for (size_t len : {0, 1, 55, 56, 63, 64, 119, 120, 1052}) {
+        for (int k = 0; k < 19; ++k) {
+            lengths.push_back(len);
+        }
+    }
+    for (size_t i = 0; i < 23; ++i) {
+        lengths.push_back(i * 37 % 300);
+    }
+    
+    std::vector<Sha256Segments> msgs(lengths.size());
+    std::vector<uint8_t> expected(32 * lengths.size());
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        // 三段长度分别取 12 / 中间 / 16（不足时缩短），起点在缓冲区中错开
+        size_t len = lengths[i];
+        size_t a = std::min<size_t>(12, len);
+        size_t c = std::min<size_t>(16, len - a);
+        size_t b = len - a - c;
+        const uint8_t* base = pool.data() + i * 7;
+        msgs[i] = {{base, base + 1500, base + 2900}, {a, b, c}};
+        std::vector<uint8_t> concat(base, base + a);
+        concat.insert(concat.end(), base + 1500, base + 1500 + b);
+        concat.insert(concat.end(), base + 2900, base + 2900 + c);
+        std::array<uint8_t, 32> hash;
+        sha256_hash(concat.data(), concat.size(), hash);
+        memcpy(expected.data() + 32 * i, hash.data(), 32);
+    }
+    
+    for (Sha256Kernel kernel : {Sha256Kernel::SCALAR, Sha256Kernel::SSE4, Sha256Kernel::AVX2,
+                                Sha256Kernel::AVX512, Sha256Kernel::SHANI}) {
+        if (!sha256_kernel_supported(kernel)) continue;
+        std::vector<uint8_t> output(32 * msgs.size());
+        ASSERT_EQ(sha256_segments_x_n_with(kernel, msgs.data(), msgs.size(), output.data()), 0);
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            EXPECT_EQ(memcmp(output.data() + 32 * i, expected.data() + 32 * i, 32), 0)
+                << sha256_kernel_name(kernel) << " len=" << lengths[i];
+        }
+    }
+}
+
+TEST(CryptoUtilsTest, AesGcmEngineParallelBlocks) {
+    std::array<uint8_t, 32> key;
+    ASSERT_EQ(tee_get_random(key.data(), 32), 0);
+    
+    // 复用同一引擎加密多块，结果与每次新建上下文的 aes_gcm_encrypt 一致
+    AesGcmEngine engine(key);
+    ASSERT_TRUE(engine.is_valid());
+    for (size_t len : {0, 1, 16, 1000, 1024}) {
+        std::vector<uint8_t> plaintext(len, static_cast<uint8_t>(len));
+        std::array<uint8_t, 12> iv;
+        ASSERT_EQ(tee_get_random(iv.data(), 12), 0);
+        
+        std::vector<uint8_t> expected;
+        std::array<uint8_t, 16> expected_tag;
+        ASSERT_EQ(aes_gcm_encrypt(key, plaintext, iv, expected, expected_tag), 0);
+        std::vector<uint8_t> ciphertext(len);
+        std::array<uint8_t, 16> auth_tag;
+        ASSERT_EQ(engine.encrypt(plaintext.data(), len, iv, ciphertext.data(), auth_tag), 0);
+        EXPECT_EQ(ciphertext, expected);
+        EXPECT_EQ(auth_tag, expected_tag);
+    }
+    
+    // 多线程分块加密（最后一块不满），每块可解密，叶子哈希正确，IV互不相同
+    std::vector<uint8_t> data(1024 * 1000 + 77);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7 + (i >> 10));
+    }
+    ThreadPool pool(3);
+    ParallelBlockEncryptor encryptor(key, &pool);
+    std::vector<EncryptedBlock> blocks;
+    std::vector<std::array<uint8_t, 32>> leaf_hashes(1001);
+    ASSERT_EQ(encryptor.encrypt_blocks(data.data(), data.size(), 1024, blocks, leaf_hashes.data()), 0);
+    ASSERT_EQ(blocks.size(), 1001u);
+    EXPECT_EQ(blocks.back().ciphertext.size(), 77u);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        std::vector<uint8_t> decrypted;
+        ASSERT_EQ(aes_gcm_decrypt(key, blocks[i].ciphertext, blocks[i].iv, blocks[i].auth_tag, decrypted), 0);
+        std::vector<uint8_t> original(data.begin() + i * 1024,
+                                      data.begin() + std::min(data.size(), (i + 1) * 1024));
+        ASSERT_EQ(decrypted, original);
+        ASSERT_EQ(leaf_hashes[i], hash_encrypted_block(blocks[i]));
+        if (i > 0) {
+            ASSERT_NE(blocks[i].iv, blocks[i - 1].iv);
+        }
+    }
+}
+
+TEST(CryptoUtilsTest, HmacSha256) {
+    std::array<uint8_t, 32> key;
+    ASSERT_EQ(tee_get_random(key.data(), key.size()), 0);
+    for (size_t len : {static_cast<size_t>(0), static_cast<size_t>(55), static_cast<size_t>(1000)}) {
+        std::vector<uint8_t> data(len, 0x5A);
+        std::array<uint8_t, 32> mac, expected;
+        unsigned int expected_len = 0;
+        ASSERT_EQ(hmac_sha256(key, data.data(), data.size(), mac), 0);
+        ASSERT_NE(HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()), data.data(), data.size(),
+                       expected.data(), &expected_len), nullptr);
+        EXPECT_EQ(mac, expected) << "len=" << len;
+    }
+    
+    // 计算 HMAC 不影响调用方在线程局部引擎上进行中的摘要
+    std::vector<uint8_t> message(100, 0x3C);
+    std::array<uint8_t, 32> mac, split_digest, whole_digest;
+    HashEngine& engine = HashEngine::local(HashAlgorithm::SHA256);
+    ASSERT_EQ(engine.init(), 0);
+    ASSERT_EQ(engine.update(message.data(), 40), 0);
+    ASSERT_EQ(hmac_sha256(key, message.data(), message.size(), mac), 0);
+    ASSERT_EQ(engine.update(message.data() + 40, 60), 0);
+    ASSERT_EQ(engine.final(split_digest), 0);
+    ASSERT_EQ(engine.digest(message.data(), message.size(), whole_digest), 0);
+    EXPECT_EQ(split_digest, whole_digest);
+}
+
+TEST(CryptoUtilsTest, ContentDefinedChunking) {
+    std::vector<uint8_t> data(1 << 20);
+    ASSERT_EQ(tee_get_random(data.data(), data.size()), 0);
+    ChunkingParams params;
+    CdcChunker chunker(params);
+    ASSERT_TRUE(chunker.is_valid());
+    EXPECT_FALSE(CdcChunker(ChunkingParams{2048, 1024, 4096}).is_valid());
+    
+    // 各内核切点一致（覆盖不足一组路数的短输入和文件开头不足预热窗口的情况），块长在 [min, max] 内
+    std::vector<size_t> expected;
+    ASSERT_EQ(chunker.split_with(GearKernel::SCALAR, data.data(), data.size(), expected), 0);
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ(expected.back(), data.size());
+    for (size_t i = 0; i + 1 < expected.size(); ++i) {
+        size_t len = expected[i] - (i == 0 ? 0 : expected[i - 1]);
+        EXPECT_GE(len, params.min_size);
+        EXPECT_LE(len, params.max_size);
+    }
+    for (GearKernel kernel : {GearKernel::AVX2, GearKernel::AVX512}) {
+        if (!gear_kernel_supported(kernel)) continue;
+        for (size_t len : {static_cast<size_t>(0), static_cast<size_t>(100), static_cast<size_t>(3000), data.size()}) {
+            std::vector<size_t> scalar_ends, ends;
+            ASSERT_EQ(chunker.split_with(GearKernel::SCALAR, data.data(), len, scalar_ends), 0);
+            ASSERT_EQ(chunker.split_with(kernel, data.data(), len, ends), 0);
+            EXPECT_EQ(ends, scalar_ends) << gear_kernel_name(kernel) << " len=" << len;
+        }
+    }
+    
+    // 在开头插入一个字节后，切点在附近重新对齐：之后的块边界整体后移一个字节
+    std::vector<uint8_t> edited(data);
+    edited.insert(edited.begin() + 10, 0x77);
+    std::vector<size_t> shifted;
+    ASSERT_EQ(chunker.split(edited.data(), edited.size(), shifted), 0);
+    size_t shared = 0;
+    for (size_t end : expected) {
+        if (std::binary_search(shifted.begin(), shifted.end(), end + 1)) {
+            ++shared;
+        }
+    }
+    EXPECT_GE(shared + 4, expected.size());
+}
+
+TEST(CryptoUtilsTest, EnclaveSignerBatch) {
+    EnclaveKeyPair key_pair;
+    ASSERT_EQ(tee_init_key_pair(key_pair), 0);
+    EXPECT_EQ(key_pair.pk[0], 0x04);
+    
+    EnclaveSigner signer;
+    EXPECT_FALSE(signer.is_valid());
+    ASSERT_EQ(signer.init(key_pair), 0);
+    EXPECT_EQ(signer.public_key(), key_pair.pk);
+    
+    // 私钥与公钥不匹配时拒绝
+    EnclaveKeyPair mismatched = key_pair;
+    mismatched.sk[31] ^= 0x01;
+    EnclaveSigner bad_signer;
+    EXPECT_NE(bad_signer.init(mismatched), 0);
+    
+    std::vector<std::vector<uint8_t>> messages(64);
+    for (size_t i = 0; i < messages.size(); ++i) {
+        messages[i].assign(60 + i, static_cast<uint8_t>(i));
+    }
+    ThreadPool pool(4);
+    std::vector<std::array<uint8_t, 64>> sigs;
+    ASSERT_EQ(signer.sign_batch(messages, sigs, &pool), 0);
+    ASSERT_EQ(sigs.size(), messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_TRUE(tee_verify_signature(key_pair.pk, messages[i].data(), messages[i].size(), sigs[i])) << i;
+    }
+    
+    // 兼容接口与签名器输出同一格式；篡改消息或签名后验证失败
+    std::array<uint8_t, 64> sig;
+    ASSERT_EQ(tee_enclave_sign(key_pair, messages[0].data(), messages[0].size(), sig), 0);
+    EXPECT_TRUE(tee_verify_signature(key_pair.pk, messages[0].data(), messages[0].size(), sig));
+    EXPECT_FALSE(tee_verify_signature(key_pair.pk, messages[1].data(), messages[1].size(), sig));
+    sig[40] ^= 0x01;
+    EXPECT_FALSE(tee_verify_signature(key_pair.pk, messages[0].data(), messages[0].size(), sig));
+}
+
+TEST(CryptoUtilsTest, SipHash) {
+    // 参考实现的测试向量：密钥 00..0f，消息 00..(len-1)
+    const std::array<uint64_t, 2> key = {0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL};
+    uint8_t message[64];
+    for (size_t i = 0; i < sizeof(message); ++i) {
+        message[i] = static_cast<uint8_t>(i);
+    }
+    EXPECT_EQ(siphash24(key, message, 0), 0x726fdb47dd0e0e31ULL);
+    EXPECT_EQ(siphash24(key, message, 15), 0xa129ca6149be45e5ULL);
+    EXPECT_EQ(siphash24(key, message, 63), 0x958a324ceb064572ULL);
+    
+    // 进程密钥固定不变
+    EXPECT_EQ(keyed_hash(message, 32), keyed_hash(message, 32));
+    EXPECT_EQ(keyed_hash(message, 32), siphash24(process_hash_key(), message, 32));
+}
+
+TEST(CryptoUtilsTest, VerifyKeyCache) {
+    // 4个分片、共4个位置：5个飞地轮流验证时必然发生淘汰
+    VerifyKeyCache cache(4, 4);
+    EXPECT_EQ(cache.capacity(), 4u);
+    
+    std::vector<EnclaveKeyPair> keys(5);
+    std::vector<std::array<uint8_t, 64>> sigs(keys.size());
+    const uint8_t msg[] = "segment proof";
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(tee_init_key_pair(keys[i]), 0);
+        ASSERT_EQ(tee_enclave_sign(keys[i], msg, sizeof(msg), sigs[i]), 0);
+    }
+    
+    // 首次验证解析公钥，再次验证命中缓存
+    EXPECT_TRUE(cache.verify(keys[0].pk, msg, sizeof(msg), sigs[0]));
+    EXPECT_TRUE(cache.verify(keys[0].pk, msg, sizeof(msg), sigs[0]));
+    VerifyKeyCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_DOUBLE_EQ(stats.hit_rate(), 0.5);
+    EXPECT_EQ(cache.size(), 1u);
+    
+    // 命中缓存时同样拒绝篡改的消息和签名、以及他人的签名
+    std::array<uint8_t, 64> bad_sig = sigs[0];
+    bad_sig[10] ^= 0x01;
+    EXPECT_FALSE(cache.verify(keys[0].pk, msg, sizeof(msg), bad_sig));
+    EXPECT_FALSE(cache.verify(keys[0].pk, msg, sizeof(msg) - 1, sigs[0]));
+    EXPECT_FALSE(cache.verify(keys[0].pk, msg, sizeof(msg), sigs[1]));
+    
+    // 无效公钥不进入缓存
+    std::array<uint8_t, 65> bad_pk = keys[0].pk;
+    bad_pk[64] ^= 0x01;
+    EXPECT_FALSE(cache.verify(bad_pk, msg, sizeof(msg), sigs[0]));
+    EXPECT_EQ(cache.size(), 1u);
+    
+    cache.reset_stats();
+    for (int round = 0; round < 3; ++round) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            EXPECT_TRUE(cache.verify(keys[i].pk, msg, sizeof(msg), sigs[i]));
+        }
+    }
+    stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 15u);
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_LE(cache.size(), cache.capacity());
+    
+    // 多线程同时验证同一组飞地
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    ThreadPool pool(4);
+    std::atomic<int> failures{0};
+    pool.parallel_for(200, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t k = i % 2;
+            if (!cache.verify(keys[k].pk, msg, sizeof(msg), sigs[k])) {
+                failures.fetch_add(1);
+            }
+        }
+    });
+    EXPECT_EQ(failures.load(), 0);
+    
+    // Ed25519 公钥（0xED || 公钥 || 补0）同样分散到各分片：缓存能容纳的公钥数超过单个分片的容量
+    VerifyKeyCache ed_cache(16, 8);
+    std::vector<EnclaveKeyPair> ed_keys(16);
+    for (auto& key : ed_keys) {
+        ASSERT_EQ(tee_init_key_pair(key, SignatureScheme::ED25519), 0);
+        std::array<uint8_t, 64> sig;
+        ASSERT_EQ(tee_enclave_sign(key, msg, sizeof(msg), sig), 0);
+        EXPECT_TRUE(ed_cache.verify(key.pk, msg, sizeof(msg), sig));
+    }
+    EXPECT_GT(ed_cache.size(), ed_cache.capacity() / 8);
+}
+
+TEST(CryptoUtilsTest, Ed25519BatchVerify) {
+    // 3个 Ed25519 飞地 + 1个 P-256 飞地
+    std::vector<EnclaveKeyPair> keys(4);
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(tee_init_key_pair(keys[i], SignatureScheme::ED25519), 0);
+    }
+    ASSERT_EQ(tee_init_key_pair(keys[3]), 0);
+    SignatureScheme scheme;
+    ASSERT_EQ(tee_key_scheme(keys[0].pk, scheme), 0);
+    EXPECT_EQ(scheme, SignatureScheme::ED25519);
+    ASSERT_EQ(tee_key_scheme(keys[3].pk, scheme), 0);
+    EXPECT_EQ(scheme, SignatureScheme::ECDSA_P256);
+    
+    EnclaveSigner signer;
+    ASSERT_EQ(signer.init(keys[0]), 0);
+    EXPECT_EQ(signer.scheme(), SignatureScheme::ED25519);
+    EnclaveKeyPair mismatched = keys[0];
+    mismatched.sk[0] ^= 0x01;
+    EnclaveSigner bad_signer;
+    EXPECT_NE(bad_signer.init(mismatched), 0);
+    
+    // 每个飞地签名多条消息（同一公钥在批中出现多次）
+    const size_t count = 40;
+    std::vector<std::vector<uint8_t>> messages(count);
+    std::vector<std::array<uint8_t, 64>> sigs(count);
+    std::vector<SignatureBatchItem> items(count);
+    for (size_t i = 0; i < count; ++i) {
+        messages[i].assign(20 + i, static_cast<uint8_t>(i * 3));
+        const EnclaveKeyPair& key = keys[i % keys.size()];
+        ASSERT_EQ(tee_enclave_sign(key, messages[i].data(), messages[i].size(), sigs[i]), 0);
+        EXPECT_TRUE(tee_verify_signature(key.pk, messages[i].data(), messages[i].size(), sigs[i])) << i;
+        items[i] = {&key.pk, messages[i].data(), messages[i].size(), &sigs[i]};
+    }
+    
+    std::vector<uint8_t> results;
+    EXPECT_TRUE(tee_verify_batch(items, results));
+    ASSERT_EQ(results.size(), count);
+    
+    // 纯 Ed25519 批直接走多标量乘法
+    std::vector<Ed25519BatchItem> ed_items;
+    for (size_t i = 0; i < count; ++i) {
+        if (i % keys.size() != 3) {
+            ed_items.push_back({keys[i % keys.size()].pk.data() + 1, messages[i].data(), messages[i].size(), sigs[i].data()});
+        }
+    }
+    EXPECT_EQ(ed25519_verify_batch(ed_items), 1);
+    EXPECT_EQ(ed25519_verify_batch({}), 1);
+    
+    // 篡改一个 Ed25519 签名的 S、另一个的消息：整批不通过，逐个验证定位到这两个
+    sigs[5][40] ^= 0x01;
+    messages[10][0] ^= 0x01;
+    EXPECT_FALSE(tee_verify_batch(items, results));
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(results[i], (i == 5 || i == 10) ? 0 : 1) << i;
+    }
+    EXPECT_EQ(ed25519_verify_batch(ed_items), 0);
+    
+    // 逐个验证（P-256 签名和整批未通过后的回退）经由指定的公钥缓存，每个飞地只解析一次公钥
+    VerifyKeyCache batch_cache;
+    EXPECT_FALSE(tee_verify_batch(items, results, &batch_cache));
+    EXPECT_EQ(batch_cache.size(), keys.size());
+    EXPECT_EQ(batch_cache.stats().misses, keys.size());
+    messages[10][0] ^= 0x01;
+    sigs[5][40] ^= 0x01;
+    
+    // S 不小于群阶、R 不是曲线点：直接判为无效
+    std::array<uint8_t, 64> bad = sigs[0];
+    memset(bad.data() + 32, 0xFF, 32);
+    EXPECT_EQ(ed25519_verify_batch({{keys[0].pk.data() + 1, messages[0].data(), messages[0].size(), bad.data()}}), 0);
+    bad = sigs[0];
+    bad[0] ^= 0x01;
+    EXPECT_NE(ed25519_verify_batch({{keys[0].pk.data() + 1, messages[0].data(), messages[0].size(), bad.data()}}), 1);
+    
+    // 公钥缓存同样接受两种方案
+    VerifyKeyCache cache;
+    EXPECT_TRUE(cache.verify(keys[0].pk, messages[0].data(), messages[0].size(), sigs[0]));
+    EXPECT_TRUE(cache.verify(keys[0].pk, messages[4].data(), messages[4].size(), sigs[4]));
+    EXPECT_FALSE(cache.verify(keys[1].pk, messages[0].data(), messages[0].size(), sigs[0]));
+    EXPECT_TRUE(cache.verify(keys[3].pk, messages[3].data(), messages[3].size(), sigs[3]));
+}
+
+TEST(CryptoUtilsTest, EcdsaNoncePool) {
+    EnclaveKeyPair key_pair;
+    ASSERT_EQ(tee_init_key_pair(key_pair), 0);
+    EnclaveSigner signer;
+    ASSERT_EQ(signer.init(key_pair), 0);
+    EXPECT_EQ(signer.nonce_pool(), nullptr);
+    ASSERT_EQ(signer.enable_nonce_pool(8), 0);
+    ASSERT_NE(signer.nonce_pool(), nullptr);
+    EXPECT_EQ(signer.nonce_pool()->depth(), 8u);
+    
+    // 多线程签名超过池深度：池空时当场计算，每个签名都有效且 r 互不相同（随机数只使用一次）
+    const size_t count = 64;
+    std::vector<std::vector<uint8_t>> messages(count);
+    for (size_t i = 0; i < count; ++i) {
+        messages[i].assign(60, static_cast<uint8_t>(i));
+    }
+    ThreadPool pool(4);
+    std::vector<std::array<uint8_t, 64>> sigs;
+    ASSERT_EQ(signer.sign_batch(messages, sigs, &pool), 0);
+    std::set<std::vector<uint8_t>> r_values;
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_TRUE(tee_verify_signature(key_pair.pk, messages[i].data(), messages[i].size(), sigs[i])) << i;
+        r_values.insert(std::vector<uint8_t>(sigs[i].begin(), sigs[i].begin() + 32));
+    }
+    EXPECT_EQ(r_values.size(), count);
+    NoncePool::Stats stats = signer.nonce_pool()->stats();
+    EXPECT_EQ(stats.pooled + stats.on_demand, count);
+    
+    // 池内随机数：r 与 k^-1 均非零
+    EcdsaNonce nonce;
+    ASSERT_EQ(NoncePool::generate(nonce), 0);
+    EXPECT_NE(nonce.r, (std::array<uint8_t, 32>{}));
+    EXPECT_NE(nonce.k_inv, (std::array<uint8_t, 32>{}));
+    
+    // Ed25519 无法预计算随机数
+    EnclaveKeyPair ed_key;
+    ASSERT_EQ(tee_init_key_pair(ed_key, SignatureScheme::ED25519), 0);
+    EnclaveSigner ed_signer;
+    ASSERT_EQ(ed_signer.init(ed_key), 0);
+    EXPECT_NE(ed_signer.enable_nonce_pool(8), 0);
+    
+    // tee_enclave_sign 的内部签名器按设置开启/关闭随机数池
+    tee_set_nonce_pool_depth(4);
+    std::array<uint8_t, 64> sig;
+    ASSERT_EQ(tee_enclave_sign(key_pair, messages[0].data(), messages[0].size(), sig), 0);
+    EXPECT_TRUE(tee_verify_signature(key_pair.pk, messages[0].data(), messages[0].size(), sig));
+    tee_set_nonce_pool_depth(0);
+    ASSERT_EQ(tee_enclave_sign(key_pair, messages[1].data(), messages[1].size(), sig), 0);
+    EXPECT_TRUE(tee_verify_signature(key_pair.pk, messages[1].data(), messages[1].size(), sig));
+    
+    ASSERT_EQ(signer.enable_nonce_pool(0), 0);
+    EXPECT_EQ(signer.nonce_pool(), nullptr);
+    
+#ifndef _WIN32
+    // fork 后子进程不使用池中的随机数（父进程也持有），析构时不等待不存在的补充线程
+    auto forked_signer = std::make_unique<EnclaveSigner>();
+    ASSERT_EQ(forked_signer->init(key_pair), 0);
+    ASSERT_EQ(forked_signer->enable_nonce_pool(4), 0);
+    for (int i = 0; i < 2000 && forked_signer->nonce_pool()->available() < 4; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(forked_signer->nonce_pool()->available(), 4u);
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        std::array<uint8_t, 64> child_sig{};
+        bool ok = forked_signer->nonce_pool()->available() == 0 &&
+                  forked_signer->sign(messages[0].data(), messages[0].size(), child_sig) == 0 &&
+                  forked_signer->nonce_pool()->stats().on_demand == 1;
+        forked_signer.reset();
+        ok = ok && write(fds[1], child_sig.data(), 32) == 32;
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+    std::array<uint8_t, 32> child_r{};
+    EXPECT_EQ(read(fds[0], child_r.data(), child_r.size()), 32);
+    close(fds[0]);
+    int child_status = 0;
+    ASSERT_EQ(waitpid(child, &child_status, 0), child);
+    EXPECT_TRUE(WIFEXITED(child_status) && WEXITSTATUS(child_status) == 0);
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_EQ(forked_signer->sign(messages[i].data(), messages[i].size(), sig), 0);
+        EXPECT_FALSE(std::equal(child_r.begin(), child_r.end(), sig.begin())) << i;
+    }
+    EXPECT_EQ(forked_signer->nonce_pool()->stats().pooled, 4u);
+#endif
+}
+
+TEST(CryptoUtilsTest, BufferedRandomSource) {
+    // 与原来的约定相同：空缓冲区或长度为0时失败
+    uint8_t byte;
+    EXPECT_EQ(tee_get_random(nullptr, 16), -1);
+    EXPECT_EQ(tee_get_random(&byte, 0), -1);
+    
+    // 连续的小请求互不相同
+    std::set<std::vector<uint8_t>> seen;
+    for (int i = 0; i < 1000; ++i) {
+        std::vector<uint8_t> r(12);
+        ASSERT_EQ(tee_get_random(r.data(), r.size()), 0);
+        seen.insert(r);
+    }
+    EXPECT_EQ(seen.size(), 1000u);
+    
+    // 跨越多次缓冲区补充和一次重新播种的大请求：各字节值出现次数接近均匀
+    std::vector<uint8_t> big(RANDOM_RESEED_INTERVAL + 12345);
+    ASSERT_EQ(tee_get_random(big.data(), big.size()), 0);
+    std::vector<size_t> histogram(256, 0);
+    for (uint8_t b : big) {
+        ++histogram[b];
+    }
+    const double expected = static_cast<double>(big.size()) / 256;
+    for (size_t v = 0; v < 256; ++v) {
+        EXPECT_NEAR(static_cast<double>(histogram[v]), expected, expected * 0.1) << v;
+    }
+    
+    // 主动重新播种后仍可正常输出
+    tee_random_reseed();
+    std::array<uint8_t, 32> a, b;
+    ASSERT_EQ(tee_get_random(a.data(), a.size()), 0);
+    ASSERT_EQ(tee_get_random(b.data(), b.size()), 0);
+    EXPECT_NE(a, b);
+    
+    // 各线程的生成器独立播种，输出互不相同
+    ThreadPool pool(4);
+    std::vector<std::array<uint8_t, 32>> outputs(64);
+    std::atomic<int> failures{0};
+    pool.parallel_for(outputs.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (tee_get_random(outputs[i].data(), outputs[i].size()) != 0) {
+                failures.fetch_add(1);
+            }
+        }
+    });
+    EXPECT_EQ(failures.load(), 0);
+    std::set<std::array<uint8_t, 32>> distinct(outputs.begin(), outputs.end());
+    EXPECT_EQ(distinct.size(), outputs.size());
+}
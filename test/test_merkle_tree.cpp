@@ -1,9 +1,16 @@
 #include <gtest/gtest.h>
 #include "../src/utils/merkle_tree.h"
 #include "../src/utils/crypto_utils.h"
+#include "../src/utils/thread_pool.h"
+#include "../src/utils/disk_merkle_tree.h"
+#include "../src/utils/partial_merkle_tree.h"
+#include "../src/utils/kary_merkle_tree.h"
+#include "../src/utils/merkle_accumulator.h"
 #include <vector>
 #include <array>
 #include <cstring>
+#include <cstdio>
+#include <filesystem>
 
 TEST(MerkleTreeTest, BasicFunctionality) {
     // 创建测试数据
@@ -91,3 +98,490 @@ TEST(MerkleTreeTest, TamperedData) {
     // 验证篡改后的数据应该失败
     EXPECT_FALSE(MerkleTree::verify_proof(tampered_leaf, path, root));
 }
+
+TEST(MerkleTreeTest, RootMatchesReferenceConstruction) {
+    // 逐节点调用 sha256_hash 的参考实现（奇数节点复制自身补全）
+    auto reference_root = [](std::vector<std::array<uint8_t, 32>> layer) {
+        while (layer.size() > 1) {
+            std::vector<std::array<uint8_t, 32>> next;
+            for (size_t i = 0; i < layer.size(); i += 2) {
+                std::array<uint8_t, 64> combined;
+                memcpy(combined.data(), layer[i].data(), 32);
+                memcpy(combined.data() + 32, layer[i + 1 < layer.size() ? i + 1 : i].data(), 32);
+                std::array<uint8_t, 32> parent;
+                sha256_hash(combined.data(), 64, parent);
+                next.push_back(parent);
+            }
+            layer = next;
+        }
+        return layer[0];
+    };
+
+    for (size_t count : {2, 3, 5, 16, 17, 33, 100, 1000}) {
+        std::vector<std::array<uint8_t, 32>> leaves(count);
+        for (size_t i = 0; i < count; ++i) {
+            memset(leaves[i].data(), static_cast<int>(i * 31 + 7), 32);
+            leaves[i][0] = static_cast<uint8_t>(i >> 8);
+        }
+        MerkleTree tree(leaves);
+        EXPECT_EQ(tree.get_root(), reference_root(leaves)) << "count=" << count;
+    }
+}
+
+TEST(MerkleTreeTest, MovedLeafBuffer) {
+    const size_t count = 37;
+    std::vector<std::array<uint8_t, 32>> leaves(count);
+    MerkleTree::NodeBuffer buffer;
+    buffer.reserve(MerkleTree::node_count(count));
+    for (size_t i = 0; i < count; ++i) {
+        memset(leaves[i].data(), static_cast<int>(i), 32);
+        buffer.push_back(leaves[i]);
+    }
+    const std::array<uint8_t, 32>* storage = buffer.data();
+
+    // 预留足够容量时移入的缓冲区直接成为树的存储，不重新分配
+    MerkleTree moved(std::move(buffer));
+    MerkleTree copied(leaves);
+    EXPECT_EQ(moved.get_root(), copied.get_root());
+    EXPECT_EQ(moved.leaf_count(), count);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(storage) % 64, 0u);
+
+    std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(moved.get_proof(i, path));
+        EXPECT_TRUE(MerkleTree::verify_proof(leaves[i], path, moved.get_root()));
+    }
+    EXPECT_FALSE(moved.get_proof(count, path));
+}
+
+TEST(MerkleTreeTest, ParallelBuildMatchesSerial) {
+    ThreadPool pool(4);
+    // 覆盖低于并行阈值、恰好2的幂、以及末尾子树不满的情况
+    for (size_t count : {1000, 8192, 16384, 50001, 131072}) {
+        MerkleTree::NodeBuffer serial_leaves(count);
+        for (size_t i = 0; i < count; ++i) {
+            memset(serial_leaves[i].data(), 0, 32);
+            memcpy(serial_leaves[i].data(), &i, sizeof(i));
+        }
+        MerkleTree::NodeBuffer parallel_leaves = serial_leaves;
+
+        MerkleTree serial(std::move(serial_leaves));
+        MerkleTree parallel(std::move(parallel_leaves), pool);
+        EXPECT_EQ(serial.get_root(), parallel.get_root()) << "count=" << count;
+
+        std::vector<std::pair<std::array<uint8_t, 32>, bool>> serial_path, parallel_path;
+        for (size_t idx : {static_cast<size_t>(0), count / 2, count - 1}) {
+            ASSERT_TRUE(serial.get_proof(idx, serial_path));
+            ASSERT_TRUE(parallel.get_proof(idx, parallel_path));
+            EXPECT_EQ(serial_path, parallel_path);
+        }
+    }
+}
+
+TEST(MerkleTreeTest, IncrementalUpdatesMatchRebuild) {
+    auto make_leaf = [](size_t seed) {
+        std::array<uint8_t, 32> leaf{};
+        memcpy(leaf.data(), &seed, sizeof(seed));
+        leaf[31] = 0x5A;
+        return leaf;
+    };
+    auto check = [](const MerkleTree& tree, const std::vector<std::array<uint8_t, 32>>& leaves) {
+        MerkleTree rebuilt(leaves);
+        ASSERT_EQ(tree.leaf_count(), leaves.size());
+        EXPECT_EQ(tree.get_root(), rebuilt.get_root());
+        std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            ASSERT_TRUE(tree.get_proof(i, path));
+            EXPECT_TRUE(MerkleTree::verify_proof(leaves[i], path, tree.get_root()));
+        }
+    };
+
+    // 从空树逐个追加（跨越多次扩容）
+    std::vector<std::array<uint8_t, 32>> leaves;
+    MerkleTree tree;
+    for (size_t i = 0; i < 70; ++i) {
+        leaves.push_back(make_leaf(i));
+        tree.append_leaf(leaves.back());
+        check(tree, leaves);
+    }
+
+    // 单叶子修改
+    for (size_t idx : {0, 33, 69}) {
+        leaves[idx] = make_leaf(1000 + idx);
+        ASSERT_TRUE(tree.update_leaf(idx, leaves[idx]));
+        check(tree, leaves);
+    }
+    EXPECT_FALSE(tree.update_leaf(leaves.size(), make_leaf(0)));
+
+    // 批量修改（含共同祖先和重复索引），越界时整体不生效
+    std::vector<std::pair<size_t, std::array<uint8_t, 32>>> updates = {
+        {5, make_leaf(2005)}, {4, make_leaf(2004)}, {40, make_leaf(2040)}, {5, make_leaf(3005)}};
+    ASSERT_TRUE(tree.update_leaves(updates));
+    for (const auto& [idx, leaf] : updates) {
+        leaves[idx] = leaf;
+    }
+    check(tree, leaves);
+    std::array<uint8_t, 32> root_before = tree.get_root();
+    EXPECT_FALSE(tree.update_leaves({{1, make_leaf(1)}, {leaves.size(), make_leaf(2)}}));
+    EXPECT_EQ(tree.get_root(), root_before);
+
+    // 截断后再追加
+    for (size_t count : {64, 37, 1}) {
+        ASSERT_TRUE(tree.truncate(count));
+        leaves.resize(count);
+        check(tree, leaves);
+    }
+    EXPECT_FALSE(tree.truncate(2));
+    std::vector<std::array<uint8_t, 32>> tail;
+    for (size_t i = 0; i < 20; ++i) {
+        tail.push_back(make_leaf(5000 + i));
+    }
+    tree.append_leaves(tail);
+    leaves.insert(leaves.end(), tail.begin(), tail.end());
+    check(tree, leaves);
+
+    ASSERT_TRUE(tree.truncate(0));
+    std::array<uint8_t, 32> empty_root{};
+    EXPECT_EQ(tree.get_root(), empty_root);
+}
+
+TEST(MerkleTreeTest, Multiproof) {
+    for (size_t count : {1, 2, 7, 64, 1000}) {
+        std::vector<std::array<uint8_t, 32>> leaves(count);
+        for (size_t i = 0; i < count; ++i) {
+            memset(leaves[i].data(), 0, 32);
+            memcpy(leaves[i].data(), &i, sizeof(i));
+        }
+        MerkleTree tree(leaves);
+        std::array<uint8_t, 32> root = tree.get_root();
+
+        // 无序、重复、相邻兄弟、奇数补全的末尾叶子
+        std::vector<std::vector<size_t>> index_sets = {{0}, {count - 1}, {count - 1, 0, count / 2, 0}};
+        if (count >= 7) {
+            index_sets.push_back({2, 3, 4, 6});
+        }
+        std::vector<size_t> all(count);
+        for (size_t i = 0; i < count; ++i) {
+            all[i] = i;
+        }
+        index_sets.push_back(all);
+
+        for (const auto& indices : index_sets) {
+            MerkleMultiproof proof;
+            ASSERT_TRUE(tree.get_multiproof(indices, proof));
+            std::vector<std::array<uint8_t, 32>> hashes;
+            for (size_t idx : indices) {
+                hashes.push_back(leaves[idx]);
+            }
+            EXPECT_TRUE(MerkleTree::verify_multiproof(indices, hashes, proof, root)) << "count=" << count;
+
+            // 证明全部叶子时不需要任何兄弟节点
+            if (indices.size() == count) {
+                EXPECT_TRUE(proof.hashes.empty());
+            }
+
+            // 篡改叶子哈希 / 证明哈希 / 叶子数
+            std::vector<std::array<uint8_t, 32>> tampered = hashes;
+            tampered.back()[0] ^= 0xFF;
+            EXPECT_FALSE(MerkleTree::verify_multiproof(indices, tampered, proof, root));
+            if (!proof.hashes.empty()) {
+                MerkleMultiproof bad = proof;
+                bad.hashes[bad.hashes.size() / 2][5] ^= 0x01;
+                EXPECT_FALSE(MerkleTree::verify_multiproof(indices, hashes, bad, root));
+                bad = proof;
+                bad.hashes.pop_back();
+                EXPECT_FALSE(MerkleTree::verify_multiproof(indices, hashes, bad, root));
+            }
+            MerkleMultiproof extra = proof;
+            extra.hashes.push_back(root);
+            EXPECT_FALSE(MerkleTree::verify_multiproof(indices, hashes, extra, root));
+        }
+
+        MerkleMultiproof proof;
+        EXPECT_FALSE(tree.get_multiproof({count}, proof));
+        EXPECT_FALSE(tree.get_multiproof({}, proof));
+    }
+}
+
+TEST(DiskMerkleTreeTest, StreamingWriteAndMappedProofs) {
+    const std::string path = (std::filesystem::temp_directory_path() / "tee_disk_merkle_test.bin").string();
+
+    // 40000 个叶子跨越写入分块边界
+    for (size_t count : {1, 2, 7, 40000}) {
+        std::vector<std::array<uint8_t, 32>> leaves(count);
+        for (size_t i = 0; i < count; ++i) {
+            memset(leaves[i].data(), 0, 32);
+            memcpy(leaves[i].data(), &i, sizeof(i));
+        }
+        MerkleTree memory_tree(leaves);
+
+        DiskMerkleTreeWriter writer;
+        ASSERT_EQ(writer.open(path), 0);
+        for (const auto& leaf : leaves) {
+            ASSERT_EQ(writer.append_leaf(leaf), 0);
+        }
+        std::array<uint8_t, 32> root;
+        ASSERT_EQ(writer.finish(&root), 0);
+        EXPECT_EQ(root, memory_tree.get_root());
+
+        // 不同常驻层数下的证明与内存树一致
+        for (size_t pinned : {0, 3, 100}) {
+            DiskMerkleTree disk_tree;
+            ASSERT_EQ(disk_tree.open(path, pinned), 0);
+            EXPECT_EQ(disk_tree.leaf_count(), count);
+            EXPECT_EQ(disk_tree.get_root(), memory_tree.get_root());
+
+            std::vector<std::pair<std::array<uint8_t, 32>, bool>> disk_path, memory_path;
+            for (size_t idx : {static_cast<size_t>(0), count / 3, count - 1}) {
+                ASSERT_TRUE(disk_tree.get_proof(idx, disk_path));
+                ASSERT_TRUE(memory_tree.get_proof(idx, memory_path));
+                EXPECT_EQ(disk_path, memory_path);
+                EXPECT_TRUE(MerkleTree::verify_proof(leaves[idx], disk_path, disk_tree.get_root()));
+            }
+            EXPECT_FALSE(disk_tree.get_proof(count, disk_path));
+        }
+    }
+
+    // 由内存树直接写出
+    std::vector<std::array<uint8_t, 32>> leaves(5);
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        memset(leaves[i].data(), static_cast<int>(i + 1), 32);
+    }
+    MerkleTree memory_tree(leaves);
+    ASSERT_EQ(DiskMerkleTreeWriter::write(path, memory_tree), 0);
+    DiskMerkleTree disk_tree;
+    ASSERT_EQ(disk_tree.open(path), 0);
+    EXPECT_EQ(disk_tree.get_root(), memory_tree.get_root());
+    disk_tree.close();
+
+    // 损坏的文件（篡改根节点）无法打开
+    FILE* f = fopen(path.c_str(), "r+b");
+    ASSERT_NE(f, nullptr);
+    fseek(f, -1, SEEK_END);
+    fputc(0xEE, f);
+    fclose(f);
+    EXPECT_NE(disk_tree.open(path), 0);
+
+    // 文件头中的叶子数被篡改为超出文件大小的值（节点字节数的乘法会溢出）
+    ASSERT_EQ(DiskMerkleTreeWriter::write(path, memory_tree), 0);
+    uint64_t bogus_leaves = static_cast<uint64_t>(1) << 59;
+    f = fopen(path.c_str(), "r+b");
+    ASSERT_NE(f, nullptr);
+    fseek(f, offsetof(DiskMerkleHeader, leaf_count), SEEK_SET);
+    fwrite(&bogus_leaves, sizeof(bogus_leaves), 1, f);
+    fclose(f);
+    EXPECT_NE(disk_tree.open(path), 0);
+
+    // 空树无法写出
+    DiskMerkleTreeWriter empty_writer;
+    ASSERT_EQ(empty_writer.open(path), 0);
+    EXPECT_NE(empty_writer.finish(), 0);
+    std::remove(path.c_str());
+}
+
+TEST(PartialMerkleTreeTest, ProofsMatchFullTree) {
+    for (size_t count : {1, 5, 64, 1000, 4097}) {
+        std::vector<std::array<uint8_t, 32>> leaves(count);
+        for (size_t i = 0; i < count; ++i) {
+            memset(leaves[i].data(), 0, 32);
+            memcpy(leaves[i].data(), &i, sizeof(i));
+        }
+        MerkleTree full(leaves);
+        size_t fetched = 0;
+        auto source = [&](size_t first, size_t n, std::array<uint8_t, 32>* out) {
+            if (first + n > leaves.size()) {
+                return -1;
+            }
+            std::copy(leaves.begin() + first, leaves.begin() + first + n, out);
+            fetched += n;
+            return 0;
+        };
+
+        for (size_t kept : {0, 1, 3, 8, 64}) {
+            PartialMerkleTree partial;
+            ASSERT_EQ(partial.build(count, kept, source), 0);
+            EXPECT_EQ(partial.get_root(), full.get_root()) << "count=" << count << " kept=" << kept;
+            EXPECT_LE(partial.memory_bytes(), MerkleTree::node_count(count) * 32);
+
+            std::vector<std::pair<std::array<uint8_t, 32>, bool>> partial_path, full_path;
+            for (size_t idx : {static_cast<size_t>(0), count / 2, count - 1}) {
+                fetched = 0;
+                ASSERT_TRUE(partial.get_proof(idx, partial_path));
+                ASSERT_TRUE(full.get_proof(idx, full_path));
+                EXPECT_EQ(partial_path, full_path);
+                // 每次取证明最多重算一棵子树的叶子
+                EXPECT_LE(fetched, partial.subtree_leaves());
+            }
+            EXPECT_FALSE(partial.get_proof(count, partial_path));
+        }
+    }
+
+    // 内存预算选层：预算足够时保留整棵树，不足时至少保留根
+    EXPECT_EQ(PartialMerkleTree::levels_for_budget(1024, MerkleTree::node_count(1024) * 32), 11u);
+    EXPECT_EQ(PartialMerkleTree::levels_for_budget(1024, 32 * 7), 3u);
+    EXPECT_EQ(PartialMerkleTree::levels_for_budget(1024, 0), 1u);
+}
+
+TEST(MerkleTreeTest, CompactPathEncoding) {
+    std::vector<std::array<uint8_t, 32>> leaves(1000);
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        memset(leaves[i].data(), 0, 32);
+        memcpy(leaves[i].data(), &i, sizeof(i));
+    }
+    MerkleTree tree(leaves);
+    std::array<uint8_t, 32> root = tree.get_root();
+
+    std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+    std::vector<uint8_t> encoded;
+    for (size_t idx : {0, 1, 500, 999}) {
+        ASSERT_TRUE(tree.get_proof(idx, path));
+        ASSERT_EQ(encode_merkle_path(path, encoded), 0);
+        EXPECT_EQ(encoded.size(), merkle_path_encoded_size(path.size()));
+        EXPECT_LT(encoded.size(), path.size() * 33);
+
+        MerklePathView view;
+        ASSERT_TRUE(view.parse(encoded));
+        ASSERT_EQ(view.depth(), path.size());
+        for (size_t i = 0; i < path.size(); ++i) {
+            EXPECT_EQ(view.is_left(i), path[i].second);
+            EXPECT_EQ(memcmp(view.sibling(i), path[i].first.data(), 32), 0);
+        }
+        EXPECT_TRUE(MerkleTree::verify_proof(leaves[idx], view, root));
+        EXPECT_FALSE(MerkleTree::verify_proof(leaves[(idx + 1) % leaves.size()], view, root));
+
+        // 翻转方向位 / 篡改哈希后验证失败
+        std::vector<uint8_t> tampered = encoded;
+        tampered[1] ^= 0x01;
+        ASSERT_TRUE(view.parse(tampered));
+        EXPECT_FALSE(MerkleTree::verify_proof(leaves[idx], view, root));
+        tampered = encoded;
+        tampered.back() ^= 0x80;
+        ASSERT_TRUE(view.parse(tampered));
+        EXPECT_FALSE(MerkleTree::verify_proof(leaves[idx], view, root));
+    }
+
+    // 格式错误：长度不匹配、位图多余位非0、空缓冲区
+    ASSERT_TRUE(tree.get_proof(3, path));
+    ASSERT_EQ(encode_merkle_path(path, encoded), 0);
+    MerklePathView view;
+    std::vector<uint8_t> bad = encoded;
+    bad.pop_back();
+    EXPECT_FALSE(view.parse(bad));
+    bad = encoded;
+    bad.push_back(0);
+    EXPECT_FALSE(view.parse(bad));
+    bad = encoded;
+    bad[2] |= 0x80;  // 深度10：第二个位图字节只用低2位
+    EXPECT_FALSE(view.parse(bad));
+    EXPECT_FALSE(view.parse(nullptr, 0));
+
+    // 单叶子树：深度为0，叶子即根
+    MerkleTree single(std::vector<std::array<uint8_t, 32>>(1, leaves[0]));
+    ASSERT_TRUE(single.get_proof(0, path));
+    ASSERT_EQ(encode_merkle_path(path, encoded), 0);
+    EXPECT_EQ(encoded.size(), 1u);
+    ASSERT_TRUE(view.parse(encoded));
+    EXPECT_TRUE(MerkleTree::verify_proof(leaves[0], view, single.get_root()));
+}
+
+template <size_t Arity, typename HashPolicy>
+static void check_kary_tree(size_t count) {
+    std::vector<std::array<uint8_t, 32>> leaves(count);
+    for (size_t i = 0; i < count; ++i) {
+        memset(leaves[i].data(), 0, 32);
+        memcpy(leaves[i].data(), &i, sizeof(i));
+    }
+    BasicMerkleTree<Arity, HashPolicy> tree(leaves);
+    std::array<uint8_t, 32> root = tree.get_root();
+
+    std::vector<KaryProofStep<Arity>> proof;
+    for (size_t idx : {static_cast<size_t>(0), count / 2, count - 1}) {
+        ASSERT_TRUE(tree.get_proof(idx, proof));
+        EXPECT_EQ(proof.size(), tree.depth());
+        EXPECT_TRUE((BasicMerkleTree<Arity, HashPolicy>::verify_proof(leaves[idx], proof, root)))
+            << "arity=" << Arity << " count=" << count << " idx=" << idx;
+        if (!proof.empty()) {
+            std::vector<KaryProofStep<Arity>> tampered = proof;
+            tampered.back().siblings[0][0] ^= 0x01;
+            EXPECT_FALSE((BasicMerkleTree<Arity, HashPolicy>::verify_proof(leaves[idx], tampered, root)));
+        }
+        // 子节点各不相同时，改变位置必然改变父节点（补齐区域内的位置本就等价，不检查）
+        if (idx == 0 && count >= Arity) {
+            std::vector<KaryProofStep<Arity>> tampered = proof;
+            tampered[0].position = 1;
+            EXPECT_FALSE((BasicMerkleTree<Arity, HashPolicy>::verify_proof(leaves[idx], tampered, root)));
+        }
+    }
+    EXPECT_FALSE(tree.get_proof(count, proof));
+}
+
+TEST(MerkleTreeTest, KaryTreeProofs) {
+    for (size_t count : {1, 2, 5, 17, 100, 1000}) {
+        check_kary_tree<2, Sha256MerkleHash>(count);
+        check_kary_tree<4, Sha256MerkleHash>(count);
+        check_kary_tree<8, Sha256MerkleHash>(count);
+        check_kary_tree<16, Sha256MerkleHash>(count);
+        check_kary_tree<4, Sha3MerkleHash>(count);
+    }
+}
+
+TEST(MerkleTreeTest, KaryTreeDefaultMatchesBinary) {
+    // 二叉 SHA-256 实例的根和路径与 MerkleTree 一致
+    for (size_t count : {1, 2, 3, 7, 64, 1001}) {
+        std::vector<std::array<uint8_t, 32>> leaves(count);
+        for (size_t i = 0; i < count; ++i) {
+            memset(leaves[i].data(), static_cast<int>(i * 7), 32);
+        }
+        MerkleTree binary(leaves);
+        BasicMerkleTree<2> kary(leaves);
+        EXPECT_EQ(kary.get_root(), binary.get_root());
+
+        std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+        std::vector<KaryProofStep<2>> proof;
+        ASSERT_TRUE(binary.get_proof(count - 1, path));
+        ASSERT_TRUE(kary.get_proof(count - 1, proof));
+        ASSERT_EQ(path.size(), proof.size());
+        for (size_t i = 0; i < path.size(); ++i) {
+            EXPECT_EQ(path[i].first, proof[i].siblings[0]);
+            EXPECT_EQ(path[i].second, proof[i].position == 0);
+        }
+    }
+
+    // 4叉树5个叶子的参考构造：第二组只有1个子节点，用自身补齐
+    std::vector<std::array<uint8_t, 32>> leaves(5);
+    for (size_t i = 0; i < 5; ++i) {
+        leaves[i].fill(static_cast<uint8_t>(i + 1));
+    }
+    auto hash4 = [](const std::array<uint8_t, 32>& a, const std::array<uint8_t, 32>& b,
+                    const std::array<uint8_t, 32>& c, const std::array<uint8_t, 32>& d) {
+        std::vector<uint8_t> message;
+        for (const auto* child : {&a, &b, &c, &d}) {
+            message.insert(message.end(), child->begin(), child->end());
+        }
+        std::array<uint8_t, 32> out;
+        sha256_hash(message.data(), message.size(), out);
+        return out;
+    };
+    std::array<uint8_t, 32> left = hash4(leaves[0], leaves[1], leaves[2], leaves[3]);
+    std::array<uint8_t, 32> right = hash4(leaves[4], leaves[4], leaves[4], leaves[4]);
+    std::array<uint8_t, 32> expected = hash4(left, right, right, right);
+    EXPECT_EQ(BasicMerkleTree<4>(leaves).get_root(), expected);
+}
+
+TEST(MerkleTreeTest, StreamingRootAccumulator) {
+    MerkleRootAccumulator accumulator;
+    std::array<uint8_t, 32> empty_root{};
+    EXPECT_EQ(accumulator.root(), empty_root);
+
+    std::vector<std::array<uint8_t, 32>> leaves;
+    for (size_t count = 1; count <= 300; ++count) {
+        std::array<uint8_t, 32> leaf{};
+        memcpy(leaf.data(), &count, sizeof(count));
+        leaves.push_back(leaf);
+        accumulator.append(leaf);
+        ASSERT_EQ(accumulator.root(), MerkleTree(leaves).get_root()) << "count=" << count;
+    }
+    EXPECT_EQ(accumulator.leaf_count(), 300u);
+    accumulator.reset();
+    EXPECT_EQ(accumulator.leaf_count(), 0u);
+}
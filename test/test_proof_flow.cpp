@@ -1,12 +1,19 @@
 #include <gtest/gtest.h>
 #include "../src/core/init/data_owner.h"
 #include "../src/core/init/storage_node.h"
+#include "../src/core/init/ingest.h"
+#include "../src/core/init/file_registry.h"
 #include "../src/core/proof_generator/proof_builder.h"
+#include "../src/core/proof_generator/challenge.h"
 #include "../src/core/verifier/single_verifier.h"
 #include "../src/blockchain_sim/reputation_contract.h"
 #include "../src/utils/merkle_tree.h"
 #include <vector>
 #include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 TEST(ProofFlowTest, FullProofCycle) {
     // 1. 初始化组件
@@ -105,7 +112,7 @@ TEST(ProofFlowTest, SegmentCredential) {
         proofs.push_back(proof);
         
         // 更新前向哈希
-        sha3_256_hash(reinterpret_cast<const uint8_t*>(&proof), sizeof(ProofPackage), prev_hash);
+        hash_proof_package(proof, prev_hash);
         
         // 更新时间
         current_time += 300000; // 5分钟（毫秒）
@@ -119,3 +126,871 @@ TEST(ProofFlowTest, SegmentCredential) {
     EXPECT_TRUE(agg_verifier.verify({credential}, merkle_tree.get_root(), enclave_key.pk, blocks.size()));
     EXPECT_TRUE(agg_verifier.spot_check(credential, proofs, enclave_key.pk));
 }
+
+TEST(ProofFlowTest, DynamicBlockUpdates) {
+    DataOwner data_owner;
+    StorageNode storage_node;
+    
+    std::vector<uint8_t> raw_file(Config::BLOCK_SIZE * 5 + 100, 0x3C);
+    std::array<uint8_t, 32> aes_key;
+    tee_get_random(aes_key.data(), 32);
+    
+    std::vector<EncryptedBlock> encrypted_blocks;
+    std::array<uint8_t, 32> file_fingerprint;
+    ASSERT_EQ(data_owner.split_and_encrypt(raw_file, aes_key, encrypted_blocks, file_fingerprint), 0);
+    ASSERT_EQ(storage_node.store_blocks(encrypted_blocks), 0);
+    MerkleTree merkle_tree;
+    ASSERT_EQ(storage_node.build_merkle_tree(encrypted_blocks, merkle_tree), 0);
+    EXPECT_EQ(merkle_tree.get_root(), file_fingerprint);
+    
+    // 重写单块：指纹变化，且两端的根保持一致
+    std::array<uint8_t, 32> old_fingerprint = file_fingerprint;
+    EncryptedBlock block;
+    std::vector<uint8_t> new_data(Config::BLOCK_SIZE, 0x7E);
+    ASSERT_EQ(data_owner.update_block(2, new_data, aes_key, block, file_fingerprint), 0);
+    ASSERT_EQ(storage_node.update_block(2, block, merkle_tree), 0);
+    EXPECT_NE(file_fingerprint, old_fingerprint);
+    EXPECT_EQ(merkle_tree.get_root(), file_fingerprint);
+    
+    // 批量重写
+    std::vector<std::pair<size_t, std::vector<uint8_t>>> updates = {{0, new_data}, {1, new_data}, {5, {1, 2, 3}}};
+    std::vector<EncryptedBlock> updated_blocks;
+    ASSERT_EQ(data_owner.update_blocks(updates, aes_key, updated_blocks, file_fingerprint), 0);
+    std::vector<std::pair<size_t, EncryptedBlock>> stored_updates;
+    for (size_t i = 0; i < updates.size(); ++i) {
+        stored_updates.emplace_back(updates[i].first, updated_blocks[i]);
+    }
+    ASSERT_EQ(storage_node.update_blocks(stored_updates, merkle_tree), 0);
+    EXPECT_EQ(merkle_tree.get_root(), file_fingerprint);
+    
+    // 追加与截断
+    ASSERT_EQ(data_owner.append_block(new_data, aes_key, block, file_fingerprint), 0);
+    ASSERT_EQ(storage_node.append_block(block, merkle_tree), 0);
+    EXPECT_EQ(storage_node.get_block_count(), 7u);
+    EXPECT_EQ(merkle_tree.get_root(), file_fingerprint);
+    
+    ASSERT_EQ(data_owner.truncate_blocks(3, file_fingerprint), 0);
+    ASSERT_EQ(storage_node.truncate_blocks(3, merkle_tree), 0);
+    EXPECT_EQ(merkle_tree.get_root(), file_fingerprint);
+    
+    // 增量维护的树与按当前块重新构建的树一致
+    std::vector<EncryptedBlock> current_blocks;
+    for (size_t i = 0; i < storage_node.get_block_count(); ++i) {
+        ASSERT_TRUE(storage_node.get_block(i, block));
+        current_blocks.push_back(block);
+    }
+    MerkleTree rebuilt;
+    ASSERT_EQ(storage_node.build_merkle_tree(current_blocks, rebuilt), 0);
+    EXPECT_EQ(rebuilt.get_root(), file_fingerprint);
+    
+    // 越界与超长块
+    EXPECT_EQ(data_owner.update_block(3, new_data, aes_key, block, file_fingerprint), -1);
+    EXPECT_EQ(storage_node.update_block(3, block, merkle_tree), -1);
+    std::vector<uint8_t> oversized(Config::BLOCK_SIZE + 1, 0);
+    EXPECT_EQ(data_owner.append_block(oversized, aes_key, block, file_fingerprint), -1);
+}
+
+TEST(ProofFlowTest, PartialMerkleTreeFromStoredBlocks) {
+    DataOwner data_owner;
+    StorageNode storage_node;
+    
+    std::vector<uint8_t> raw_file(Config::BLOCK_SIZE * 37, 0x42);
+    std::array<uint8_t, 32> aes_key;
+    tee_get_random(aes_key.data(), 32);
+    std::vector<EncryptedBlock> encrypted_blocks;
+    std::array<uint8_t, 32> file_fingerprint;
+    ASSERT_EQ(data_owner.split_and_encrypt(raw_file, aes_key, encrypted_blocks, file_fingerprint), 0);
+    ASSERT_EQ(storage_node.store_blocks(encrypted_blocks), 0);
+    
+    // 37块的树高为6，只保留顶部2层：每次取证明从已存储的块重算一棵32叶子的子树
+    PartialMerkleTree partial_tree;
+    ASSERT_EQ(storage_node.build_partial_merkle_tree(2, partial_tree), 0);
+    EXPECT_EQ(partial_tree.get_root(), file_fingerprint);
+    EXPECT_EQ(partial_tree.subtree_leaves(), 32u);
+    
+    std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+    for (size_t idx : {0, 17, 36}) {
+        ASSERT_TRUE(partial_tree.get_proof(idx, path));
+        EXPECT_TRUE(MerkleTree::verify_proof(hash_encrypted_block(encrypted_blocks[idx]), path, file_fingerprint));
+    }
+}
+
+TEST(ProofFlowTest, FusedIngest) {
+    DataOwner data_owner;
+    StorageNode storage_node;
+    
+    std::vector<uint8_t> raw_file(Config::BLOCK_SIZE * 50 + 7);
+    for (size_t i = 0; i < raw_file.size(); ++i) {
+        raw_file[i] = static_cast<uint8_t>(i * 31);
+    }
+    std::array<uint8_t, 32> aes_key;
+    tee_get_random(aes_key.data(), 32);
+    
+    std::array<uint8_t, 32> file_fingerprint;
+    MerkleTree merkle_tree;
+    ASSERT_EQ(ingest_file(data_owner, storage_node, raw_file, aes_key, file_fingerprint, merkle_tree), 0);
+    EXPECT_EQ(storage_node.get_block_count(), 51u);
+    EXPECT_EQ(merkle_tree.get_root(), file_fingerprint);
+    
+    // 与存储节点自行重建的树一致
+    std::vector<EncryptedBlock> blocks(storage_node.get_block_count());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        ASSERT_TRUE(storage_node.get_block(i, blocks[i]));
+    }
+    MerkleTree rebuilt;
+    ASSERT_EQ(storage_node.build_merkle_tree(blocks, rebuilt), 0);
+    EXPECT_EQ(rebuilt.get_root(), file_fingerprint);
+    
+    // 叶子数不符或叶子与存储块不符的树被拒绝
+    MerkleTree adopted;
+    MerkleTree::NodeBuffer fake_leaves(blocks.size());
+    EXPECT_EQ(storage_node.adopt_merkle_tree(MerkleTree(std::move(fake_leaves)), adopted), -1);
+    std::vector<std::array<uint8_t, 32>> short_leaves(blocks.size() - 1);
+    EXPECT_EQ(storage_node.adopt_merkle_tree(MerkleTree(short_leaves), adopted), -1);
+    
+    // 空文件无法入库
+    DataOwner empty_owner;
+    StorageNode empty_node;
+    EXPECT_EQ(ingest_file(empty_owner, empty_node, {}, aes_key, file_fingerprint, merkle_tree), -1);
+}
+
+TEST(ProofFlowTest, StreamingFileIngest) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string file_path = (dir / "tee_stream_ingest_test.bin").string();
+    const std::string tree_path = (dir / "tee_stream_ingest_test.tree").string();
+    
+    std::vector<uint8_t> raw_file(Config::BLOCK_SIZE * 37 + Config::BLOCK_SIZE / 2);
+    for (size_t i = 0; i < raw_file.size(); ++i) {
+        raw_file[i] = static_cast<uint8_t>(i * 13 + 5);
+    }
+    FILE* f = fopen(file_path.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    ASSERT_EQ(fwrite(raw_file.data(), 1, raw_file.size(), f), raw_file.size());
+    fclose(f);
+    
+    std::array<uint8_t, 32> aes_key;
+    tee_get_random(aes_key.data(), 32);
+    
+    // 读缓冲区只有4块，文件需要分10次读入
+    DataOwner data_owner;
+    StorageNode storage_node;
+    StorageNodeSink sink(storage_node);
+    ASSERT_EQ(sink.open_tree(tree_path), 0);
+    std::array<uint8_t, 32> file_fingerprint;
+    ASSERT_EQ(data_owner.split_and_encrypt_file(file_path, aes_key, sink, file_fingerprint,
+                                                Config::BLOCK_SIZE * 4), 0);
+    std::array<uint8_t, 32> tree_root;
+    ASSERT_EQ(sink.finish(tree_root), 0);
+    EXPECT_EQ(tree_root, file_fingerprint);
+    ASSERT_EQ(storage_node.get_block_count(), 38u);
+    
+    // 块可解密还原文件，且与内存中重建的树一致
+    std::vector<EncryptedBlock> blocks(storage_node.get_block_count());
+    std::vector<uint8_t> restored;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        ASSERT_TRUE(storage_node.get_block(i, blocks[i]));
+        std::vector<uint8_t> plaintext;
+        ASSERT_EQ(aes_gcm_decrypt(aes_key, blocks[i].ciphertext, blocks[i].iv, blocks[i].auth_tag, plaintext), 0);
+        restored.insert(restored.end(), plaintext.begin(), plaintext.end());
+    }
+    EXPECT_EQ(restored, raw_file);
+    MerkleTree rebuilt;
+    ASSERT_EQ(storage_node.build_merkle_tree(blocks, rebuilt), 0);
+    EXPECT_EQ(rebuilt.get_root(), file_fingerprint);
+    
+    DiskMerkleTree disk_tree;
+    ASSERT_EQ(disk_tree.open(tree_path), 0);
+    EXPECT_EQ(disk_tree.get_root(), file_fingerprint);
+    disk_tree.close();
+    
+    // 不存在的文件
+    StorageNode other_node;
+    StorageNodeSink other_sink(other_node);
+    EXPECT_EQ(data_owner.split_and_encrypt_file(file_path + ".missing", aes_key, other_sink, file_fingerprint), -1);
+    
+    // 未打开磁盘树时 finish 返回-1，但已接收的块已经落盘
+    const std::filesystem::path store_dir = dir / "tee_stream_ingest_test_store";
+    std::filesystem::remove_all(store_dir);
+    {
+        StorageNode disk_node;
+        ASSERT_EQ(disk_node.open_block_store(store_dir.string()), 0);
+        StorageNodeSink disk_sink(disk_node);
+        ASSERT_EQ(data_owner.split_and_encrypt_file(file_path, aes_key, disk_sink, file_fingerprint), 0);
+        EXPECT_EQ(disk_sink.finish(tree_root), -1);
+        BlockStoreHeader header{};
+        FILE* index = std::fopen((store_dir / "index.dat").string().c_str(), "rb");
+        ASSERT_NE(index, nullptr);
+        ASSERT_EQ(std::fread(&header, sizeof(header), 1, index), 1u);
+        std::fclose(index);
+        EXPECT_EQ(header.block_count, 38u);
+    }
+    std::filesystem::remove_all(store_dir);
+    
+    std::remove(file_path.c_str());
+    std::remove(tree_path.c_str());
+}
+
+TEST(ProofFlowTest, ParallelSplitAndEncrypt) {
+    std::vector<uint8_t> raw_file(1024 * 3000 + 500);
+    for (size_t i = 0; i < raw_file.size(); ++i) {
+        raw_file[i] = static_cast<uint8_t>(i ^ (i >> 9));
+    }
+    std::array<uint8_t, 32> key;
+    key.fill(0x5A);
+    
+    // 多线程加密的文件指纹与存储节点按块重建的树根一致
+    DataOwner data_owner;
+    data_owner.set_encrypt_threads(4);
+    std::vector<EncryptedBlock> blocks;
+    std::array<uint8_t, 32> fingerprint;
+    ASSERT_EQ(data_owner.split_and_encrypt(raw_file, key, blocks, fingerprint), 0);
+    ASSERT_EQ(blocks.size(), 3001u);
+    
+    StorageNode storage_node;
+    MerkleTree tree;
+    ASSERT_EQ(storage_node.build_merkle_tree(blocks, tree), 0);
+    EXPECT_EQ(tree.get_root(), fingerprint);
+    EXPECT_EQ(data_owner.get_file_tree().get_root(), fingerprint);
+    
+    std::vector<uint8_t> decrypted;
+    ASSERT_EQ(aes_gcm_decrypt(key, blocks[3000].ciphertext, blocks[3000].iv, blocks[3000].auth_tag, decrypted), 0);
+    EXPECT_EQ(decrypted, std::vector<uint8_t>(raw_file.begin() + 3000 * 1024, raw_file.end()));
+    
+    // 写入连续存储的块集合，移交给存储节点后重建的树与指纹一致
+    EncryptedBlockSet block_set;
+    ASSERT_EQ(data_owner.split_and_encrypt(raw_file, key, block_set, fingerprint), 0);
+    ASSERT_EQ(block_set.size(), 3001u);
+    ASSERT_EQ(storage_node.store_blocks(std::move(block_set)), 0);
+    ASSERT_EQ(storage_node.get_block_count(), 3001u);
+    ASSERT_EQ(storage_node.build_merkle_tree(storage_node.get_blocks(), tree), 0);
+    EXPECT_EQ(tree.get_root(), fingerprint);
+    
+    EncryptedBlockView view;
+    ASSERT_TRUE(storage_node.get_block_view(3000, view));
+    EncryptedBlock last = view.to_block();
+    ASSERT_EQ(aes_gcm_decrypt(key, last.ciphertext, last.iv, last.auth_tag, decrypted), 0);
+    EXPECT_EQ(decrypted, std::vector<uint8_t>(raw_file.begin() + 3000 * 1024, raw_file.end()));
+    EXPECT_FALSE(storage_node.get_block_view(3001, view));
+}
+
+TEST(ProofFlowTest, DiskBlockStore) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tee_block_store_test";
+    std::filesystem::remove_all(dir);
+    
+    std::vector<uint8_t> raw_file(1024 * 300 + 77);
+    for (size_t i = 0; i < raw_file.size(); ++i) {
+        raw_file[i] = static_cast<uint8_t>(i * 7 + (i >> 11));
+    }
+    std::array<uint8_t, 32> key;
+    key.fill(0x3C);
+    DataOwner data_owner;
+    EncryptedBlockSet block_set;
+    std::array<uint8_t, 32> fingerprint;
+    ASSERT_EQ(data_owner.split_and_encrypt(raw_file, key, block_set, fingerprint), 0);
+    ASSERT_EQ(block_set.size(), 301u);
+    
+    // 段文件只有128KB，301块需要分布在多个段中
+    std::array<uint8_t, 32> root;
+    {
+        StorageNode storage_node;
+        ASSERT_EQ(storage_node.open_block_store(dir.string(), 1 << 17), 0);
+        ASSERT_EQ(storage_node.store_blocks(std::move(block_set)), 0);
+        ASSERT_EQ(storage_node.get_block_count(), 301u);
+        EXPECT_TRUE(storage_node.get_blocks().empty());
+        
+        MerkleTree tree;
+        ASSERT_EQ(storage_node.build_merkle_tree(tree), 0);
+        EXPECT_EQ(tree.get_root(), fingerprint);
+        
+        // 修改、追加、截断都落到磁盘上，且与内存中的树保持一致
+        EncryptedBlock block;
+        ASSERT_TRUE(storage_node.get_block(5, block));
+        block.ciphertext[0] ^= 0xFF;
+        ASSERT_EQ(storage_node.update_block(5, block, tree), 0);
+        ASSERT_EQ(storage_node.append_block(block, tree), 0);
+        ASSERT_EQ(storage_node.append_block(block, tree), 0);
+        ASSERT_EQ(storage_node.truncate_blocks(302, tree), 0);
+        ASSERT_EQ(storage_node.get_block_count(), 302u);
+        
+        EncryptedBlockView view;
+        ASSERT_TRUE(storage_node.get_block_view(301, view));
+        EXPECT_EQ(view.to_block().ciphertext, block.ciphertext);
+        EXPECT_FALSE(storage_node.get_block_view(302, view));
+        
+        MerkleTree rebuilt;
+        ASSERT_EQ(storage_node.build_merkle_tree(rebuilt), 0);
+        EXPECT_EQ(rebuilt.get_root(), tree.get_root());
+        root = tree.get_root();
+        
+        // 密文超过索引项能表示的长度
+        EncryptedBlock oversized = block;
+        oversized.ciphertext.resize(BlockStore::MAX_CIPHERTEXT_SIZE + 1);
+        EXPECT_EQ(storage_node.append_block(oversized, tree), -1);
+    }
+    
+    // 重新打开只读取索引，恢复的块和树根与关闭前一致
+    {
+        StorageNode storage_node;
+        ASSERT_EQ(storage_node.open_block_store(dir.string()), 0);
+        ASSERT_EQ(storage_node.get_block_count(), 302u);
+        MerkleTree tree;
+        ASSERT_EQ(storage_node.build_merkle_tree(tree), 0);
+        EXPECT_EQ(tree.get_root(), root);
+        
+        PartialMerkleTree partial;
+        ASSERT_EQ(storage_node.build_partial_merkle_tree(3, partial), 0);
+        EXPECT_EQ(partial.get_root(), root);
+        
+        EncryptedBlock block;
+        std::vector<uint8_t> decrypted;
+        ASSERT_TRUE(storage_node.get_block(300, block));
+        ASSERT_EQ(aes_gcm_decrypt(key, block.ciphertext, block.iv, block.auth_tag, decrypted), 0);
+        EXPECT_EQ(decrypted, std::vector<uint8_t>(raw_file.begin() + 300 * 1024, raw_file.end()));
+    }
+    
+    // 已有内存中的块时不能再切换到磁盘存储
+    StorageNode memory_node;
+    std::vector<EncryptedBlock> blocks(1);
+    ASSERT_EQ(memory_node.store_blocks(blocks), 0);
+    EXPECT_EQ(memory_node.open_block_store(dir.string()), -1);
+    
+    // 篡改索引文件中的一个8字节字段后重新打开应失败（不创建或扩展段文件），恢复后可以正常打开
+    auto reopen_with = [&](long offset, uint64_t value) {
+        const std::string index_path = (dir / "index.dat").string();
+        FILE* index = std::fopen(index_path.c_str(), "r+b");
+        uint64_t original = 0;
+        bool patched = index && std::fseek(index, offset, SEEK_SET) == 0 &&
+                       std::fread(&original, sizeof(original), 1, index) == 1 &&
+                       std::fseek(index, offset, SEEK_SET) == 0 &&
+                       std::fwrite(&value, sizeof(value), 1, index) == 1;
+        if (index) {
+            std::fclose(index);
+        }
+        int ret = patched ? 0 : -2;
+        if (patched) {
+            BlockStore store;
+            ret = store.open(dir.string());
+        }
+        index = std::fopen(index_path.c_str(), "r+b");
+        if (index) {
+            std::fseek(index, offset, SEEK_SET);
+            std::fwrite(&original, sizeof(original), 1, index);
+            std::fclose(index);
+        }
+        return ret;
+    };
+    auto segment_files = [&]() {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            count += entry.path().filename().string().rfind("segment_", 0) == 0 ? 1 : 0;
+        }
+        return count;
+    };
+    const size_t segments = segment_files();
+    const long segment_bytes_offset = static_cast<long>(offsetof(BlockStoreHeader, segment_bytes));
+    const long tail_offset = static_cast<long>(offsetof(BlockStoreHeader, tail));
+    EXPECT_EQ(reopen_with(segment_bytes_offset, uint64_t(1) << 50), -1);
+    EXPECT_EQ(reopen_with(tail_offset, uint64_t(40) << 17), -1);
+    EXPECT_EQ(segment_files(), segments);
+    // 索引项的记录跨出所在的段（偏移在第0段末尾，长度仍在 tail 以内）
+    uint64_t crossing = ((uint64_t(1) << 17) - 100) | (uint64_t(1024) << 48);
+    EXPECT_EQ(reopen_with(static_cast<long>(sizeof(BlockStoreHeader)), crossing), -1);
+    {
+        BlockStore store;
+        ASSERT_EQ(store.open(dir.string()), 0);
+        EXPECT_EQ(store.size(), 302u);
+        
+        // 批量追加中途失败（超长密文）时本批全部撤销
+        std::vector<EncryptedBlock> batch(3);
+        for (auto& block : batch) {
+            block.ciphertext.assign(500, 0x21);
+        }
+        batch[1].ciphertext.resize(BlockStore::MAX_CIPHERTEXT_SIZE + 1);
+        EXPECT_EQ(store.append_blocks(batch), -1);
+        EXPECT_EQ(store.size(), 302u);
+        EncryptedBlock last;
+        EXPECT_TRUE(store.get_block(301, last));
+    }
+    EXPECT_EQ(segment_files(), segments);
+    
+    // 文件头中的块数被篡改为乘以索引项大小后溢出的值，重新打开应失败而不是越界读取
+    {
+        uint64_t bogus_count = uint64_t(1) << 61;
+        FILE* index = std::fopen((dir / "index.dat").string().c_str(), "r+b");
+        ASSERT_NE(index, nullptr);
+        ASSERT_EQ(std::fseek(index, offsetof(BlockStoreHeader, block_count), SEEK_SET), 0);
+        ASSERT_EQ(std::fwrite(&bogus_count, sizeof(bogus_count), 1, index), 1u);
+        std::fclose(index);
+        StorageNode storage_node;
+        EXPECT_EQ(storage_node.open_block_store(dir.string()), -1);
+    }
+    
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ProofFlowTest, AsyncBlockReads) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tee_async_read_test";
+    std::filesystem::remove_all(dir);
+    
+    std::vector<uint8_t> raw_file(1024 * 200 + 300);
+    for (size_t i = 0; i < raw_file.size(); ++i) {
+        raw_file[i] = static_cast<uint8_t>(i * 29 + (i >> 10));
+    }
+    std::array<uint8_t, 32> key;
+    key.fill(0x6B);
+    DataOwner data_owner;
+    EncryptedBlockSet block_set;
+    std::array<uint8_t, 32> fingerprint;
+    ASSERT_EQ(data_owner.split_and_encrypt(raw_file, key, block_set, fingerprint), 0);
+    
+    StorageNode storage_node;
+    ASSERT_EQ(storage_node.open_block_store(dir.string(), 1 << 17), 0);
+    ASSERT_EQ(storage_node.store_blocks(std::move(block_set)), 0);
+    const BlockStore* store = storage_node.get_block_store();
+    ASSERT_NE(store, nullptr);
+    MerkleTree tree;
+    ASSERT_EQ(storage_node.build_merkle_tree(tree), 0);
+    
+    // io_uring 与线程池两种后端读出的块都与映射读取一致；队列深度小于请求数，需要随完成补充
+    for (bool allow_io_uring : {true, false}) {
+        AsyncBlockReader reader;
+        ASSERT_EQ(reader.open(*store, 4, allow_io_uring), 0);
+        if (!allow_io_uring) {
+            EXPECT_FALSE(reader.uses_io_uring());
+        }
+        
+        std::vector<size_t> indices = {0, 200, 7, 7, 150, 199, 63, 64, 128, 1};
+        std::vector<int> status(indices.size(), 1);
+        auto check = [&](size_t request, int st, const EncryptedBlockView& block) {
+            status[request] = st;
+            std::array<uint8_t, 32> leaf;
+            if (st == 0 && (!tree.get_leaf(indices[request], leaf) || leaf != hash_encrypted_block(block))) {
+                status[request] = 2;
+            }
+        };
+        ASSERT_EQ(reader.read_blocks(indices.data(), indices.size(), check), 0);
+        EXPECT_EQ(status, std::vector<int>(indices.size(), 0));
+        
+        // 越界的请求单独失败，其余照常完成
+        indices.push_back(201);
+        status.assign(indices.size(), 1);
+        EXPECT_EQ(reader.read_blocks(indices.data(), indices.size(), check), -1);
+        EXPECT_EQ(status.back(), -1);
+        EXPECT_EQ(std::vector<int>(status.begin(), status.end() - 1), std::vector<int>(indices.size() - 1, 0));
+    }
+    
+    // 读取器打开后追加的块（可能落在新段中）也能读到
+    AsyncBlockReader reader;
+    ASSERT_EQ(reader.open(*store), 0);
+    EncryptedBlock block;
+    ASSERT_TRUE(storage_node.get_block(3, block));
+    for (int i = 0; i < 130; ++i) {
+        ASSERT_EQ(storage_node.append_block(block, tree), 0);
+    }
+    size_t last = storage_node.get_block_count() - 1;
+    std::vector<uint8_t> ciphertext;
+    ASSERT_EQ(reader.read_blocks(&last, 1, [&](size_t, int st, const EncryptedBlockView& view) {
+        if (st == 0) {
+            ciphertext = view.to_block().ciphertext;
+        }
+    }), 0);
+    EXPECT_EQ(ciphertext, block.ciphertext);
+    reader.close();
+    
+    // 后端等待失败：在途与未提交的请求都以失败回调，读取器随即关闭
+    struct FailingBackend : AsyncBlockReader::Backend {
+        int open_segment(size_t, const std::string&) override { return 0; }
+        int submit(size_t, uint64_t, uint8_t*, size_t, size_t) override { return 0; }
+        int wait(std::vector<std::pair<size_t, int>>&) override { return -1; }
+    };
+    ASSERT_EQ(reader.open(*store, std::make_unique<FailingBackend>(), 2), 0);
+    std::vector<size_t> indices = {0, 1, 2, 3, 4};
+    std::vector<int> status(indices.size(), 1);
+    EXPECT_EQ(reader.read_blocks(indices.data(), indices.size(), [&](size_t request, int st, const EncryptedBlockView&) {
+        status[request] = st;
+    }), -1);
+    EXPECT_EQ(status, std::vector<int>(indices.size(), -1));
+    EXPECT_FALSE(reader.is_open());
+    EXPECT_EQ(reader.read_blocks(indices.data(), indices.size(), [](size_t, int, const EncryptedBlockView&) {}), -1);
+    
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ProofFlowTest, ProofChainHash) {
+    std::vector<uint8_t> raw_file(1024 * 20 + 77);
+    for (size_t i = 0; i < raw_file.size(); ++i) {
+        raw_file[i] = static_cast<uint8_t>(i * 13);
+    }
+    std::array<uint8_t, 32> key;
+    key.fill(0x2D);
+    DataOwner data_owner;
+    EncryptedBlockSet blocks;
+    std::array<uint8_t, 32> fingerprint;
+    ASSERT_EQ(data_owner.split_and_encrypt(raw_file, key, blocks, fingerprint), 0);
+    StorageNode storage_node;
+    ASSERT_EQ(storage_node.store_blocks(std::move(blocks)), 0);
+    MerkleTree tree;
+    ASSERT_EQ(storage_node.build_merkle_tree(tree), 0);
+    
+    // Ed25519 签名是确定性的：同样的输入两次构建出的证明包内容相同，链式指针也必须相同
+    EnclaveKeyPair enclave_key;
+    ASSERT_EQ(tee_init_key_pair(enclave_key, SignatureScheme::ED25519), 0);
+    std::vector<std::pair<std::array<uint8_t, 32>, uint32_t>> challenges;
+    for (uint32_t i = 0; i < 6; ++i) {
+        std::array<uint8_t, 32> r;
+        r.fill(static_cast<uint8_t>(i + 1));
+        challenges.emplace_back(r, (i * 7) % static_cast<uint32_t>(storage_node.get_block_count()));
+    }
+    std::array<uint8_t, 32> prev_hash;
+    prev_hash.fill(0x11);
+    ProofBuilder proof_builder;
+    std::vector<ProofPackage> first, second;
+    ASSERT_EQ(proof_builder.build_proof_packages(enclave_key, tree, storage_node, challenges, 0.5, 9, 1000,
+                                                 prev_hash, first), 0);
+    ASSERT_EQ(proof_builder.build_proof_packages(enclave_key, tree, storage_node, challenges, 0.5, 9, 1000,
+                                                 prev_hash, second), 0);
+    ASSERT_EQ(first.size(), challenges.size());
+    ASSERT_EQ(second.size(), challenges.size());
+    EXPECT_EQ(first[0].prev_hash, prev_hash);
+    for (size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(first[i].prev_hash, second[i].prev_hash) << i;
+        if (i > 0) {
+            // 验证者从收到的证明包（另一份拷贝）即可重算链式指针
+            ProofPackage received = first[i - 1];
+            std::array<uint8_t, 32> expected;
+            hash_proof_package(received, expected);
+            EXPECT_EQ(first[i].prev_hash, expected) << i;
+        }
+    }
+    
+    // 链式哈希覆盖Merkle路径的内容
+    std::array<uint8_t, 32> original, tampered;
+    hash_proof_package(first[1], original);
+    first[1].merkle_path.back() ^= 0x01;
+    hash_proof_package(first[1], tampered);
+    EXPECT_NE(original, tampered);
+}
+
+TEST(ProofFlowTest, HotBlockCache) {
+    // CLOCK 淘汰：容量只够放下少量块，刚被访问过的块在下一轮淘汰中得以保留
+    std::array<uint8_t, 12> iv{};
+    std::array<uint8_t, 16> tag{};
+    std::vector<uint8_t> ciphertext(1000, 0x42);
+    EncryptedBlockView view(ciphertext.data(), ciphertext.size(), iv, tag);
+    BlockCache cache(4 * 1200, 1);
+    std::array<uint8_t, 32> leaf{};
+    for (size_t i = 0; i < 4; ++i) {
+        leaf[0] = static_cast<uint8_t>(i);
+        cache.insert(i, leaf, &view);
+    }
+    std::array<uint8_t, 32> found;
+    ASSERT_TRUE(cache.lookup_leaf(0, found));
+    EXPECT_EQ(found[0], 0);
+    cache.insert(4, leaf, &view);
+    EXPECT_TRUE(cache.contains(0, true));
+    EXPECT_FALSE(cache.contains(1, false));
+    EncryptedBlock block;
+    ASSERT_TRUE(cache.lookup_block(4, block));
+    EXPECT_EQ(block.ciphertext, ciphertext);
+    EXPECT_FALSE(cache.lookup_leaf(1, found));
+    BlockCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_LE(cache.memory_bytes(), cache.capacity_bytes());
+    
+    // 存储节点：挑战公布后预取，生成证明时叶子哈希全部命中缓存
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tee_block_cache_test";
+    std::filesystem::remove_all(dir);
+    std::vector<uint8_t> raw_file(1024 * 500);
+    for (size_t i = 0; i < raw_file.size(); ++i) {
+        raw_file[i] = static_cast<uint8_t>(i * 3 + (i >> 12));
+    }
+    std::array<uint8_t, 32> key;
+    key.fill(0x21);
+    DataOwner data_owner;
+    EncryptedBlockSet block_set;
+    std::array<uint8_t, 32> fingerprint;
+    ASSERT_EQ(data_owner.split_and_encrypt(raw_file, key, block_set, fingerprint), 0);
+    
+    for (bool on_disk : {false, true}) {
+        StorageNode storage_node;
+        if (on_disk) {
+            ASSERT_EQ(storage_node.open_block_store(dir.string()), 0);
+        }
+        ASSERT_EQ(storage_node.store_blocks(EncryptedBlockSet(block_set)), 0);
+        storage_node.set_block_cache(1 << 20);
+        MerkleTree tree;
+        ASSERT_EQ(storage_node.build_merkle_tree(tree), 0);
+        
+        ChallengeGenerator challenge_gen;
+        std::vector<std::pair<std::array<uint8_t, 32>, uint32_t>> challenges;
+        ASSERT_EQ(challenge_gen.generate_batch_challenges(64, storage_node.get_block_count(), challenges), 0);
+        std::vector<size_t> indices;
+        for (const auto& challenge : challenges) {
+            indices.push_back(challenge.second);
+        }
+        ASSERT_EQ(storage_node.prefetch_blocks(indices), 0);
+        const BlockCache* node_cache = storage_node.get_block_cache();
+        ASSERT_NE(node_cache, nullptr);
+        EXPECT_EQ(node_cache->stats().misses, 0u);
+        for (size_t index : indices) {
+            std::array<uint8_t, 32> stored_leaf, tree_leaf;
+            ASSERT_TRUE(storage_node.get_block_leaf(index, stored_leaf));
+            ASSERT_TRUE(tree.get_leaf(index, tree_leaf));
+            EXPECT_EQ(stored_leaf, tree_leaf);
+        }
+        EXPECT_EQ(node_cache->stats().hits, indices.size());
+        EXPECT_EQ(storage_node.prefetch_blocks({storage_node.get_block_count()}), -1);
+        
+        // 修改后的块不会从缓存中读到旧内容
+        EncryptedBlock block;
+        ASSERT_TRUE(storage_node.get_block(indices[0], block));
+        block.ciphertext[0] ^= 0x01;
+        ASSERT_EQ(storage_node.update_block(indices[0], block, tree), 0);
+        std::array<uint8_t, 32> updated_leaf, tree_leaf;
+        ASSERT_TRUE(storage_node.get_block_leaf(indices[0], updated_leaf));
+        ASSERT_TRUE(tree.get_leaf(indices[0], tree_leaf));
+        EXPECT_EQ(updated_leaf, tree_leaf);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ProofFlowTest, MultiFileRegistry) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tee_file_registry_test";
+    std::filesystem::remove_all(dir);
+    
+    // 两个数据所有者各上传若干文件
+    std::array<uint8_t, 32> key;
+    key.fill(0x17);
+    DataOwner data_owner;
+    FileRegistry registry(dir.string());
+    std::vector<std::array<uint8_t, 32>> fingerprints;
+    size_t block_bytes = 0, tree_bytes = 0;
+    for (size_t f = 0; f < 12; ++f) {
+        std::vector<uint8_t> raw_file(1024 * (40 + f * 7) + f);
+        for (size_t i = 0; i < raw_file.size(); ++i) {
+            raw_file[i] = static_cast<uint8_t>(i * (f + 3) + f);
+        }
+        EncryptedBlockSet blocks;
+        std::array<uint8_t, 32> fingerprint;
+        ASSERT_EQ(data_owner.split_and_encrypt(raw_file, key, blocks, fingerprint), 0);
+        auto storage = std::make_unique<StorageNode>();
+        ASSERT_EQ(storage->store_blocks(std::move(blocks)), 0);
+        MerkleTree tree;
+        ASSERT_EQ(storage->build_merkle_tree(tree), 0);
+        ASSERT_EQ(tree.get_root(), fingerprint);
+        block_bytes += storage->get_blocks().memory_bytes();
+        tree_bytes += tree.memory_bytes();
+        MerkleTree duplicate = tree;
+        ASSERT_EQ(registry.add_file(f % 2 ? "owner-b" : "owner-a", std::move(storage), std::move(tree)), 0);
+        if (f == 0) {
+            // 同一指纹不能注册两次
+            auto other = std::make_unique<StorageNode>();
+            ASSERT_EQ(other->store_blocks(std::vector<EncryptedBlock>(duplicate.leaf_count())), 0);
+            EXPECT_EQ(registry.add_file("owner-a", std::move(other), std::move(duplicate)), -1);
+        }
+        fingerprints.push_back(fingerprint);
+    }
+    ASSERT_EQ(registry.file_count(), 12u);
+    EXPECT_EQ(registry.memory_bytes(), block_bytes + tree_bytes);
+    EXPECT_EQ(registry.owner_memory_bytes("owner-a") + registry.owner_memory_bytes("owner-b"),
+              registry.memory_bytes());
+    
+    // 多个证明线程并发取证明，同时把内存预算压低到只够一半的树常驻（内存中的块不能逐出），触发冷树逐出
+    auto prove_all = [&](size_t seed, bool& ok) {
+        for (size_t n = 0; n < 200; ++n) {
+            const auto& fingerprint = fingerprints[(seed + n) % fingerprints.size()];
+            std::shared_ptr<HostedFile> file = registry.find(fingerprint);
+            if (!file) {
+                ok = false;
+                continue;
+            }
+            std::array<uint8_t, 32> leaf;
+            std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+            size_t idx = (n * 37) % file->leaf_count();
+            ok &= file->get_leaf(idx, leaf) && file->get_proof(idx, path) &&
+                  MerkleTree::verify_proof(leaf, path, fingerprint);
+        }
+    };
+    bool ok[4] = {true, true, true, true};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < 4; ++t) {
+        workers.emplace_back(prove_all, t, std::ref(ok[t]));
+    }
+    const size_t budget = block_bytes + tree_bytes / 2;
+    registry.set_memory_budget(budget);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (bool worker_ok : ok) {
+        EXPECT_TRUE(worker_ok);
+    }
+    EXPECT_LE(registry.memory_bytes(), budget);
+    size_t evicted = 0;
+    for (const auto& fingerprint : fingerprints) {
+        evicted += registry.find(fingerprint)->tree_resident() ? 0 : 1;
+    }
+    EXPECT_GT(evicted, 0u);
+    
+    // 修改已逐出的文件：树先加载回内存，更新后的根与数据所有者的新指纹一致
+    registry.set_memory_budget(0);
+    std::array<uint8_t, 32> evicted_fp{};
+    for (const auto& fingerprint : fingerprints) {
+        if (!registry.find(fingerprint)->tree_resident()) {
+            evicted_fp = fingerprint;
+            break;
+        }
+    }
+    std::array<uint8_t, 32> new_root{};
+    ASSERT_EQ(registry.modify_file(evicted_fp, [&](StorageNode& storage, MerkleTree& tree) {
+        EncryptedBlock block;
+        if (!storage.get_block(0, block) || storage.append_block(block, tree) != 0) {
+            return -1;
+        }
+        new_root = tree.get_root();
+        return 0;
+    }), 0);
+    // 修改后按新树根索引，旧指纹查不到
+    EXPECT_EQ(registry.find(evicted_fp), nullptr);
+    std::shared_ptr<HostedFile> modified = registry.find(new_root);
+    ASSERT_NE(modified, nullptr);
+    EXPECT_EQ(modified->fingerprint(), new_root);
+    EXPECT_EQ(registry.file_count(), 12u);
+    *std::find(fingerprints.begin(), fingerprints.end(), evicted_fp) = new_root;
+    EXPECT_TRUE(modified->tree_resident());
+    EXPECT_EQ(modified->leaf_count(), modified->storage().get_block_count());
+    std::array<uint8_t, 32> leaf;
+    std::vector<std::pair<std::array<uint8_t, 32>, bool>> path;
+    ASSERT_TRUE(modified->get_leaf(modified->leaf_count() - 1, leaf));
+    ASSERT_TRUE(modified->get_proof(modified->leaf_count() - 1, path));
+    EXPECT_TRUE(MerkleTree::verify_proof(leaf, path, new_root));
+    
+    // 删除文件后内存计数随之减少
+    size_t bytes = registry.memory_bytes();
+    ASSERT_EQ(registry.remove_file(fingerprints[1]), 0);
+    EXPECT_EQ(registry.remove_file(fingerprints[1]), -1);
+    EXPECT_EQ(registry.find(fingerprints[1]), nullptr);
+    EXPECT_LT(registry.memory_bytes(), bytes);
+    EXPECT_EQ(registry.file_count(), 11u);
+    
+    // 删除已逐出的文件时仍被引用：引用释放前磁盘树照常可读，释放后树文件才被删除
+    auto spilled_files = [&]() {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            count += entry.path().extension() == ".tree" ? 1 : 0;
+        }
+        return count;
+    };
+    ASSERT_EQ(registry.evict_cold_trees(0), 0);
+    std::shared_ptr<HostedFile> held = registry.find(fingerprints[2]);
+    ASSERT_FALSE(held->tree_resident());
+    size_t spilled = spilled_files();
+    ASSERT_EQ(registry.remove_file(fingerprints[2]), 0);
+    EXPECT_EQ(spilled_files(), spilled);
+    ASSERT_TRUE(held->get_leaf(0, leaf));
+    ASSERT_TRUE(held->get_proof(0, path));
+    EXPECT_TRUE(MerkleTree::verify_proof(leaf, path, fingerprints[2]));
+    held.reset();
+    EXPECT_EQ(spilled_files(), spilled - 1);
+    
+    // 使用去重块存储的文件按引用数分摊去重块存储保存的密文；
+    // 树无法逐出（逐出目录被同名文件占据）时注册照常生效，逐出失败单独计数
+    auto chunk_store = std::make_shared<ChunkStore>();
+    auto deduped = std::make_unique<StorageNode>();
+    ASSERT_EQ(deduped->use_chunk_store(chunk_store), 0);
+    std::vector<EncryptedBlock> chunk_blocks(16);
+    for (size_t i = 0; i < chunk_blocks.size(); ++i) {
+        chunk_blocks[i].ciphertext.assign(4096, static_cast<uint8_t>(i));
+    }
+    ASSERT_EQ(deduped->store_blocks(chunk_blocks), 0);
+    MerkleTree chunk_tree;
+    ASSERT_EQ(deduped->build_merkle_tree(chunk_tree), 0);
+    const std::array<uint8_t, 32> deduped_fp = chunk_tree.get_root();
+    std::filesystem::remove_all(dir);
+    std::ofstream(dir.string()).put('x');
+    registry.set_memory_budget(1);
+    EXPECT_EQ(registry.eviction_failures(), 0u);
+    bytes = registry.memory_bytes();
+    ASSERT_EQ(registry.add_file("owner-a", std::move(deduped), std::move(chunk_tree)), 0);
+    EXPECT_EQ(registry.eviction_failures(), 1u);
+    EXPECT_GE(registry.memory_bytes() - bytes, chunk_store->stats().stored_bytes);
+    ASSERT_NE(registry.find(deduped_fp), nullptr);
+    EXPECT_TRUE(registry.find(deduped_fp)->tree_resident());
+    
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ProofFlowTest, ContentDefinedDedup) {
+    std::vector<uint8_t> v1(1024 * 300);
+    ASSERT_EQ(tee_get_random(v1.data(), v1.size()), 0);
+    std::vector<uint8_t> v2(v1);
+    v2.insert(v2.begin() + 5000, 100, 0x33);
+    v2.erase(v2.begin() + 200000, v2.begin() + 200050);
+    
+    std::array<uint8_t, 32> key;
+    key.fill(0x5C);
+    DataOwner data_owner;
+    ChunkingParams params;
+    EncryptedBlockSet blocks1, blocks2;
+    std::array<uint8_t, 32> fingerprint1, fingerprint2;
+    ASSERT_EQ(data_owner.split_and_encrypt_cdc(v1, key, params, blocks1, fingerprint1), 0);
+    ASSERT_EQ(data_owner.split_and_encrypt_cdc(v2, key, params, blocks2, fingerprint2), 0);
+    EXPECT_NE(fingerprint1, fingerprint2);
+    
+    // 块可以正常解密
+    std::vector<uint8_t> plaintext;
+    EncryptedBlock first = blocks1[0].to_block();
+    ASSERT_EQ(aes_gcm_decrypt(key, first.ciphertext, first.iv, first.auth_tag, plaintext), 0);
+    EXPECT_TRUE(std::equal(plaintext.begin(), plaintext.end(), v1.begin()));
+    
+    // 两个版本共享去重块存储：只有编辑附近的块是新的
+    auto chunk_store = std::make_shared<ChunkStore>();
+    StorageNode node1, node2;
+    ASSERT_EQ(node1.use_chunk_store(chunk_store), 0);
+    ASSERT_EQ(node2.use_chunk_store(chunk_store), 0);
+    const size_t count1 = blocks1.size();
+    const size_t count2 = blocks2.size();
+    ASSERT_EQ(node1.store_blocks(EncryptedBlockSet(blocks1)), 0);
+    size_t unique_v1 = chunk_store->stats().unique_chunks;
+    ASSERT_EQ(node2.store_blocks(EncryptedBlockSet(blocks2)), 0);
+    ChunkStore::Stats stats = chunk_store->stats();
+    EXPECT_EQ(stats.references, count1 + count2);
+    EXPECT_LE(stats.unique_chunks, unique_v1 + 8);
+    EXPECT_LT(stats.stored_bytes * 10, stats.logical_bytes * 6);
+    EXPECT_EQ(node1.open_block_store("unused"), -1);
+    
+    // 存储节点的树与数据所有者的文件指纹一致，证明流程不变
+    MerkleTree tree2;
+    ASSERT_EQ(node2.build_merkle_tree(tree2), 0);
+    EXPECT_EQ(tree2.get_root(), fingerprint2);
+    std::array<uint8_t, 32> leaf, tree_leaf;
+    ASSERT_TRUE(node2.get_block_leaf(count2 / 2, leaf));
+    ASSERT_TRUE(tree2.get_leaf(count2 / 2, tree_leaf));
+    EXPECT_EQ(leaf, tree_leaf);
+    
+    // 修改/截断只影响本节点的引用，另一版本的块保持不变
+    EncryptedBlock block;
+    ASSERT_TRUE(node2.get_block(0, block));
+    block.ciphertext[0] ^= 0x01;
+    ASSERT_EQ(node2.update_block(0, block, tree2), 0);
+    ASSERT_EQ(node2.truncate_blocks(1, tree2), 0);
+    EncryptedBlock original;
+    ASSERT_TRUE(node1.get_block(0, original));
+    EXPECT_EQ(original.ciphertext, blocks1[0].to_block().ciphertext);
+    MerkleTree tree1;
+    ASSERT_EQ(node1.build_merkle_tree(tree1), 0);
+    EXPECT_EQ(tree1.get_root(), fingerprint1);
+    EXPECT_EQ(chunk_store->stats().references, count1 + 1);
+    
+    // 整批替换中途失败（块超过最大块长）时放回已引用的新块，原有的块保持不变
+    std::vector<EncryptedBlock> oversized(2);
+    oversized[0].ciphertext.assign(4096, 0x5a);
+    oversized[1].ciphertext.resize(ChunkStore::MAX_CHUNK_SIZE + 1);
+    ASSERT_EQ(node1.store_blocks(oversized), -1);
+    EXPECT_EQ(node1.get_block_count(), count1);
+    EXPECT_EQ(chunk_store->stats().references, count1 + 1);
+    ASSERT_EQ(node1.build_merkle_tree(tree1), 0);
+    EXPECT_EQ(tree1.get_root(), fingerprint1);
+}
+